@@ -62,6 +62,14 @@
 #define gFsciMaxOpGroups_c       8
 #endif
 
+#ifndef gFsciMaxOpCodes_c
+#define gFsciMaxOpCodes_c         8 /* OpCode handlers registered with FSCI_RegisterOpCode() */
+#endif
+
+#ifndef gFsciOpCodeHashSize_c
+#define gFsciOpCodeHashSize_c    16 /* power of 2, at least 2 * gFsciMaxOpCodes_c */
+#endif
+
 #ifndef gFsciMaxInterfaces_c
 #define gFsciMaxInterfaces_c      1
 #endif
@@ -90,6 +98,39 @@
 #define gFsciUseFileDataLog_c     0 /* boolean */
 #endif
 
+/* Deferred binary logging, see FSCI_LogBinary() */
+#ifndef gFsciUseBinLog_c
+#define gFsciUseBinLog_c          0 /* boolean */
+#endif
+
+#ifndef gFsciBinLogBufferSize_c
+#define gFsciBinLogBufferSize_c   1024 /* bytes, power of 2 */
+#endif
+
+/* Streamed memory reads and writes, see FSCI_BulkReadReqFunc() */
+#ifndef gFsciUseBulkTransfer_c
+#define gFsciUseBulkTransfer_c    1 /* boolean */
+#endif
+
+#ifndef gFsciBulkFlashWrite_c
+#define gFsciBulkFlashWrite_c     0 /* boolean, allows the bulk writes to program the flash */
+#endif
+
+/* OTA image chunks received while the previous ones are programmed, see
+   FSCI_OtaPipelineInit(). 0: each chunk is processed when received */
+#ifndef gFsciOtaPipelineDepth_c
+#define gFsciOtaPipelineDepth_c   0
+#endif
+
+/* Host selected monitored events, see FSCI_MonitorSubscribe() */
+#ifndef gFsciMonitorFilter_c
+#define gFsciMonitorFilter_c      1 /* boolean */
+#endif
+
+#ifndef gFsciMonitorMaxSubscriptions_c
+#define gFsciMonitorMaxSubscriptions_c  8
+#endif
+
 #ifndef gFsciTimestampSize_c
 #define gFsciTimestampSize_c      0 /* bytes */
 #endif
@@ -114,12 +155,21 @@
 #define gFsciRxAck_c              0 /* boolean */
 #endif
 
+/* Maximum number of packets sent without waiting for an ACK, once the host
+   enabled the windowed mode (Fsci-SetTxWindow.Request). 1: stop-and-wait only */
+#ifndef gFsciTxWindowSize_c
+#define gFsciTxWindowSize_c       1 /* power of 2, [1..32] */
+#endif
+
 #ifndef gFsciRxTimeout_c
 #define gFsciRxTimeout_c          1 /* boolean */
 #endif
 
 #define mFsciInvalidInterface_c   (0xFF)
 
+/* Matches all the OpCodes of a monitored OpGroup */
+#define gFsciMonitorAnyOpCode_c   (0x100)
+
 /* Used for maintaining backward compatibillity */
 #define gFSCI_McpsSapId_c  1
 #define gFSCI_MlmeSapId_c  2
@@ -136,6 +186,7 @@
  * in intended for or received from.
  */
 #define gFSCI_LoggingOpcodeGroup_c       0xB0    /* FSCI data logging utillity    */
+#define gFSCI_BinLogOpCode_c             0x10    /* Deferred binary log records   */
 #define gFSCI_ReqOpcodeGroup_c           0xA3    /* FSCI utility Requests         */
 #define gFSCI_CnfOpcodeGroup_c           0xA4    /* FSCI utility Confirmations/Indications    */
 #define gFSCI_ReservedOpGroup_c          0x52
@@ -239,6 +290,15 @@ typedef enum{
     gFsciInvalidMode = 0xFF
 } gFsciMode_t;
 
+/* Counters of a monitor subscription */
+typedef struct fsciMonitorStats_tag
+{
+    opGroup_t opGroup;
+    uint16_t  opCode;   /* gFsciMonitorAnyOpCode_c for all the OpCodes */
+    uint32_t  sent;     /* events sent to the host */
+    uint32_t  dropped;  /* events skipped by the sampling or the rate limit */
+} fsciMonitorStats_t;
+
 /* FSCI Serial Interface initialization structure */
 typedef struct{
     uint32_t              baudrate;
@@ -269,9 +329,21 @@ gFsciStatus_t FSCI_RegisterOpGroup (opGroup_t opGroup, gFsciMode_t mode,
                                     pfMsgHandler_t pfHandler,
                                     void* param,
                                     uint32_t fsciInterface);
+gFsciStatus_t FSCI_RegisterOpCode (opGroup_t opGroup, opCode_t opCode,
+                                   pfMsgHandler_t pfHandler,
+                                   void* param,
+                                   uint32_t fsciInterface);
 
 /* Monitoring SAPs */
 gFsciStatus_t FSCI_Monitor (opGroup_t opGroup, void *pData, void* param, uint32_t fsciInterface);
+gFsciStatus_t FSCI_MonitorOpCode (opGroup_t opGroup, opCode_t opCode, void *pData, void* param, uint32_t fsciInterface);
+
+#if gFsciMonitorFilter_c
+gFsciStatus_t FSCI_MonitorSubscribe (opGroup_t opGroup, uint16_t opCode, uint8_t sampleRate, uint16_t maxRate);
+gFsciStatus_t FSCI_MonitorUnsubscribe (opGroup_t opGroup, uint16_t opCode);
+void FSCI_MonitorFilterReset (bool_t monitorAll);
+bool_t FSCI_MonitorGetStats (uint8_t index, fsciMonitorStats_t *pStats);
+#endif
 
 gFsciStatus_t FSCI_ProcessRxPkt (clientPacket_t* pPacket, uint32_t fsciInterface);
 gFsciStatus_t FSCI_CallRegisteredFunc (opGroup_t opGroup, void *pData, uint32_t fsciInterface);
@@ -301,6 +373,12 @@ void FSCI_LogFormatedText (const char *fmt, ...);
 void FSCI_LogToFile (char *fileName, uint8_t *pData, uint16_t dataSize, uint8_t mode);
 #endif
 
+#if gFsciUseBinLog_c
+void FSCI_BinLogInit (void);
+void FSCI_LogBinary (const char *fmt, uint32_t argc, ...);
+void FSCI_BinLogFlush (void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
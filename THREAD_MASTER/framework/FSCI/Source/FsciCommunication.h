@@ -46,6 +46,7 @@
 #include "SerialManager.h"
 #include "TimersManager.h"
 #include "FsciInterface.h"
+#include "FsciParser.h"
 
 #include "fsl_os_abstraction.h"
 
@@ -57,22 +58,45 @@
 #define mFsciRxTimeoutUsePolling_c 0
 #endif
 
+#if gFsciTxWindowSize_c > 1
+#if !gFsciRxAck_c || !gFsciTxAck_c
+#error The windowed mode requires gFsciRxAck_c and gFsciTxAck_c
+#endif
+#if gFsciMaxVirtualInterfaces_c
+#error The windowed mode does not support virtual interfaces
+#endif
+#if (gFsciTxWindowSize_c & (gFsciTxWindowSize_c - 1)) || (gFsciTxWindowSize_c > gFSCI_SeqModulo_c / 2)
+#error gFsciTxWindowSize_c must be a power of 2, at most 32
+#endif
+#endif
+
+/* Size of the buffer needed by FSCI_EncodePayload() */
+#if gFsciUseEscapeSeq_c
+#define FSCI_EncodedPacketSize(msgLen) (2 * (sizeof(clientPacketHdr_t) + (msgLen) + 2))
+#else
+#define FSCI_EncodedPacketSize(msgLen) (sizeof(clientPacketHdr_t) + (msgLen) + 2)
+#endif
+
 /*! *********************************************************************************
 *************************************************************************************
 * Public type definitions
 *************************************************************************************
 ********************************************************************************** */
-typedef enum {
-  PACKET_IS_VALID,
-  PACKET_IS_TO_SHORT,
-  FRAMING_ERROR,
-  INTERNAL_ERROR
-} fsci_packetStatus_t;
+#if gFsciTxWindowSize_c > 1
+/* Packet sent in the windowed mode, kept until it is acknowledged */
+typedef struct fsciTxWindowEntry_tag{
+    uint8_t           *pFrame;            /* NULL if the entry is free */
+    uint64_t           deadline;          /* timestamp of the next retransmission */
+    uint16_t           frameLen;
+    uint8_t            seqExt;            /* sequence byte sent after the start marker */
+    uint8_t            retries;
+    uint8_t            txPending;         /* transmissions not yet completed by the SMGR */
+    bool_t             acked;
+}fsciTxWindowEntry_t;
+#endif
 
 typedef struct fsciComm_tag{
-    clientPacket_t    *pPacketFromClient;
-    clientPacketHdr_t  pktHeader;
-    uint16_t           bytesReceived;
+    fsciRxParser_t     rxParser;
 #if gFsciHostSupport_c
     osaMutexId_t       syncHostMutexId;
 #endif
@@ -85,6 +109,17 @@ typedef struct fsciComm_tag{
     volatile bool_t    ackReceived;
     volatile bool_t    ackWaitOngoing;
 #endif
+#if gFsciTxWindowSize_c > 1
+    fsciTxWindowEntry_t txWindow[gFsciTxWindowSize_c];  /* indexed by sequence number */
+    clientPacket_t    *rxReorder[gFsciTxWindowSize_c];  /* packets received out of order */
+    tmrTimerID_t       txWindowTmr;
+    uint8_t            window;            /* negotiated window size, 0 in stop-and-wait mode */
+    uint8_t            txBase;            /* oldest unacknowledged sequence number */
+    uint8_t            txNextSeq;
+    uint8_t            rxNextSeq;         /* next in-order sequence number expected */
+    uint8_t            rxReorderCnt;
+    volatile uint8_t   txAckSeq;          /* last cumulative ACK received */
+#endif
 #if gFsciRxTimeout_c
 #if mFsciRxTimeoutUsePolling_c
     uint64_t           lastRxByteTs;
@@ -112,9 +147,6 @@ extern uint8_t gFsciSerialInterfaces[];
 * Public macros
 *************************************************************************************
 ********************************************************************************** */
-#define gFSCI_StartMarker_c     0x02
-#define gFSCI_EndMarker_c       0x03
-#define gFSCI_EscapeChar_c      0x7F
 
 /*! *********************************************************************************
 *************************************************************************************
@@ -125,9 +157,13 @@ void FSCI_commInit( void* initStruct );
 void FSCI_receivePacket( void* param );
 uint32_t FSCI_GetVirtualInterface(uint32_t fsciInterface);
 uint32_t FSCI_GetFsciInterface(uint32_t hwInterface, uint32_t virtualInterface);
-uint32_t FSCI_encodeEscapeSeq( uint8_t* pDataIn, uint32_t len, uint8_t* pDataOut );
-void FSCI_decodeEscapeSeq( uint8_t* pData, uint32_t len );
-uint8_t FSCI_computeChecksum( void *pBuffer, uint16_t size );
+void FSCI_WriteUnsequenced( uint32_t fsciInterface, uint8_t *pFrame, uint16_t frameLen );
+uint16_t FSCI_EncodePayload( uint8_t OG, uint8_t OC, void *pMsg, uint16_t msgLen, uint32_t fsciInterface, uint8_t *pOut );
+void FSCI_transmitEncodedPacket( uint8_t *pFrame, uint16_t frameLen, uint32_t fsciInterface );
+
+#if gFsciTxWindowSize_c > 1
+void FSCI_SetTxWindow( uint32_t fsciInterface, uint8_t window );
+#endif
 
 #if gFsciHostSupport_c
 void FSCI_HostSyncLock(uint32_t fsciInstance, opGroup_t OG, opCode_t OC);
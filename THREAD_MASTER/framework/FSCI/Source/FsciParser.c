@@ -0,0 +1,412 @@
+/*!
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+*
+* \file
+*
+* This is the source file for the FSCI frame parser and encoding functions.
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* o Redistributions of source code must retain the above copyright notice, this list
+*   of conditions and the following disclaimer.
+*
+* o Redistributions in binary form must reproduce the above copyright notice, this
+*   list of conditions and the following disclaimer in the documentation and/or
+*   other materials provided with the distribution.
+*
+* o Neither the name of Freescale Semiconductor, Inc. nor the names of its
+*   contributors may be used to endorse or promote products derived from this
+*   software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "FsciParser.h"
+#include "FunctionLib.h"
+#include "MemManager.h"
+
+#if gFsciIncluded_c
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+#define mFsciHdrSize_c (sizeof(clientPacketHdr_t))
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  Drops the packet being received, and searches for a new start marker
+*
+* \param[in]  pParser pointer to the parser state
+*
+********************************************************************************** */
+void FSCI_ParserReset( fsciRxParser_t *pParser )
+{
+    if( (NULL != pParser->pPacket) &&
+        (pParser->pPacket != (clientPacket_t*)&pParser->pktHeader) )
+    {
+        MEM_BufferFree(pParser->pPacket);
+    }
+
+    pParser->pPacket = NULL;
+    pParser->bytesReceived = 0;
+#if gFsciUseEscapeSeq_c
+    pParser->escape = FALSE;
+#endif
+}
+
+/*! *********************************************************************************
+* \brief  Parses received data. Stops after the end of a packet, so that the packet
+*         can be handled before the following data.
+*
+* \param[in]  pParser pointer to the parser state
+* \param[in]  pData pointer to the received data
+* \param[in]  size the number of received bytes
+* \param[out] pUsed the number of bytes that were parsed
+*
+* \return PACKET_IS_VALID if a packet was received (see FSCI_ParserTakePacket()),
+*         PACKET_IS_TO_SHORT if all the data was parsed without completing a packet,
+*         FRAMING_ERROR or INTERNAL_ERROR if the packet was dropped
+*
+********************************************************************************** */
+fsci_packetStatus_t FSCI_ParserInput( fsciRxParser_t *pParser, const uint8_t *pData,
+                                      uint16_t size, uint16_t *pUsed )
+{
+    fsci_packetStatus_t status = PACKET_IS_TO_SHORT;
+    uint16_t i = 0;
+    uint16_t packetLen;
+#if !gFsciUseEscapeSeq_c
+    uint16_t n;
+#endif
+    uint8_t c;
+
+    while( i < size )
+    {
+        c = pData[i++];
+
+        /* Search for the start marker */
+        if( NULL == pParser->pPacket )
+        {
+            if( gFSCI_StartMarker_c == c )
+            {
+                pParser->pPacket = (clientPacket_t*)&pParser->pktHeader;
+                pParser->pktHeader.startMarker = c;
+                pParser->bytesReceived = 1;
+                pParser->checksum = 0;
+#if gFsciTxWindowSize_c > 1
+                pParser->seq = gFSCI_SeqNone_c;
+#endif
+            }
+            continue;
+        }
+
+#if gFsciTxWindowSize_c > 1
+        /* Sequence byte of the windowed mode */
+        if( pParser->seqExt && (gFSCI_SeqNone_c == pParser->seq) )
+        {
+            if( !FSCI_SeqExtDecode(c, &pParser->seq) )
+            {
+                if( gFSCI_StartMarker_c == c )
+                {
+                    i--;
+                }
+                status = FRAMING_ERROR;
+                break;
+            }
+            continue;
+        }
+#endif
+
+#if gFsciUseEscapeSeq_c
+        if( pParser->escape )
+        {
+            pParser->escape = FALSE;
+            c ^= gFSCI_EscapeChar_c;
+        }
+        else if( gFSCI_EscapeChar_c == c )
+        {
+            pParser->escape = TRUE;
+            continue;
+        }
+        else if( gFSCI_StartMarker_c == c )
+        {
+            /* A new packet starts before the current one was complete */
+            i--;
+            status = FRAMING_ERROR;
+            break;
+        }
+        else if( gFSCI_EndMarker_c == c )
+        {
+            status = FRAMING_ERROR;
+            break;
+        }
+#endif
+
+        /* Header */
+        if( pParser->bytesReceived < mFsciHdrSize_c )
+        {
+            pParser->pPacket->raw[pParser->bytesReceived++] = c;
+            pParser->checksum ^= c;
+
+            if( pParser->bytesReceived == mFsciHdrSize_c )
+            {
+                /* If the length appears to be too long, we are probably out of sync */
+                if( pParser->pktHeader.len > gFsciMaxPayloadLen_c )
+                {
+                    status = FRAMING_ERROR;
+                    break;
+                }
+
+                pParser->pPacket = MEM_BufferAlloc( mFsciHdrSize_c + pParser->pktHeader.len + 2 );
+                if( NULL == pParser->pPacket )
+                {
+                    status = INTERNAL_ERROR;
+                    break;
+                }
+                FLib_MemCpy(pParser->pPacket, &pParser->pktHeader, mFsciHdrSize_c);
+            }
+            continue;
+        }
+
+        packetLen = mFsciHdrSize_c + pParser->pPacket->structured.header.len;
+
+        /* Payload */
+        if( pParser->bytesReceived < packetLen )
+        {
+#if gFsciUseEscapeSeq_c
+            pParser->pPacket->raw[pParser->bytesReceived++] = c;
+            pParser->checksum ^= c;
+#else
+            /* Store all the payload bytes available in this chunk */
+            i--;
+            n = packetLen - pParser->bytesReceived;
+            if( n > size - i )
+            {
+                n = size - i;
+            }
+            FLib_MemCpy(&pParser->pPacket->raw[pParser->bytesReceived], (void*)&pData[i], n);
+            pParser->bytesReceived += n;
+            while( n-- )
+            {
+                pParser->checksum ^= pData[i++];
+            }
+#endif
+            continue;
+        }
+
+        /* Checksum, stored at payload[len] */
+        pParser->pPacket->raw[pParser->bytesReceived++] = c;
+
+        if( pParser->bytesReceived == packetLen + 1 )
+        {
+            pParser->virtualInterface = c - pParser->checksum;
+            if( 0 == pParser->virtualInterface )
+            {
+                status = PACKET_IS_VALID;
+                break;
+            }
+#if gFsciMaxVirtualInterfaces_c
+            /* A second checksum byte follows for virtual interfaces */
+            if( pParser->virtualInterface < gFsciMaxVirtualInterfaces_c )
+            {
+                continue;
+            }
+#endif
+        }
+#if gFsciMaxVirtualInterfaces_c
+        else if( c == (pParser->checksum ^ (uint8_t)(pParser->checksum + pParser->virtualInterface)) )
+        {
+            status = PACKET_IS_VALID;
+            break;
+        }
+#endif
+
+        status = FRAMING_ERROR;
+        break;
+    }
+
+    if( (FRAMING_ERROR == status) || (INTERNAL_ERROR == status) )
+    {
+        FSCI_ParserReset(pParser);
+    }
+
+    *pUsed = i;
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief  Returns the packet received by FSCI_ParserInput(), and prepares the
+*         parser for the next one. The caller must free the packet.
+*
+* \param[in]  pParser pointer to the parser state
+*
+* \return pointer to the received packet
+*
+********************************************************************************** */
+clientPacket_t* FSCI_ParserTakePacket( fsciRxParser_t *pParser )
+{
+    clientPacket_t *pPacket = pParser->pPacket;
+
+    pParser->pPacket = NULL;
+    pParser->bytesReceived = 0;
+#if gFsciUseEscapeSeq_c
+    pParser->escape = FALSE;
+#endif
+    return pPacket;
+}
+
+/*! *********************************************************************************
+* \brief  This function performs a XOR over the message to compute the CRC
+*
+* \param[in]  pBuffer - pointer to the messae
+* \param[in]  size - the length of the message
+*
+* \return  the CRC of the message
+*
+********************************************************************************** */
+uint8_t FSCI_computeChecksum( void *pBuffer, uint16_t size )
+{
+    uint16_t index;
+    uint8_t  checksum = 0;
+
+    for ( index = 0; index < size; index++ )
+    {
+        checksum ^= ((uint8_t*)pBuffer)[index];
+    }
+
+    return checksum;
+}
+
+/*! *********************************************************************************
+* \brief  This function performs the encoding of a message, using the Escape Sequence
+*
+* \param[in]  pDataIn, pointer to the messae to be encoded
+* \param[in]  len, the length of the message
+* \param[out]  pDataOut, pointer to the encoded message
+*
+* \return  The number of bytes added in the new buffer
+*
+********************************************************************************** */
+#if gFsciUseEscapeSeq_c
+uint32_t FSCI_encodeEscapeSeq( uint8_t* pDataIn, uint32_t len, uint8_t* pDataOut )
+{
+    uint32_t index, new_index = 0;
+
+    if( NULL != pDataOut )
+    {
+        for ( index = 0; index < len; index++ )
+        {
+            if( (pDataIn[index] == gFSCI_StartMarker_c) ||
+               (pDataIn[index] == gFSCI_EndMarker_c)    ||
+                   (pDataIn[index] == gFSCI_EscapeChar_c) )
+            {
+                pDataOut[new_index++] = gFSCI_EscapeChar_c;
+                pDataOut[new_index++] = pDataIn[index] ^ gFSCI_EscapeChar_c;
+            }
+            else
+            {
+                pDataOut[new_index++] = pDataIn[index];
+            }
+        }
+    }
+
+    return new_index;
+}
+#endif
+
+/*! *********************************************************************************
+* \brief  This function performs the decoding of a message, using the Escape Sequence
+*
+* \param[in]  pData pointer to the messae to be encoded
+* \param[in]  len the length of the message
+*
+*
+********************************************************************************** */
+#if gFsciUseEscapeSeq_c
+void FSCI_decodeEscapeSeq( uint8_t* pData, uint32_t len )
+{
+    uint32_t index, new_index;
+
+    /* Find the first gFSCI_EscapeChar_c */
+    for ( index = 0; index < len; index++ )
+        if ( pData[index] == gFSCI_EscapeChar_c )
+            break;
+
+    new_index = index;
+
+    /* If a gFSCI_EscapeChar_c was found, decode the packet in place */
+    while ( index < len )
+    {
+        if ( pData[index] == gFSCI_EscapeChar_c )
+        {
+            index++; /* skip over the gFSCI_EscapeChar_c */
+
+            if ( index < len )
+                pData[new_index++] = pData[index++] ^ gFSCI_EscapeChar_c;
+        }
+        else if ( new_index != index )
+        {
+            pData[new_index++] = pData[index++];
+        }
+    }
+}
+#endif
+
+#if gFsciTxWindowSize_c > 1
+/*! *********************************************************************************
+* \brief  Builds the sequence byte which follows the start marker in the windowed mode
+*
+* \param[in]  seq the sequence number [0..gFSCI_SeqModulo_c)
+*
+* \return the sequence byte
+*
+********************************************************************************** */
+uint8_t FSCI_SeqExtEncode( uint8_t seq )
+{
+    uint8_t parity = seq ^ (seq >> 4);
+
+    parity ^= parity >> 2;
+    parity ^= parity >> 1;
+
+    return 0x80 | ((parity & 1) << 6) | (seq & (gFSCI_SeqModulo_c - 1));
+}
+
+/*! *********************************************************************************
+* \brief  Checks a received sequence byte
+*
+* \param[in]  ext the received byte
+* \param[out] pSeq the sequence number
+*
+* \return TRUE if the byte is a valid sequence byte
+*
+********************************************************************************** */
+bool_t FSCI_SeqExtDecode( uint8_t ext, uint8_t *pSeq )
+{
+    *pSeq = ext & (gFSCI_SeqModulo_c - 1);
+    return (FSCI_SeqExtEncode(*pSeq) == ext);
+}
+#endif
+
+#endif /* gFsciIncluded_c */
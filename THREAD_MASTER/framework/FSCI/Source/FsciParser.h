@@ -0,0 +1,113 @@
+/*!
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+*
+* \file
+*
+* This is the private header file for the FSCI frame parser and encoding functions.
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* o Redistributions of source code must retain the above copyright notice, this list
+*   of conditions and the following disclaimer.
+*
+* o Redistributions in binary form must reproduce the above copyright notice, this
+*   list of conditions and the following disclaimer in the documentation and/or
+*   other materials provided with the distribution.
+*
+* o Neither the name of Freescale Semiconductor, Inc. nor the names of its
+*   contributors may be used to endorse or promote products derived from this
+*   software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _FSCI_PARSER_H_
+#define _FSCI_PARSER_H_
+
+
+/*! *********************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+********************************************************************************** */
+#include "EmbeddedTypes.h"
+#include "FsciInterface.h"
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+********************************************************************************** */
+typedef enum {
+  PACKET_IS_VALID,
+  PACKET_IS_TO_SHORT,
+  FRAMING_ERROR,
+  INTERNAL_ERROR
+} fsci_packetStatus_t;
+
+/* State of a packet reception. The data is un-escaped and checked as it
+   arrives, and the payload is stored directly into the packet buffer. */
+typedef struct fsciRxParser_tag{
+    clientPacket_t    *pPacket;           /* NULL while searching for a start marker */
+    clientPacketHdr_t  pktHeader;         /* holds the header until the packet is allocated */
+    uint16_t           bytesReceived;     /* bytes stored, including the start marker */
+    uint8_t            checksum;          /* XOR of the bytes following the start marker */
+    uint8_t            virtualInterface;
+#if gFsciUseEscapeSeq_c
+    bool_t             escape;            /* the previous byte was gFSCI_EscapeChar_c */
+#endif
+#if gFsciTxWindowSize_c > 1
+    bool_t             seqExt;            /* a sequence byte follows the start marker */
+    uint8_t            seq;               /* gFSCI_SeqNone_c until received */
+#endif
+}fsciRxParser_t;
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public macros
+*************************************************************************************
+********************************************************************************** */
+#define gFSCI_StartMarker_c     0x02
+#define gFSCI_EndMarker_c       0x03
+#define gFSCI_EscapeChar_c      0x7F
+
+/* In the windowed mode, a sequence byte follows the start marker: 1 P S5..S0.
+   P gives the low 7 bits an even parity, so the byte never matches a marker or
+   the escape character. It is not covered by the packet checksum. */
+#define gFSCI_SeqModulo_c       64
+#define gFSCI_SeqNone_c         0xFF
+
+/* TRUE while a packet is being received */
+#define FSCI_ParserBusy(pParser)  (NULL != (pParser)->pPacket)
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public prototypes
+*************************************************************************************
+********************************************************************************** */
+void FSCI_ParserReset( fsciRxParser_t *pParser );
+fsci_packetStatus_t FSCI_ParserInput( fsciRxParser_t *pParser, const uint8_t *pData,
+                                      uint16_t size, uint16_t *pUsed );
+clientPacket_t* FSCI_ParserTakePacket( fsciRxParser_t *pParser );
+
+uint32_t FSCI_encodeEscapeSeq( uint8_t* pDataIn, uint32_t len, uint8_t* pDataOut );
+void FSCI_decodeEscapeSeq( uint8_t* pData, uint32_t len );
+uint8_t FSCI_computeChecksum( void *pBuffer, uint16_t size );
+
+#if gFsciTxWindowSize_c > 1
+uint8_t FSCI_SeqExtEncode( uint8_t seq );
+bool_t FSCI_SeqExtDecode( uint8_t ext, uint8_t *pSeq );
+#endif
+
+#endif /* _FSCI_PARSER_H_ */
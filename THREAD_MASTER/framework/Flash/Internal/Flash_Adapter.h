@@ -66,6 +66,19 @@
 #define gNvDisableIntCmdSeq_c           (1)
 #endif
 
+/*
+ * Name: gNvWriteCombining_c
+ * Description: if set to TRUE, NV_FlashProgramUnaligned() gathers the bytes
+ *              of a partially written phrase in RAM and programs the phrase
+ *              only once it is complete or when the write buffer is flushed.
+ *              The buffer is flushed by NV_FlashProgram(), NV_FlashRead(),
+ *              NV_FlashEraseSector(), NV_FlashVerifyErase() and by any write
+ *              to a different phrase, so the program order is preserved.
+ */
+#ifndef gNvWriteCombining_c
+#define gNvWriteCombining_c             (1)
+#endif
+
 /* size of array to copy__Launch_Command function to.*/
 /* It should be at least equal to actual size of __Launch_Command func */
 /* User can change this value based on RAM size availability and actual size of __Launch_Command function */
@@ -91,7 +104,11 @@
 #define READ_USER_MARGIN          0x01
 #define READ_FACTORY_MARGIN       0x02
 
+#if gNvWriteCombining_c
+#define NV_FlashRead(pSrc, pDest, size) { (void)NV_FlashFlushWriteBuffer(); FLib_MemCpy((void*)(pDest), (void*)(pSrc), size); }
+#else
 #define NV_FlashRead(pSrc, pDest, size) FLib_MemCpy((void*)(pDest), (void*)(pSrc), size);
+#endif
 
 /*! *********************************************************************************
 *************************************************************************************
@@ -143,6 +160,8 @@ uint32_t NV_FlashEraseSector(     uint32_t dest,
                                   uint32_t size);
 uint32_t NV_FlashVerifyErase ( uint32_t start, uint32_t lengthInBytes, flash_margin_value_t margin);
 
+uint32_t NV_FlashFlushWriteBuffer(void);
+
 uint32_t NV_ReadHWParameters(hardwareParameters_t *pHwParams);
 
 uint32_t NV_WriteHWParameters(hardwareParameters_t *pHwParams);
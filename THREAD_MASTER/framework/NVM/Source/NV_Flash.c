@@ -66,11 +66,28 @@
    #error "*** ERROR: gNvUseExtendedFeatureSet_d not available on FlexNVM"
  #endif
 
+ #if (gNvPendingSavesQueueSize_c > 254)
+   #error "*** ERROR: gNvPendingSavesQueueSize_c shall not exceed 254"
+ #endif
+
+#if gNvCircularLog_d
+ #if (gNvUseFlexNVM_d == TRUE) || (gNvUseExtendedFeatureSet_d == TRUE) || (gUnmirroredFeatureSet_d == TRUE)
+   #error "*** ERROR: gNvCircularLog_d not available with FlexNVM, gNvUseExtendedFeatureSet_d or gUnmirroredFeatureSet_d"
+ #endif
+ #if (gNvCircularLogPagesCount_c < 3)
+   #error "*** ERROR: gNvCircularLogPagesCount_c shall be at least 3"
+ #endif
+#endif
+
 /*
  * Name: gNvVirtualPagesCount_c
  * Description: the count of virtual pages used
  */
+#if gNvCircularLog_d
+#define gNvVirtualPagesCount_c         gNvCircularLogPagesCount_c
+#else
 #define gNvVirtualPagesCount_c         2 /* DO NOT MODIFY */
+#endif
 
 /*
  * Name: gNvGuardValue_c
@@ -452,12 +469,147 @@ static uint8_t NvGetPendingSavesCount
   NVM_SaveQueue_t *pQueue
 );
 
+/******************************************************************************
+ * Name: NvGetPendingSaveBucket
+ * Description: Get the pending saves queue bucket of an entry ID
+ * Parameters: [IN] entryId - the table entry ID
+ * Return: the bucket index
+ ******************************************************************************/
+static uint8_t NvGetPendingSaveBucket
+(
+  NvTableEntryId_t entryId
+);
+
+/******************************************************************************
+ * Name: NvLinkPendingSave
+ * Description: Add a queue slot to the bucket of its entry ID
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] slot - the queue slot
+ * Return: -
+ ******************************************************************************/
+static void NvLinkPendingSave
+(
+  NVM_SaveQueue_t *pQueue,
+  index_t slot
+);
+
+/******************************************************************************
+ * Name: NvUnlinkPendingSave
+ * Description: Remove a queue slot from the bucket of its entry ID
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] slot - the queue slot
+ * Return: -
+ ******************************************************************************/
+static void NvUnlinkPendingSave
+(
+  NVM_SaveQueue_t *pQueue,
+  index_t slot
+);
+
+/******************************************************************************
+ * Name: NvGetNextPendingSave
+ * Description: Iterate through the queued requests of an entry ID
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] entryId - the table entry ID
+ *             [IN] link - 0 to get the first request, or the value returned
+ *                         by the previous call to get the next one
+ * Return: the queue slot + 1 of the request, 0 if there are no more requests
+ ******************************************************************************/
+static uint8_t NvGetNextPendingSave
+(
+  NVM_SaveQueue_t *pQueue,
+  NvTableEntryId_t entryId,
+  uint8_t link
+);
+
+/******************************************************************************
+ * Name: NvRemovePendingSaves
+ * Description: Cancel the queued requests of an entry ID. The cancelled
+ *              requests keep their queue slot until reused or popped.
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] entryId - the table entry ID
+ *             [IN] elementIndex - the element index, or
+ *                                 gNvInvalidElementIndex_c for all elements
+ * Return: -
+ ******************************************************************************/
+static void NvRemovePendingSaves
+(
+  NVM_SaveQueue_t *pQueue,
+  NvTableEntryId_t entryId,
+  uint16_t elementIndex
+);
+
+/******************************************************************************
+ * Name: NvInvalidatePendingSave
+ * Description: Cancel the request stored in a queue slot
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] slot - the queue slot
+ * Return: -
+ ******************************************************************************/
+static void NvInvalidatePendingSave
+(
+  NVM_SaveQueue_t *pQueue,
+  index_t slot
+);
+
+/******************************************************************************
+ * Name: NvGetInvalidPendingSave
+ * Description: Get a queue slot holding a cancelled request
+ * Parameters: [IN] pQueue - pointer to queue
+ * Return: the queue slot, gNvPendingSavesQueueSize_c if there is none
+ ******************************************************************************/
+static index_t NvGetInvalidPendingSave
+(
+  NVM_SaveQueue_t *pQueue
+);
+
+/******************************************************************************
+ * Name: NvScheduleIntervalSave
+ * Description: Schedule the save-on-interval of a table entry
+ * Parameters: [IN] tableEntryIdx - the table entry index
+ *             [IN] ticks - ticks until the save is due
+ * Return: -
+ ******************************************************************************/
+static void NvScheduleIntervalSave
+(
+  uint16_t tableEntryIdx,
+  uint32_t ticks
+);
+
+/******************************************************************************
+ * Name: NvCancelIntervalSave
+ * Description: Cancel the save-on-interval of a table entry
+ * Parameters: [IN] tableEntryIdx - the table entry index
+ * Return: -
+ ******************************************************************************/
+static void NvCancelIntervalSave
+(
+  uint16_t tableEntryIdx
+);
+
+/******************************************************************************
+ * Name: NvSaveDeadlineHeapSiftUp / NvSaveDeadlineHeapSiftDown
+ * Description: Restore the save deadlines heap order starting from a node
+ * Parameters: [IN] pos - the heap node
+ * Return: -
+ ******************************************************************************/
+static void NvSaveDeadlineHeapSiftUp
+(
+  uint16_t pos
+);
+
+static void NvSaveDeadlineHeapSiftDown
+(
+  uint16_t pos
+);
+
 /*****************************************************************
  * The below functions are compiled only if FlexNVM is NOT used
  *****************************************************************/
 
 #if (gNvUseFlexNVM_d == FALSE) || ((gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE == 0)) /* no FlexNVM */
 
+#if !gNvCircularLog_d
 /******************************************************************************
  * Name: UpgradeLegacyTable
  * Description: Upgrades an legacy table to the new format
@@ -468,6 +620,7 @@ static NVM_Status_t UpgradeLegacyTable
 (
   void
 );
+#endif
 
 /******************************************************************************
  * Name: NvUpdateSize
@@ -494,6 +647,7 @@ static NVM_Status_t NvEraseVirtualPage
 );
 
 
+#if !gNvCircularLog_d
 /******************************************************************************
  * Name: NvInitStorageSystem
  * Description: Initialize the storage system, retrieve the active page and
@@ -505,6 +659,33 @@ static void NvInitStorageSystem
 (
   bool_t read_legacy_location
 );
+#else
+/******************************************************************************
+ * Name: NvLogInitStorageSystem
+ * Description: Initialize the circular log: retrieve the active (newest) log
+ *              page, the oldest log page and the page counter. Called once by
+ *              NvModuleInit() function.
+ * Parameter(s): -
+ * Return: -
+ *****************************************************************************/
+static void NvLogInitStorageSystem
+(
+  void
+);
+
+/******************************************************************************
+ * Name: NvLogGetPageCounter
+ * Description: read the page counter of a log page
+ * Parameter(s): [IN] pageId - the ID of the log page
+ *               [OUT] pPageCounter - the page counter value
+ * Return: TRUE if the log page holds a valid page counter, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvLogGetPageCounter
+(
+  NVM_VirtualPageID_t pageId,
+  uint32_t* pPageCounter
+);
+#endif
 
 
 /******************************************************************************
@@ -524,13 +705,13 @@ static NVM_Status_t NvVirtualPageBlankCheck
 /******************************************************************************
  * Name: NvUpdateLastMetaInfoAddress
  * Description: retrieve and store (update) the last meta information address
- * Parameter(s): -
+ * Parameter(s): [IN] pageId - the ID of the page
  * Return: gNVM_MetaNotFound_c - if no meta information has been found
  *         gNVM_OK_c - if the meta was found and stored (updated)
  *****************************************************************************/
 static NVM_Status_t NvUpdateLastMetaInfoAddress
 (
-    void
+    NVM_VirtualPageID_t pageId
 );
 
 
@@ -584,6 +765,23 @@ static bool_t NvIsMemoryAreaAvailable
 );
 
 
+/******************************************************************************
+ * Name: NvGetOlderPage
+ * Description: move to the page holding the records older than the ones of
+ *              the given page. Only the circular log spreads the records over
+ *              several pages; the empty log pages are skipped.
+ * Parameter(s): [IN/OUT] pPageId - the ID of the page
+ *               [OUT] pLastMetaAddress - the last meta information address
+ *                                        of the older page
+ * Return: TRUE if an older page holding records was found, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvGetOlderPage
+(
+  NVM_VirtualPageID_t* pPageId,
+  uint32_t* pLastMetaAddress
+);
+
+#if !gNvCircularLog_d
 /******************************************************************************
  * Name: NvIsRecordCopied
  * Description: Checks if a record or an entire table entry is already copied.
@@ -597,12 +795,15 @@ static bool_t NvIsRecordCopied
   NVM_VirtualPageID_t pageId,
   NVM_RecordMetaInfo_t* metaInf
 );
+#endif
 
 
 /******************************************************************************
  * Name: NvInternalCopy
  * Description: Performs a copy of an record / entire table entry
- * Parameter(s): [IN] dstAddress - destination record address
+ * Parameter(s): [IN] srcPageId - source page ID
+ *               [IN] dstPageId - destination page ID
+ *               [IN] dstAddress - destination record address
  *               [IN] dstMetaAddress - destination meta address
  *               [IN] srcMetaInfo - source meta information
  *               [IN] srcTblEntryIdx - source table entry index
@@ -617,6 +818,8 @@ static bool_t NvIsRecordCopied
  *****************************************************************************/
 static NVM_Status_t NvInternalCopy
 (
+  NVM_VirtualPageID_t srcPageId,
+  NVM_VirtualPageID_t dstPageId,
   uint32_t dstAddress,
   uint32_t dstMetaAddress,
   NVM_RecordMetaInfo_t* srcMetaInfo,
@@ -626,6 +829,7 @@ static NVM_Status_t NvInternalCopy
 
 
 
+#if gNvFragmentation_Enabled_d && !gNvCircularLog_d
 /******************************************************************************
  * Name: NvGetTblEntryMetaAddrFromId
  * Description: Gets the table entry meta address based on table entry ID
@@ -633,7 +837,6 @@ static NVM_Status_t NvInternalCopy
  *               [IN] dataEntryId - table entry ID
  * Return: the value of the meta address
  *****************************************************************************/
-#if gNvFragmentation_Enabled_d
 static uint32_t NvGetTblEntryMetaAddrFromId
 (
   uint32_t searchStartAddress,
@@ -660,7 +863,7 @@ static NVM_Status_t NvInternalDefragmentedCopy
   uint32_t dstRecordAddr,
   NVM_RecordMetaInfo_t *ownerRecordMetaInfo
 );
-#endif /* #if gNvFragmentation_Enabled_d */
+#endif /* #if gNvFragmentation_Enabled_d && !gNvCircularLog_d */
 
 
 /******************************************************************************
@@ -687,6 +890,247 @@ static NVM_Status_t NvCopyPage
   NvTableEntryId_t skipEntryId
 );
 
+#if !gNvCircularLog_d
+/******************************************************************************
+ * Name: NvCopyPageStart
+ * Description: Initialise the page copy status. The destination (mirror) page
+ *              must be blank when this function is called.
+ * Parameter(s): [IN] skipEntryId - the entry ID to be skipped when page
+ *                                  copy is performed
+ * Return: -
+ *****************************************************************************/
+static void NvCopyPageStart
+(
+  NvTableEntryId_t skipEntryId
+);
+
+/******************************************************************************
+ * Name: NvCopyPageStep
+ * Description: Continue the page copy started by NvCopyPageStart(). At most
+ *              metasCount meta information tags of the source page are
+ *              processed.
+ * Parameter(s): [IN] metasCount - the maximum number of source meta
+ *                                 information tags to be processed, or
+ *                                 gNvCopyAll_c to run the copy to completion
+ * Return: gNVM_PageCopyPending_c - if the copy is not yet completed
+ *         gNVM_OK_c - page copy completed successfully
+ *         other values - in case of error(s)
+ *****************************************************************************/
+static NVM_Status_t NvCopyPageStep
+(
+  uint16_t metasCount
+);
+#else
+/******************************************************************************
+ * Name: NvLogGetFreePagesCount
+ * Description: return the count of log pages that are neither the active
+ *              page nor hold older records
+ * Parameter(s): -
+ * Return: the count of free log pages
+ *****************************************************************************/
+static uint8_t NvLogGetFreePagesCount
+(
+  void
+);
+
+/******************************************************************************
+ * Name: NvLogAdvance
+ * Description: Make the next log page the active page. One free log page is
+ *              kept in reserve for the reclaim of the oldest log page.
+ * Parameter(s): [IN] useReserve - if TRUE, the reserved free log page may be
+ *                                 used
+ * Return: TRUE if the active page was changed, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvLogAdvance
+(
+  bool_t useReserve
+);
+
+/******************************************************************************
+ * Name: NvLogGetRecordSpace
+ * Description: get the place of a record moved to the active page by the
+ *              reclaim; the next log page is taken if the active page is full
+ * Parameter(s): [IN] recordSize - the record size, multiple of PGM_SIZE_BYTE
+ *               [OUT] pMetaAddress - the meta information address
+ *               [OUT] pRecordAddress - the record address
+ * Return: TRUE if the space was found, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvLogGetRecordSpace
+(
+  uint32_t recordSize,
+  uint32_t* pMetaAddress,
+  uint32_t* pRecordAddress
+);
+
+/******************************************************************************
+ * Name: NvLogIsRecordSuperseded
+ * Description: Checks if a record of the oldest log page was saved again
+ *              later, as a single element or as an entire table entry
+ * Parameter(s): [IN] srcMetaAddress - the meta information address of the record
+ *               [IN] srcMetaInfo - the meta information of the record
+ * Return: TRUE if a newer record exists, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvLogIsRecordSuperseded
+(
+  uint32_t srcMetaAddress,
+  NVM_RecordMetaInfo_t* srcMetaInfo
+);
+
+#if gNvFragmentation_Enabled_d
+/******************************************************************************
+ * Name: NvLogMergedCopy
+ * Description: Copy an entire table entry record of the oldest log page to
+ *              the active page, merged with the newer single element records
+ * Parameter(s): [IN] srcMetaAddress - the meta information address of the record
+ *               [IN] srcMetaInfo - the meta information of the record
+ *               [IN] srcTblEntryIdx - the table entry index
+ *               [IN] dstMetaAddress - destination meta address
+ *               [IN] dstRecordAddress - destination record address
+ * Return: the status of the operation
+ *****************************************************************************/
+static NVM_Status_t NvLogMergedCopy
+(
+  uint32_t srcMetaAddress,
+  NVM_RecordMetaInfo_t* srcMetaInfo,
+  uint16_t srcTblEntryIdx,
+  uint32_t dstMetaAddress,
+  uint32_t dstRecordAddress
+);
+#endif /* gNvFragmentation_Enabled_d */
+
+/******************************************************************************
+ * Name: NvLogReclaimStart
+ * Description: Initialise the reclaim of the oldest log page
+ * Parameter(s): -
+ * Return: -
+ *****************************************************************************/
+static void NvLogReclaimStart
+(
+  void
+);
+
+/******************************************************************************
+ * Name: NvLogReclaimStep
+ * Description: Continue the reclaim started by NvLogReclaimStart(). At most
+ *              metasCount meta information tags of the oldest log page are
+ *              processed.
+ * Parameter(s): [IN] metasCount - the maximum number of meta information tags
+ *                                 to be processed, or gNvCopyAll_c to run the
+ *                                 reclaim to completion
+ * Return: gNVM_PageCopyPending_c - if the reclaim is not yet completed
+ *         gNVM_OK_c - reclaim completed successfully
+ *         other values - in case of error(s)
+ *****************************************************************************/
+static NVM_Status_t NvLogReclaimStep
+(
+  uint16_t metasCount
+);
+#endif /* !gNvCircularLog_d */
+
+/******************************************************************************
+ * Name: NvEraseNextSector
+ * Description: Erase the next sector of the virtual page that has a pending
+ *              erase request.
+ * Parameter(s): -
+ * Return: TRUE if the virtual page is entirely erased, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvEraseNextSector
+(
+  void
+);
+
+/******************************************************************************
+ * Name: NvEraseStorageSector
+ * Description: Erase one NV storage sector, unless it is already blank, and
+ *              update the wear statistics
+ * Parameter(s): [IN] sectorAddress - the start address of the sector
+ * Return: gNVM_OK_c - if the sector is blank
+ *         gNVM_SectorEraseFail_c - if the sector cannot be erased
+ *****************************************************************************/
+static NVM_Status_t NvEraseStorageSector
+(
+  uint32_t sectorAddress
+);
+
+#if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+/******************************************************************************
+ * Name: NvUnmirroredCacheLookup
+ * Description: Get the cached location of an unmirrored element record
+ * Parameter(s): [IN] entryId - the table entry ID
+ *               [IN] elementIndex - the element index
+ *               [OUT] pRecordOffset - the record offset in the active page,
+ *                                     0 if the element was erased
+ * Return: TRUE if the location is cached, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvUnmirroredCacheLookup
+(
+  NvTableEntryId_t entryId,
+  uint16_t elementIndex,
+  uint16_t* pRecordOffset
+);
+
+/******************************************************************************
+ * Name: NvUnmirroredCacheUpdate
+ * Description: Store the location of an unmirrored element record, replacing
+ *              the least recently used cache entry if needed
+ * Parameter(s): [IN] entryId - the table entry ID
+ *               [IN] elementIndex - the element index
+ *               [IN] recordOffset - the record offset in the active page
+ * Return: -
+ *****************************************************************************/
+static void NvUnmirroredCacheUpdate
+(
+  NvTableEntryId_t entryId,
+  uint16_t elementIndex,
+  uint16_t recordOffset
+);
+
+/******************************************************************************
+ * Name: NvUnmirroredCacheInvalidate
+ * Description: Drop cached unmirrored element locations
+ * Parameter(s): [IN] entryId - the table entry ID, or gNvInvalidDataEntry_c
+ *                              to drop all the cached locations
+ *               [IN] elementIndex - the element index, or
+ *                                   gNvInvalidElementIndex_c for all the
+ *                                   elements of the table entry
+ * Return: -
+ *****************************************************************************/
+static void NvUnmirroredCacheInvalidate
+(
+  NvTableEntryId_t entryId,
+  uint16_t elementIndex
+);
+#endif /* gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c */
+
+/******************************************************************************
+ * Name: NvCompactionStep
+ * Description: Perform a bounded unit of the pending page copy / page erase
+ *              work.
+ * Parameter(s): -
+ * Return: gNVM_PageCopyPending_c - if more steps are required
+ *         gNVM_OK_c - if there is no more copy / erase work pending
+ *         other values - if the page copy failed
+ *****************************************************************************/
+static NVM_Status_t NvCompactionStep
+(
+  void
+);
+
+#if gNvCompactionFillWatermark_c
+/******************************************************************************
+ * Name: NvIsPageFillAboveWatermark
+ * Description: Check the active page fill level against
+ *              gNvCompactionFillWatermark_c
+ * Parameter(s): -
+ * Return: TRUE if the active page fill level is above the watermark,
+ *         FALSE otherwise
+ *****************************************************************************/
+static bool_t NvIsPageFillAboveWatermark
+(
+  void
+);
+#endif /* gNvCompactionFillWatermark_c */
+
 
 /******************************************************************************
  * Name: NvInternalFormat
@@ -937,6 +1381,16 @@ static
 #endif
 NVM_VirtualPageID_t mNvActivePageId;
 
+#if gNvCircularLog_d
+/*
+ * Name: mNvLogTailPageId
+ * Description: variable that holds the ID of the oldest log page. The log
+ *              pages from the oldest one up to the active one hold the
+ *              records, the other log pages are free.
+ */
+static NVM_VirtualPageID_t mNvLogTailPageId;
+#endif
+
 /*
  * Name: mNvPageCounter
  * Description: page counter, used to validate the entire virtual page
@@ -968,6 +1422,47 @@ static bool_t mNvCopyOperationIsPending = FALSE;
  */
 static NVM_ErasePageCmdStatus_t mNvErasePgCmdStatus;
 
+/*
+ * Name: mNvCopyPgCmdStatus
+ * Description: progress of the page copy. The idle task copies the active
+ *              page in several steps, gNvCompactionMetasPerStep_c meta
+ *              information tags at a time, so that a page copy never blocks
+ *              the idle task for more than gNvCompactionTimeBudget_c
+ */
+static NVM_CopyPageCmdStatus_t mNvCopyPgCmdStatus;
+
+/*
+ * Name: mNvWearStatistics
+ * Description: sector wear and page reclaim counters since the module
+ *              initialisation, reported by NvGetPagesStatistics()
+ */
+static NVM_Statistics_t mNvWearStatistics;
+
+#if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+/*
+ * Name: maNvUnmirroredCache
+ * Description: locations of the recently restored unmirrored elements. Saves
+ *              the parsing of the meta information on repeated restores.
+ */
+static NVM_UnmirroredCacheEntry_t maNvUnmirroredCache[gNvUnmirroredCacheEntries_c];
+
+/*
+ * Name: mNvUnmirroredCacheUseCounter
+ * Description: incremented on each cache access, used to find the least
+ *              recently used cache entry
+ */
+static uint32_t mNvUnmirroredCacheUseCounter;
+#endif
+
+#if gNvCompactionFillWatermark_c
+/*
+ * Name: mNvCompactionWatermarkArmed
+ * Description: if set, the idle task starts a page copy when the active page
+ *              fill level goes above gNvCompactionFillWatermark_c
+ */
+static bool_t mNvCompactionWatermarkArmed = TRUE;
+#endif
+
 /*
  * Name: mNvFlashConfigInitialised
  * Description: variable that holds the hal driver and active page initialisation status
@@ -983,6 +1478,17 @@ static bool_t mNvFlashConfigInitialised = FALSE;
 static uint16_t maNvRecordsCpyOffsets[gNvRecordsCopiedBufferSize_c];
 #endif /* gNvFragmentation_Enabled_d */
 
+#if gNvFragmentation_Enabled_d && gNvCircularLog_d
+/*
+ * Name: maNvLogRecordsAddress
+ * Description: the addresses of the newest single element records of a
+ *              table entry, merged into the table entry record moved by the
+ *              reclaim of the oldest log page. The records may be spread over
+ *              several log pages, hence the absolute addresses.
+ */
+static uint32_t maNvLogRecordsAddress[gNvRecordsCopiedBufferSize_c];
+#endif /* gNvFragmentation_Enabled_d && gNvCircularLog_d */
+
 #if gNvUseExtendedFeatureSet_d
 /*
  * Name: mNvTableSizeInFlash
@@ -1070,6 +1576,32 @@ static bool_t mNvSaveOnIntervalEvent;
  * Description: the value of the last timestamp used by the Save-On-Interval functionality
  */
 static uint64_t mNvLastTimestampValue = 0;
+
+/*
+ * Name: mNvTickCounter
+ * Description: the count of save-on-interval ticks
+ */
+static uint32_t mNvTickCounter = 0;
+
+/*
+ * Name: maNvSaveDeadlineHeap
+ * Description: min-heap of the table entries indexes with a save-on-interval
+ *              pending, ordered by maDatasetInfo[].nextSaveTick. The tick
+ *              processing only looks at the heap root.
+ */
+static uint16_t maNvSaveDeadlineHeap[gNvTableEntriesCountMax_c];
+
+/*
+ * Name: maNvSaveDeadlineHeapPos
+ * Description: position in maNvSaveDeadlineHeap of each table entry
+ */
+static uint16_t maNvSaveDeadlineHeapPos[gNvTableEntriesCountMax_c];
+
+/*
+ * Name: mNvSaveDeadlineHeapSize
+ * Description: the count of table entries in maNvSaveDeadlineHeap
+ */
+static uint16_t mNvSaveDeadlineHeapSize = 0;
 /*
  * Name: mNVMMutexId
  * Description: mutex used to ensure NVM functions thread switch safety
@@ -1302,9 +1834,7 @@ static NVM_Status_t __NvEraseEntryFromStorage
     uint16_t tableEntryIndex
 )
 {
-    index_t loopCnt;
     NVM_Status_t status = gNVM_OK_c;
-    uint8_t remaining_count;
 
     if(!mNvModuleInitialized)
     {
@@ -1313,28 +1843,9 @@ static NVM_Status_t __NvEraseEntryFromStorage
 
 
     /* Check if is in pending queue - if yes than remove it */
-    if (NvGetPendingSavesCount(&mNvPendingSavesQueue))
-    {
-        /* Start from the queue's head */
-        loopCnt = mNvPendingSavesQueue.Head;
-        remaining_count = mNvPendingSavesQueue.EntriesCount;
-
-        while (remaining_count)
-        {
-            if(entryId == mNvPendingSavesQueue.QData[loopCnt].entryId)
-            {
-                mNvPendingSavesQueue.QData[loopCnt].entryId = gNvInvalidDataEntry_c;
-            }
-            remaining_count--;
-            /* increment and wrap the loop index */
-            if(++loopCnt >= (uint8_t)gNvPendingSavesQueueSize_c)
-            {
-                loopCnt=0;
-            }
-        }
-    }
-    maDatasetInfo[tableEntryIndex].countsToNextSave = gNvCountsBetweenSaves;
-    maDatasetInfo[tableEntryIndex].saveNextInterval = FALSE;
+    NvRemovePendingSaves(&mNvPendingSavesQueue, entryId, gNvInvalidElementIndex_c);
+    maDatasetInfo[tableEntryIndex].countsToNextSave = gNvCountsBetweenSaves;
+    NvCancelIntervalSave(tableEntryIndex);
 
     /* postpone the operation */
     if (mNvCriticalSectionFlag)
@@ -1631,7 +2142,7 @@ static NVM_Status_t __NvAtomicSave
             }
             if (FALSE == skip)
             {
-                mNvPendingSavesQueue.QData[loopCnt].entryId = gNvInvalidDataEntry_c;
+                NvInvalidatePendingSave(&mNvPendingSavesQueue, loopCnt);
             }
             remaining_count--;
             /* increment and wrap the loop index */
@@ -1771,14 +2282,8 @@ static NVM_Status_t __NvSyncSave
         {
             return status;
         }
-        mNvCopyOperationIsPending = FALSE;
+        /* the old page is erased in steps by NvIdle() */
 
-        /* erase old page */
-        status = NvEraseVirtualPage(mNvErasePgCmdStatus.NvPageToErase);
-        if (gNVM_OK_c != status)
-            return status;
-        mNvVirtualPageProperty[mNvErasePgCmdStatus.NvPageToErase].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
-        mNvErasePgCmdStatus.NvErasePending = FALSE;
         /* write record */
         status = NvWriteRecord(&tblIdx);
     }
@@ -1837,7 +2342,7 @@ static NVM_Status_t __NvFormat
         for(loopCnt = 0; loopCnt < (index_t)gNVM_TABLE_entries_c; loopCnt++)
         {            
             maDatasetInfo[loopCnt].countsToNextSave = gNvCountsBetweenSaves;
-            maDatasetInfo[loopCnt].saveNextInterval = FALSE;
+            NvCancelIntervalSave(loopCnt);
             if(pNVM_DataTable[loopCnt].DataEntryType != gNVM_MirroredInRam_c)
             {
                 for (loopCnt2 = 0; loopCnt2 < pNVM_DataTable[loopCnt].ElementsCount; loopCnt2++)
@@ -1897,7 +2402,8 @@ static void __NvIdle
 {
     NVM_TableEntryInfo_t tblIdx;
     #if (gNvUseFlexNVM_d == FALSE) || ((gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE == 0)) /* no FlexNVM */
-    uint32_t status;
+    NVM_Status_t status;
+    uint64_t compactionStartTime;
     #endif
     
     uint64_t currentTimestampValue = 0;
@@ -1912,41 +2418,29 @@ static void __NvIdle
     }
 
     #if (gNvUseFlexNVM_d == FALSE) || ((gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE == 0)) /* no FlexNVM */
-    if(mNvCopyOperationIsPending)
+    #if gNvCompactionFillWatermark_c
+    /* start the page copy in background before a save finds the page full */
+    if(!mNvCopyOperationIsPending && !mNvErasePgCmdStatus.NvErasePending &&
+       mNvCompactionWatermarkArmed && NvIsPageFillAboveWatermark())
     {
-        #if (gFsciIncluded_c && gNvmEnableFSCIMonitoring_c)
-            FSCI_MsgNVVirtualPageMonitoring(TRUE,gNVM_OK_c);
-            FSCI_MsgNVVirtualPageMonitoring(FALSE,status = NvCopyPage(gNvCopyAll_c));
-        #else
-            status = NvCopyPage(gNvCopyAll_c);
-        #endif
-        if (gNVM_OK_c == status)
-        {
-            mNvCopyOperationIsPending = FALSE;
-        }
+        mNvCompactionWatermarkArmed = FALSE;
+        mNvCopyOperationIsPending = TRUE;
     }
+    #endif
 
-    if(mNvErasePgCmdStatus.NvErasePending)
+    if(mNvCopyOperationIsPending || mNvErasePgCmdStatus.NvErasePending)
     {
-        if(mNvErasePgCmdStatus.NvSectorAddress >= mNvVirtualPageProperty[mNvErasePgCmdStatus.NvPageToErase].NvRawSectorEndAddress)
+        /* copy / erase in steps until the time budget is consumed */
+        compactionStartTime = TMR_GetTimestamp();
+        do
         {
-            /* all sectors of the page had been erased */
-            mNvVirtualPageProperty[mNvErasePgCmdStatus.NvPageToErase].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
-            mNvErasePgCmdStatus.NvErasePending = FALSE;
-            #if (gFsciIncluded_c && gNvmEnableFSCIMonitoring_c)
-            FSCI_MsgNVPageEraseMonitoring(mNvVirtualPageProperty[mNvErasePgCmdStatus.NvPageToErase].NvRawSectorStartAddress, gNVM_OK_c);
-            #endif
-            return;
-        }
-
-        /* erase */
-        status = NV_FlashEraseSector(mNvErasePgCmdStatus.NvSectorAddress, (uint32_t) ((uint8_t*) NV_STORAGE_SECTOR_SIZE));
+            status = NvCompactionStep();
+        } while((gNVM_PageCopyPending_c == status) &&
+                (TMR_GetTimestamp() - compactionStartTime < (uint64_t)gNvCompactionTimeBudget_c));
 
-        /* blank check */
-        if(kStatus_FLASH_Success == NV_FlashVerifyErase (mNvErasePgCmdStatus.NvSectorAddress, (uint32_t)NV_STORAGE_SECTOR_SIZE, kFLASH_MarginValueNormal))
-        
+        if(mNvCopyOperationIsPending)
         {
-            mNvErasePgCmdStatus.NvSectorAddress += (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE);
+            /* the saves are processed once the active page is switched */
             return;
         }
     }
@@ -2012,8 +2506,6 @@ bool_t __NvIsDataSetDirty
 
     NVM_TableEntryInfo_t tblIdx;
     uint16_t tableEntryIdx;
-    index_t loopIdx;
-    uint8_t remaining_count;
 
     if(!mNvModuleInitialized)
     {
@@ -2038,25 +2530,9 @@ bool_t __NvIsDataSetDirty
             return FALSE;
         }
         /* Check if is in pendding queue */
-        if (mNvPendingSavesQueue.EntriesCount)
+        if (NvGetNextPendingSave(&mNvPendingSavesQueue, tblIdx.entryId, 0))
         {
-            /* Start from the queue's head */
-            loopIdx = mNvPendingSavesQueue.Head;
-            remaining_count = mNvPendingSavesQueue.EntriesCount;
-
-            while(remaining_count)
-            {
-                if(mNvPendingSavesQueue.QData[loopIdx].entryId == tblIdx.entryId)
-                {
-                    return TRUE;
-                }
-                remaining_count--;
-                /* increment and wrap the loop index */
-                if(++loopIdx >= (uint8_t)gNvPendingSavesQueueSize_c)
-                {
-                    loopIdx=0;
-                }
-            }
+            return TRUE;
         }
         return maDatasetInfo[tableEntryIdx].saveNextInterval;
     }
@@ -2154,78 +2630,65 @@ static bool_t __NvTimerTick
     bool_t countTick
 )
 {
-    bool_t fTicksLeft = FALSE;
     NVM_TableEntryInfo_t tblIdx;
-    uint16_t idx = 0;
+    uint16_t idx;
 
     if(!mNvModuleInitialized)
     {
         return gNVM_ModuleNotInitialized_c;
     }
-    
-    while(idx < gNVM_TABLE_entries_c)
+
+    if(countTick)
     {
-        if(countTick)
+        mNvTickCounter++;
+    }
+
+    /* only the data sets whose save is due are visited */
+    while(mNvSaveDeadlineHeapSize &&
+          ((int32_t)(maDatasetInfo[maNvSaveDeadlineHeap[0]].nextSaveTick - mNvTickCounter) <= 0))
+    {
+        idx = maNvSaveDeadlineHeap[0];
+
+        tblIdx.entryId = pNVM_DataTable[idx].DataEntryID;
+        #if gUnmirroredFeatureSet_d
+        if (gNVM_MirroredInRam_c != pNVM_DataTable[idx].DataEntryType)
+        {
+            tblIdx.elementIndex = maDatasetInfo[idx].elementIndex;
+            tblIdx.saveRestoreAll = FALSE;
+        }
+        else
+        #endif
+        {
+            tblIdx.elementIndex = 0;
+            tblIdx.saveRestoreAll = TRUE;
+        }
+        NvCancelIntervalSave(idx);
+        if(!mNvCriticalSectionFlag)
         {
-            if(maDatasetInfo[idx].ticksToNextSave)
+            #if (gNvUseFlexNVM_d == FALSE) || ((gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE == 0)) /* no FlexNVM */
+            if(NvWriteRecord(&tblIdx) == gNVM_PageCopyPending_c)
             {
-                --maDatasetInfo[idx].ticksToNextSave;
+                /* retry next time we have a tick */
+                if (NvAddSaveRequestToQueue(&tblIdx) == gNVM_SaveRequestRejected_c)
+                {
+                    NvScheduleIntervalSave(idx, 1);
+                }
             }
+            #else /* FlexNVM */
+            NvWriteRecord(&tblIdx);
+            #endif
         }
-
-        if(maDatasetInfo[idx].saveNextInterval)
+        else
         {
-            if (maDatasetInfo[idx].ticksToNextSave)
+            /* retry next time we have a tick */
+            if (NvAddSaveRequestToQueue(&tblIdx) == gNVM_SaveRequestRejected_c)
             {
-                fTicksLeft = TRUE;
+                NvScheduleIntervalSave(idx, 1);
             }
-            else
-            {
-                tblIdx.entryId = pNVM_DataTable[idx].DataEntryID;
-                #if gUnmirroredFeatureSet_d
-                if (gNVM_MirroredInRam_c != pNVM_DataTable[idx].DataEntryType)
-                {
-                    tblIdx.elementIndex = maDatasetInfo[idx].elementIndex;
-                    tblIdx.saveRestoreAll = FALSE;
-                }
-                else
-                #endif
-                {
-                    tblIdx.elementIndex = 0;
-                    tblIdx.saveRestoreAll = TRUE;
-                }
-                maDatasetInfo[idx].saveNextInterval = FALSE;
-                if(!mNvCriticalSectionFlag)
-                {
-                    #if (gNvUseFlexNVM_d == FALSE) || ((gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE == 0)) /* no FlexNVM */
-                    if(NvWriteRecord(&tblIdx) == gNVM_PageCopyPending_c)
-                    {
-                        /* retry next time we have a tick */
-                        if (NvAddSaveRequestToQueue(&tblIdx) == gNVM_SaveRequestRejected_c)
-                        {
-                            maDatasetInfo[idx].saveNextInterval = TRUE;
-                    }
-                    }
-                    #else /* FlexNVM */
-                    NvWriteRecord(&tblIdx);
-                    #endif
-                }
-                else
-                {
-                    /* retry next time we have a tick */
-                    if (NvAddSaveRequestToQueue(&tblIdx) == gNVM_SaveRequestRejected_c)
-                    {
-                        maDatasetInfo[idx].saveNextInterval = TRUE;
-					}
-				}
-			}
         }
-
-        /* increment the loop counter */
-        idx++;
     }
-    
-    return fTicksLeft;
+
+    return (bool_t)(mNvSaveDeadlineHeapSize != 0);
 }/* NvTimerTick() */
 
 
@@ -2341,8 +2804,7 @@ static NVM_Status_t __NvSaveOnInterval
 
     if(maDatasetInfo[tableEntryIdx].saveNextInterval == FALSE)
     {
-        maDatasetInfo[tableEntryIdx].ticksToNextSave = gNvMinimumTicksBetweenSaves;
-        maDatasetInfo[tableEntryIdx].saveNextInterval = TRUE;
+        NvScheduleIntervalSave(tableEntryIdx, gNvMinimumTicksBetweenSaves);
 #if gUnmirroredFeatureSet_d
         if (gNVM_MirroredInRam_c != pNVM_DataTable[tableEntryIdx].DataEntryType)
         {
@@ -2459,6 +2921,11 @@ static NVM_Status_t __NvModuleInit
     
     /* Initialize the pending saves queue */
     NvInitPendingSavesQueue(&mNvPendingSavesQueue);
+
+#if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+    /* no element location is known yet */
+    NvUnmirroredCacheInvalidate(gNvInvalidDataEntry_c, gNvInvalidElementIndex_c);
+#endif
     
     /* Initialize the data set info table */
     for(loopCnt = 0; loopCnt < (index_t)gNvTableEntriesCountMax_c; loopCnt++)
@@ -2466,6 +2933,7 @@ static NVM_Status_t __NvModuleInit
         maDatasetInfo[loopCnt].saveNextInterval = FALSE;
         maDatasetInfo[loopCnt].countsToNextSave = gNvCountsBetweenSaves;
     }
+    mNvSaveDeadlineHeapSize = 0;
     
     /* initialize the event used by save-on-interval functionality */
     mNvSaveOnIntervalEvent = FALSE;
@@ -2498,11 +2966,19 @@ static NVM_Status_t __NvModuleInit
     
 #else /* no FlexNVM */
     
+#if gNvCircularLog_d
+    /* check linker file symbol definition for sector count; it should be multiple of the log pages count */
+    if (((uint32_t)NV_STORAGE_MAX_SECTORS) % gNvVirtualPagesCount_c)
+    {
+        return gNVM_InvalidSectorsCount_c;
+    }
+#else
     /* check linker file symbol definition for sector count; it should be multiple of 2 */
     if (((uint32_t)NV_STORAGE_MAX_SECTORS) & 0x1)
     {
         return gNVM_InvalidSectorsCount_c;
     }
+#endif
     InitNVMConfig();
     
     /* both pages are not valid, format the NV storage system */
@@ -2529,7 +3005,7 @@ static NVM_Status_t __NvModuleInit
         mNvTableUpdated = (GetFlashTableVersion() != mNvFlashTableVersion) || NvIsRamTableUpdated();
         if( mNvTableUpdated )
         {
-            if(gNVM_OK_c == NvUpdateLastMetaInfoAddress())
+            if(gNVM_OK_c == NvUpdateLastMetaInfoAddress(mNvActivePageId))
             {
                 /* copy the new RAM table and the page content */
 #if (gFsciIncluded_c && gNvmEnableFSCIMonitoring_c)
@@ -2557,7 +3033,16 @@ static NVM_Status_t __NvModuleInit
 #endif /* gNvUseExtendedFeatureSet_d */
     
     /* get the last meta information address */
-    if(gNVM_OK_c == (status = NvUpdateLastMetaInfoAddress()))
+    status = NvUpdateLastMetaInfoAddress(mNvActivePageId);
+#if gNvCircularLog_d
+    if(gNVM_MetaNotFound_c == status)
+    {
+        /* no valid record on the active log page, the older log pages still hold the records */
+        mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+        status = gNVM_OK_c;
+    }
+#endif
+    if(gNVM_OK_c == status)
     {
         /* NVM module is now initialized */
         mNvModuleInitialized = TRUE;
@@ -2727,8 +3212,6 @@ static NVM_Status_t __NvmMoveToRam
     uint16_t tableEntryIndex;
     NVM_Status_t status;
     void* pData=NULL;
-    index_t loopIdx;
-    uint8_t remaining_count;
 
     /* Get entry from NVM table */
     if((status = NvGetEntryFromDataPtr(ppData, &tblIdx)) != gNVM_OK_c)
@@ -2750,29 +3233,8 @@ static NVM_Status_t __NvmMoveToRam
     if(!NvIsNVMFlashAddress(*ppData)&&(*ppData != NULL))
     {
         /* Check if is in pendding queue - if yes than remove it */
-        if (NvGetPendingSavesCount(&mNvPendingSavesQueue))
-        {
-            /* Start from the queue's head */
-            loopIdx = mNvPendingSavesQueue.Head;
-            remaining_count = mNvPendingSavesQueue.EntriesCount;
-
-            while(remaining_count)
-            {
-                if((tblIdx.entryId == mNvPendingSavesQueue.QData[loopIdx].entryId)&&
-                   (tblIdx.elementIndex == mNvPendingSavesQueue.QData[loopIdx].elementIndex))
-                {
-                    mNvPendingSavesQueue.QData[loopIdx].entryId = gNvInvalidDataEntry_c;
-                    break;
-                }
-                remaining_count--;
-                /* increment and wrap the loop index */
-                if(++loopIdx >= (uint8_t)gNvPendingSavesQueueSize_c)
-                {
-                    loopIdx=0;
-                }
-            }
-        }
-        maDatasetInfo[tableEntryIndex].saveNextInterval = FALSE;
+        NvRemovePendingSaves(&mNvPendingSavesQueue, tblIdx.entryId, tblIdx.elementIndex);
+        NvCancelIntervalSave(tableEntryIndex);
         return gNVM_OK_c;
     }
 
@@ -2810,8 +3272,6 @@ static NVM_Status_t __NvmErase
     NVM_Status_t status;
     NVM_TableEntryInfo_t tblIdx;
     uint16_t tableEntryIndex;
-    index_t loopCnt;
-    uint8_t remaining_count;
 
     /* Get entry from NVM table */
     if((status = NvGetEntryFromDataPtr(ppData, &tblIdx)) != gNVM_OK_c)
@@ -2842,26 +3302,7 @@ static NVM_Status_t __NvmErase
     }
 
     /* Check if is in pending queue - if yes than remove it */
-    if (NvGetPendingSavesCount(&mNvPendingSavesQueue))
-    {
-        /* Start from the queue's head */
-        loopCnt = mNvPendingSavesQueue.Head;
-        remaining_count = mNvPendingSavesQueue.EntriesCount;
-        while (remaining_count)
-        {
-            /* if the element is waiting to be saved, cancel the save */
-            if ((tblIdx.entryId == mNvPendingSavesQueue.QData[loopCnt].entryId) && (tblIdx.elementIndex == mNvPendingSavesQueue.QData[loopCnt].elementIndex))
-            {
-                mNvPendingSavesQueue.QData[loopCnt].entryId = gNvInvalidDataEntry_c;
-            }
-            remaining_count--;
-            /* increment and wrap the loop index */
-            if(++loopCnt >= (uint8_t)gNvPendingSavesQueueSize_c)
-            {
-                loopCnt=0;
-            }
-        }
-    }
+    NvRemovePendingSaves(&mNvPendingSavesQueue, tblIdx.entryId, tblIdx.elementIndex);
     OSA_InterruptDisable();
     *ppData = NULL;
     OSA_InterruptEnable();
@@ -2913,6 +3354,8 @@ static bool_t NvInitPendingSavesQueue
     pQueue->Head = 0;
     pQueue->Tail = 0;
     pQueue->EntriesCount = 0;
+    FLib_MemSet(pQueue->HashHead, 0, sizeof(pQueue->HashHead));
+    FLib_MemSet(pQueue->InvalidSlots, 0, sizeof(pQueue->InvalidSlots));
 
     return TRUE;
 }
@@ -2938,6 +3381,9 @@ static bool_t NvPushPendingSave
     if((pQueue->Tail == pQueue->Head) && (pQueue->EntriesCount > 0))
     {
 #if gFifoOverwriteEnabled_c
+        /* the oldest request is overwritten */
+        NvInvalidatePendingSave(pQueue, pQueue->Head);
+        pQueue->InvalidSlots[pQueue->Head >> 5] &= ~(1UL << (pQueue->Head & 0x1F));
         /* Increment and wrap the head when it reaches gNvPendingSavesQueueSize_c */
         if(++pQueue->Head >= (uint8_t)gNvPendingSavesQueueSize_c)
         {
@@ -2950,6 +3396,7 @@ static bool_t NvPushPendingSave
 
     /* Add the item to queue */
     pQueue->QData[pQueue->Tail] = data;
+    NvLinkPendingSave(pQueue, pQueue->Tail);
 
     /* Increment and wrap the tail when it reaches gNvPendingSavesQueueSize_c */
     if(++pQueue->Tail >= (uint8_t)gNvPendingSavesQueueSize_c)
@@ -2987,6 +3434,16 @@ static bool_t NvPopPendingSave
 
     *pData = pQueue->QData[pQueue->Head];
 
+    if(pQueue->InvalidSlots[pQueue->Head >> 5] & (1UL << (pQueue->Head & 0x1F)))
+    {
+        /* cancelled request, not indexed anymore */
+        pQueue->InvalidSlots[pQueue->Head >> 5] &= ~(1UL << (pQueue->Head & 0x1F));
+    }
+    else
+    {
+        NvUnlinkPendingSave(pQueue, pQueue->Head);
+    }
+
     /* Increment and wrap the head when it reaches gNvPendingSavesQueueSize_c */    
     if(++pQueue->Head >= (uint8_t)gNvPendingSavesQueueSize_c)
     {
@@ -3016,121 +3473,448 @@ static uint8_t NvGetPendingSavesCount
     return pQueue->EntriesCount;
 }
 
-
-/*****************************************************************
- * The below functions are compiled only if FlexNVM is NOT used
- *****************************************************************/
-
-#if (gNvUseFlexNVM_d == FALSE) || ((gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE == 0)) /* no FlexNVM */
-
+/******************************************************************************
+ * Name: NvGetPendingSaveBucket
+ * Description: Get the pending saves queue bucket of an entry ID
+ * Parameters: [IN] entryId - the table entry ID
+ * Return: the bucket index
+ ******************************************************************************/
+static uint8_t NvGetPendingSaveBucket
+(
+    NvTableEntryId_t entryId
+)
+{
+    return (uint8_t)((entryId ^ (entryId >> 8)) % gNvPendingSavesHashSize_c);
+}
 
 /******************************************************************************
- * Name: InitNVMConfig
- * Description: Initialises the hal driver, and gets the active page.
- * Parameter(s): -
+ * Name: NvLinkPendingSave
+ * Description: Add a queue slot to the bucket of its entry ID
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] slot - the queue slot
  * Return: -
- *****************************************************************************/
-static void InitNVMConfig
+ ******************************************************************************/
+static void NvLinkPendingSave
 (
-    void
+    NVM_SaveQueue_t *pQueue,
+    index_t slot
 )
 {
-    if (mNvFlashConfigInitialised)
-        return;
-    /* Initialize flash HAL driver */
-    NV_Init();
-
-    /* no pending erase operations on system initialisation */
-    mNvErasePgCmdStatus.NvErasePending = FALSE;
-
-    /* Initialize the active page ID */
-    mNvActivePageId = gVirtualPageNone_c;
+    uint8_t bucket = NvGetPendingSaveBucket(pQueue->QData[slot].entryId);
 
-    /* First virtual page initialisation */
-    mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorStartAddress = (uint32_t)((uint8_t*)NV_STORAGE_END_ADDRESS);
-    mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorsCount = (uint32_t)((uint8_t*) NV_STORAGE_MAX_SECTORS) >> 1;
-    mNvVirtualPageProperty[gFirstVirtualPage_c].NvTotalPageSize = mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorsCount *
-        (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE);
-    mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorEndAddress = mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorStartAddress +
-        mNvVirtualPageProperty[gFirstVirtualPage_c].NvTotalPageSize - 1;
+    pQueue->HashNext[slot] = pQueue->HashHead[bucket];
+    pQueue->HashHead[bucket] = slot + 1;
+}
 
-    /* Second virtual page initialisation */
-    mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorStartAddress = mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorEndAddress + 1;
-    mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorsCount = (uint32_t)((uint8_t*) NV_STORAGE_MAX_SECTORS) >> 1;
-    mNvVirtualPageProperty[gSecondVirtualPage_c].NvTotalPageSize = mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorsCount *
-        (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE);
-    mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorEndAddress = mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorStartAddress +
-        mNvVirtualPageProperty[gSecondVirtualPage_c].NvTotalPageSize - 1;
+/******************************************************************************
+ * Name: NvUnlinkPendingSave
+ * Description: Remove a queue slot from the bucket of its entry ID
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] slot - the queue slot
+ * Return: -
+ ******************************************************************************/
+static void NvUnlinkPendingSave
+(
+    NVM_SaveQueue_t *pQueue,
+    index_t slot
+)
+{
+    uint8_t *pLink = &pQueue->HashHead[NvGetPendingSaveBucket(pQueue->QData[slot].entryId)];
 
-    /* Initialize the storage system: get active page and page counter */
-    NvInitStorageSystem(FALSE);
-    if (mNvActivePageId == gVirtualPageNone_c)
+    while(*pLink)
     {
-        /* maybe the table is in old format and needs to be updated */
-        NvInitStorageSystem(TRUE);
-        if (mNvActivePageId != gVirtualPageNone_c)
+        if(*pLink == slot + 1)
         {
-            UpgradeLegacyTable();
+            *pLink = pQueue->HashNext[slot];
+            break;
         }
+        pLink = &pQueue->HashNext[*pLink - 1];
     }
-    #if gNvUseExtendedFeatureSet_d
-    if (mNvActivePageId != gVirtualPageNone_c)
-    {
-        mNvTableSizeInFlash = NvGetFlashTableSize();
-    }
-    #endif
-    mNvFlashConfigInitialised = TRUE;
+    pQueue->HashNext[slot] = 0;
 }
 
 /******************************************************************************
- * Name: NvUpdateSize
- * Description: Updates the size to be a multiple of 4 or 8 depending on the flash controller
- * Parameter(s): [IN] size - size to be updated
- * Return: the computed size
- *****************************************************************************/
-static uint32_t NvUpdateSize
+ * Name: NvGetNextPendingSave
+ * Description: Iterate through the queued requests of an entry ID
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] entryId - the table entry ID
+ *             [IN] link - 0 to get the first request, or the value returned
+ *                         by the previous call to get the next one
+ * Return: the queue slot + 1 of the request, 0 if there are no more requests
+ ******************************************************************************/
+static uint8_t NvGetNextPendingSave
 (
-    uint32_t size
+    NVM_SaveQueue_t *pQueue,
+    NvTableEntryId_t entryId,
+    uint8_t link
 )
 {
-    /* compute the size that will be actually written on FLASH memory */
-    uint8_t paddingBytes = size % (uint8_t)PGM_SIZE_BYTE;
-
-    if(paddingBytes)
+    if(0 == link)
     {
-        size += (uint8_t)((uint8_t)PGM_SIZE_BYTE-paddingBytes);
+        link = pQueue->HashHead[NvGetPendingSaveBucket(entryId)];
+    }
+    else
+    {
+        link = pQueue->HashNext[link - 1];
     }
 
-    return size;
+    /* skip the other entry IDs sharing the same bucket */
+    while(link && (pQueue->QData[link - 1].entryId != entryId))
+    {
+        link = pQueue->HashNext[link - 1];
+    }
+    return link;
 }
 
 /******************************************************************************
- * Name: NvEraseVirtualPage
- * Description: erase the specified page
- * Parameter(s): [IN] pageID - the ID of the page to be erased
- * Return: gNVM_InvalidPageID_c - if the page ID is not valid
- *         gNVM_SectorEraseFail_c - if the page cannot be erased
- *         gNVM_OK_c - if operation completed successfully
- *****************************************************************************/
-static NVM_Status_t NvEraseVirtualPage
+ * Name: NvInvalidatePendingSave
+ * Description: Cancel the request stored in a queue slot
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] slot - the queue slot
+ * Return: -
+ ******************************************************************************/
+static void NvInvalidatePendingSave
 (
-    NVM_VirtualPageID_t pageID
+    NVM_SaveQueue_t *pQueue,
+    index_t slot
 )
 {
-    uint32_t status;
-
-    if(pageID > gSecondVirtualPage_c)
-        return gNVM_InvalidPageID_c;
-
-    /* erase virtual page */
-    status = NV_FlashEraseSector(mNvVirtualPageProperty[pageID].NvRawSectorStartAddress,
-                                 mNvVirtualPageProperty[pageID].NvTotalPageSize);
-    if(kStatus_FLASH_Success != status)
+    if(pQueue->InvalidSlots[slot >> 5] & (1UL << (slot & 0x1F)))
     {
-        #if (gFsciIncluded_c && gNvmEnableFSCIMonitoring_c)
-            FSCI_MsgNVPageEraseMonitoring(mNvVirtualPageProperty[pageID].NvRawSectorStartAddress, status);
-        #endif
-        return gNVM_SectorEraseFail_c;
+        return;
+    }
+    NvUnlinkPendingSave(pQueue, slot);
+    pQueue->QData[slot].entryId = gNvInvalidDataEntry_c;
+    pQueue->InvalidSlots[slot >> 5] |= (1UL << (slot & 0x1F));
+}
+
+/******************************************************************************
+ * Name: NvRemovePendingSaves
+ * Description: Cancel the queued requests of an entry ID. The cancelled
+ *              requests keep their queue slot until reused or popped.
+ * Parameters: [IN] pQueue - pointer to queue
+ *             [IN] entryId - the table entry ID
+ *             [IN] elementIndex - the element index, or
+ *                                 gNvInvalidElementIndex_c for all elements
+ * Return: -
+ ******************************************************************************/
+static void NvRemovePendingSaves
+(
+    NVM_SaveQueue_t *pQueue,
+    NvTableEntryId_t entryId,
+    uint16_t elementIndex
+)
+{
+    uint8_t link;
+    uint8_t nextLink;
+
+    link = NvGetNextPendingSave(pQueue, entryId, 0);
+    while(link)
+    {
+        /* get the next request before the current one is unlinked */
+        nextLink = NvGetNextPendingSave(pQueue, entryId, link);
+        if((gNvInvalidElementIndex_c == elementIndex) ||
+           (pQueue->QData[link - 1].elementIndex == elementIndex))
+        {
+            NvInvalidatePendingSave(pQueue, link - 1);
+        }
+        link = nextLink;
+    }
+}
+
+/******************************************************************************
+ * Name: NvGetInvalidPendingSave
+ * Description: Get a queue slot holding a cancelled request
+ * Parameters: [IN] pQueue - pointer to queue
+ * Return: the queue slot, gNvPendingSavesQueueSize_c if there is none
+ ******************************************************************************/
+static index_t NvGetInvalidPendingSave
+(
+    NVM_SaveQueue_t *pQueue
+)
+{
+    index_t word;
+    index_t slot;
+    uint32_t bits;
+
+    for(word = 0; word < (index_t)((gNvPendingSavesQueueSize_c + 31) / 32); word++)
+    {
+        bits = pQueue->InvalidSlots[word];
+        if(bits)
+        {
+            slot = (index_t)(word << 5);
+            while(0 == (bits & 1))
+            {
+                bits >>= 1;
+                slot++;
+            }
+            return slot;
+        }
+    }
+    return (index_t)gNvPendingSavesQueueSize_c;
+}
+
+/******************************************************************************
+ * Name: NvSaveDeadlineHeapSiftUp
+ * Description: Move a save deadlines heap node towards the root until the
+ *              heap order is restored
+ * Parameters: [IN] pos - the heap node
+ * Return: -
+ ******************************************************************************/
+static void NvSaveDeadlineHeapSiftUp
+(
+    uint16_t pos
+)
+{
+    uint16_t parent;
+    uint16_t tableEntryIdx = maNvSaveDeadlineHeap[pos];
+
+    while(pos)
+    {
+        parent = (pos - 1) >> 1;
+        if((int32_t)(maDatasetInfo[maNvSaveDeadlineHeap[parent]].nextSaveTick - maDatasetInfo[tableEntryIdx].nextSaveTick) <= 0)
+        {
+            break;
+        }
+        maNvSaveDeadlineHeap[pos] = maNvSaveDeadlineHeap[parent];
+        maNvSaveDeadlineHeapPos[maNvSaveDeadlineHeap[pos]] = pos;
+        pos = parent;
+    }
+    maNvSaveDeadlineHeap[pos] = tableEntryIdx;
+    maNvSaveDeadlineHeapPos[tableEntryIdx] = pos;
+}
+
+/******************************************************************************
+ * Name: NvSaveDeadlineHeapSiftDown
+ * Description: Move a save deadlines heap node towards the leaves until the
+ *              heap order is restored
+ * Parameters: [IN] pos - the heap node
+ * Return: -
+ ******************************************************************************/
+static void NvSaveDeadlineHeapSiftDown
+(
+    uint16_t pos
+)
+{
+    uint16_t child;
+    uint16_t tableEntryIdx = maNvSaveDeadlineHeap[pos];
+
+    while((child = (pos << 1) + 1) < mNvSaveDeadlineHeapSize)
+    {
+        if((child + 1 < mNvSaveDeadlineHeapSize) &&
+           ((int32_t)(maDatasetInfo[maNvSaveDeadlineHeap[child + 1]].nextSaveTick - maDatasetInfo[maNvSaveDeadlineHeap[child]].nextSaveTick) < 0))
+        {
+            child++;
+        }
+        if((int32_t)(maDatasetInfo[tableEntryIdx].nextSaveTick - maDatasetInfo[maNvSaveDeadlineHeap[child]].nextSaveTick) <= 0)
+        {
+            break;
+        }
+        maNvSaveDeadlineHeap[pos] = maNvSaveDeadlineHeap[child];
+        maNvSaveDeadlineHeapPos[maNvSaveDeadlineHeap[pos]] = pos;
+        pos = child;
+    }
+    maNvSaveDeadlineHeap[pos] = tableEntryIdx;
+    maNvSaveDeadlineHeapPos[tableEntryIdx] = pos;
+}
+
+/******************************************************************************
+ * Name: NvScheduleIntervalSave
+ * Description: Schedule the save-on-interval of a table entry
+ * Parameters: [IN] tableEntryIdx - the table entry index
+ *             [IN] ticks - ticks until the save is due
+ * Return: -
+ ******************************************************************************/
+static void NvScheduleIntervalSave
+(
+    uint16_t tableEntryIdx,
+    uint32_t ticks
+)
+{
+    NvCancelIntervalSave(tableEntryIdx);
+
+    maDatasetInfo[tableEntryIdx].nextSaveTick = mNvTickCounter + ticks;
+    maDatasetInfo[tableEntryIdx].saveNextInterval = TRUE;
+
+    maNvSaveDeadlineHeap[mNvSaveDeadlineHeapSize] = tableEntryIdx;
+    NvSaveDeadlineHeapSiftUp(mNvSaveDeadlineHeapSize++);
+}
+
+/******************************************************************************
+ * Name: NvCancelIntervalSave
+ * Description: Cancel the save-on-interval of a table entry
+ * Parameters: [IN] tableEntryIdx - the table entry index
+ * Return: -
+ ******************************************************************************/
+static void NvCancelIntervalSave
+(
+    uint16_t tableEntryIdx
+)
+{
+    uint16_t pos;
+    uint16_t movedIdx;
+
+    if(!maDatasetInfo[tableEntryIdx].saveNextInterval)
+    {
+        return;
+    }
+    maDatasetInfo[tableEntryIdx].saveNextInterval = FALSE;
+
+    /* replace the node with the last one and restore the heap order */
+    pos = maNvSaveDeadlineHeapPos[tableEntryIdx];
+    if(pos != --mNvSaveDeadlineHeapSize)
+    {
+        movedIdx = maNvSaveDeadlineHeap[mNvSaveDeadlineHeapSize];
+        maNvSaveDeadlineHeap[pos] = movedIdx;
+        NvSaveDeadlineHeapSiftUp(pos);
+        NvSaveDeadlineHeapSiftDown(maNvSaveDeadlineHeapPos[movedIdx]);
+    }
+}
+
+
+/*****************************************************************
+ * The below functions are compiled only if FlexNVM is NOT used
+ *****************************************************************/
+
+#if (gNvUseFlexNVM_d == FALSE) || ((gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE == 0)) /* no FlexNVM */
+
+
+/******************************************************************************
+ * Name: InitNVMConfig
+ * Description: Initialises the hal driver, and gets the active page.
+ * Parameter(s): -
+ * Return: -
+ *****************************************************************************/
+static void InitNVMConfig
+(
+    void
+)
+{
+#if gNvCircularLog_d
+    uint8_t pageIdx;
+#endif
+
+    if (mNvFlashConfigInitialised)
+        return;
+    /* Initialize flash HAL driver */
+    NV_Init();
+
+    /* no pending erase operations on system initialisation */
+    mNvErasePgCmdStatus.NvErasePending = FALSE;
+
+    /* Initialize the active page ID */
+    mNvActivePageId = gVirtualPageNone_c;
+
+#if gNvCircularLog_d
+    /* log pages initialisation, the log pages follow each other in the NV storage */
+    for(pageIdx = 0; pageIdx < gNvVirtualPagesCount_c; pageIdx++)
+    {
+        mNvVirtualPageProperty[pageIdx].NvRawSectorsCount = (uint32_t)((uint8_t*) NV_STORAGE_MAX_SECTORS) / gNvVirtualPagesCount_c;
+        mNvVirtualPageProperty[pageIdx].NvTotalPageSize = mNvVirtualPageProperty[pageIdx].NvRawSectorsCount *
+            (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE);
+        mNvVirtualPageProperty[pageIdx].NvRawSectorStartAddress = (uint32_t)((uint8_t*)NV_STORAGE_END_ADDRESS) +
+            pageIdx * mNvVirtualPageProperty[pageIdx].NvTotalPageSize;
+        mNvVirtualPageProperty[pageIdx].NvRawSectorEndAddress = mNvVirtualPageProperty[pageIdx].NvRawSectorStartAddress +
+            mNvVirtualPageProperty[pageIdx].NvTotalPageSize - 1;
+    }
+
+    /* Initialize the storage system: get the active page, the oldest page and the page counter */
+    NvLogInitStorageSystem();
+#else
+    /* First virtual page initialisation */
+    mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorStartAddress = (uint32_t)((uint8_t*)NV_STORAGE_END_ADDRESS);
+    mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorsCount = (uint32_t)((uint8_t*) NV_STORAGE_MAX_SECTORS) >> 1;
+    mNvVirtualPageProperty[gFirstVirtualPage_c].NvTotalPageSize = mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorsCount *
+        (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE);
+    mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorEndAddress = mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorStartAddress +
+        mNvVirtualPageProperty[gFirstVirtualPage_c].NvTotalPageSize - 1;
+
+    /* Second virtual page initialisation */
+    mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorStartAddress = mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorEndAddress + 1;
+    mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorsCount = (uint32_t)((uint8_t*) NV_STORAGE_MAX_SECTORS) >> 1;
+    mNvVirtualPageProperty[gSecondVirtualPage_c].NvTotalPageSize = mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorsCount *
+        (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE);
+    mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorEndAddress = mNvVirtualPageProperty[gSecondVirtualPage_c].NvRawSectorStartAddress +
+        mNvVirtualPageProperty[gSecondVirtualPage_c].NvTotalPageSize - 1;
+
+    /* Initialize the storage system: get active page and page counter */
+    NvInitStorageSystem(FALSE);
+    if (mNvActivePageId == gVirtualPageNone_c)
+    {
+        /* maybe the table is in old format and needs to be updated */
+        NvInitStorageSystem(TRUE);
+        if (mNvActivePageId != gVirtualPageNone_c)
+        {
+            UpgradeLegacyTable();
+        }
+    }
+#endif /* gNvCircularLog_d */
+    #if gNvUseExtendedFeatureSet_d
+    if (mNvActivePageId != gVirtualPageNone_c)
+    {
+        mNvTableSizeInFlash = NvGetFlashTableSize();
+    }
+    #endif
+    mNvFlashConfigInitialised = TRUE;
+}
+
+/******************************************************************************
+ * Name: NvUpdateSize
+ * Description: Updates the size to be a multiple of 4 or 8 depending on the flash controller
+ * Parameter(s): [IN] size - size to be updated
+ * Return: the computed size
+ *****************************************************************************/
+static uint32_t NvUpdateSize
+(
+    uint32_t size
+)
+{
+    /* compute the size that will be actually written on FLASH memory */
+    uint8_t paddingBytes = size % (uint8_t)PGM_SIZE_BYTE;
+
+    if(paddingBytes)
+    {
+        size += (uint8_t)((uint8_t)PGM_SIZE_BYTE-paddingBytes);
+    }
+
+    return size;
+}
+
+/******************************************************************************
+ * Name: NvEraseVirtualPage
+ * Description: erase the specified page
+ * Parameter(s): [IN] pageID - the ID of the page to be erased
+ * Return: gNVM_InvalidPageID_c - if the page ID is not valid
+ *         gNVM_SectorEraseFail_c - if the page cannot be erased
+ *         gNVM_OK_c - if operation completed successfully
+ *****************************************************************************/
+static NVM_Status_t NvEraseVirtualPage
+(
+    NVM_VirtualPageID_t pageID
+)
+{
+    uint32_t status = gNVM_OK_c;
+    uint32_t sectorAddress;
+
+    if(pageID >= gNvVirtualPagesCount_c)
+        return gNVM_InvalidPageID_c;
+
+    /* erase virtual page, sector by sector; the sectors that were not written are not erased */
+    for(sectorAddress = mNvVirtualPageProperty[pageID].NvRawSectorStartAddress;
+        sectorAddress < mNvVirtualPageProperty[pageID].NvRawSectorEndAddress;
+        sectorAddress += (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE))
+    {
+        if(gNVM_OK_c != (status = NvEraseStorageSector(sectorAddress)))
+        {
+            break;
+        }
+    }
+    if(gNVM_OK_c != status)
+    {
+        #if (gFsciIncluded_c && gNvmEnableFSCIMonitoring_c)
+            FSCI_MsgNVPageEraseMonitoring(mNvVirtualPageProperty[pageID].NvRawSectorStartAddress, status);
+        #endif
+        return gNVM_SectorEraseFail_c;
     }
 
     if(gNVM_OK_c != (status = NvVirtualPageBlankCheck(pageID)))
@@ -3147,6 +3931,7 @@ static NVM_Status_t NvEraseVirtualPage
 }
 
 
+#if !gNvCircularLog_d
 /******************************************************************************
  * Name: NvInitStorageSystem
  * Description: Initialize the storage system, retrieve the active page and
@@ -3273,6 +4058,96 @@ static void NvInitStorageSystem
 
     mNvActivePageId = gVirtualPageNone_c;
 }
+#else
+/******************************************************************************
+ * Name: NvLogInitStorageSystem
+ * Description: Initialize the circular log: retrieve the active (newest) log
+ *              page, the oldest log page and the page counter. Called once by
+ *              NvModuleInit() function.
+ * Parameter(s): -
+ * Return: -
+ *****************************************************************************/
+static void NvLogInitStorageSystem
+(
+    void
+)
+{
+    uint8_t pageIdx;
+    NVM_VirtualPageID_t pageId;
+    uint32_t pageCounter;
+
+    /* the active page is the valid log page with the highest page counter */
+    mNvActivePageId = gVirtualPageNone_c;
+    for(pageIdx = 0; pageIdx < gNvVirtualPagesCount_c; pageIdx++)
+    {
+        if(NvLogGetPageCounter((NVM_VirtualPageID_t)pageIdx, &pageCounter) &&
+           ((gVirtualPageNone_c == mNvActivePageId) || (pageCounter > mNvPageCounter)))
+        {
+            mNvPageCounter = pageCounter;
+            mNvActivePageId = (NVM_VirtualPageID_t)pageIdx;
+        }
+    }
+
+    if(gVirtualPageNone_c == mNvActivePageId)
+    {
+        return;
+    }
+
+    /* the older log pages precede the active page, with consecutive page counters.
+     * A reclaimed page whose erase did not complete is still part of the log: its
+     * records are either superseded or copied again by the next reclaim */
+    mNvLogTailPageId = mNvActivePageId;
+    for(pageIdx = 1; pageIdx < gNvVirtualPagesCount_c; pageIdx++)
+    {
+        pageId = (NVM_VirtualPageID_t)((mNvActivePageId + gNvVirtualPagesCount_c - pageIdx) % gNvVirtualPagesCount_c);
+        if(!NvLogGetPageCounter(pageId, &pageCounter) || (pageCounter != mNvPageCounter - pageIdx))
+        {
+            break;
+        }
+        mNvLogTailPageId = pageId;
+
+        if(gNVM_OK_c != NvUpdateLastMetaInfoAddress(pageId))
+        {
+            /* no valid record on this log page */
+            mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+        }
+    }
+
+    /* the next log page is erased in background if it was left unerased */
+    pageId = (NVM_VirtualPageID_t)((mNvActivePageId + 1) % gNvVirtualPagesCount_c);
+    if((pageId != mNvLogTailPageId) && (gNVM_PageIsNotBlank_c == NvVirtualPageBlankCheck(pageId)))
+    {
+        mNvErasePgCmdStatus.NvPageToErase = pageId;
+        mNvErasePgCmdStatus.NvSectorAddress = mNvVirtualPageProperty[pageId].NvRawSectorStartAddress;
+        mNvErasePgCmdStatus.NvErasePending = TRUE;
+    }
+}
+
+/******************************************************************************
+ * Name: NvLogGetPageCounter
+ * Description: read the page counter of a log page
+ * Parameter(s): [IN] pageId - the ID of the log page
+ *               [OUT] pPageCounter - the page counter value
+ * Return: TRUE if the log page holds a valid page counter, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvLogGetPageCounter
+(
+    NVM_VirtualPageID_t pageId,
+    uint32_t* pPageCounter
+)
+{
+    uint32_t topValue;
+    uint32_t bottomValue;
+
+    NV_FlashRead(mNvVirtualPageProperty[pageId].NvRawSectorStartAddress, (uint8_t*)&topValue,
+                 sizeof(topValue));
+    NV_FlashRead(mNvVirtualPageProperty[pageId].NvRawSectorEndAddress - sizeof(NVM_TableInfo_t) + 1,
+                 (uint8_t*)&bottomValue, sizeof(bottomValue));
+
+    *pPageCounter = topValue;
+    return (bool_t)((topValue == bottomValue) && (gPageCounterMaxValue_c != topValue));
+}
+#endif /* !gNvCircularLog_d */
 
 /******************************************************************************
  * Name: NvVirtualPageBlankCheck
@@ -3287,7 +4162,7 @@ static NVM_Status_t NvVirtualPageBlankCheck
     NVM_VirtualPageID_t pageID
 )
 {
-    if(pageID > gSecondVirtualPage_c)
+    if(pageID >= gNvVirtualPagesCount_c)
         return gNVM_InvalidPageID_c;
 
 
@@ -3304,36 +4179,36 @@ static NVM_Status_t NvVirtualPageBlankCheck
 /******************************************************************************
  * Name: NvUpdateLastMetaInfoAddress
  * Description: retrieve and store (update) the last meta information address
- * Parameter(s): -
+ * Parameter(s): [IN] pageId - the ID of the page
  * Return: gNVM_MetaNotFound_c - if no meta information has been found
  *         gNVM_OK_c - if the meta was found and stored (updated)
  *****************************************************************************/
 static NVM_Status_t NvUpdateLastMetaInfoAddress
 (
-    void
+    NVM_VirtualPageID_t pageId
 )
 {
     NVM_RecordMetaInfo_t metaValue;
-    uint32_t readAddress = mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c;
+    uint32_t readAddress = mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c;
 
-    while(readAddress < mNvVirtualPageProperty[mNvActivePageId].NvRawSectorEndAddress)
+    while(readAddress < mNvVirtualPageProperty[pageId].NvRawSectorEndAddress)
     {
         NV_FlashRead(readAddress, (uint8_t*)&metaValue, sizeof(metaValue));
 
         if(gNvGuardValue_c == metaValue.rawValue)
         {
-            if(readAddress == (mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
+            if(readAddress == (mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
             {
-                mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+                mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
                 #if gUnmirroredFeatureSet_d
-                    mNvVirtualPageProperty[mNvActivePageId].NvLastMetaUnerasedInfoAddress = gEmptyPageMetaAddress_c;
+                    mNvVirtualPageProperty[pageId].NvLastMetaUnerasedInfoAddress = gEmptyPageMetaAddress_c;
                 #endif
                 return gNVM_OK_c;
             }
 
             readAddress -= sizeof(NVM_RecordMetaInfo_t);
 
-            while(readAddress >= (mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
+            while(readAddress >= (mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
             {
                 NV_FlashRead(readAddress, (uint8_t*)&metaValue, sizeof(metaValue));
 
@@ -3341,10 +4216,10 @@ static NVM_Status_t NvUpdateLastMetaInfoAddress
                    ((gValidationByteSingleRecord_c == metaValue.fields.NvValidationStartByte) ||
                     (gValidationByteAllRecords_c == metaValue.fields.NvValidationStartByte)))
                 {
-                    mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress = readAddress;
+                    mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress = readAddress;
                     #if gUnmirroredFeatureSet_d
                     {
-                        while(readAddress >= (mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
+                        while(readAddress >= (mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
                         {
                             if(metaValue.fields.NvmRecordOffset == 0)
                             {
@@ -3353,7 +4228,7 @@ static NVM_Status_t NvUpdateLastMetaInfoAddress
                             }
                             else
                             {
-                                mNvVirtualPageProperty[mNvActivePageId].NvLastMetaUnerasedInfoAddress = readAddress;
+                                mNvVirtualPageProperty[pageId].NvLastMetaUnerasedInfoAddress = readAddress;
                                 break;
                             }
                         }
@@ -3518,8 +4393,46 @@ static bool_t NvIsMemoryAreaAvailable
 
 
 /******************************************************************************
- * Name: NvIsRecordCopied
- * Description: Checks if a record or an entire table entry is already copied.
+ * Name: NvGetOlderPage
+ * Description: move to the page holding the records older than the ones of
+ *              the given page. Only the circular log spreads the records over
+ *              several pages; the empty log pages are skipped.
+ * Parameter(s): [IN/OUT] pPageId - the ID of the page
+ *               [OUT] pLastMetaAddress - the last meta information address
+ *                                        of the older page
+ * Return: TRUE if an older page holding records was found, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvGetOlderPage
+(
+    NVM_VirtualPageID_t* pPageId,
+    uint32_t* pLastMetaAddress
+)
+{
+#if gNvCircularLog_d
+    NVM_VirtualPageID_t pageId = *pPageId;
+
+    while(pageId != mNvLogTailPageId)
+    {
+        pageId = (NVM_VirtualPageID_t)((pageId + gNvVirtualPagesCount_c - 1) % gNvVirtualPagesCount_c);
+        if(gEmptyPageMetaAddress_c != mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress)
+        {
+            *pPageId = pageId;
+            *pLastMetaAddress = mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress;
+            return TRUE;
+        }
+    }
+#else
+    /* all the records are on the active page */
+    (void)pPageId;
+    (void)pLastMetaAddress;
+#endif
+    return FALSE;
+}
+
+#if !gNvCircularLog_d
+/******************************************************************************
+ * Name: NvIsRecordCopied
+ * Description: Checks if a record or an entire table entry is already copied.
  *              Called by page copy function.
  * Parameter(s): [IN] pageId - the ID of the page where to perform the check
  *               [IN] metaInf - a pointer to source page meta information tag
@@ -3599,6 +4512,7 @@ static bool_t NvIsRecordCopied
 
     return retVal;
 }
+#endif /* !gNvCircularLog_d */
 
 
 /******************************************************************************
@@ -3619,6 +4533,8 @@ static bool_t NvIsRecordCopied
  *****************************************************************************/
 static NVM_Status_t NvInternalCopy
 (
+    NVM_VirtualPageID_t srcPageId,
+    NVM_VirtualPageID_t dstPageId,
     uint32_t dstAddress,
     uint32_t dstMetaAddress,
     NVM_RecordMetaInfo_t* srcMetaInfo,
@@ -3643,7 +4559,7 @@ static NVM_Status_t NvInternalCopy
     * the preparation is made here because the 'dstAddress' may change afterwards
     */
     dstMetaInfo.fields = srcMetaInfo->fields;
-    dstMetaInfo.fields.NvmRecordOffset = dstAddress - mNvVirtualPageProperty[(mNvActivePageId+1)%2].NvRawSectorStartAddress;
+    dstMetaInfo.fields.NvmRecordOffset = dstAddress - mNvVirtualPageProperty[dstPageId].NvRawSectorStartAddress;
 
     if (srcMetaInfo->fields.NvValidationStartByte != gValidationByteSingleRecord_c)
     {
@@ -3664,7 +4580,7 @@ static NVM_Status_t NvInternalCopy
         if(size > (uint16_t)gNvCacheBufferSize_c)
         {
             /* copy from FLASH to cache buffer */
-            NV_FlashRead(mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + srcMetaInfo->fields.NvmRecordOffset + innerOffset,
+            NV_FlashRead(mNvVirtualPageProperty[srcPageId].NvRawSectorStartAddress + srcMetaInfo->fields.NvmRecordOffset + innerOffset,
                          (uint8_t*)&cacheBuffer[0], (uint16_t)gNvCacheBufferSize_c);
 
             /* write to destination page */
@@ -3684,7 +4600,7 @@ static NVM_Status_t NvInternalCopy
         else
         {
             /* copy from FLASH to cache buffer */
-            NV_FlashRead(mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + srcMetaInfo->fields.NvmRecordOffset + innerOffset,
+            NV_FlashRead(mNvVirtualPageProperty[srcPageId].NvRawSectorStartAddress + srcMetaInfo->fields.NvmRecordOffset + innerOffset,
                          (uint8_t*)&cacheBuffer[0], size);
             /* write to destination page */
             if(kStatus_FLASH_Success == NV_FlashProgramUnaligned(dstAddress, (uint16_t)size, cacheBuffer))
@@ -3756,6 +4672,7 @@ static NVM_Status_t NvInternalCopy
 }
 
 
+#if gNvFragmentation_Enabled_d && !gNvCircularLog_d
 /******************************************************************************
  * Name: NvGetTblEntryMetaAddrFromId
  * Description: Gets the table entry meta address based on table entry ID
@@ -3763,7 +4680,6 @@ static NVM_Status_t NvInternalCopy
  *               [IN] dataEntryId - table entry ID
  * Return: the value of the meta address
  *****************************************************************************/
-#if gNvFragmentation_Enabled_d
 static uint32_t NvGetTblEntryMetaAddrFromId
 (
     uint32_t searchStartAddress,
@@ -3982,48 +4898,84 @@ static NVM_Status_t NvInternalDefragmentedCopy
     }
     return status;
 }
-#endif /* gNvFragmentation_Enabled_d */
+#endif /* gNvFragmentation_Enabled_d && !gNvCircularLog_d */
 
+#if !gNvCircularLog_d
 /******************************************************************************
- * Name: NvCopyPage
- * Description: Copy the active page content to the mirror page. Only the
- *              latest table entries / elements are copied. A merge operation
- *              is performed before copy if an entry has single elements
- *              saved priori and newer than the table entry. If one or more
- *              elements were singular saved and the NV page doesn't has a
- *              full table entry saved, then the elements are copied as they
- *              are.
+ * Name: NvCopyPageStart
+ * Description: Initialise the page copy status. The destination (mirror) page
+ *              must be blank when this function is called.
  * Parameter(s): [IN] skipEntryId - the entry ID to be skipped when page
  *                                  copy is performed
- * Return: gNVM_InvalidPageID_c - if the source or destination page is not
- *                                valid
+ * Return: -
+ *****************************************************************************/
+static void NvCopyPageStart
+(
+    NvTableEntryId_t skipEntryId
+)
+{
+    NVM_VirtualPageID_t dstPageId;
+
+    dstPageId = (NVM_VirtualPageID_t)((mNvActivePageId+1)%2);
+
+    mNvCopyPgCmdStatus.NvDstPageId = dstPageId;
+    mNvCopyPgCmdStatus.NvSkipEntryId = skipEntryId;
+    /* initialise the destination page meta info start address */
+    mNvCopyPgCmdStatus.NvDstMetaAddress = mNvVirtualPageProperty[dstPageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c;
+    /* initialise the destination page record start address */
+    mNvCopyPgCmdStatus.NvDstRecordAddress = mNvVirtualPageProperty[dstPageId].NvRawSectorEndAddress - sizeof(NVM_TableInfo_t) + 1;
+    /* the source page is walked from the last meta info towards the first one */
+    mNvCopyPgCmdStatus.NvSrcMetaAddress = mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress;
+    #if gNvUseExtendedFeatureSet_d
+    mNvCopyPgCmdStatus.NvTableUpgraded = FALSE;
+    if (mNvTableUpdated)
+        mNvCopyPgCmdStatus.NvTableUpgraded = (GetFlashTableVersion() != mNvFlashTableVersion);
+    #endif
+    mNvCopyPgCmdStatus.NvCopyInProgress = TRUE;
+}
+
+/******************************************************************************
+ * Name: NvCopyPageStep
+ * Description: Continue the page copy started by NvCopyPageStart(). At most
+ *              metasCount meta information tags of the source page are
+ *              processed. When the source page is exhausted the active page
+ *              is switched, the RAM table is saved and the old page is
+ *              scheduled for erase.
+ * Parameter(s): [IN] metasCount - the maximum number of source meta
+ *                                 information tags to be processed, or
+ *                                 gNvCopyAll_c to run the copy to completion
+ * Return: gNVM_PageCopyPending_c - if the copy is not yet completed
  *         gNVM_MetaInfoWriteError_c - if the meta information couldn't be
  *                                     written
  *         gNVM_RecordWriteError_c - if the record couldn't be written
  *         gNVM_Error_c - in case of error(s)
  *         gNVM_OK_c - page copy completed successfully
  *****************************************************************************/
-static NVM_Status_t NvCopyPage
+static NVM_Status_t NvCopyPageStep
 (
-    NvTableEntryId_t skipEntryId
+    uint16_t metasCount
 )
 {
     /* source page related variables */
     uint32_t srcMetaAddress;
     NVM_RecordMetaInfo_t srcMetaInfo;
     uint16_t srcTableEntryIdx;
+    uint32_t srcFirstMetaAddress;
+    uint32_t srcFreeSpace;
 
     /* destination page related variables */
     uint32_t dstMetaAddress;
     uint32_t firstMetaAddress;
     NVM_VirtualPageID_t dstPageId;
     uint32_t dstRecordAddress;
+    uint32_t dstFreeSpace;
 
+    NvTableEntryId_t skipEntryId;
     #if gNvUseExtendedFeatureSet_d
     uint16_t idx;
     bool_t entryFound;
     NVM_DataEntry_t flashDataEntry;
-    bool_t tableUpgraded = FALSE;
+    bool_t tableUpgraded;
     #endif /* gNvUseExtendedFeatureSet_d */
     #if gNvFragmentation_Enabled_d
     uint32_t tblEntryMetaAddress = 0;
@@ -4033,34 +4985,29 @@ static NVM_Status_t NvCopyPage
     /* status variable */
     NVM_Status_t status;
 
-    dstPageId = (NVM_VirtualPageID_t)((mNvActivePageId+1)%2);
-
-    /* Check if the destination page is blank. If not, erase it. */
-    if(gNVM_PageIsNotBlank_c == NvVirtualPageBlankCheck(dstPageId))
-    {
-        status = NvEraseVirtualPage(dstPageId);
-        if(gNVM_OK_c != status)
-        {
-            return status;
-        }
-    }
-    /* initialise the destination page meta info start address */
-    dstMetaAddress = mNvVirtualPageProperty[dstPageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c;
+    /* restore the copy progress */
+    dstPageId = mNvCopyPgCmdStatus.NvDstPageId;
+    skipEntryId = mNvCopyPgCmdStatus.NvSkipEntryId;
+    srcMetaAddress = mNvCopyPgCmdStatus.NvSrcMetaAddress;
+    dstMetaAddress = mNvCopyPgCmdStatus.NvDstMetaAddress;
+    dstRecordAddress = mNvCopyPgCmdStatus.NvDstRecordAddress;
     #if gNvUseExtendedFeatureSet_d
-    if (mNvTableUpdated)
-        tableUpgraded = (GetFlashTableVersion() != mNvFlashTableVersion);
+    tableUpgraded = mNvCopyPgCmdStatus.NvTableUpgraded;
     #endif
 
-    firstMetaAddress = dstMetaAddress;
+    firstMetaAddress = mNvVirtualPageProperty[dstPageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c;
+    srcFirstMetaAddress = mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c;
+
     /*if src is an empty page, just copy the table and make the initialisations*/
-    srcMetaAddress = mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress;
     if (srcMetaAddress != gEmptyPageMetaAddress_c)
     {
-        /* initialise the destination page record start address */
-        dstRecordAddress = mNvVirtualPageProperty[dstPageId].NvRawSectorEndAddress - sizeof(NVM_TableInfo_t) + 1;
-
-        while(srcMetaAddress >= (mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
+        while((srcMetaAddress >= srcFirstMetaAddress) && (metasCount != 0))
         {
+            if(metasCount != gNvCopyAll_c)
+            {
+                metasCount--;
+            }
+
             /* get current meta information */
             (void)NvGetMetaInfo(mNvActivePageId, srcMetaAddress, &srcMetaInfo);
 
@@ -4193,7 +5140,7 @@ static NVM_Status_t NvCopyPage
                     bytesToCopy = pNVM_DataTable[srcTableEntryIdx].ElementSize;
                     dstRecordAddress -= NvUpdateSize(bytesToCopy);
 
-                    if((status = NvInternalCopy(dstRecordAddress, dstMetaAddress, &srcMetaInfo, srcTableEntryIdx, bytesToCopy)) != gNVM_OK_c)
+                    if((status = NvInternalCopy(mNvActivePageId, dstPageId, dstRecordAddress, dstMetaAddress, &srcMetaInfo, srcTableEntryIdx, bytesToCopy)) != gNVM_OK_c)
                     {
                         return status;
                     }
@@ -4249,7 +5196,7 @@ static NVM_Status_t NvCopyPage
             /*
             * full table entry
             */
-            if((status = NvInternalCopy(dstRecordAddress, dstMetaAddress, &srcMetaInfo, srcTableEntryIdx, bytesToCopy)) != gNVM_OK_c)
+            if((status = NvInternalCopy(mNvActivePageId, dstPageId, dstRecordAddress, dstMetaAddress, &srcMetaInfo, srcTableEntryIdx, bytesToCopy)) != gNVM_OK_c)
             {
                 return status;
             }
@@ -4260,48 +5207,965 @@ static NVM_Status_t NvCopyPage
             /* move to the next meta info */
             srcMetaAddress -= sizeof(NVM_RecordMetaInfo_t);
         };
+
+        #if gNvWriteCombining_c
+        /* the copied records must be in flash before the next step or the page swap */
+        if(kStatus_FLASH_Success != NV_FlashFlushWriteBuffer())
+        {
+            return gNVM_RecordWriteError_c;
+        }
+        #endif
+
+        if(srcMetaAddress >= srcFirstMetaAddress)
+        {
+            /* save the copy progress, there are more meta info tags to be processed */
+            mNvCopyPgCmdStatus.NvSrcMetaAddress = srcMetaAddress;
+            mNvCopyPgCmdStatus.NvDstMetaAddress = dstMetaAddress;
+            mNvCopyPgCmdStatus.NvDstRecordAddress = dstRecordAddress;
+            return gNVM_PageCopyPending_c;
+        }
+    }
+
+    mNvCopyPgCmdStatus.NvCopyInProgress = FALSE;
+
+    /* the free space of the source page, used for the reclaim statistics */
+    if(gNVM_OK_c != NvGetPageFreeSpace(&srcFreeSpace))
+    {
+        srcFreeSpace = 0;
+    }
+
+    /* make a request to erase the old page */
+    mNvErasePgCmdStatus.NvPageToErase = mNvActivePageId;
+    mNvErasePgCmdStatus.NvSectorAddress = mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress;
+    mNvErasePgCmdStatus.NvErasePending = TRUE;
+
+    /* update the the active page ID */
+    mNvActivePageId = dstPageId;
+
+    #if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+    /* the records were moved to the new active page */
+    NvUnmirroredCacheInvalidate(gNvInvalidDataEntry_c, gNvInvalidElementIndex_c);
+    #endif
+
+    /* update the last meta info address */
+    if(dstMetaAddress == firstMetaAddress)
+    {
+        mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+    }
+    else
+    {
+        mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress = dstMetaAddress - sizeof(NVM_RecordMetaInfo_t);
+    }
+
+    #if gUnmirroredFeatureSet_d
+    mNvVirtualPageProperty[mNvActivePageId].NvLastMetaUnerasedInfoAddress = mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress;
+    #endif
+
+    mNvPageCounter++;
+    /* save the current RAM table */
+    if(!NvSaveRamTable(dstPageId))
+    {
+        return gNVM_Error_c;
+    }
+
+    #if gNvUseExtendedFeatureSet_d
+    if(mNvTableUpdated)
+    {
+        /* update the size of the NV table stored in FLASH */
+        mNvTableSizeInFlash = NvGetFlashTableSize();
+
+        /* clear the flag */
+        mNvTableUpdated = FALSE;
+    }
+    #endif /* gNvUseExtendedFeatureSet_d */
+
+    mNvWearStatistics.PageCopiesCount++;
+    if(gNVM_OK_c == NvGetPageFreeSpace(&dstFreeSpace) && (dstFreeSpace > srcFreeSpace))
+    {
+        mNvWearStatistics.ReclaimedBytesCount += dstFreeSpace - srcFreeSpace;
+    }
+
+    #if gNvCompactionFillWatermark_c
+    /* a page that is still above the watermark after copy would be copied over and over */
+    mNvCompactionWatermarkArmed = !NvIsPageFillAboveWatermark();
+    #endif
+    return gNVM_OK_c;
+}
+#else
+/******************************************************************************
+ * Name: NvLogGetFreePagesCount
+ * Description: return the count of log pages that are neither the active
+ *              page nor hold older records
+ * Parameter(s): -
+ * Return: the count of free log pages
+ *****************************************************************************/
+static uint8_t NvLogGetFreePagesCount
+(
+    void
+)
+{
+    return (uint8_t)(gNvVirtualPagesCount_c - 1 -
+                     ((mNvActivePageId + gNvVirtualPagesCount_c - mNvLogTailPageId) % gNvVirtualPagesCount_c));
+}
+
+/******************************************************************************
+ * Name: NvLogAdvance
+ * Description: Make the next log page the active page. One free log page is
+ *              kept in reserve for the reclaim of the oldest log page.
+ * Parameter(s): [IN] useReserve - if TRUE, the reserved free log page may be
+ *                                 used
+ * Return: TRUE if the active page was changed, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvLogAdvance
+(
+    bool_t useReserve
+)
+{
+    NVM_VirtualPageID_t pageId;
+
+    /* an empty active page is not left behind, the record does not fit any log page */
+    if((gEmptyPageMetaAddress_c == mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress) ||
+       (NvLogGetFreePagesCount() < (useReserve ? 1 : 2)))
+    {
+        return FALSE;
+    }
+
+    pageId = (NVM_VirtualPageID_t)((mNvActivePageId + 1) % gNvVirtualPagesCount_c);
+
+    /* the page is erased now, drop any sector-by-sector erase of it */
+    if(mNvErasePgCmdStatus.NvErasePending && (mNvErasePgCmdStatus.NvPageToErase == pageId))
+    {
+        mNvErasePgCmdStatus.NvErasePending = FALSE;
+    }
+    if(gNVM_OK_c != NvEraseVirtualPage(pageId))
+    {
+        return FALSE;
+    }
+
+    /* the page counter makes the page the newest one of the log */
+    mNvPageCounter++;
+    if(!NvSaveRamTable(pageId))
+    {
+        mNvPageCounter--;
+        return FALSE;
+    }
+
+    mNvActivePageId = pageId;
+    mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+
+    if(NvLogGetFreePagesCount() < 2)
+    {
+        /* the next page change would need the reserve, reclaim the oldest log page in background */
+        mNvCopyOperationIsPending = TRUE;
+    }
+    #if gNvCompactionFillWatermark_c
+    mNvCompactionWatermarkArmed = TRUE;
+    #endif
+    return TRUE;
+}
+
+/******************************************************************************
+ * Name: NvLogGetRecordSpace
+ * Description: get the place of a record moved to the active page by the
+ *              reclaim; the next log page is taken if the active page is full
+ * Parameter(s): [IN] recordSize - the record size, multiple of PGM_SIZE_BYTE
+ *               [OUT] pMetaAddress - the meta information address
+ *               [OUT] pRecordAddress - the record address
+ * Return: TRUE if the space was found, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvLogGetRecordSpace
+(
+    uint32_t recordSize,
+    uint32_t* pMetaAddress,
+    uint32_t* pRecordAddress
+)
+{
+    NVM_RecordMetaInfo_t metaInfo;
+    uint32_t metaAddress;
+    uint32_t recordAddress;
+
+    do
+    {
+        metaAddress = mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress;
+        if(gEmptyPageMetaAddress_c == metaAddress)
+        {
+            metaAddress = mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c;
+            recordAddress = mNvVirtualPageProperty[mNvActivePageId].NvRawSectorEndAddress - sizeof(NVM_TableInfo_t) + 1;
+        }
+        else
+        {
+            (void)NvGetMetaInfo(mNvActivePageId, metaAddress, &metaInfo);
+            metaAddress += sizeof(NVM_RecordMetaInfo_t);
+            recordAddress = mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset;
+        }
+
+        /* skip the areas left unblank by a reset; one extra meta info space must be
+         * kept always free, to be able to perform the meta info search */
+        while(metaAddress + 2 * sizeof(NVM_RecordMetaInfo_t) + recordSize < recordAddress)
+        {
+            if(!NvIsMemoryAreaAvailable(recordAddress - recordSize, recordSize))
+            {
+                recordAddress -= recordSize;
+            }
+            else if(!NvIsMemoryAreaAvailable(metaAddress, sizeof(NVM_RecordMetaInfo_t)))
+            {
+                metaAddress += sizeof(NVM_RecordMetaInfo_t);
+            }
+            else
+            {
+                *pMetaAddress = metaAddress;
+                *pRecordAddress = recordAddress - recordSize;
+                return TRUE;
+            }
+        }
+    } while(NvLogAdvance(TRUE));
+
+    return FALSE;
+}
+
+/******************************************************************************
+ * Name: NvLogIsRecordSuperseded
+ * Description: Checks if a record of the oldest log page was saved again
+ *              later, as a single element or as an entire table entry
+ * Parameter(s): [IN] srcMetaAddress - the meta information address of the record
+ *               [IN] srcMetaInfo - the meta information of the record
+ * Return: TRUE if a newer record exists, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvLogIsRecordSuperseded
+(
+    uint32_t srcMetaAddress,
+    NVM_RecordMetaInfo_t* srcMetaInfo
+)
+{
+    NVM_VirtualPageID_t pageId = mNvActivePageId;
+    uint32_t metaAddress = mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress;
+    NVM_RecordMetaInfo_t metaInfo;
+
+    if((gEmptyPageMetaAddress_c == metaAddress) && !NvGetOlderPage(&pageId, &metaAddress))
+    {
+        return FALSE;
+    }
+
+    /* parse the meta info backwards, from the newest record to the checked one */
+    do
+    {
+        while(metaAddress >= (mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
+        {
+            if(metaAddress == srcMetaAddress)
+            {
+                return FALSE;
+            }
+
+            (void)NvGetMetaInfo(pageId, metaAddress, &metaInfo);
+
+            if((metaInfo.fields.NvValidationStartByte == metaInfo.fields.NvValidationEndByte) &&
+               (metaInfo.fields.NvmDataEntryID == srcMetaInfo->fields.NvmDataEntryID))
+            {
+                /* a newer entire table entry supersedes any record of the entry */
+                if(gValidationByteAllRecords_c == metaInfo.fields.NvValidationStartByte)
+                {
+                    return TRUE;
+                }
+
+                /* a newer single element record supersedes a single element record */
+                if((gValidationByteSingleRecord_c == metaInfo.fields.NvValidationStartByte) &&
+                   (gValidationByteSingleRecord_c == srcMetaInfo->fields.NvValidationStartByte) &&
+                   (metaInfo.fields.NvmElementIndex == srcMetaInfo->fields.NvmElementIndex))
+                {
+                    return TRUE;
+                }
+            }
+            metaAddress -= sizeof(NVM_RecordMetaInfo_t);
+        }
+    } while(NvGetOlderPage(&pageId, &metaAddress));
+
+    return FALSE;
+}
+
+#if gNvFragmentation_Enabled_d
+/******************************************************************************
+ * Name: NvLogMergedCopy
+ * Description: Copy an entire table entry record of the oldest log page to
+ *              the active page, merged with the newer single element records
+ * Parameter(s): [IN] srcMetaAddress - the meta information address of the record
+ *               [IN] srcMetaInfo - the meta information of the record
+ *               [IN] srcTblEntryIdx - the table entry index
+ *               [IN] dstMetaAddress - destination meta address
+ *               [IN] dstRecordAddress - destination record address
+ * Return: the status of the operation
+ *****************************************************************************/
+static NVM_Status_t NvLogMergedCopy
+(
+    uint32_t srcMetaAddress,
+    NVM_RecordMetaInfo_t* srcMetaInfo,
+    uint16_t srcTblEntryIdx,
+    uint32_t dstMetaAddress,
+    uint32_t dstRecordAddress
+)
+{
+    NVM_VirtualPageID_t pageId = mNvActivePageId;
+    uint32_t metaAddress = mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress;
+    NVM_RecordMetaInfo_t metaInfo;
+    NVM_RecordMetaInfo_t dstMetaInfo;
+    uint16_t elementSize = pNVM_DataTable[srcTblEntryIdx].ElementSize;
+    uint32_t size = elementSize * pNVM_DataTable[srcTblEntryIdx].ElementsCount;
+    uint32_t offset;
+    uint32_t srcAddress;
+    uint16_t elementIdx;
+    uint16_t elementOffset;
+    uint8_t copied;
+    uint8_t copyAmount;
+    uint8_t dstBuffer[PGM_SIZE_BYTE];
+
+    /* clear the records addresses buffer */
+    FLib_MemSet(maNvLogRecordsAddress, 0, sizeof(uint32_t)*pNVM_DataTable[srcTblEntryIdx].ElementsCount);
+
+    /* find the newest single element records, saved after the table entry record */
+    if((gEmptyPageMetaAddress_c != metaAddress) || NvGetOlderPage(&pageId, &metaAddress))
+    {
+        do
+        {
+            while((metaAddress >= (mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c)) &&
+                  (metaAddress != srcMetaAddress))
+            {
+                (void)NvGetMetaInfo(pageId, metaAddress, &metaInfo);
+
+                if((metaInfo.fields.NvValidationStartByte == metaInfo.fields.NvValidationEndByte) &&
+                   (gValidationByteSingleRecord_c == metaInfo.fields.NvValidationStartByte) &&
+                   (metaInfo.fields.NvmDataEntryID == srcMetaInfo->fields.NvmDataEntryID) &&
+                   (metaInfo.fields.NvmElementIndex < pNVM_DataTable[srcTblEntryIdx].ElementsCount) &&
+                   (0 == maNvLogRecordsAddress[metaInfo.fields.NvmElementIndex]))
+                {
+                    maNvLogRecordsAddress[metaInfo.fields.NvmElementIndex] =
+                        mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset;
+                }
+                metaAddress -= sizeof(NVM_RecordMetaInfo_t);
+            }
+        } while((metaAddress != srcMetaAddress) && NvGetOlderPage(&pageId, &metaAddress));
+    }
+
+    /* write the record, one program unit at a time */
+    for(offset = 0; offset < size; offset += PGM_SIZE_BYTE)
+    {
+        FLib_MemSet(dstBuffer, 0xFF, PGM_SIZE_BYTE);
+
+        for(copied = 0; (copied < PGM_SIZE_BYTE) && (offset + copied < size); copied += copyAmount)
+        {
+            elementIdx = (uint16_t)((offset + copied) / elementSize);
+            elementOffset = (uint16_t)((offset + copied) % elementSize);
+            copyAmount = PGM_SIZE_BYTE - copied;
+            if(copyAmount > elementSize - elementOffset)
+            {
+                copyAmount = (uint8_t)(elementSize - elementOffset);
+            }
+
+            /* copy from the table entry record if no newer single element record was found */
+            if(0 == maNvLogRecordsAddress[elementIdx])
+            {
+                srcAddress = mNvVirtualPageProperty[mNvLogTailPageId].NvRawSectorStartAddress + srcMetaInfo->fields.NvmRecordOffset + offset + copied;
+            }
+            else
+            {
+                srcAddress = maNvLogRecordsAddress[elementIdx] + elementOffset;
+            }
+            FLib_MemCpy(dstBuffer + copied, (void*)srcAddress, copyAmount);
+        }
+
+        if(kStatus_FLASH_Success != NV_FlashProgram(dstRecordAddress + offset, PGM_SIZE_BYTE, dstBuffer))
+        {
+            return gNVM_RecordWriteError_c;
+        }
+    }
+
+    /* write the associated record meta information */
+    dstMetaInfo.fields = srcMetaInfo->fields;
+    dstMetaInfo.fields.NvmRecordOffset = dstRecordAddress - mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress;
+    if(kStatus_FLASH_Success != NV_FlashProgram(dstMetaAddress, sizeof(NVM_RecordMetaInfo_t), (uint8_t*)(&dstMetaInfo)))
+    {
+        return gNVM_MetaInfoWriteError_c;
+    }
+    return gNVM_OK_c;
+}
+#endif /* gNvFragmentation_Enabled_d */
+
+/******************************************************************************
+ * Name: NvLogReclaimStart
+ * Description: Initialise the reclaim of the oldest log page
+ * Parameter(s): -
+ * Return: -
+ *****************************************************************************/
+static void NvLogReclaimStart
+(
+    void
+)
+{
+    /* the oldest log page is walked from the first meta info towards the last one */
+    mNvCopyPgCmdStatus.NvSrcMetaAddress = mNvVirtualPageProperty[mNvLogTailPageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c;
+    mNvCopyPgCmdStatus.NvMovedBytesCount = 0;
+    mNvCopyPgCmdStatus.NvCopyInProgress = TRUE;
+}
+
+/******************************************************************************
+ * Name: NvLogReclaimStep
+ * Description: Continue the reclaim started by NvLogReclaimStart(). At most
+ *              metasCount meta information tags of the oldest log page are
+ *              processed. The records that were not saved again later are
+ *              moved to the active page; when the oldest log page is
+ *              exhausted, it is scheduled for erase and the next log page
+ *              becomes the oldest one.
+ * Parameter(s): [IN] metasCount - the maximum number of meta information tags
+ *                                 to be processed, or gNvCopyAll_c to run the
+ *                                 reclaim to completion
+ * Return: gNVM_PageCopyPending_c - if the reclaim is not yet completed
+ *         gNVM_MetaInfoWriteError_c - if the meta information couldn't be
+ *                                     written
+ *         gNVM_RecordWriteError_c - if the record couldn't be written
+ *         gNVM_Error_c - if the records do not fit the log pages
+ *         gNVM_OK_c - reclaim completed successfully
+ *****************************************************************************/
+static NVM_Status_t NvLogReclaimStep
+(
+    uint16_t metasCount
+)
+{
+    uint32_t srcMetaAddress;
+    uint32_t srcLastMetaAddress;
+    NVM_RecordMetaInfo_t srcMetaInfo;
+    uint16_t srcTableEntryIdx;
+    uint32_t srcUsedSpace;
+    uint32_t dstMetaAddress;
+    uint32_t dstRecordAddress;
+    uint32_t recordSize;
+    NVM_Status_t status;
+
+    srcMetaAddress = mNvCopyPgCmdStatus.NvSrcMetaAddress;
+    srcLastMetaAddress = mNvVirtualPageProperty[mNvLogTailPageId].NvLastMetaInfoAddress;
+
+    /* an empty page has no record to move */
+    if(srcLastMetaAddress != gEmptyPageMetaAddress_c)
+    {
+        while((srcMetaAddress <= srcLastMetaAddress) && (metasCount != 0))
+        {
+            if(metasCount != gNvCopyAll_c)
+            {
+                metasCount--;
+            }
+
+            /* get current meta information */
+            (void)NvGetMetaInfo(mNvLogTailPageId, srcMetaAddress, &srcMetaInfo);
+
+            /* get table entry index */
+            srcTableEntryIdx = NvGetTableEntryIndexFromId(srcMetaInfo.fields.NvmDataEntryID);
+
+            if((srcMetaInfo.fields.NvValidationStartByte != srcMetaInfo.fields.NvValidationEndByte) ||
+               ((srcMetaInfo.fields.NvValidationStartByte != gValidationByteSingleRecord_c) &&
+                (srcMetaInfo.fields.NvValidationStartByte != gValidationByteAllRecords_c)) ||
+               (srcTableEntryIdx == gNvInvalidTableEntryIndex_c) ||
+               ((srcMetaInfo.fields.NvValidationStartByte == gValidationByteSingleRecord_c) &&
+                (srcMetaInfo.fields.NvmElementIndex >= pNVM_DataTable[srcTableEntryIdx].ElementsCount)) ||
+               NvLogIsRecordSuperseded(srcMetaAddress, &srcMetaInfo))
+            {
+                /* go to the next meta information tag */
+                srcMetaAddress += sizeof(NVM_RecordMetaInfo_t);
+                continue;
+            }
+
+            if(srcMetaInfo.fields.NvValidationStartByte == gValidationByteSingleRecord_c)
+            {
+                recordSize = pNVM_DataTable[srcTableEntryIdx].ElementSize;
+            }
+            else
+            {
+                recordSize = pNVM_DataTable[srcTableEntryIdx].ElementsCount * pNVM_DataTable[srcTableEntryIdx].ElementSize;
+            }
+
+            if(!NvLogGetRecordSpace(NvUpdateSize(recordSize), &dstMetaAddress, &dstRecordAddress))
+            {
+                return gNVM_Error_c;
+            }
+
+            #if gNvFragmentation_Enabled_d
+            /*
+            * full table entry, merged with the newer single element records
+            */
+            if(srcMetaInfo.fields.NvValidationStartByte == gValidationByteAllRecords_c)
+            {
+                status = NvLogMergedCopy(srcMetaAddress, &srcMetaInfo, srcTableEntryIdx, dstMetaAddress, dstRecordAddress);
+            }
+            else
+            #endif /* gNvFragmentation_Enabled_d */
+            {
+                status = NvInternalCopy(mNvLogTailPageId, mNvActivePageId, dstRecordAddress, dstMetaAddress, &srcMetaInfo, srcTableEntryIdx, (uint16_t)recordSize);
+            }
+            if(gNVM_OK_c != status)
+            {
+                return status;
+            }
+
+            /* the moved record is the newest one of the active page */
+            mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress = dstMetaAddress;
+            mNvCopyPgCmdStatus.NvMovedBytesCount += NvUpdateSize(recordSize) + sizeof(NVM_RecordMetaInfo_t);
+
+            /* move to the next meta info */
+            srcMetaAddress += sizeof(NVM_RecordMetaInfo_t);
+        }
+
+        #if gNvWriteCombining_c
+        /* the moved records must be in flash before the next step or the page erase */
+        if(kStatus_FLASH_Success != NV_FlashFlushWriteBuffer())
+        {
+            return gNVM_RecordWriteError_c;
+        }
+        #endif
+
+        if(srcMetaAddress <= srcLastMetaAddress)
+        {
+            /* save the reclaim progress, there are more meta info tags to be processed */
+            mNvCopyPgCmdStatus.NvSrcMetaAddress = srcMetaAddress;
+            return gNVM_PageCopyPending_c;
+        }
+    }
+
+    mNvCopyPgCmdStatus.NvCopyInProgress = FALSE;
+
+    /* the space used by the oldest page, used for the reclaim statistics */
+    srcUsedSpace = 0;
+    if(srcLastMetaAddress != gEmptyPageMetaAddress_c)
+    {
+        (void)NvGetMetaInfo(mNvLogTailPageId, srcLastMetaAddress, &srcMetaInfo);
+        srcUsedSpace = (srcLastMetaAddress + sizeof(NVM_RecordMetaInfo_t)) -
+                       (mNvVirtualPageProperty[mNvLogTailPageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c) +
+                       (mNvVirtualPageProperty[mNvLogTailPageId].NvTotalPageSize - sizeof(NVM_TableInfo_t) - srcMetaInfo.fields.NvmRecordOffset);
+    }
+
+    /* make a request to erase the oldest page */
+    mNvErasePgCmdStatus.NvPageToErase = mNvLogTailPageId;
+    mNvErasePgCmdStatus.NvSectorAddress = mNvVirtualPageProperty[mNvLogTailPageId].NvRawSectorStartAddress;
+    mNvErasePgCmdStatus.NvErasePending = TRUE;
+
+    /* the next page becomes the oldest one */
+    mNvLogTailPageId = (NVM_VirtualPageID_t)((mNvLogTailPageId + 1) % gNvVirtualPagesCount_c);
+
+    mNvWearStatistics.PageCopiesCount++;
+    if(srcUsedSpace > mNvCopyPgCmdStatus.NvMovedBytesCount)
+    {
+        mNvWearStatistics.ReclaimedBytesCount += srcUsedSpace - mNvCopyPgCmdStatus.NvMovedBytesCount;
+    }
+
+    #if gNvCompactionFillWatermark_c
+    mNvCompactionWatermarkArmed = !NvIsPageFillAboveWatermark();
+    #endif
+    return gNVM_OK_c;
+}
+#endif /* !gNvCircularLog_d */
+
+/******************************************************************************
+ * Name: NvCopyPage
+ * Description: Copy the active page content to the mirror page. Only the
+ *              latest table entries / elements are copied. A merge operation
+ *              is performed before copy if an entry has single elements
+ *              saved priori and newer than the table entry. If one or more
+ *              elements were singular saved and the NV page doesn't has a
+ *              full table entry saved, then the elements are copied as they
+ *              are. A copy already started in background by the idle task
+ *              is completed synchronously.
+ * Parameter(s): [IN] skipEntryId - the entry ID to be skipped when page
+ *                                  copy is performed
+ * Return: gNVM_InvalidPageID_c - if the source or destination page is not
+ *                                valid
+ *         gNVM_MetaInfoWriteError_c - if the meta information couldn't be
+ *                                     written
+ *         gNVM_RecordWriteError_c - if the record couldn't be written
+ *         gNVM_Error_c - in case of error(s)
+ *         gNVM_OK_c - page copy completed successfully
+ *****************************************************************************/
+static NVM_Status_t NvCopyPage
+(
+    NvTableEntryId_t skipEntryId
+)
+{
+#if gNvCircularLog_d
+    NVM_Status_t status = gNVM_OK_c;
+    uint8_t reclaimCount;
+
+    /* no table entry is erased from storage without gNvUseExtendedFeatureSet_d */
+    (void)skipEntryId;
+
+    if(mNvCopyPgCmdStatus.NvCopyInProgress)
+    {
+        /* complete the reclaim started in background */
+        status = NvLogReclaimStep(gNvCopyAll_c);
+    }
+
+    /* reclaim the oldest log pages until a save can move on to the next log page */
+    for(reclaimCount = 0; (gNVM_OK_c == status) && (reclaimCount < gNvVirtualPagesCount_c) &&
+        (NvLogGetFreePagesCount() < 2); reclaimCount++)
+    {
+        if(mNvErasePgCmdStatus.NvErasePending)
+        {
+            /* the reclaim requests the erase of the oldest log page, only one erase can be pending */
+            status = NvEraseVirtualPage(mNvErasePgCmdStatus.NvPageToErase);
+            if(gNVM_OK_c != status)
+            {
+                break;
+            }
+            mNvVirtualPageProperty[mNvErasePgCmdStatus.NvPageToErase].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+            mNvErasePgCmdStatus.NvErasePending = FALSE;
+        }
+
+        if(mNvLogTailPageId == mNvActivePageId)
+        {
+            /* there is no older log page to reclaim */
+            break;
+        }
+
+        NvLogReclaimStart();
+        status = NvLogReclaimStep(gNvCopyAll_c);
+    }
+#else
+    NVM_VirtualPageID_t dstPageId;
+    NVM_Status_t status;
+
+    if(mNvCopyPgCmdStatus.NvCopyInProgress && (mNvCopyPgCmdStatus.NvSkipEntryId != skipEntryId))
+    {
+        /* complete the background copy first; the requested copy is performed on top of it */
+        status = NvCopyPageStep(gNvCopyAll_c);
+        mNvCopyPgCmdStatus.NvCopyInProgress = FALSE;
+        if(gNVM_OK_c != status)
+        {
+            return status;
+        }
+    }
+
+    if(!mNvCopyPgCmdStatus.NvCopyInProgress)
+    {
+        dstPageId = (NVM_VirtualPageID_t)((mNvActivePageId+1)%2);
+
+        /* Check if the destination page is blank. If not, erase it. */
+        if(gNVM_PageIsNotBlank_c == NvVirtualPageBlankCheck(dstPageId))
+        {
+            status = NvEraseVirtualPage(dstPageId);
+            if(gNVM_OK_c != status)
+            {
+                return status;
+            }
+        }
+
+        /* the destination page is blank, drop any sector-by-sector erase of it */
+        if(mNvErasePgCmdStatus.NvErasePending && (mNvErasePgCmdStatus.NvPageToErase == dstPageId))
+        {
+            mNvVirtualPageProperty[dstPageId].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+            mNvErasePgCmdStatus.NvErasePending = FALSE;
+        }
+
+        NvCopyPageStart(skipEntryId);
+    }
+
+    status = NvCopyPageStep(gNvCopyAll_c);
+#endif /* gNvCircularLog_d */
+    if(gNVM_OK_c != status)
+    {
+        mNvCopyPgCmdStatus.NvCopyInProgress = FALSE;
+    }
+    else
+    {
+        /* the requested or postponed compaction is done */
+        mNvCopyOperationIsPending = FALSE;
+    }
+    return status;
+}
+
+/******************************************************************************
+ * Name: NvEraseNextSector
+ * Description: Erase the next sector of the virtual page that has a pending
+ *              erase request.
+ * Parameter(s): -
+ * Return: TRUE if the virtual page is entirely erased, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvEraseNextSector
+(
+    void
+)
+{
+    if(mNvErasePgCmdStatus.NvSectorAddress >= mNvVirtualPageProperty[mNvErasePgCmdStatus.NvPageToErase].NvRawSectorEndAddress)
+    {
+        /* all sectors of the page had been erased */
+        mNvVirtualPageProperty[mNvErasePgCmdStatus.NvPageToErase].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+        mNvErasePgCmdStatus.NvErasePending = FALSE;
+        #if (gFsciIncluded_c && gNvmEnableFSCIMonitoring_c)
+        FSCI_MsgNVPageEraseMonitoring(mNvVirtualPageProperty[mNvErasePgCmdStatus.NvPageToErase].NvRawSectorStartAddress, gNVM_OK_c);
+        #endif
+        return TRUE;
+    }
+
+    /* erase and blank check */
+    if(gNVM_OK_c == NvEraseStorageSector(mNvErasePgCmdStatus.NvSectorAddress))
+    {
+        mNvErasePgCmdStatus.NvSectorAddress += (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE);
+    }
+    return FALSE;
+}
+
+/******************************************************************************
+ * Name: NvEraseStorageSector
+ * Description: Erase one NV storage sector, unless it is already blank, and
+ *              update the wear statistics. The page copy writes the meta
+ *              information from the page start and the records from the page
+ *              end, so the sectors in between are often left blank.
+ * Parameter(s): [IN] sectorAddress - the start address of the sector
+ * Return: gNVM_OK_c - if the sector is blank
+ *         gNVM_SectorEraseFail_c - if the sector cannot be erased
+ *****************************************************************************/
+static NVM_Status_t NvEraseStorageSector
+(
+    uint32_t sectorAddress
+)
+{
+    uint32_t sectorIdx;
+
+    if(kStatus_FLASH_Success == NV_FlashVerifyErase(sectorAddress, (uint32_t)NV_STORAGE_SECTOR_SIZE, kFLASH_MarginValueNormal))
+    {
+        mNvWearStatistics.BlankSectorsSkippedCount++;
+        return gNVM_OK_c;
+    }
+
+    (void)NV_FlashEraseSector(sectorAddress, (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE));
+
+    mNvWearStatistics.SectorErasesCount++;
+    sectorIdx = (sectorAddress - mNvVirtualPageProperty[gFirstVirtualPage_c].NvRawSectorStartAddress) /
+                (uint32_t)((uint8_t*)NV_STORAGE_SECTOR_SIZE);
+    if(sectorIdx < gNvWearStatisticsSectorsCount_c)
+    {
+        mNvWearStatistics.SectorEraseCyclesCount[sectorIdx]++;
+    }
+
+    if(kStatus_FLASH_Success != NV_FlashVerifyErase(sectorAddress, (uint32_t)NV_STORAGE_SECTOR_SIZE, kFLASH_MarginValueNormal))
+    {
+        return gNVM_SectorEraseFail_c;
+    }
+    return gNVM_OK_c;
+}
+
+#if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+/******************************************************************************
+ * Name: NvUnmirroredCacheLookup
+ * Description: Get the cached location of an unmirrored element record
+ * Parameter(s): [IN] entryId - the table entry ID
+ *               [IN] elementIndex - the element index
+ *               [OUT] pRecordOffset - the record offset in the active page,
+ *                                     0 if the element was erased
+ * Return: TRUE if the location is cached, FALSE otherwise
+ *****************************************************************************/
+static bool_t NvUnmirroredCacheLookup
+(
+    NvTableEntryId_t entryId,
+    uint16_t elementIndex,
+    uint16_t* pRecordOffset
+)
+{
+    uint8_t idx;
+
+    for(idx = 0; idx < (uint8_t)gNvUnmirroredCacheEntries_c; idx++)
+    {
+        if((maNvUnmirroredCache[idx].entryId == entryId) &&
+           (maNvUnmirroredCache[idx].elementIndex == elementIndex))
+        {
+            maNvUnmirroredCache[idx].lastUse = ++mNvUnmirroredCacheUseCounter;
+            *pRecordOffset = maNvUnmirroredCache[idx].recordOffset;
+            mNvWearStatistics.UnmirroredCacheHitsCount++;
+            return TRUE;
+        }
+    }
+    mNvWearStatistics.UnmirroredCacheMissesCount++;
+    return FALSE;
+}
+
+/******************************************************************************
+ * Name: NvUnmirroredCacheUpdate
+ * Description: Store the location of an unmirrored element record, replacing
+ *              the least recently used cache entry if needed
+ * Parameter(s): [IN] entryId - the table entry ID
+ *               [IN] elementIndex - the element index
+ *               [IN] recordOffset - the record offset in the active page
+ * Return: -
+ *****************************************************************************/
+static void NvUnmirroredCacheUpdate
+(
+    NvTableEntryId_t entryId,
+    uint16_t elementIndex,
+    uint16_t recordOffset
+)
+{
+    uint8_t idx;
+    uint8_t lruIdx = 0;
+
+    for(idx = 0; idx < (uint8_t)gNvUnmirroredCacheEntries_c; idx++)
+    {
+        if(gNvInvalidDataEntry_c == maNvUnmirroredCache[idx].entryId)
+        {
+            /* free entry */
+            lruIdx = idx;
+            break;
+        }
+        if((int32_t)(maNvUnmirroredCache[idx].lastUse - maNvUnmirroredCache[lruIdx].lastUse) < 0)
+        {
+            lruIdx = idx;
+        }
+    }
+
+    maNvUnmirroredCache[lruIdx].entryId = entryId;
+    maNvUnmirroredCache[lruIdx].elementIndex = elementIndex;
+    maNvUnmirroredCache[lruIdx].recordOffset = recordOffset;
+    maNvUnmirroredCache[lruIdx].lastUse = ++mNvUnmirroredCacheUseCounter;
+}
+
+/******************************************************************************
+ * Name: NvUnmirroredCacheInvalidate
+ * Description: Drop cached unmirrored element locations
+ * Parameter(s): [IN] entryId - the table entry ID, or gNvInvalidDataEntry_c
+ *                              to drop all the cached locations
+ *               [IN] elementIndex - the element index, or
+ *                                   gNvInvalidElementIndex_c for all the
+ *                                   elements of the table entry
+ * Return: -
+ *****************************************************************************/
+static void NvUnmirroredCacheInvalidate
+(
+    NvTableEntryId_t entryId,
+    uint16_t elementIndex
+)
+{
+    uint8_t idx;
+
+    for(idx = 0; idx < (uint8_t)gNvUnmirroredCacheEntries_c; idx++)
+    {
+        if((gNvInvalidDataEntry_c == entryId) ||
+           ((maNvUnmirroredCache[idx].entryId == entryId) &&
+            ((gNvInvalidElementIndex_c == elementIndex) || (maNvUnmirroredCache[idx].elementIndex == elementIndex))))
+        {
+            maNvUnmirroredCache[idx].entryId = gNvInvalidDataEntry_c;
+        }
     }
-    /* make a request to erase the old page */
-    mNvErasePgCmdStatus.NvPageToErase = mNvActivePageId;
-    mNvErasePgCmdStatus.NvSectorAddress = mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress;
-    mNvErasePgCmdStatus.NvErasePending = TRUE;
+}
+#endif /* gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c */
 
-    /* update the the active page ID */
-    mNvActivePageId = dstPageId;
+/******************************************************************************
+ * Name: NvCompactionStep
+ * Description: Perform a bounded unit of the pending page copy / page erase
+ *              work: either one sector erase or the processing of
+ *              gNvCompactionMetasPerStep_c source meta information tags.
+ * Parameter(s): -
+ * Return: gNVM_PageCopyPending_c - if more steps are required
+ *         gNVM_OK_c - if there is no more copy / erase work pending
+ *         other values - if the page copy failed
+ *****************************************************************************/
+static NVM_Status_t NvCompactionStep
+(
+    void
+)
+{
+#if !gNvCircularLog_d
+    NVM_VirtualPageID_t dstPageId;
+#endif
+    NVM_Status_t status;
 
-    /* update the last meta info address */
-    if(dstMetaAddress == firstMetaAddress)
+    if(mNvErasePgCmdStatus.NvErasePending)
     {
-        mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+        if(!NvEraseNextSector())
+        {
+            return gNVM_PageCopyPending_c;
+        }
     }
-    else
+
+    if(!mNvCopyOperationIsPending)
     {
-        mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress = dstMetaAddress - sizeof(NVM_RecordMetaInfo_t);
+        return gNVM_OK_c;
     }
 
-    #if gUnmirroredFeatureSet_d
-    mNvVirtualPageProperty[mNvActivePageId].NvLastMetaUnerasedInfoAddress = mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress;
-    #endif
+    if(!mNvCopyPgCmdStatus.NvCopyInProgress)
+    {
+#if gNvCircularLog_d
+        if(mNvLogTailPageId == mNvActivePageId)
+        {
+            /* there is no older log page to reclaim */
+            mNvCopyOperationIsPending = FALSE;
+            return gNVM_OK_c;
+        }
 
-    mNvPageCounter++;
-    /* save the current RAM table */
-    if(!NvSaveRamTable(dstPageId))
+        NvLogReclaimStart();
+#else
+        dstPageId = (NVM_VirtualPageID_t)((mNvActivePageId+1)%2);
+
+        /* the destination page is erased sector by sector before the copy starts */
+        if(gNVM_PageIsNotBlank_c == NvVirtualPageBlankCheck(dstPageId))
+        {
+            mNvErasePgCmdStatus.NvPageToErase = dstPageId;
+            mNvErasePgCmdStatus.NvSectorAddress = mNvVirtualPageProperty[dstPageId].NvRawSectorStartAddress;
+            mNvErasePgCmdStatus.NvErasePending = TRUE;
+            return gNVM_PageCopyPending_c;
+        }
+
+        NvCopyPageStart(gNvCopyAll_c);
+#endif /* gNvCircularLog_d */
+        #if (gFsciIncluded_c && gNvmEnableFSCIMonitoring_c)
+        FSCI_MsgNVVirtualPageMonitoring(TRUE,gNVM_OK_c);
+        #endif
+    }
+
+#if gNvCircularLog_d
+    status = NvLogReclaimStep(gNvCompactionMetasPerStep_c);
+#else
+    status = NvCopyPageStep(gNvCompactionMetasPerStep_c);
+#endif
+    if(gNVM_PageCopyPending_c != status)
     {
-        return gNVM_Error_c;
+        #if (gFsciIncluded_c && gNvmEnableFSCIMonitoring_c)
+        FSCI_MsgNVVirtualPageMonitoring(FALSE,status);
+        #endif
+        if(gNVM_OK_c == status)
+        {
+            mNvCopyOperationIsPending = FALSE;
+        }
+        else
+        {
+            mNvCopyPgCmdStatus.NvCopyInProgress = FALSE;
+        }
     }
+    return status;
+}
 
-    #if gNvUseExtendedFeatureSet_d
-    if(mNvTableUpdated)
+#if gNvCompactionFillWatermark_c
+/******************************************************************************
+ * Name: NvIsPageFillAboveWatermark
+ * Description: Check the active page fill level against
+ *              gNvCompactionFillWatermark_c
+ * Parameter(s): -
+ * Return: TRUE if the active page fill level is above the watermark,
+ *         FALSE otherwise
+ *****************************************************************************/
+static bool_t NvIsPageFillAboveWatermark
+(
+    void
+)
+{
+    uint32_t freeSpace;
+
+    #if gNvCircularLog_d
+    /* the active log page filling up matters only when the next save cannot move on */
+    if(NvLogGetFreePagesCount() >= 2)
     {
-        /* update the size of the NV table stored in FLASH */
-        mNvTableSizeInFlash = NvGetFlashTableSize();
+        return FALSE;
+    }
+    #endif
 
-        /* clear the flag */
-        mNvTableUpdated = FALSE;
+    if(gNVM_OK_c != NvGetPageFreeSpace(&freeSpace))
+    {
+        return FALSE;
     }
-    #endif /* gNvUseExtendedFeatureSet_d */
-    return gNVM_OK_c;
+    return (bool_t)((uint64_t)freeSpace * 100 <
+                    (uint64_t)(100 - gNvCompactionFillWatermark_c) * mNvVirtualPageProperty[mNvActivePageId].NvTotalPageSize);
 }
+#endif /* gNvCompactionFillWatermark_c */
 
 /******************************************************************************
  * Name: NvInternalFormat
@@ -4321,6 +6185,9 @@ static NVM_Status_t NvInternalFormat
 )
 {
     uint8_t retryCount = gNvFormatRetryCount_c;
+    #if gNvCircularLog_d
+    uint8_t pageIdx;
+    #endif
 
     /* increment the page counter value */
     if(pageCounterValue == (uint32_t)gPageCounterMaxValue_c - 1)
@@ -4335,14 +6202,38 @@ static NVM_Status_t NvInternalFormat
 
     while(retryCount--)
     {
+        #if gNvCircularLog_d
+        /* erase all the log pages */
+        for(pageIdx = 0; pageIdx < gNvVirtualPagesCount_c; pageIdx++)
+        {
+            if(gNVM_OK_c != NvEraseVirtualPage((NVM_VirtualPageID_t)pageIdx))
+            {
+                break;
+            }
+            mNvVirtualPageProperty[pageIdx].NvLastMetaInfoAddress = gEmptyPageMetaAddress_c;
+        }
+        if(pageIdx == gNvVirtualPagesCount_c)
+            break;
+        #else
         /* erase first page */
         if (gNVM_OK_c == NvEraseVirtualPage(gFirstVirtualPage_c) &&
             gNVM_OK_c == NvEraseVirtualPage(gSecondVirtualPage_c))
             break;
+        #endif
     }
 
+    /* both pages are blank, any copy / erase in progress is obsolete */
+    mNvCopyPgCmdStatus.NvCopyInProgress = FALSE;
+    mNvErasePgCmdStatus.NvErasePending = FALSE;
+    #if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+    NvUnmirroredCacheInvalidate(gNvInvalidDataEntry_c, gNvInvalidElementIndex_c);
+    #endif
+
     /* active page after format = first virtual page */
     mNvActivePageId = gFirstVirtualPage_c;
+    #if gNvCircularLog_d
+    mNvLogTailPageId = gFirstVirtualPage_c;
+    #endif
 
     /* save NV table from RAM memory to FLASH memory */
     if (FALSE == NvSaveRamTable(mNvActivePageId))
@@ -4356,7 +6247,7 @@ static NVM_Status_t NvInternalFormat
     /* update the page counter value */
     mNvPageCounter = pageCounterValue;
 
-    return NvUpdateLastMetaInfoAddress();
+    return NvUpdateLastMetaInfoAddress(mNvActivePageId);
 }
 
 /******************************************************************************
@@ -4608,6 +6499,13 @@ static NVM_Status_t UpgradeLegacyTable()
         return gNVM_Error_c;
     }
 
+    #if gNvWriteCombining_c
+    if(kStatus_FLASH_Success != NV_FlashFlushWriteBuffer())
+    {
+        return gNVM_RecordWriteError_c;
+    }
+    #endif
+
     /* erase old page */
     mNvErasePgCmdStatus.NvPageToErase = mNvActivePageId;
     mNvErasePgCmdStatus.NvSectorAddress = mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress;
@@ -4713,6 +6611,11 @@ static NVM_Status_t NvWriteRecord
         return gNVM_InvalidTableEntry_c;
     }
 
+#if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+    /* the element gets a new record (or is erased) */
+    NvUnmirroredCacheInvalidate(tblIndexes->entryId, tblIndexes->saveRestoreAll ? gNvInvalidElementIndex_c : tblIndexes->elementIndex);
+#endif
+
 #if (gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE != 0) /* FlexNVM */
 
     recordSize = pNVM_DataTable[tableEntryIdx].ElementsCount * pNVM_DataTable[tableEntryIdx].ElementSize;
@@ -4782,8 +6685,14 @@ static NVM_Status_t NvWriteRecord
     return gNVM_OK_c;
 
 #else /* No FlexNVM */
-    /* make sure i don't process the save if page copy is active */
-    if (mNvCopyOperationIsPending)
+    /* make sure i don't process the save if page copy is active; a pending
+     * compaction which has not started yet leaves the free space available */
+    #if gNvCircularLog_d
+    /* the reclaim of the oldest log page only blocks the saves once it took the last free log page */
+    if (mNvCopyPgCmdStatus.NvCopyInProgress && (0 == NvLogGetFreePagesCount()))
+    #else
+    if (mNvCopyPgCmdStatus.NvCopyInProgress)
+    #endif
     {
         return gNVM_PageCopyPending_c;
     }
@@ -4838,6 +6747,13 @@ static NVM_Status_t NvWriteRecord
         /* there is no space to save the record, try to copy the current active page latest records
         * to the other page
         */
+        #if gNvCircularLog_d
+        /* move on to the next log page; the new active page is empty, so this is done once */
+        if(NvLogAdvance(FALSE))
+        {
+            return NvWriteRecord(tblIndexes);
+        }
+        #endif
         mNvCopyOperationIsPending = TRUE;
         return gNVM_PageCopyPending_c;
     }
@@ -4966,6 +6882,13 @@ static NVM_Status_t NvWriteRecord
             /* there is no space to save the record, try to copy the current active page latest records
             * to the other page
             */
+            #if gNvCircularLog_d
+            /* move on to the next log page; the new active page is empty, so this is done once */
+            if(NvLogAdvance(FALSE))
+            {
+                return NvWriteRecord(tblIndexes);
+            }
+            #endif
             mNvCopyOperationIsPending = TRUE;
             return gNVM_PageCopyPending_c;
         }
@@ -5057,10 +6980,14 @@ static NVM_Status_t NvRestoreData
 #if (gNvUseFlexNVM_d == FALSE) || ((gNvUseFlexNVM_d == TRUE) && (DEBLOCK_SIZE == 0)) /* no FlexNVM */
     NVM_RecordMetaInfo_t metaInfo;
     uint32_t metaInfoAddress;
+    NVM_VirtualPageID_t pageId;
     NVM_Status_t status;
     #if gNvFragmentation_Enabled_d
     uint16_t cnt;
     #endif
+    #if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+    uint16_t cachedRecordOffset;
+    #endif
 #else
     NVM_FlexMetaInfo_t flexMetaInfo;
     uint32_t EERamAddress;
@@ -5125,7 +7052,9 @@ static NVM_Status_t NvRestoreData
 
 #else /* FlexNVM */
     /* get the last meta information address */
-    if((metaInfoAddress = mNvVirtualPageProperty[mNvActivePageId].NvLastMetaInfoAddress) == gEmptyPageMetaAddress_c)
+    pageId = mNvActivePageId;
+    if(((metaInfoAddress = mNvVirtualPageProperty[pageId].NvLastMetaInfoAddress) == gEmptyPageMetaAddress_c) &&
+       !NvGetOlderPage(&pageId, &metaInfoAddress))
     {
         /* blank page, no data to restore */
         return gNVM_PageIsEmpty_c;
@@ -5150,146 +7079,175 @@ static NVM_Status_t NvRestoreData
         /* clear the buffer */
         FLib_MemSet(maNvRecordsCpyOffsets, 0, sizeof(uint16_t)*pNVM_DataTable[tableEntryIdx].ElementsCount);
 
-        /* parse meta info backwards */
-        while(metaInfoAddress >= (mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
+        /* parse meta info backwards, from the newest page to the oldest one */
+        do
         {
-            /* get the meta information */
-            NvGetMetaInfo(mNvActivePageId, metaInfoAddress, &metaInfo);
-
-            if(metaInfo.fields.NvValidationStartByte != metaInfo.fields.NvValidationEndByte)
+            while(metaInfoAddress >= (mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
             {
-                /* invalid meta info, move to the previous meta info */
-                metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
-                continue;
-            }
+                /* get the meta information */
+                NvGetMetaInfo(pageId, metaInfoAddress, &metaInfo);
 
-            if(metaInfo.fields.NvmDataEntryID == tblIdx->entryId)
-            {
-                /* single save found */
-                if ((metaInfo.fields.NvValidationStartByte == gValidationByteSingleRecord_c) &&
-                    (0 == maNvRecordsCpyOffsets[metaInfo.fields.NvmElementIndex]))
+                if(metaInfo.fields.NvValidationStartByte != metaInfo.fields.NvValidationEndByte)
                 {
-                    maNvRecordsCpyOffsets[metaInfo.fields.NvmElementIndex] = 1;
-                    NV_FlashRead(mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset,
-                                 (uint8_t*)pNVM_DataTable[tableEntryIdx].pData + metaInfo.fields.NvmElementIndex * pNVM_DataTable[tableEntryIdx].ElementSize,
-                                 pNVM_DataTable[tableEntryIdx].ElementSize);
-                    status = gNVM_OK_c;
+                    /* invalid meta info, move to the previous meta info */
+                    metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
+                    continue;
                 }
-                /* full save found */
-                else if (metaInfo.fields.NvValidationStartByte == gValidationByteAllRecords_c)
+
+                if(metaInfo.fields.NvmDataEntryID == tblIdx->entryId)
                 {
-                    for (cnt=0; cnt<pNVM_DataTable[tableEntryIdx].ElementsCount; cnt++)
+                    /* single save found */
+                    if ((metaInfo.fields.NvValidationStartByte == gValidationByteSingleRecord_c) &&
+                        (0 == maNvRecordsCpyOffsets[metaInfo.fields.NvmElementIndex]))
                     {
-                        /* skip allready restored elements */
-                        if (1 == maNvRecordsCpyOffsets[cnt])
-                            continue;
-                        NV_FlashRead(mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset + cnt * pNVM_DataTable[tableEntryIdx].ElementSize,
-                                     (uint8_t*)pNVM_DataTable[tableEntryIdx].pData + cnt * pNVM_DataTable[tableEntryIdx].ElementSize,
+                        maNvRecordsCpyOffsets[metaInfo.fields.NvmElementIndex] = 1;
+                        NV_FlashRead(mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset,
+                                     (uint8_t*)pNVM_DataTable[tableEntryIdx].pData + metaInfo.fields.NvmElementIndex * pNVM_DataTable[tableEntryIdx].ElementSize,
                                      pNVM_DataTable[tableEntryIdx].ElementSize);
+                        status = gNVM_OK_c;
+                    }
+                    /* full save found */
+                    else if (metaInfo.fields.NvValidationStartByte == gValidationByteAllRecords_c)
+                    {
+                        for (cnt=0; cnt<pNVM_DataTable[tableEntryIdx].ElementsCount; cnt++)
+                        {
+                            /* skip allready restored elements */
+                            if (1 == maNvRecordsCpyOffsets[cnt])
+                                continue;
+                            NV_FlashRead(mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset + cnt * pNVM_DataTable[tableEntryIdx].ElementSize,
+                                         (uint8_t*)pNVM_DataTable[tableEntryIdx].pData + cnt * pNVM_DataTable[tableEntryIdx].ElementSize,
+                                         pNVM_DataTable[tableEntryIdx].ElementSize);
+                        }
+                        return gNVM_OK_c;
                     }
-                    return gNVM_OK_c;
                 }
-            }
 
-            metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
-        }
+                metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
+            }
+        } while(NvGetOlderPage(&pageId, &metaInfoAddress));
         return status;
         #else
         /* parse meta info backwards until the full save is found */
-        while(metaInfoAddress >= (mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
+        do
         {
-            /* get the meta information */
-            NvGetMetaInfo(mNvActivePageId, metaInfoAddress, &metaInfo);
-
-            if(metaInfo.fields.NvValidationStartByte != metaInfo.fields.NvValidationEndByte)
+            while(metaInfoAddress >= (mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
             {
-                /* invalid meta info, move to the previous meta info */
-                metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
-                continue;
-            }
+                /* get the meta information */
+                NvGetMetaInfo(pageId, metaInfoAddress, &metaInfo);
 
-            if(metaInfo.fields.NvmDataEntryID == tblIdx->entryId)
-            {
-                /* single saves are not allowed if fragmentation is off */
-                if(metaInfo.fields.NvValidationStartByte == gValidationByteSingleRecord_c)
+                if(metaInfo.fields.NvValidationStartByte != metaInfo.fields.NvValidationEndByte)
                 {
-                    return gNVM_FragmentatedEntry_c;
+                    /* invalid meta info, move to the previous meta info */
+                    metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
+                    continue;
                 }
 
-                NV_FlashRead(mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset,
-                             (uint8_t*)pNVM_DataTable[tableEntryIdx].pData,
-                             pNVM_DataTable[tableEntryIdx].ElementsCount * pNVM_DataTable[tableEntryIdx].ElementSize);
-                return gNVM_OK_c;
-            }
+                if(metaInfo.fields.NvmDataEntryID == tblIdx->entryId)
+                {
+                    /* single saves are not allowed if fragmentation is off */
+                    if(metaInfo.fields.NvValidationStartByte == gValidationByteSingleRecord_c)
+                    {
+                        return gNVM_FragmentatedEntry_c;
+                    }
 
-            metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
-        }
+                    NV_FlashRead(mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset,
+                                 (uint8_t*)pNVM_DataTable[tableEntryIdx].pData,
+                                 pNVM_DataTable[tableEntryIdx].ElementsCount * pNVM_DataTable[tableEntryIdx].ElementSize);
+                    return gNVM_OK_c;
+                }
+
+                metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
+            }
+        } while(NvGetOlderPage(&pageId, &metaInfoAddress));
         return status;
         #endif
     }
 
     /*** restore single ***/
 
-    /* parse meta info backwards until the element is found */
-    while(metaInfoAddress >= (mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
+    #if gUnmirroredFeatureSet_d && gNvUnmirroredCacheEntries_c
+    if((gNVM_MirroredInRam_c != pNVM_DataTable[tableEntryIdx].DataEntryType) &&
+       NvUnmirroredCacheLookup(tblIdx->entryId, tblIdx->elementIndex, &cachedRecordOffset))
     {
-        /* get the meta information */
-        NvGetMetaInfo(mNvActivePageId, metaInfoAddress, &metaInfo);
-
-        if(metaInfo.fields.NvValidationStartByte != metaInfo.fields.NvValidationEndByte)
+        if(!cachedRecordOffset)
         {
-            /* invalid meta info, move to the previous meta info */
-            metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
-            continue;
+            ((uint8_t**)pNVM_DataTable[tableEntryIdx].pData)[tblIdx->elementIndex]=NULL;
+        }
+        else
+        {
+            ((uint8_t**)pNVM_DataTable[tableEntryIdx].pData)[tblIdx->elementIndex] =
+                (uint8_t*)mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + cachedRecordOffset;
         }
+        return gNVM_OK_c;
+    }
+    #endif
 
-        if(metaInfo.fields.NvmDataEntryID == tblIdx->entryId)
+    /* parse meta info backwards until the element is found */
+    do
+    {
+        while(metaInfoAddress >= (mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + gNvFirstMetaOffset_c))
         {
-            if(metaInfo.fields.NvValidationStartByte == gValidationByteSingleRecord_c && metaInfo.fields.NvmElementIndex == tblIdx->elementIndex)
+            /* get the meta information */
+            NvGetMetaInfo(pageId, metaInfoAddress, &metaInfo);
+
+            if(metaInfo.fields.NvValidationStartByte != metaInfo.fields.NvValidationEndByte)
             {
-                #if gUnmirroredFeatureSet_d
-                if(gNVM_MirroredInRam_c != pNVM_DataTable[tableEntryIdx].DataEntryType)
+                /* invalid meta info, move to the previous meta info */
+                metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
+                continue;
+            }
+
+            if(metaInfo.fields.NvmDataEntryID == tblIdx->entryId)
+            {
+                if(metaInfo.fields.NvValidationStartByte == gValidationByteSingleRecord_c && metaInfo.fields.NvmElementIndex == tblIdx->elementIndex)
                 {
-                    if(!metaInfo.fields.NvmRecordOffset)
+                    #if gUnmirroredFeatureSet_d
+                    if(gNVM_MirroredInRam_c != pNVM_DataTable[tableEntryIdx].DataEntryType)
                     {
-                        ((uint8_t**)pNVM_DataTable[tableEntryIdx].pData)[tblIdx->elementIndex]=NULL;
+                        if(!metaInfo.fields.NvmRecordOffset)
+                        {
+                            ((uint8_t**)pNVM_DataTable[tableEntryIdx].pData)[tblIdx->elementIndex]=NULL;
+                        }
+                        else
+                        {
+                            ((uint8_t**)pNVM_DataTable[tableEntryIdx].pData)[tblIdx->elementIndex] =
+                                (uint8_t*)mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset;
+                        }
+                        #if gNvUnmirroredCacheEntries_c
+                        NvUnmirroredCacheUpdate(tblIdx->entryId, tblIdx->elementIndex, metaInfo.fields.NvmRecordOffset);
+                        #endif
+                        status = gNVM_OK_c;
+                        break;
                     }
                     else
+                    #endif
                     {
-                        ((uint8_t**)pNVM_DataTable[tableEntryIdx].pData)[tblIdx->elementIndex] =
-                            (uint8_t*)mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset;
+                        /* restore the element */
+                        NV_FlashRead(mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset,
+                                     (uint8_t*)((uint8_t*)pNVM_DataTable[tableEntryIdx].pData +
+                                                (metaInfo.fields.NvmElementIndex * pNVM_DataTable[tableEntryIdx].ElementSize)),
+                                     pNVM_DataTable[tableEntryIdx].ElementSize);
+                        status = gNVM_OK_c;
+                        break;
                     }
-                    status = gNVM_OK_c;
-                    break;
                 }
-                else
-                #endif
+
+                if(metaInfo.fields.NvValidationStartByte == gValidationByteAllRecords_c)
                 {
-                    /* restore the element */
-                    NV_FlashRead(mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset,
-                                 (uint8_t*)((uint8_t*)pNVM_DataTable[tableEntryIdx].pData +
-                                            (metaInfo.fields.NvmElementIndex * pNVM_DataTable[tableEntryIdx].ElementSize)),
-                                 pNVM_DataTable[tableEntryIdx].ElementSize);
+                    /* restore the single element from the entire table entry record */
+                    NV_FlashRead((mNvVirtualPageProperty[pageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset +
+                                  (tblIdx->elementIndex * pNVM_DataTable[tableEntryIdx].ElementSize)),
+                    ((uint8_t*)pNVM_DataTable[tableEntryIdx].pData + (tblIdx->elementIndex * pNVM_DataTable[tableEntryIdx].ElementSize)),
+                    pNVM_DataTable[tableEntryIdx].ElementSize);
                     status = gNVM_OK_c;
                     break;
                 }
             }
 
-            if(metaInfo.fields.NvValidationStartByte == gValidationByteAllRecords_c)
-            {
-                /* restore the single element from the entire table entry record */
-                NV_FlashRead((mNvVirtualPageProperty[mNvActivePageId].NvRawSectorStartAddress + metaInfo.fields.NvmRecordOffset +
-                              (tblIdx->elementIndex * pNVM_DataTable[tableEntryIdx].ElementSize)),
-                ((uint8_t*)pNVM_DataTable[tableEntryIdx].pData + (tblIdx->elementIndex * pNVM_DataTable[tableEntryIdx].ElementSize)),
-                pNVM_DataTable[tableEntryIdx].ElementSize);
-                status = gNVM_OK_c;
-                break;
-            }
+            /* move to the previous meta info */
+            metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
         }
-
-        /* move to the previous meta info */
-        metaInfoAddress -= sizeof(NVM_RecordMetaInfo_t);
-    }
+    } while((gNVM_OK_c != status) && NvGetOlderPage(&pageId, &metaInfoAddress));
     return status;
 
 #endif /* gNvUseFlexNVM_d */
@@ -5362,10 +7320,6 @@ static bool NvProcessFirstSaveInQueue
                 #else
                 status = NvCopyPage(gNvCopyAll_c);
                 #endif
-                if (gNVM_OK_c == status)
-                {
-                    mNvCopyOperationIsPending = FALSE;
-                }
                 if (gNVM_OK_c == NvWriteRecord(&tblIdx))
                 {
                     return TRUE;
@@ -5407,92 +7361,56 @@ static NVM_Status_t NvAddSaveRequestToQueue
     NVM_TableEntryInfo_t* ptrTblIdx
 )
 {
-    uint8_t loopIdx;
-    bool_t  isQueued = FALSE;
-    bool_t  isInvalidEntry = FALSE;
-    uint8_t lastInvalidIdx;
-    uint8_t remaining_count;
+    uint8_t link = 0;
+    index_t slot;
 
-    if(mNvPendingSavesQueue.EntriesCount == 0)
+    /* check if the request is not already stored in queue; only the requests
+     * having the same entry ID are visited */
+    while((link = NvGetNextPendingSave(&mNvPendingSavesQueue, ptrTblIdx->entryId, link)) != 0)
     {
-        /* add request to queue */
-        if(NvPushPendingSave(&mNvPendingSavesQueue, *ptrTblIdx))
+        if(mNvPendingSavesQueue.QData[link - 1].saveRestoreAll == TRUE) /* full table entry already queued */
         {
+            /* request is already queued */
             return gNVM_OK_c;
         }
-        return gNVM_SaveRequestRejected_c;
-    }
-
-    /* start from the queue's head */
-    loopIdx = mNvPendingSavesQueue.Head;
-
-    remaining_count = mNvPendingSavesQueue.EntriesCount;
-    /* check if the request is not already stored in queue */
-    while(remaining_count)
-    {
-        if(ptrTblIdx->entryId == mNvPendingSavesQueue.QData[loopIdx].entryId)
-        {
-            if(mNvPendingSavesQueue.QData[loopIdx].saveRestoreAll == TRUE) /* full table entry already queued */
-            {
-                /* request is already queued */
-                isQueued = TRUE;
-                break;
-            }
-
-            /* single element from table entry is queued */
-            if(ptrTblIdx->saveRestoreAll == TRUE) /* a full table entry is requested to be saved */
-            {
-                /* update only the flag of the already queued request */
-                mNvPendingSavesQueue.QData[loopIdx].saveRestoreAll = TRUE;
-                /* request is already queued */
-                isQueued = TRUE;
-                break;
-            }
-
-            /* The request is for a single element and the queued request is also for a single element;
-            * Check if the request is for the same element. If the request is for a different element,
-            * add the new request to queue.
-            */
-            if(ptrTblIdx->elementIndex == mNvPendingSavesQueue.QData[loopIdx].elementIndex)
-            {
-                /* request is already queued */
-                isQueued = TRUE;
-                break;
-            }
 
-        }
-        /* Check if in the queue is an invalid entryId that can be used*/
-        if((gNvInvalidDataEntry_c == mNvPendingSavesQueue.QData[loopIdx].entryId)&&
-           (isInvalidEntry == FALSE))
+        /* single element from table entry is queued */
+        if(ptrTblIdx->saveRestoreAll == TRUE) /* a full table entry is requested to be saved */
         {
-            isInvalidEntry = TRUE;
-            lastInvalidIdx = loopIdx;
+            /* update only the flag of the already queued request */
+            mNvPendingSavesQueue.QData[link - 1].saveRestoreAll = TRUE;
+            return gNVM_OK_c;
         }
-        remaining_count--;
-        /* increment and wrap the loop index */
-        if(++loopIdx >= (uint8_t)gNvPendingSavesQueueSize_c)
+
+        /* The request is for a single element and the queued request is also for a single element;
+        * Check if the request is for the same element. If the request is for a different element,
+        * add the new request to queue.
+        */
+        if(ptrTblIdx->elementIndex == mNvPendingSavesQueue.QData[link - 1].elementIndex)
         {
-            loopIdx=0;
+            /* request is already queued */
+            return gNVM_OK_c;
         }
     }
 
-    if(!isQueued)
+    /* Reuse an invalid entry from the queue */
+    slot = NvGetInvalidPendingSave(&mNvPendingSavesQueue);
+    if(slot < (index_t)gNvPendingSavesQueueSize_c)
     {
-        /* Reuse an invalid entry from the queue*/
-        if(TRUE == isInvalidEntry)
-        {
-            mNvPendingSavesQueue.QData[lastInvalidIdx] = *ptrTblIdx;
-            return gNVM_OK_c;
-        }
-        /* push the request to save operation pending queue */
+        mNvPendingSavesQueue.InvalidSlots[slot >> 5] &= ~(1UL << (slot & 0x1F));
+        mNvPendingSavesQueue.QData[slot] = *ptrTblIdx;
+        NvLinkPendingSave(&mNvPendingSavesQueue, slot);
+        return gNVM_OK_c;
+    }
+
+    /* push the request to save operation pending queue */
+    if(!NvPushPendingSave(&mNvPendingSavesQueue, *ptrTblIdx))
+    {
+        /* free a space */
+        NvProcessFirstSaveInQueue();
         if(!NvPushPendingSave(&mNvPendingSavesQueue, *ptrTblIdx))
         {
-            /* free a space */
-            NvProcessFirstSaveInQueue();
-            if(!NvPushPendingSave(&mNvPendingSavesQueue, *ptrTblIdx))
-            {
-                return gNVM_SaveRequestRejected_c;
-            }
+            return gNVM_SaveRequestRejected_c;
         }
     }
 
@@ -5566,13 +7484,11 @@ static void __NvCompletePendingOperations(void)
     return;
   }
     
-  while(idx < gNVM_TABLE_entries_c)
+  /* all the scheduled saves become due; equal deadlines keep the heap order */
+  while(idx < mNvSaveDeadlineHeapSize)
   {		
-    if((maDatasetInfo[idx].saveNextInterval) && (maDatasetInfo[idx].ticksToNextSave))
-    {
-      maDatasetInfo[idx].ticksToNextSave = 0;
-      mNvSaveOnIntervalEvent = TRUE;
-    }      
+    maDatasetInfo[maNvSaveDeadlineHeap[idx]].nextSaveTick = mNvTickCounter;
+    mNvSaveOnIntervalEvent = TRUE;
     idx++;
   }
 
@@ -6105,8 +8021,9 @@ bool_t NvIsDataSetDirty
  * Name: NvGetStatistics
  * Description:
  * Parameter(s): [OUT] ptrStat - pointer to a memory location where the pages
- *                               statistics (erase cycles of each page) will
- *                               be stored
+ *                               statistics (erase cycles of each page, erase
+ *                               count of each sector and page reclaim
+ *                               counters) will be stored
  * Return: -
  *****************************************************************************/
 void NvGetPagesStatistics
@@ -6126,6 +8043,10 @@ void NvGetPagesStatistics
         return;
     }
 
+    #if gNvCircularLog_d
+    /* the log pages are written in turn, each one once per lap */
+    ptrStat->FirstPageEraseCyclesCount = ptrStat->SecondPageEraseCyclesCount = mNvPageCounter/gNvVirtualPagesCount_c;
+    #else
     if(mNvPageCounter%2)
     {
         ptrStat->FirstPageEraseCyclesCount = ptrStat->SecondPageEraseCyclesCount = (mNvPageCounter-1)/2;
@@ -6135,10 +8056,27 @@ void NvGetPagesStatistics
         ptrStat->FirstPageEraseCyclesCount = mNvPageCounter/2;
         ptrStat->SecondPageEraseCyclesCount = (mNvPageCounter-2)/2;
     }
+    #endif
+
+    ptrStat->PageCopiesCount = mNvWearStatistics.PageCopiesCount;
+    ptrStat->ReclaimedBytesCount = mNvWearStatistics.ReclaimedBytesCount;
+    ptrStat->SectorErasesCount = mNvWearStatistics.SectorErasesCount;
+    ptrStat->BlankSectorsSkippedCount = mNvWearStatistics.BlankSectorsSkippedCount;
+    #if gNvCircularLog_d
+    ptrStat->SectorsCount = (uint8_t)((uint32_t)((uint8_t*)NV_STORAGE_MAX_SECTORS));
+    #else
+    ptrStat->SectorsCount = (uint8_t)((uint32_t)((uint8_t*)NV_STORAGE_MAX_SECTORS) & ~1UL);
+    #endif
+    if(ptrStat->SectorsCount > gNvWearStatisticsSectorsCount_c)
+    {
+        ptrStat->SectorsCount = gNvWearStatisticsSectorsCount_c;
+    }
+    FLib_MemCpy(ptrStat->SectorEraseCyclesCount, mNvWearStatistics.SectorEraseCyclesCount, sizeof(ptrStat->SectorEraseCyclesCount));
+    ptrStat->UnmirroredCacheHitsCount = mNvWearStatistics.UnmirroredCacheHitsCount;
+    ptrStat->UnmirroredCacheMissesCount = mNvWearStatistics.UnmirroredCacheMissesCount;
 
     #else /* FlexNVM */
-    ptrStat->FirstPageEraseCyclesCount = 0;
-    ptrStat->SecondPageEraseCyclesCount = 0;
+    FLib_MemSet(ptrStat, 0, sizeof(NVM_Statistics_t));
     return;
     #endif
 #else
@@ -246,13 +246,14 @@ None
 bool_t FSCI_MsgGetNVCountersReqFunc(void* pData, uint32_t fsciInterface)
 {
     NVM_Statistics_t ptrStat;
-    uint8_t payload[sizeof(NVM_Statistics_t)+1];
+    /* status + page erase cycles counters; the wear statistics are not part of the message */
+    uint8_t payload[2*sizeof(uint32_t)+1];
 
     payload[0] = 0; 
     NvGetPagesStatistics(&ptrStat);
     FLib_MemCpy(&payload[1],&ptrStat.FirstPageEraseCyclesCount,4);
     FLib_MemCpy(&payload[5],&ptrStat.SecondPageEraseCyclesCount,4);
-    FSCI_transmitPayload(gNV_FsciCnfOG_d,mFsciMsgGetNVCountersReq_c,payload,sizeof(NVM_Statistics_t)+1,fsciInterface);
+    FSCI_transmitPayload(gNV_FsciCnfOG_d,mFsciMsgGetNVCountersReq_c,payload,sizeof(payload),fsciInterface);
 
     return FALSE;
 }
@@ -81,6 +81,10 @@
 #include "VirtualNicInterface.h"
 #endif
 
+#if (gSerialMgrUseMux_c)
+#include "SerialMux.h"
+#endif
+
 #if gSerialMgrUseFSCIHdr_c
 #include "FsciInterface.h"
 #include "FsciCommunication.h"
@@ -101,6 +105,9 @@
 
 #define gSMRxBufSize_c (gSerialMgrRxBufSize_c + 1)
 
+/* Computes a watermark as a percent of the Rx buffer capacity */
+#define mSerial_RxWatermark_d(capacity, percent) ((uint16_t)(((uint32_t)(capacity) * (percent)) / 100))
+
 #define mSMGR_DapIsrPrio_c    (0x80)
 
 #if gSerialMgrUseFSCIHdr_c
@@ -114,13 +121,10 @@
 ********************************************************************************** */
 #if (gSerialManagerMaxInterfaces_c)
 /*
- * Set the size of the Rx buffer indexes
+ * Set the size of the Rx buffer indexes.
+ * The Rx buffer can be replaced by a larger one using Serial_SetRxBuffer()
  */
-#if gSMRxBufSize_c < 255
-typedef uint8_t bufIndex_t;
-#else
 typedef uint16_t bufIndex_t;
-#endif
 
 /*
  * Defines events recognized by the SerialManager's Task
@@ -144,7 +148,17 @@ typedef struct serial_tag{
     volatile bufIndex_t    rxOut;
     pSerialCallBack_t      rxCallback;
     void                  *pRxParam;
-    uint8_t                rxBuffer[gSMRxBufSize_c];
+    uint8_t               *rxBuffer;
+    uint16_t               rxBufSize;
+    uint8_t                rxStorage[gSMRxBufSize_c];
+    /* Rx flow control */
+    uint16_t               rxHighWatermark;
+    uint16_t               rxLowWatermark;
+    pSerialRxFlowCallBack_t rxFlowCallback;
+    void                  *pRxFlowParam;
+    volatile uint8_t       rxThrottled;
+    uint32_t               rxDrops;
+    uint32_t               rxThrottles;
     /* Tx parameters */
     SerialMsg_t            txQueue[gSerialMgrTxQueueSize_c];
 #if gSMGR_UseOsSemForSynchronization_c
@@ -158,6 +172,17 @@ typedef struct serial_tag{
     fsciLen_t              rxFsciIn;
     fsciLen_t              rxFsciLen;
     uint8_t                rxFsciPkt;
+#endif
+#if gSerialMgrTxCoalescingBufSize_c
+    /* Tx coalescing */
+    uint8_t                txStaging[2][gSerialMgrTxCoalescingBufSize_c];
+    uint16_t               txStagedLen;
+    uint16_t               txStagedWrites;
+    uint32_t               txStagedTs;
+    uint8_t                txStagingIdx;
+    volatile uint8_t       txStagingBusy;
+    uint8_t                txCoalescing;
+    serialTxStatistics_t   txStats;
 #endif
     volatile uint8_t       txIn;
     volatile uint8_t       txOut;
@@ -173,7 +198,8 @@ typedef struct serial_tag{
 typedef enum{
     gSMGR_Rx_c     = (1<<0),
     gSMGR_TxDone_c = (1<<1),
-    gSMGR_TxNew_c  = (1<<2)
+    gSMGR_TxNew_c  = (1<<2),
+    gSMGR_TxStaged_c = (1<<3)
 }serialEventType_t;
 
 /*
@@ -210,7 +236,19 @@ void  SerialManager_TxNotify(uint32_t i);
 static void  Serial_SyncTxCallback(void *pSer);
 #endif
 static void  Serial_TxQueueMaintenance(serial_t *pSer);
+static void  Serial_RxReadNotify(uint8_t InterfaceId);
+static uint16_t Serial_RxCount(serial_t *pSer);
+static void  Serial_RxCheckWatermarks(uint32_t i);
+static void  Serial_RxFlowControl(uint32_t i, uint8_t rxReady);
 static serialStatus_t Serial_WriteInternal (uint8_t InterfaceId);
+static serialStatus_t Serial_EnqueueTx (uint8_t InterfaceId, const serialSegment_t *pSegments, uint8_t count);
+static bool_t Serial_TxQueueInsert (serial_t *pSer, const serialSegment_t *pSegments, uint8_t count);
+#if gSerialMgrTxCoalescingBufSize_c
+static bool_t Serial_TxCoalesce(uint8_t InterfaceId, uint8_t *pBuf, uint16_t bufLen);
+static serialStatus_t Serial_TxStagingFlush(uint8_t InterfaceId);
+static void Serial_TxStagingDone(void *param);
+static uint32_t Serial_TxStagingWaitTime(void);
+#endif
 #if (gSerialMgrUseSPI_c) || (gSerialMgrUseIIC_c)
 static uint32_t Serial_GetInterfaceIdFromType(serialInterfaceType_t type);
 #endif
@@ -420,7 +458,11 @@ void SerialManagerTask(osaTaskParam_t argument)
     while( 1 )
     {
         /* Wait for an event. The task will block here. */
+#if gSerialMgrTxCoalescingBufSize_c
+        (void)OSA_EventWait(mSMTaskEventId, osaEventFlagsAll_c, FALSE, Serial_TxStagingWaitTime() ,&mSMTaskEventFlags);
+#else
         (void)OSA_EventWait(mSMTaskEventId, osaEventFlagsAll_c, FALSE, osaWaitForever_c ,&mSMTaskEventFlags);
+#endif
 #endif
         for( i = 0; i < gSerialManagerMaxInterfaces_c; i++ )
         {
@@ -440,6 +482,15 @@ void SerialManagerTask(osaTaskParam_t argument)
                 Serial_TxQueueMaintenance(&mSerials[i]);
             }
 
+#if gSerialMgrTxCoalescingBufSize_c
+            /* Send the staged data if no other write was merged for a while */
+            if( mSerials[i].txStagedLen &&
+                ((OSA_TimeGetMsec() - mSerials[i].txStagedTs) >= gSerialMgrTxCoalescingTimeout_c) )
+            {
+                (void)Serial_TxStagingFlush(i);
+            }
+#endif
+
             /* If the Serial is IDLE and there is data to tx */
             if( (mSerials[i].state == 0) && (mSerials[i].txQueue[mSerials[i].txCurrent].dataSize > 0) )
             {
@@ -510,6 +561,10 @@ serialStatus_t Serial_InitInterface( uint8_t *pInterfaceId,
         {
             OSA_InterruptDisable();
             pSer->serialChannel = instance;
+            pSer->rxBuffer = pSer->rxStorage;
+            pSer->rxBufSize = gSMRxBufSize_c;
+            pSer->rxHighWatermark = mSerial_RxWatermark_d(gSerialMgrRxBufSize_c, gSerialMgrRxHighWatermark_c);
+            pSer->rxLowWatermark = mSerial_RxWatermark_d(gSerialMgrRxBufSize_c, gSerialMgrRxLowWatermark_c);
             switch ( interfaceType )
             {
             case gSerialMgrUart_c:
@@ -608,6 +663,15 @@ serialStatus_t Serial_InitInterface( uint8_t *pInterfaceId,
                 /* Nothing to do here. The initialization is done outsinde SerialManager */
                 break;
 
+            case gSerialMgrMux_c:
+#if gSerialMgrUseMux_c
+                /* The instance is the channel number */
+                status = SerialMux_OpenChannel(instance, i);
+#else
+                status = gSerial_InvalidInterface_c;
+#endif
+                break;
+
             default:
                 status = gSerial_InvalidInterface_c;
                 break;
@@ -669,19 +733,104 @@ serialStatus_t Serial_AsyncWrite( uint8_t InterfaceId,
                                   uint16_t bufLen,
                                   pSerialCallBack_t cb,
                                   void *pTxParam )
+{
+    serialSegment_t segment;
+
+#if gSerialMgrTxCoalescingBufSize_c
+    /* Only writes without callback can be merged, the data is copied */
+    if( (NULL == cb) && Serial_TxCoalesce(InterfaceId, pBuf, bufLen) )
+    {
+        return gSerial_Success_c;
+    }
+#endif
+
+    segment.pData = pBuf;
+    segment.dataSize = bufLen;
+    segment.releaseCb = cb;
+    segment.pReleaseParam = pTxParam;
+
+    return Serial_AsyncWriteV( InterfaceId, &segment, 1 );
+}
+
+/*! *********************************************************************************
+* \brief   Transmit a list of data buffers asynchronously, back to back, without
+*          copying them. Each segment uses one Tx queue entry, and all the
+*          entries are reserved at once, so the segments of different writes
+*          are never interleaved.
+*
+* \param[in] InterfaceId the interface number
+* \param[in] pSegments pointer to the list of segments. The list itself may be
+*            reused after the function returns, but the data of each segment
+*            must remain valid until its release callback is called.
+* \param[in] count the number of segments (at most gSerialMgrTxQueueSize_c)
+*
+* \return The status of the operation
+*
+* \remarks The release callbacks are called in order, from the SMGR task, so the
+*          callback of the last segment also signals the end of the whole write.
+*
+********************************************************************************** */
+serialStatus_t Serial_AsyncWriteV( uint8_t InterfaceId,
+                                   const serialSegment_t *pSegments,
+                                   uint8_t count )
+{
+#if gSerialMgrTxCoalescingBufSize_c
+    serialStatus_t status;
+
+    if( InterfaceId < gSerialManagerMaxInterfaces_c )
+    {
+        /* The staged data was written first, it cannot be overtaken */
+        status = Serial_TxStagingFlush(InterfaceId);
+        if( gSerial_Success_c != status )
+        {
+            return status;
+        }
+    }
+#endif
+    return Serial_EnqueueTx(InterfaceId, pSegments, count);
+}
+
+/*! *********************************************************************************
+* \brief   Puts a list of data buffers into the Tx queue and starts the transmission
+*
+* \param[in] InterfaceId the interface number
+* \param[in] pSegments pointer to the list of segments
+* \param[in] count the number of segments
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+static serialStatus_t Serial_EnqueueTx( uint8_t InterfaceId,
+                                        const serialSegment_t *pSegments,
+                                        uint8_t count )
 {
     serialStatus_t status = gSerial_Success_c;
 #if gSerialManagerMaxInterfaces_c
-    SerialMsg_t *pMsg = NULL;
     serial_t *pSer = &mSerials[InterfaceId];
+    bool_t queued = FALSE;
+#if gSerialMgr_ParamValidation_d
+    uint8_t j;
+#endif
 
 #if gSerialMgr_ParamValidation_d
-    if( (NULL == pBuf) || (0 == bufLen) || (InterfaceId >= gSerialManagerMaxInterfaces_c) ||
-        (pSer->serialType == gSerialMgrNone_c) )
+    if( (NULL == pSegments) || (0 == count) || (count > gSerialMgrTxQueueSize_c) ||
+        (InterfaceId >= gSerialManagerMaxInterfaces_c) || (pSer->serialType == gSerialMgrNone_c) )
     {
         status = gSerial_InvalidParameter_c;
     }
     else
+    {
+        for( j = 0; j < count; j++ )
+        {
+            if( (NULL == pSegments[j].pData) || (0 == pSegments[j].dataSize) )
+            {
+                status = gSerial_InvalidParameter_c;
+                break;
+            }
+        }
+    }
+
+    if( gSerial_Success_c == status )
 #endif
     {
 
@@ -696,22 +845,13 @@ serialStatus_t Serial_AsyncWrite( uint8_t InterfaceId,
         }
 #endif
 
-        /* Check if slot is free */
+        /* Check if enough slots are free */
         do {
             OSA_InterruptDisable();
 
-            if( (0 == pSer->txQueue[pSer->txIn].dataSize) && (NULL == pSer->txQueue[pSer->txIn].txCallback) && (pSer->txNo < gSerialMgrTxQueueSize_c) )
-            {
-                pMsg = &pSer->txQueue[pSer->txIn];
-                pMsg->dataSize   = bufLen;
-                pMsg->pData      = (void*)pBuf;
-                pMsg->txCallback = cb;
-                pMsg->pTxParam   = pTxParam;
-                mSerial_IncIdx_d(pSer->txIn, gSerialMgrTxQueueSize_c)
-                pSer->txNo++;
-            }
+            queued = Serial_TxQueueInsert(pSer, pSegments, count);
 #if (gSerialMgr_BlockSenderOnQueueFull_c) && (gSMGR_UseOsSemForSynchronization_c)
-            else
+            if( !queued )
             {
                 if(taskHandler != gSerialManagerTaskId)
                 {
@@ -721,7 +861,7 @@ serialStatus_t Serial_AsyncWrite( uint8_t InterfaceId,
 #endif
             OSA_InterruptEnable();
 
-            if( pMsg )
+            if( queued )
             {
                 status = Serial_WriteInternal( InterfaceId );
                 break;
@@ -748,14 +888,171 @@ serialStatus_t Serial_AsyncWrite( uint8_t InterfaceId,
     }
 #else
     (void)InterfaceId;
-    (void)pBuf;
-    (void)bufLen;
-    (void)cb;
-    (void)pTxParam;
+    (void)pSegments;
+    (void)count;
 #endif /* gSerialManagerMaxInterfaces_c */
     return status;
 }
 
+/*! *********************************************************************************
+* \brief   Puts a list of data buffers into the Tx queue, if enough entries are free.
+*          Must be called with the interrupts disabled.
+*
+* \param[in] pSer pointer to the interface
+* \param[in] pSegments pointer to the list of segments
+* \param[in] count the number of segments
+*
+* \return TRUE if the segments were queued, FALSE if the Tx queue is full
+*
+********************************************************************************** */
+static bool_t Serial_TxQueueInsert( serial_t *pSer,
+                                    const serialSegment_t *pSegments,
+                                    uint8_t count )
+{
+#if gSerialManagerMaxInterfaces_c
+    uint8_t idx;
+    uint8_t j;
+
+    if( (pSer->txNo + count) > gSerialMgrTxQueueSize_c )
+    {
+        return FALSE;
+    }
+
+    idx = pSer->txIn;
+    for( j = 0; j < count; j++ )
+    {
+        if( (0 != pSer->txQueue[idx].dataSize) || (NULL != pSer->txQueue[idx].txCallback) )
+        {
+            return FALSE;
+        }
+        mSerial_IncIdx_d(idx, gSerialMgrTxQueueSize_c)
+    }
+
+    for( j = 0; j < count; j++ )
+    {
+        pSer->txQueue[pSer->txIn].dataSize   = pSegments[j].dataSize;
+        pSer->txQueue[pSer->txIn].pData      = pSegments[j].pData;
+        pSer->txQueue[pSer->txIn].txCallback = pSegments[j].releaseCb;
+        pSer->txQueue[pSer->txIn].pTxParam   = pSegments[j].pReleaseParam;
+        mSerial_IncIdx_d(pSer->txIn, gSerialMgrTxQueueSize_c)
+    }
+    pSer->txNo += count;
+
+    return TRUE;
+#else
+    (void)pSer;
+    (void)pSegments;
+    (void)count;
+    return FALSE;
+#endif
+}
+
+
+/*! *********************************************************************************
+* \brief   Enables or disables the merging of small writes for an interface.
+*          When enabled, Serial_SyncWrite() calls and Serial_AsyncWrite() calls
+*          without callback of up to gSerialMgrTxCoalescingMaxWrite_c bytes are
+*          copied into a staging buffer, which is sent when it is full, after
+*          gSerialMgrTxCoalescingTimeout_c ms without new writes, before any
+*          other write, or when Serial_TxFlush() is called.
+*
+* \param[in] InterfaceId the interface number
+* \param[in] enable TRUE to merge small writes, FALSE otherwise
+*
+* \return The status of the operation
+*
+* \remarks A merged Serial_SyncWrite() returns before its data is transmitted.
+*
+********************************************************************************** */
+serialStatus_t Serial_SetTxCoalescing( uint8_t InterfaceId, bool_t enable )
+{
+    serialStatus_t status = gSerial_Success_c;
+#if gSerialManagerMaxInterfaces_c && gSerialMgrTxCoalescingBufSize_c
+#if gSerialMgr_ParamValidation_d
+    if( InterfaceId >= gSerialManagerMaxInterfaces_c )
+    {
+        status = gSerial_InvalidParameter_c;
+    }
+    else
+#endif
+    {
+        if( !enable )
+        {
+            status = Serial_TxStagingFlush(InterfaceId);
+        }
+        mSerials[InterfaceId].txCoalescing = enable;
+    }
+#else
+    (void)InterfaceId;
+    (void)enable;
+    status = gSerial_InvalidParameter_c;
+#endif
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   Sends the data merged into the Tx staging buffer, if any
+*
+* \param[in] InterfaceId the interface number
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t Serial_TxFlush( uint8_t InterfaceId )
+{
+    serialStatus_t status = gSerial_Success_c;
+#if gSerialManagerMaxInterfaces_c && gSerialMgrTxCoalescingBufSize_c
+#if gSerialMgr_ParamValidation_d
+    if( InterfaceId >= gSerialManagerMaxInterfaces_c )
+    {
+        status = gSerial_InvalidParameter_c;
+    }
+    else
+#endif
+    {
+        status = Serial_TxStagingFlush(InterfaceId);
+    }
+#else
+    (void)InterfaceId;
+#endif
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   Returns the Tx coalescing counters of an interface
+*
+* \param[in] InterfaceId the interface number
+* \param[out] pStats pointer to location where to store the counters
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t Serial_GetTxStatistics( uint8_t InterfaceId, serialTxStatistics_t *pStats )
+{
+    serialStatus_t status = gSerial_Success_c;
+#if gSerialManagerMaxInterfaces_c
+#if gSerialMgr_ParamValidation_d
+    if( (InterfaceId >= gSerialManagerMaxInterfaces_c) || (NULL == pStats) )
+    {
+        status = gSerial_InvalidParameter_c;
+    }
+    else
+#endif
+    {
+#if gSerialMgrTxCoalescingBufSize_c
+        OSA_InterruptDisable();
+        *pStats = mSerials[InterfaceId].txStats;
+        OSA_InterruptEnable();
+#else
+        FLib_MemSet(pStats, 0x00, sizeof(serialTxStatistics_t));
+#endif
+    }
+#else
+    (void)InterfaceId;
+    (void)pStats;
+#endif
+    return status;
+}
 
 /*! *********************************************************************************
 * \brief Transmit a data buffer synchronously. The task will block until the Tx is done
@@ -776,6 +1073,14 @@ serialStatus_t Serial_SyncWrite( uint8_t InterfaceId,
     pSerialCallBack_t cb = NULL;
     serial_t *pSer = &mSerials[InterfaceId];
 
+#if gSerialMgrTxCoalescingBufSize_c
+    /* The data is copied into the Tx staging buffer, so there is nothing to wait for */
+    if( Serial_TxCoalesce(InterfaceId, pBuf, bufLen) )
+    {
+        return gSerial_Success_c;
+    }
+#endif
+
 #if gSMGR_UseOsSemForSynchronization_c
     /* If the calling task is SMGR do not block on semaphore */
     if( OSA_TaskGetId() != gSerialManagerTaskId )
@@ -822,95 +1127,391 @@ serialStatus_t Serial_SyncWrite( uint8_t InterfaceId,
 #endif
     }
 #else
-    (void)pBuf;
-    (void)bufLen;
+    (void)pBuf;
+    (void)bufLen;
+    (void)InterfaceId;
+#endif /* gSerialManagerMaxInterfaces_c */
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   Returns a specified number of characters from the Rx buffer
+*
+* \param[in] InterfaceId the interface number
+* \param[out] pData pointer to location where to store the characters
+* \param[in] dataSize the number of characters to be read
+* \param[out] bytesRead the number of characters read
+*
+* \return The status of the operation
+*
+* \remarks The Rx buffer is copied in at most two segments (before and after the
+*          buffer wrap). With the lossless Rx buffer, the copy is done with the
+*          interrupts enabled.
+*
+********************************************************************************** */
+serialStatus_t Serial_Read( uint8_t InterfaceId, uint8_t *pData, uint16_t dataSize, uint16_t *bytesRead )
+{
+    serialStatus_t status = gSerial_Success_c;
+#if (gSerialManagerMaxInterfaces_c)
+    serial_t *pSer = &mSerials[InterfaceId];
+    uint16_t bytes = 0;
+    uint16_t segment;
+    bufIndex_t rxIn, rxOut;
+
+#if gSerialMgr_ParamValidation_d
+    if ( (InterfaceId >= gSerialManagerMaxInterfaces_c) || (NULL == pData) || (0 == dataSize) )
+    {
+        status = gSerial_InvalidParameter_c;
+    }
+    else
+#endif
+    {
+        /* With the lossless Rx buffer, the Rx ISR only writes outside of [rxOut, rxIn)
+         * and never moves rxOut: the data is copied outside of the critical section.
+         * Otherwise the ISR moves rxOut when the buffer overflows, so the indexes
+         * and the data are accessed inside the same critical section */
+        OSA_InterruptDisable();
+        rxIn  = pSer->rxIn;
+        rxOut = pSer->rxOut;
+#if gSerialMgrLosslessRx_c
+        OSA_InterruptEnable();
+#endif
+
+        if( rxIn >= rxOut )
+        {
+            segment = rxIn - rxOut;
+        }
+        else
+        {
+            segment = pSer->rxBufSize - rxOut;
+        }
+
+        /* Copy data up to the end of the buffer */
+        if( segment > dataSize )
+        {
+            segment = dataSize;
+        }
+        FLib_MemCpy(pData, &pSer->rxBuffer[rxOut], segment);
+        bytes = segment;
+        rxOut += segment;
+
+        if( rxOut >= pSer->rxBufSize )
+        {
+            /* Copy the data stored from the beginning of the buffer */
+            rxOut = 0;
+            segment = rxIn;
+            if( segment > dataSize - bytes )
+            {
+                segment = dataSize - bytes;
+            }
+            FLib_MemCpy(&pData[bytes], pSer->rxBuffer, segment);
+            bytes += segment;
+            rxOut = segment;
+        }
+
+#if gSerialMgrLosslessRx_c
+        OSA_InterruptDisable();
+#endif
+        pSer->rxOut = rxOut;
+        OSA_InterruptEnable();
+
+        /* Aditional processing depending on interface */
+        Serial_RxReadNotify(InterfaceId);
+
+        if( bytesRead )
+        {
+            *bytesRead = bytes;
+        }
+    }
+#else
+    (void)InterfaceId;
+    (void)pData;
+    (void)dataSize;
+    bytesRead = 0;
+    (void)bytesRead;
+#endif
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   Returns a pointer to the oldest received characters, without removing
+*          them from the Rx buffer. Only the characters stored contiguously are
+*          reported, so a second call may be needed after the buffer wraps.
+*
+* \param[in] InterfaceId the interface number
+* \param[out] ppData location where to store the address of the first character
+* \param[out] pSize the number of contiguous characters available at *ppData
+*
+* \return The status of the operation
+*
+* \remarks The characters remain valid until Serial_RxConsume() is called, unless
+*          the Rx buffer overflows in the meantime.
+*
+********************************************************************************** */
+serialStatus_t Serial_RxPeek( uint8_t InterfaceId, uint8_t **ppData, uint16_t *pSize )
+{
+    serialStatus_t status = gSerial_Success_c;
+#if (gSerialManagerMaxInterfaces_c)
+    serial_t *pSer = &mSerials[InterfaceId];
+    bufIndex_t rxIn, rxOut;
+
+#if gSerialMgr_ParamValidation_d
+    if ( (InterfaceId >= gSerialManagerMaxInterfaces_c) || (NULL == ppData) || (NULL == pSize) )
+    {
+        status = gSerial_InvalidParameter_c;
+    }
+    else
+#endif
+    {
+        OSA_InterruptDisable();
+        rxIn  = pSer->rxIn;
+        rxOut = pSer->rxOut;
+        OSA_InterruptEnable();
+
+        *ppData = &pSer->rxBuffer[rxOut];
+
+        if( rxIn >= rxOut )
+        {
+            *pSize = rxIn - rxOut;
+        }
+        else
+        {
+            *pSize = pSer->rxBufSize - rxOut;
+        }
+    }
+#else
+    (void)InterfaceId;
+    (void)ppData;
+    (void)pSize;
+#endif
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   Removes characters from the Rx buffer, usually after they were
+*          processed in place using Serial_RxPeek().
+*
+* \param[in] InterfaceId the interface number
+* \param[in] count the number of characters to be removed
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t Serial_RxConsume( uint8_t InterfaceId, uint16_t count )
+{
+    serialStatus_t status = gSerial_Success_c;
+#if (gSerialManagerMaxInterfaces_c)
+    serial_t *pSer = &mSerials[InterfaceId];
+    uint16_t bytes;
+    uint16_t rxOut;
+
+#if gSerialMgr_ParamValidation_d
+    if ( InterfaceId >= gSerialManagerMaxInterfaces_c )
+    {
+        status = gSerial_InvalidParameter_c;
+    }
+    else
+#endif
+    {
+        OSA_InterruptDisable();
+        bytes = Serial_RxCount(pSer);
+
+        if( count > bytes )
+        {
+            count = bytes;
+        }
+
+        rxOut = pSer->rxOut + count;
+        if( rxOut >= pSer->rxBufSize )
+        {
+            rxOut -= pSer->rxBufSize;
+        }
+        pSer->rxOut = rxOut;
+        OSA_InterruptEnable();
+
+        Serial_RxReadNotify(InterfaceId);
+    }
+#else
+    (void)InterfaceId;
+    (void)count;
+#endif
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   Replaces the Rx buffer of an interface. Any data from the previous
+*          Rx buffer is discarded, and the watermarks are set to their default
+*          values relative to the new buffer.
+*
+* \param[in] InterfaceId the interface number
+* \param[in] pBuffer pointer to the new Rx buffer. Must remain valid while the
+*            interface is used.
+* \param[in] size the size of the new Rx buffer. One byte is always kept free,
+*            so up to size-1 bytes can be buffered.
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t Serial_SetRxBuffer( uint8_t InterfaceId, uint8_t *pBuffer, uint16_t size )
+{
+    serialStatus_t status = gSerial_Success_c;
+#if (gSerialManagerMaxInterfaces_c)
+    serial_t *pSer = &mSerials[InterfaceId];
+
+#if gSerialMgr_ParamValidation_d
+    if ( (InterfaceId >= gSerialManagerMaxInterfaces_c) || (NULL == pBuffer) || (size < 2) )
+    {
+        status = gSerial_InvalidParameter_c;
+    }
+    else
+#endif
+    {
+        OSA_InterruptDisable();
+        pSer->rxBuffer = pBuffer;
+        pSer->rxBufSize = size;
+        pSer->rxIn = 0;
+        pSer->rxOut = 0;
+        pSer->rxHighWatermark = mSerial_RxWatermark_d(size - 1, gSerialMgrRxHighWatermark_c);
+        pSer->rxLowWatermark = mSerial_RxWatermark_d(size - 1, gSerialMgrRxLowWatermark_c);
+
+        /* The drivers store the received data directly into the Rx buffer */
+        switch ( pSer->serialType )
+        {
+#if gSerialMgrUseUart_c
+        case gSerialMgrUart_c:
+        case gSerialMgrLpuart_c:
+        case gSerialMgrLpsci_c:
+            mDrvData[InterfaceId].uartState.pRxData = pSer->rxBuffer;
+            break;
+#endif
+#if gSerialMgrUseIIC_c
+        case gSerialMgrIICMaster_c:
+        case gSerialMgrIICSlave_c:
+            mDrvData[InterfaceId].i2cState.pRxData = pSer->rxBuffer;
+            break;
+#endif
+#if gSerialMgrUseSPI_c
+        case gSerialMgrSPIMaster_c:
+        case gSerialMgrSPISlave_c:
+            mDrvData[InterfaceId].spiState.pRxData = pSer->rxBuffer;
+            break;
+#endif
+        default:
+            break;
+        }
+
+        if( pSer->rxThrottled )
+        {
+            pSer->rxThrottled = FALSE;
+            Serial_RxFlowControl(InterfaceId, TRUE);
+        }
+        OSA_InterruptEnable();
+    }
+#else
+    (void)InterfaceId;
+    (void)pBuffer;
+    (void)size;
+#endif
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   Sets the Rx buffer fill levels used for flow control. When the number
+*          of buffered bytes reaches the high watermark, the sender is throttled
+*          (the RTS hook of the UART is called and the callback is notified).
+*          When it drops to the low watermark, the transmission is resumed.
+*
+* \param[in] InterfaceId the interface number
+* \param[in] highWatermark the number of buffered bytes which throttles the sender
+* \param[in] lowWatermark the number of buffered bytes which resumes the sender
+* \param[in] cb pointer to a function called on flow control events, or NULL
+* \param[in] pParam parameter passed to the callback
+*
+* \return The status of the operation
+*
+* \remarks The callback is called from ISR context when the high watermark is reached.
+*
+********************************************************************************** */
+serialStatus_t Serial_SetRxWatermarks( uint8_t InterfaceId, uint16_t highWatermark, uint16_t lowWatermark,
+                                       pSerialRxFlowCallBack_t cb, void *pParam )
+{
+    serialStatus_t status = gSerial_Success_c;
+#if (gSerialManagerMaxInterfaces_c)
+    serial_t *pSer = &mSerials[InterfaceId];
+
+#if gSerialMgr_ParamValidation_d
+    if ( (InterfaceId >= gSerialManagerMaxInterfaces_c) || (lowWatermark >= highWatermark) ||
+         (highWatermark >= pSer->rxBufSize) )
+    {
+        status = gSerial_InvalidParameter_c;
+    }
+    else
+#endif
+    {
+        OSA_InterruptDisable();
+        pSer->rxHighWatermark = highWatermark;
+        pSer->rxLowWatermark = lowWatermark;
+        pSer->rxFlowCallback = cb;
+        pSer->pRxFlowParam = pParam;
+        OSA_InterruptEnable();
+
+        Serial_RxCheckWatermarks(InterfaceId);
+    }
+#else
     (void)InterfaceId;
-#endif /* gSerialManagerMaxInterfaces_c */
+    (void)highWatermark;
+    (void)lowWatermark;
+    (void)cb;
+    (void)pParam;
+#endif
     return status;
 }
 
 /*! *********************************************************************************
-* \brief   Returns a specified number of characters from the Rx buffer
+* \brief   Returns the Rx error counters of an interface
 *
 * \param[in] InterfaceId the interface number
-* \param[out] pData pointer to location where to store the characters
-* \param[in] dataSize the number of characters to be read
-* \param[out] bytesRead the number of characters read
+* \param[out] pStats pointer to location where to store the counters
 *
 * \return The status of the operation
 *
 ********************************************************************************** */
-serialStatus_t Serial_Read( uint8_t InterfaceId, uint8_t *pData, uint16_t dataSize, uint16_t *bytesRead )
+serialStatus_t Serial_GetRxStatistics( uint8_t InterfaceId, serialRxStatistics_t *pStats )
 {
     serialStatus_t status = gSerial_Success_c;
 #if (gSerialManagerMaxInterfaces_c)
     serial_t *pSer = &mSerials[InterfaceId];
-    uint16_t i, bytes;
 
 #if gSerialMgr_ParamValidation_d
-    if ( (InterfaceId >= gSerialManagerMaxInterfaces_c) || (NULL == pData) || (0 == dataSize) )
+    if ( (InterfaceId >= gSerialManagerMaxInterfaces_c) || (NULL == pStats) )
     {
         status = gSerial_InvalidParameter_c;
     }
     else
 #endif
     {
-        /* Copy bytes from the SMGR Rx buffer */
-        Serial_RxBufferByteCount(InterfaceId, &bytes);
-
-        if( bytes > 0 )
-        {
-            if( bytes > dataSize )
-            {
-                bytes = dataSize;
-            }
-
-            /* Copy data */
-            for( i=0; i<bytes; i++ )
-            {
-                OSA_InterruptDisable();
-                *pData++ = pSer->rxBuffer[pSer->rxOut++];
-                if ( pSer->rxOut >= gSMRxBufSize_c )
-                {
-                    pSer->rxOut = 0;
-                }
-                OSA_InterruptEnable();
-            }
-
-            dataSize -= bytes;
-        }
+        OSA_InterruptDisable();
+        pStats->overruns = 0;
+        pStats->drops = pSer->rxDrops;
+        pStats->throttles = pSer->rxThrottles;
 
-        /* Aditional processing depending on interface */
         switch ( pSer->serialType )
         {
-#if gSerialMgrUseUSB_c
-        case gSerialMgrUSB_c:
-            VirtualCom_SMReadNotify( mDrvData[InterfaceId].pDrvData );
-            break;
-#endif
-
-#if gSerialMgrUseUSB_VNIC_c
-        case gSerialMgrUSB_VNIC_c:
-            VirtualNic_SMReadNotify( mDrvData[InterfaceId].pDrvData );
+#if gSerialMgrUseUart_c
+        case gSerialMgrUart_c:
+        case gSerialMgrLpuart_c:
+        case gSerialMgrLpsci_c:
+            pStats->overruns = mDrvData[InterfaceId].uartState.rxOverruns;
             break;
 #endif
-
-
         default:
             break;
         }
-
-        if( bytesRead )
-        {
-            *bytesRead = bytes;
-        }
+        OSA_InterruptEnable();
     }
 #else
     (void)InterfaceId;
-    (void)pData;
-    (void)dataSize;
-    bytesRead = 0;
-    (void)bytesRead;
+    (void)pStats;
 #endif
     return status;
 }
@@ -937,16 +1538,7 @@ serialStatus_t Serial_RxBufferByteCount( uint8_t InterfaceId, uint16_t *bytesCou
 #endif
     {
         OSA_InterruptDisable();
-
-        if( mSerials[InterfaceId].rxIn >= mSerials[InterfaceId].rxOut )
-        {
-            *bytesCount = mSerials[InterfaceId].rxIn - mSerials[InterfaceId].rxOut;
-        }
-        else
-        {
-            *bytesCount = gSMRxBufSize_c - mSerials[InterfaceId].rxOut + mSerials[InterfaceId].rxIn;
-        }
-
+        *bytesCount = Serial_RxCount(&mSerials[InterfaceId]);
         OSA_InterruptEnable();
     }
 #else
@@ -1051,6 +1643,7 @@ serialStatus_t Serial_SetBaudRate( uint8_t InterfaceId, uint32_t baudRate  )
 #endif
 
         case gSerialMgrCustom_c:
+        case gSerialMgrMux_c:
             /* Nothing to do here. */
             break;
 
@@ -1550,6 +2143,16 @@ static serialStatus_t Serial_WriteInternal( uint8_t InterfaceId )
         break;
 #endif
 
+#if gSerialMgrUseMux_c
+    case gSerialMgrMux_c:
+        /* The channel multiplexer calls Serial_CustomSendCompleted() when the data was sent */
+        if( SerialMux_SendData(pSer->serialChannel, pSer->txQueue[idx].pData, pSer->txQueue[idx].dataSize) )
+        {
+            status = gSerial_InternalError_c;
+        }
+        break;
+#endif
+
     default:
         status = gSerial_InternalError_c;
         break;
@@ -1584,19 +2187,33 @@ static serialStatus_t Serial_WriteInternal( uint8_t InterfaceId )
 void SerialManager_VirtualComRxNotify(uint8_t* pData, uint16_t dataSize, uint8_t interface)
 {
 
+  serial_t *pSer = &mSerials[interface];
+  bufIndex_t inIndex;
+
   while(dataSize)
   {
     OSA_InterruptDisable();
-    mSerials[interface].rxBuffer[mSerials[interface].rxIn] = *pData++;
-    mSerial_IncIdx_d(mSerials[interface].rxIn, gSMRxBufSize_c);
-    if(mSerials[interface].rxIn == mSerials[interface].rxOut)
+    pSer->rxBuffer[pSer->rxIn] = *pData++;
+    inIndex = pSer->rxIn;
+    mSerial_IncIdx_d(inIndex, pSer->rxBufSize);
+    if(inIndex == pSer->rxOut)
+    {
+      pSer->rxDrops++;
+#if !gSerialMgrLosslessRx_c
+      pSer->rxIn = inIndex;
+      mSerial_IncIdx_d(pSer->rxOut, pSer->rxBufSize);
+#endif
+    }
+    else
     {
-      mSerial_IncIdx_d(mSerials[interface].rxOut, gSMRxBufSize_c);
+      pSer->rxIn = inIndex;
     }
     OSA_InterruptEnable();
     dataSize--;
   }
 
+  Serial_RxCheckWatermarks(interface);
+
    mSerials[interface].events |= gSMGR_Rx_c;
    (void)OSA_EventSet(mSMTaskEventId, gSMGR_Rx_c);
 
@@ -1619,19 +2236,20 @@ uint16_t SerialManager_VirtualNicRxNotify(uint8_t* pData, uint16_t dataSize, uin
   bufIndex_t inIndex;
   uint16_t charReceived = 0;
   inIndex = mSerials[interface].rxIn;
-  mSerial_IncIdx_d(inIndex, gSMRxBufSize_c);
+  mSerial_IncIdx_d(inIndex, mSerials[interface].rxBufSize);
   while(dataSize && (inIndex != mSerials[interface].rxOut))
   {
     //OSA_InterruptDisable();
     mSerials[interface].rxBuffer[mSerials[interface].rxIn] = *pData++;
     mSerials[interface].rxIn = inIndex;
     charReceived++;
-    mSerial_IncIdx_d(inIndex, gSMRxBufSize_c);
+    mSerial_IncIdx_d(inIndex, mSerials[interface].rxBufSize);
     //OSA_InterruptEnable();
     dataSize--;
   }
   if(charReceived)
   {
+    Serial_RxCheckWatermarks(interface);
     mSerials[interface].events |= gSMGR_Rx_c;
     (void)OSA_EventSet(mSMTaskEventId, gSMGR_Rx_c);
   }
@@ -1656,13 +2274,25 @@ void SerialManager_RxNotify( uint32_t i )
     uint8_t rxByte = pSer->rxBuffer[pSer->rxIn];
     uint8_t slaveDapRxEnd = 0;
 #endif
+    bufIndex_t inIndex = pSer->rxIn;
 
-    mSerial_IncIdx_d(pSer->rxIn, gSMRxBufSize_c)
-    if(pSer->rxIn == pSer->rxOut)
+    mSerial_IncIdx_d(inIndex, pSer->rxBufSize)
+    if(inIndex == pSer->rxOut)
+    {
+        /* The Rx buffer is full */
+        pSer->rxDrops++;
+#if !gSerialMgrLosslessRx_c
+        pSer->rxIn = inIndex;
+        mSerial_IncIdx_d(pSer->rxOut, pSer->rxBufSize)
+#endif
+    }
+    else
     {
-        mSerial_IncIdx_d(pSer->rxOut, gSMRxBufSize_c)
+        pSer->rxIn = inIndex;
     }
 
+    Serial_RxCheckWatermarks(i);
+
     switch( pSer->serialType )
     {
         /* Uart driver is in continuous Rx. No need to restart reception. */
@@ -1935,6 +2565,301 @@ static void Serial_TxQueueMaintenance(serial_t *pSer)
     }
 }
 
+/*! *********************************************************************************
+* \brief   Interface specific processing after data was removed from the Rx buffer
+*
+* \param[in] InterfaceId the interface number
+*
+********************************************************************************** */
+static void Serial_RxReadNotify(uint8_t InterfaceId)
+{
+    /* Resume the sender if enough space was freed */
+    Serial_RxCheckWatermarks(InterfaceId);
+
+    switch ( mSerials[InterfaceId].serialType )
+    {
+#if gSerialMgrUseUSB_c
+    case gSerialMgrUSB_c:
+        VirtualCom_SMReadNotify( mDrvData[InterfaceId].pDrvData );
+        break;
+#endif
+
+#if gSerialMgrUseUSB_VNIC_c
+    case gSerialMgrUSB_VNIC_c:
+        VirtualNic_SMReadNotify( mDrvData[InterfaceId].pDrvData );
+        break;
+#endif
+
+#if gSerialMgrUseMux_c
+    case gSerialMgrMux_c:
+        SerialMux_RxConsumed( mSerials[InterfaceId].serialChannel );
+        break;
+#endif
+
+    default:
+        break;
+    }
+}
+
+#if gSerialMgrTxCoalescingBufSize_c
+/*! *********************************************************************************
+* \brief   Copies a small write into the active Tx staging buffer.
+*
+* \param[in] InterfaceId the interface number
+* \param[in] pBuf pointer to data location
+* \param[in] bufLen the number of bytes to be sent
+*
+* \return TRUE if the data was merged, FALSE if it must be sent as a separate
+*         transfer (the staged data was already sent in this case)
+*
+********************************************************************************** */
+static bool_t Serial_TxCoalesce(uint8_t InterfaceId, uint8_t *pBuf, uint16_t bufLen)
+{
+    serial_t *pSer;
+    bool_t merged = FALSE;
+    bool_t signal = FALSE;
+    bool_t fits;
+    uint8_t attempt;
+
+    if( (InterfaceId >= gSerialManagerMaxInterfaces_c) || (NULL == pBuf) || (0 == bufLen) )
+    {
+        return FALSE;
+    }
+
+    pSer = &mSerials[InterfaceId];
+
+    if( !pSer->txCoalescing || (bufLen > gSerialMgrTxCoalescingMaxWrite_c) ||
+        (bufLen > gSerialMgrTxCoalescingBufSize_c) )
+    {
+        (void)Serial_TxStagingFlush(InterfaceId);
+        return FALSE;
+    }
+
+    for( attempt = 0; attempt < 2; attempt++ )
+    {
+        /* The free space is checked in the critical section of the copy, so that
+         * concurrent writers cannot overflow the buffer. The active buffer cannot
+         * be used while it is still being transmitted */
+        OSA_InterruptDisable();
+        fits = ((pSer->txStagedLen + bufLen) <= gSerialMgrTxCoalescingBufSize_c);
+        if( fits && (0 == (pSer->txStagingBusy & (1 << pSer->txStagingIdx))) )
+        {
+            FLib_MemCpy(&pSer->txStaging[pSer->txStagingIdx][pSer->txStagedLen], pBuf, bufLen);
+            signal = (0 == pSer->txStagedLen);
+            pSer->txStagedLen += bufLen;
+            pSer->txStagedWrites++;
+            pSer->txStagedTs = OSA_TimeGetMsec();
+            pSer->txStats.mergedWrites++;
+            merged = TRUE;
+        }
+        OSA_InterruptEnable();
+
+        /* Flush on size, then try the other buffer. If the staged data could not
+         * be queued, the write is not merged and fails like the flush */
+        if( fits || (gSerial_Success_c != Serial_TxStagingFlush(InterfaceId)) )
+        {
+            break;
+        }
+    }
+
+    if( merged )
+    {
+        if( pSer->txStagedLen == gSerialMgrTxCoalescingBufSize_c )
+        {
+            (void)Serial_TxStagingFlush(InterfaceId);
+        }
+        else if( signal )
+        {
+            /* Let the SMGR task start the idle timeout */
+            OSA_InterruptDisable();
+            pSer->events |= gSMGR_TxStaged_c;
+            OSA_InterruptEnable();
+            (void)OSA_EventSet(mSMTaskEventId, gSMGR_TxStaged_c);
+        }
+    }
+
+    return merged;
+}
+
+/*! *********************************************************************************
+* \brief   Puts the active Tx staging buffer into the Tx queue, and switches to
+*          the other staging buffer.
+*
+* \param[in] InterfaceId the interface number
+*
+* \return The status of the operation: gSerial_OutOfMemory_c if the Tx queue is
+*         full, the data stays staged in this case
+*
+********************************************************************************** */
+static serialStatus_t Serial_TxStagingFlush(uint8_t InterfaceId)
+{
+    serial_t *pSer = &mSerials[InterfaceId];
+    serialSegment_t segment;
+    bool_t queued;
+    uint8_t idx;
+
+    OSA_InterruptDisable();
+    if( 0 == pSer->txStagedLen )
+    {
+        OSA_InterruptEnable();
+        return gSerial_Success_c;
+    }
+
+    idx = pSer->txStagingIdx;
+    segment.pData = pSer->txStaging[idx];
+    segment.dataSize = pSer->txStagedLen;
+    segment.releaseCb = Serial_TxStagingDone;
+    segment.pReleaseParam = (void*)(((uint32_t)InterfaceId << 1) | idx);
+
+    /* The buffer is queued in the same critical section, so that no write is merged
+     * into it afterwards. If the Tx queue is full, the data stays staged and is sent
+     * by a later flush: the SMGR task retries on its next event */
+    queued = Serial_TxQueueInsert(pSer, &segment, 1);
+    if( queued )
+    {
+        pSer->txStats.transfersSaved += pSer->txStagedWrites - 1;
+        pSer->txStats.flushes++;
+        pSer->txStagingBusy |= (1 << idx);
+        pSer->txStagingIdx = idx ^ 1;
+        pSer->txStagedLen = 0;
+        pSer->txStagedWrites = 0;
+    }
+    OSA_InterruptEnable();
+
+    if( !queued )
+    {
+        return gSerial_OutOfMemory_c;
+    }
+
+    return Serial_WriteInternal(InterfaceId);
+}
+
+/*! *********************************************************************************
+* \brief   Releases a Tx staging buffer after it was transmitted
+*
+* \param[in] param the interface number and the index of the staging buffer
+*
+********************************************************************************** */
+static void Serial_TxStagingDone(void *param)
+{
+    uint32_t InterfaceId = (uint32_t)param >> 1;
+
+    OSA_InterruptDisable();
+    mSerials[InterfaceId].txStagingBusy &= ~(1 << ((uint32_t)param & 1));
+    OSA_InterruptEnable();
+}
+
+/*! *********************************************************************************
+* \brief   Returns how long the SMGR task may wait for events, so that the
+*          staged data is sent in time
+*
+* \return The wait time in milliseconds
+*
+********************************************************************************** */
+static uint32_t Serial_TxStagingWaitTime(void)
+{
+    uint32_t i;
+
+    for( i = 0; i < gSerialManagerMaxInterfaces_c; i++ )
+    {
+        if( mSerials[i].txStagedLen )
+        {
+            return gSerialMgrTxCoalescingTimeout_c;
+        }
+    }
+    return osaWaitForever_c;
+}
+#endif /* gSerialMgrTxCoalescingBufSize_c */
+
+/*! *********************************************************************************
+* \brief   Returns the number of bytes stored into the Rx buffer.
+*          Must be called with interrupts disabled.
+*
+* \param[in] pSer pointer to the serial interface internal structure
+*
+* \return The number of bytes available
+*
+********************************************************************************** */
+static uint16_t Serial_RxCount(serial_t *pSer)
+{
+    uint16_t bytes;
+
+    if( pSer->rxIn >= pSer->rxOut )
+    {
+        bytes = pSer->rxIn - pSer->rxOut;
+    }
+    else
+    {
+        bytes = pSer->rxBufSize - pSer->rxOut + pSer->rxIn;
+    }
+    return bytes;
+}
+
+/*! *********************************************************************************
+* \brief   Throttles or resumes the sender depending on the Rx buffer fill level.
+*          The flow control hook is called inside the critical section, so that
+*          the RTS state always matches the rxThrottled flag. The application
+*          callback is called afterwards.
+*
+* \param[in] i the interface number
+*
+********************************************************************************** */
+static void Serial_RxCheckWatermarks(uint32_t i)
+{
+    serial_t *pSer = &mSerials[i];
+    uint16_t bytes;
+    uint8_t  event = 0xFF;
+
+    OSA_InterruptDisable();
+    bytes = Serial_RxCount(pSer);
+    if( !pSer->rxThrottled && (bytes >= pSer->rxHighWatermark) )
+    {
+        pSer->rxThrottled = TRUE;
+        pSer->rxThrottles++;
+        Serial_RxFlowControl(i, FALSE);
+        event = gSerialRxAboveHighWatermark_c;
+    }
+    else if( pSer->rxThrottled && (bytes <= pSer->rxLowWatermark) )
+    {
+        pSer->rxThrottled = FALSE;
+        Serial_RxFlowControl(i, TRUE);
+        event = gSerialRxBelowLowWatermark_c;
+    }
+    OSA_InterruptEnable();
+
+    if( (0xFF != event) && (NULL != pSer->rxFlowCallback) )
+    {
+        pSer->rxFlowCallback(pSer->pRxFlowParam, (serialRxFlowEvent_t)event);
+    }
+}
+
+/*! *********************************************************************************
+* \brief   Drives the flow control signal of the interface, if supported
+*
+* \param[in] i the interface number
+* \param[in] rxReady TRUE if the peer may send data, FALSE otherwise
+*
+********************************************************************************** */
+static void Serial_RxFlowControl(uint32_t i, uint8_t rxReady)
+{
+    switch ( mSerials[i].serialType )
+    {
+#if gSerialMgrUseUart_c
+    case gSerialMgrUart_c:
+        (void)UART_SetRxFlowControl(mSerials[i].serialChannel, rxReady);
+        break;
+    case gSerialMgrLpuart_c:
+        (void)LPUART_SetRxFlowControl(mSerials[i].serialChannel, rxReady);
+        break;
+    case gSerialMgrLpsci_c:
+        (void)LPSCI_SetRxFlowControl(mSerials[i].serialChannel, rxReady);
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
 /*! *********************************************************************************
 * \brief   This function will unblock the task who called Serial_SyncWrite().
 *
@@ -2179,7 +3104,7 @@ static void Serial_UartTxCb(uartState_t* state)
 }
 #endif /* #if (gSerialMgrUseUart_c) */
 
-#if gSerialMgrUseCustomInterface_c
+#if gSerialMgrUseCustomInterface_c || gSerialMgrUseMux_c
 /*! *********************************************************************************
 * \brief   This function is used for a custom interface to notify the SerialManager
 *          that the data transfer has ended
@@ -2207,22 +3132,24 @@ uint32_t Serial_CustomReceiveData(uint8_t InterfaceId, uint8_t *pRxData, uint32_
 {
     serial_t *pSer = &mSerials[InterfaceId];
 
-    while(size--)
+    while(size)
     {
         OSA_InterruptDisable();
         pSer->rxBuffer[pSer->rxIn] = *pRxData++;
-        mSerial_IncIdx_d(pSer->rxIn, gSMRxBufSize_c);
+        mSerial_IncIdx_d(pSer->rxIn, pSer->rxBufSize);
         /* Check for overflow */
         if(pSer->rxIn == pSer->rxOut)
         {
-            mSerial_DecIdx_d(pSer->rxIn, gSMRxBufSize_c);
+            mSerial_DecIdx_d(pSer->rxIn, pSer->rxBufSize);
             OSA_InterruptEnable();
-            size++;
             break;
         }
         OSA_InterruptEnable();
+        size--;
     }
 
+    Serial_RxCheckWatermarks(InterfaceId);
+
     /* Signal SMGR task if not allready done */
     pSer->events |= gSMGR_Rx_c;
     (void)OSA_EventSet(mSMTaskEventId, gSMGR_Rx_c);
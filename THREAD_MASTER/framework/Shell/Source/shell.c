@@ -44,6 +44,10 @@
 #include "SerialManager.h"
 #include "MemManager.h"
 #include "board.h"
+#include "fsl_os_abstraction.h"
+#if SHELL_ASYNC_OUTPUT
+#include "TimersManager.h"
+#endif
 
 #if SHELL_ENABLED
 /************************************************************************************
@@ -56,6 +60,9 @@
 #define DEL                     ((char)255)
 #define DEL7                    ((char)127)
 
+/* Delay before sending the output again, when the Serial Manager Tx queue was full */
+#define mShellOutRetryMs_c      (2)
+
 /* Move cursor at the beginning of the line */
 #define BEGINNING_OF_LINE()             \
 while( mCmdIdx ) {                      \
@@ -85,8 +92,19 @@ if( mCmdIdx < mCmdLen )                                 \
 *************************************************************************************
 ************************************************************************************/
 static void shell_main( void *params );
+static void shell_ProcessLine( int16_t ret );
 static int16_t shell_ProcessChr( void );
+static uint16_t shell_RunLength( uint8_t *pData, uint16_t size, bool_t printable );
+static int16_t shell_EditChr( char ichar );
 static void shell_erase_to_eol( void );
+static uint16_t shell_cmd_slot( const char *name );
+static void shell_cmd_index_rebuild( void );
+static void shell_out( uint8_t *pData, uint16_t n );
+#if SHELL_ASYNC_OUTPUT
+static void shell_out_kick( void );
+static void shell_out_tx_done( void *params );
+static void shell_out_retry( void *params );
+#endif
 
 /************************************************************************************
 *************************************************************************************
@@ -97,6 +115,11 @@ static char*    pPrompt;
 static char     mCmdBuf[SHELL_CB_SIZE + 1];
 static uint16_t mCmdLen;
 static uint16_t mCmdIdx;
+static uint8_t  mEscLen;
+static char     mLineEndPair;   /* the character which may follow the last line end */
+static bool_t   mRawMode;       /* no echo, line editing or history */
+static bool_t   mRawOverflow;   /* the current raw line is too long, it is discarded */
+static bool_t   mLineShown;     /* the prompt and the edited line are displayed */
 uint8_t  gShellSerMgrIf;
 
 uint8_t  mInsert = 1;
@@ -104,9 +127,34 @@ uint8_t  mShellMaxCmdLen = 0;
 
 cmd_tbl_t *gpCmdTable[SHELL_MAX_COMMANDS];
 
-int8_t (*mpfShellBreak)(uint8_t argc, char * argv[]) = NULL;
+/* Open addressing hash index of gpCmdTable, by command name. An entry holds the
+   gpCmdTable index + 1, 0 marks a free entry. At least half of it stays free */
+#define SHELL_CMD_INDEX_SIZE    (2 * SHELL_MAX_COMMANDS + 1)
+#if SHELL_MAX_COMMANDS > 254
+#error "SHELL_MAX_COMMANDS must be less than 255"
+#endif
+static uint8_t mShellCmdIndex[SHELL_CMD_INDEX_SIZE];
+
+static pfShellFallback_t mpfShellFallback = NULL;
+
 void (*pfShellProcessCommand) (char * pCmd, uint16_t length) = NULL;
 
+#if SHELL_ASYNC_OUTPUT
+/* Output ring buffer. The oldest bytes are sent in contiguous chunks, one
+   chunk (mShellOutSending bytes) at a time */
+static uint8_t           mShellOutBuf[SHELL_OUT_BUF_SIZE];
+static uint16_t          mShellOutHead;
+static uint16_t          mShellOutCount;
+static uint16_t          mShellOutSending;
+static shellOutStats_t   mShellOutStats;
+static tmrTimerID_t      mShellOutRetryTmr = gTmrInvalidTimerID_c;
+#if SHELL_OUT_FULL_POLICY == SHELL_OUT_BLOCK
+/* The Serial Manager task runs the Rx and Tx callbacks, so it cannot wait for space */
+static osaTaskId_t       mShellSerMgrTaskId;
+extern const uint8_t     gUseRtos_c;
+#endif
+#endif
+
 #if SHELL_USE_LOGO
 const char mLogo[] = "\n\n\r\n"
        " ####         ######      ##### ##########    \n\r"
@@ -136,6 +184,16 @@ extern int8_t cmd_auto_complete(char * prompt, char * buf, uint8_t * np, uint8_t
 extern uint8_t cmd_auto_complete2(char *buf, uint8_t);
 #endif
 
+#if (SHELL_USE_AUTO_COMPLETE || SHELL_USE_HELP)
+extern void cmd_trie_rebuild(void);
+extern void cmd_trie_insert(uint8_t idx);
+#endif
+
+extern void job_init(void);
+extern void job_prepare(void);
+extern void job_command_done(int8_t ret, int8_t (*pfCmd)(uint8_t argc, char * argv[]), char *pName);
+extern bool_t job_cancel(uint8_t jobId);
+
 #if SHELL_MAX_HIST
 extern void hist_init(void);
 extern void hist_add(char * line);
@@ -177,13 +235,21 @@ void shell_init(char* prompt)
     mCmdLen = 0;
     mCmdIdx = 0;
     FLib_MemSet(gpCmdTable, 0, sizeof(gpCmdTable));
+    FLib_MemSet(mShellCmdIndex, 0, sizeof(mShellCmdIndex));
     FLib_MemSet(mCmdBuf, 0, sizeof(mCmdBuf));
+#if (SHELL_USE_AUTO_COMPLETE || SHELL_USE_HELP)
+    cmd_trie_rebuild();
+#endif
 #if SHELL_USE_HELP
     shell_register_function(&CommandFun_Help);
     shell_register_function(&CommandFun_Ver);
 #endif
 #if SHELL_MAX_HIST
     hist_init();
+#endif
+    job_init();
+#if SHELL_ASYNC_OUTPUT
+    mShellOutRetryTmr = TMR_AllocateTimer();
 #endif
 #if SHELL_USE_LOGO
     shell_write((char*)mLogo);
@@ -191,6 +257,7 @@ void shell_init(char* prompt)
     shell_write(__DATE__);
     shell_write("\n\rCopyright (c) 2016 NXP Semiconductors\r\n");
     shell_write(pPrompt);
+    mLineShown = TRUE;
 #endif
 }
 
@@ -208,18 +275,6 @@ void shell_change_prompt(char* prompt)
     shell_refresh();
 }
 
-/*! *********************************************************************************
-* \brief  Notify shell that the async command has finished
-*
-********************************************************************************** */
-void shell_cmd_finished(void)
-{
-    mpfShellBreak = NULL;
-    SHELL_RESET();
-    SHELL_NEWLINE();
-    shell_write(pPrompt);
-}
-
 /*! *********************************************************************************
 * \brief  Empty command buffer and print command prompt
 *
@@ -231,6 +286,7 @@ void shell_refresh(void)
     SHELL_NEWLINE();
 #if !gHybridApp_d
     shell_write(pPrompt);
+    mLineShown = TRUE;
 #endif
 #endif
 }
@@ -262,13 +318,13 @@ void shell_writeN(char *pBuff, uint16_t n)
             pHdr[3] = n;
             FLib_MemCpy(&pHdr[4], pBuff, n);
             pHdr[4+n] = 0;
-            Serial_SyncWrite( gShellSerMgrIf, pHdr, n+5 );
+            shell_out( pHdr, n+5 );
             MEM_BufferFree(pHdr);
         }
     }
     else
     {
-        Serial_SyncWrite(gShellSerMgrIf, (uint8_t*)pBuff, n);
+        shell_out((uint8_t*)pBuff, n);
     }
 }
 
@@ -295,7 +351,7 @@ void shell_write( char *pBuff )
 ********************************************************************************** */
 void shell_putc(char c)
 {
-    Serial_SyncWrite(gShellSerMgrIf, (uint8_t*)&c, 1);
+    shell_writeN(&c, 1);
 }
 
 /*! *********************************************************************************
@@ -311,7 +367,21 @@ void shell_writeDec
     uint32_t nb
 )
 {
+#if SHELL_ASYNC_OUTPUT
+    /* Serial_PrintDec() would bypass the output buffer */
+    char decString[10];
+    uint8_t i = sizeof(decString);
+
+    do
+    {
+        decString[--i] = '0' + (char)(nb % 10);
+        nb = nb / 10;
+    } while( nb );
+
+    shell_writeN(&decString[i], sizeof(decString) - i);
+#else
     Serial_PrintDec(gShellSerMgrIf, nb);
+#endif
 }
 
 /*! *********************************************************************************
@@ -333,7 +403,7 @@ void shell_writeSignedDec
         shell_write("-");
         nb = ~(nb - 1);
     }
-    Serial_PrintDec(gShellSerMgrIf, nb);
+    shell_writeDec((uint8_t)nb);
 }
 
 /*! *********************************************************************************
@@ -351,7 +421,19 @@ void shell_writeHex
     uint8_t len
 )
 {
+#if SHELL_ASYNC_OUTPUT
+    char hexString[2];
+
+    while( len-- )
+    {
+        hexString[0] = HexToAscii(*pHex >> 4);
+        hexString[1] = HexToAscii(*pHex);
+        shell_writeN(hexString, 2);
+        pHex++;
+    }
+#else
     Serial_PrintHex(gShellSerMgrIf, pHex, len, gPrtHexBigEndian_c);
+#endif
 }
 
 /*! *********************************************************************************
@@ -369,7 +451,11 @@ void shell_writeHexLe
     uint8_t len
 )
 {
+#if SHELL_ASYNC_OUTPUT
+    shell_writeHex(pHex, len);
+#else
     Serial_PrintHex(gShellSerMgrIf, pHex, len, gPrtHexNoFormat_c);
+#endif
 }
 
 /*! *********************************************************************************
@@ -420,12 +506,43 @@ uint16_t shell_printf(char * format,...)
     va_start(ap, format);
     n = vsnprintf(pStr, SHELL_CB_SIZE, format, ap);
     //va_end(ap); /* follow MISRA... */
-    Serial_SyncWrite(gShellSerMgrIf, (uint8_t*)pStr, n);
+    if( n >= SHELL_CB_SIZE )
+    {
+        /* The output was truncated */
+        n = SHELL_CB_SIZE - 1;
+    }
+    shell_writeN(pStr, n);
     MEM_BufferFree(pStr);
     return n;
 }
 #endif
 
+/*! *********************************************************************************
+* \brief  This function returns the statistics of the asynchronous output
+*
+* \param[out] pStats pointer to the location where the statistics are copied
+* \param[in]  clear  if TRUE, the statistics are reset after they were read
+*
+* \remarks All the values are 0 if SHELL_ASYNC_OUTPUT is disabled
+*
+********************************************************************************** */
+void shell_get_output_stats(shellOutStats_t *pStats, bool_t clear)
+{
+#if SHELL_ASYNC_OUTPUT
+    OSA_InterruptDisable();
+    FLib_MemCpy(pStats, &mShellOutStats, sizeof(shellOutStats_t));
+    if( clear )
+    {
+        FLib_MemSet(&mShellOutStats, 0, sizeof(shellOutStats_t));
+        mShellOutStats.maxUsed = mShellOutCount;
+    }
+    OSA_InterruptEnable();
+#else
+    (void)clear;
+    FLib_MemSet(pStats, 0, sizeof(shellOutStats_t));
+#endif
+}
+
 /*! *********************************************************************************
 * \brief  This function registers a command into the SHELL
 *
@@ -437,13 +554,12 @@ uint16_t shell_printf(char * format,...)
 uint8_t shell_register_function(cmd_tbl_t * pAddress)
 {
     uint16_t i;
+    uint16_t slot = shell_cmd_slot(pAddress->name);
+
     /* check name conflict */
-    for(i = 0; i< SHELL_MAX_COMMANDS; i++)
+    if( mShellCmdIndex[slot] )
     {
-        if( gpCmdTable[i] && !strcmp(pAddress->name, gpCmdTable[i]->name) )
-        {
-            return 1;
-        }
+        return 1;
     }
     /* insert */
     for (i = 0; i< SHELL_MAX_COMMANDS; i++)
@@ -451,6 +567,10 @@ uint8_t shell_register_function(cmd_tbl_t * pAddress)
         if (gpCmdTable[i] == NULL)
         {
             gpCmdTable[i] =  pAddress;
+            mShellCmdIndex[slot] = i + 1;
+#if (SHELL_USE_AUTO_COMPLETE || SHELL_USE_HELP)
+            cmd_trie_insert(i);
+#endif
             // Update max command length
             i = strlen(pAddress->name);
             if( i > mShellMaxCmdLen )
@@ -488,19 +608,88 @@ void shell_register_function_array(cmd_tbl_t * pAddress, uint8_t num)
 *
 ********************************************************************************** */
 uint8_t shell_unregister_function(char * name)
+{
+    uint8_t idx = mShellCmdIndex[shell_cmd_slot(name)];
+
+    if( !idx )
+    {
+        return 1;
+    }
+
+    gpCmdTable[idx - 1] = NULL;
+    /* Removing a single entry could break the probe sequence of other commands */
+    shell_cmd_index_rebuild();
+#if (SHELL_USE_AUTO_COMPLETE || SHELL_USE_HELP)
+    cmd_trie_rebuild();
+#endif
+
+    return 0;
+}
+
+/*! *********************************************************************************
+* \brief  Enables or disables the raw line mode, for machine clients: the received
+*         lines are executed as they are, without echo, line editing or history
+*
+* \param[in]  enable TRUE to enable the raw line mode
+*
+* \remarks Only the line ends and ^C are processed. The lines longer than
+*          SHELL_CB_SIZE are discarded.
+*
+********************************************************************************** */
+void shell_set_raw_mode(bool_t enable)
+{
+    mRawMode = enable;
+    mRawOverflow = FALSE;
+    mEscLen = 0;
+}
+
+/*! *********************************************************************************
+* \brief  This function registers the handler of the lines which do not start
+*         with a registered command. Without a handler, an error is displayed.
+*
+* \param[in]  pfFallback pointer to the handler, or NULL to remove it
+*
+* \remarks The handler is called like a command, and returns a command_ret_t value
+*
+********************************************************************************** */
+void shell_register_fallback(pfShellFallback_t pfFallback)
+{
+    mpfShellFallback = pfFallback;
+}
+
+/*! *********************************************************************************
+* \brief  Prepares the terminal for a line which is not the output of the command
+*         being executed, like the output of a job: the line starts below the prompt
+*
+********************************************************************************** */
+void shell_async_line_begin(void)
+{
+    if( mLineShown )
+    {
+        SHELL_NEWLINE();
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Displays again the prompt and the edited line, after shell_async_line_begin()
+*
+********************************************************************************** */
+void shell_async_line_end(void)
 {
     uint16_t i;
 
-    for( i=0; i<SHELL_MAX_COMMANDS; i++ )
+    if( mLineShown )
     {
-        if( gpCmdTable[i] && !strcmp(name, gpCmdTable[i]->name) )
+        shell_write(pPrompt);
+        if( !mRawMode )
         {
-            gpCmdTable[i] = NULL;
-            return 0;
+            shell_writeN(mCmdBuf, mCmdLen);
+            for( i = mCmdIdx; i < mCmdLen; i++ )
+            {
+                shell_putc(CTL_BACKSPACE);
+            }
         }
     }
-
-    return 1;
 }
 
 /*! *********************************************************************************
@@ -556,30 +745,16 @@ char * shell_get_opt
 ********************************************************************************** */
 cmd_tbl_t * shell_find_command (char * cmd)
 {
-    uint16_t i;
+    uint8_t idx;
 
     if( !cmd )
     {
         return NULL;
     }
 
-    for( i=0; i < SHELL_MAX_COMMANDS; i++)
-    {
-        if( (gpCmdTable[i] != NULL) && !strcmp((char*)cmd, gpCmdTable[i]->name) )
-        {
-            return gpCmdTable[i];
-        }
-    }
+    idx = mShellCmdIndex[shell_cmd_slot(cmd)];
 
-    if (!strcmp((char*)cmd, "G0"))
-    {
-    	APP_GetActiveSlaves(NULL);
-    }
-    else
-    {
-    	APP_SerialCommand(cmd);
-    }
-    return NULL;
+    return idx ? gpCmdTable[idx - 1] : NULL;
 }
 
 /*! *********************************************************************************
@@ -631,7 +806,7 @@ uint8_t make_argv(char *s, uint8_t argvsz, char * argv[])
 ************************************************************************************/
 
 /*! *********************************************************************************
-* \brief  This function is called every time a character is received.
+* \brief  This function is called every time characters are received.
 *         The main SHELL processing is done from here
 *
 * \param [in]   params       unused
@@ -640,23 +815,42 @@ uint8_t make_argv(char *s, uint8_t argvsz, char * argv[])
 static void shell_main( void *params )
 {
     int16_t ret;
+
+#if SHELL_ASYNC_OUTPUT && (SHELL_OUT_FULL_POLICY == SHELL_OUT_BLOCK)
+    mShellSerMgrTaskId = OSA_TaskGetId();
+#endif
+    // Process all the lines received
+    while( (ret = shell_ProcessChr()) != -2 )
+    {
+        shell_ProcessLine(ret);
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Executes the command line, or handles the ^C
+*
+* \param [in]   ret      the return value of shell_ProcessChr()
+*
+********************************************************************************** */
+static void shell_ProcessLine( int16_t ret )
+{
     uint8_t argc;
     char * argv[SHELL_MAX_ARGS+1];    /* NULL terminated  */
     cmd_tbl_t * cmdtp;
 
-    // Process the received char
-    ret = shell_ProcessChr();
-    
     if( ret == 0 )
     {
         if( mCmdLen == 0 )
         {
             SHELL_RESET();
-            if( !mpfShellBreak )
-                shell_write(pPrompt);
+            shell_write(pPrompt);
+            mLineShown = TRUE;
             return;
         }
-        
+
+        /* The output of the command follows the line */
+        mLineShown = FALSE;
+
         if( pfShellProcessCommand )
         {
             pfShellProcessCommand(mCmdBuf, mCmdLen);
@@ -673,6 +867,7 @@ static void shell_main( void *params )
             }
             // Search for the appropriate command
             cmdtp = shell_find_command(argv[0]);
+            job_prepare();
 
             if ((cmdtp != NULL) && (cmdtp->cmd != NULL))
             {
@@ -685,9 +880,14 @@ static void shell_main( void *params )
                     ret = (cmdtp->cmd)(argc, argv);
                 }
             }
+            else if( argc && mpfShellFallback )
+            {
+                /* Let the application handle the line */
+                cmdtp = NULL;
+                ret = mpfShellFallback(argc, argv);
+            }
             else
             {
-            	/*
                 shell_write("Unknown command '");
                 shell_write(argv[0]);
 #if SHELL_USE_HELP
@@ -695,10 +895,9 @@ static void shell_main( void *params )
 #else
                 shell_write("' ");
 #endif
-				*/
             }
 #if SHELL_USE_HELP
-            if( ret == CMD_RET_USAGE )
+            if( (ret == CMD_RET_USAGE) && cmdtp )
             {
                 if( cmdtp->usage != NULL )
                 {
@@ -721,25 +920,18 @@ static void shell_main( void *params )
                 }
             }
 #endif
-            if( ret == CMD_RET_ASYNC )
-            {
-                mpfShellBreak = cmdtp->cmd;
-                SHELL_RESET();
-            }
-            else
-            {
-                mpfShellBreak = NULL;
-                shell_refresh();
-            }
+            /* An asynchronous command goes on as a job, the console is available again */
+            job_command_done(ret, cmdtp ? cmdtp->cmd : mpfShellFallback, cmdtp ? cmdtp->name : NULL);
+            shell_refresh();
         }
     }
     else if (ret == -1)
     {
         shell_write("<INTERRUPT>\r\n");
-        if( mpfShellBreak )
+        mLineShown = FALSE;
+        /* Cancel the most recent job */
+        if( job_cancel(0) )
         {
-            mpfShellBreak(0,0);
-            mpfShellBreak = NULL;
             shell_refresh();
         }
         SHELL_RESET();
@@ -751,267 +943,457 @@ static void shell_main( void *params )
 }
 
 /*! *********************************************************************************
-* \brief  This function is called to process the received character
+* \brief  This function is called to process the received characters, until the
+*         end of a line or until the Rx buffer is empty
 *
 * \return       uint16_t     0 - comand received complete
 *                           -1 - CTRL + C was pressed
-*                           -2 - new character received
+*                           -2 - all the received characters were processed
 *
 ********************************************************************************** */
 static int16_t shell_ProcessChr( void )
 {
-    uint16_t wlen;
+    uint8_t *pData;
+    uint16_t size;
+    uint16_t used;
+    uint16_t run;
     char ichar;
-    static uint8_t esc_len = 0;
-//    static char esc_save[4];
+    char pair;
+    int16_t ret = -2;
 
-    while( 1 ) 
+    /* Scan the Rx buffer in place, one contiguous block at a time */
+    while( (ret == -2) &&
+           (gSerial_Success_c == Serial_RxPeek(gShellSerMgrIf, &pData, &size)) && size )
     {
-        Serial_Read( gShellSerMgrIf, (uint8_t*)&ichar, 1, &wlen );
-
-        if( !wlen )
-            return -2;
+        used = 0;
 
-        if( (ichar == '\n') || (ichar == '\r') ) 
+        while( (ret == -2) && (used < size) )
         {
-            Serial_Read( gShellSerMgrIf, (uint8_t*)&ichar, 1, &wlen );
-            SHELL_NEWLINE();
-            break;
-        }
+            ichar = (char)pData[used];
 
-        /* handle standard linux xterm esc sequences for arrow key, etc.*/
-        if (esc_len != 0)
-        {
-            if (esc_len == 1) 
+            /* Skip the second character of a "\r\n" or "\n\r" line end */
+            pair = mLineEndPair;
+            mLineEndPair = 0;
+            if( pair && (ichar == pair) )
             {
-                if (ichar == '[')
+                used++;
+                continue;
+            }
+
+            if( (ichar == '\n') || (ichar == '\r') )
+            {
+                mLineEndPair = (ichar == '\r') ? '\n' : '\r';
+                used++;
+                if( mRawMode )
                 {
-//                    esc_save[esc_len] = ichar;
-                    esc_len++;
-                } 
+                    if( mRawOverflow )
+                    {
+                        /* Discard the line */
+                        mRawOverflow = FALSE;
+                        SHELL_RESET();
+                    }
+                }
                 else
                 {
-//                    cread_add_str(esc_save, esc_len, mInsert, &mCmdIdx, &mCmdLen, mCmdBuf, mCmdLen);
-                    esc_len = 0;
+                    SHELL_NEWLINE();
                 }
-                continue;
+                ret = 0;
+            }
+            else if( mRawMode )
+            {
+                if( ichar == CTL_CH('c') )
+                {
+                    used++;
+                    mRawOverflow = FALSE;
+                    SHELL_RESET();
+                    ret = -1;
+                    break;
+                }
+
+                /* Copy everything up to the end of the line */
+                run = shell_RunLength(&pData[used], size - used, FALSE);
+                if( mRawOverflow || (run > SHELL_CB_SIZE - mCmdLen) )
+                {
+                    mRawOverflow = TRUE;
+                }
+                else
+                {
+                    FLib_MemCpy(&mCmdBuf[mCmdLen], &pData[used], run);
+                    mCmdLen += run;
+                    mCmdIdx = mCmdLen;
+                }
+                used += run;
             }
+            else if( (mEscLen == 0) && (mCmdIdx == mCmdLen) &&
+                     (run = shell_RunLength(&pData[used], size - used, TRUE)) )
+            {
+                /* Printable characters typed at the end of the line */
+                if( run > SHELL_CB_SIZE - mCmdLen )
+                {
+                    run = SHELL_CB_SIZE - mCmdLen;
+                }
+                FLib_MemCpy(&mCmdBuf[mCmdLen], &pData[used], run);
+#if SHELL_USE_ECHO
+                shell_writeN(&mCmdBuf[mCmdLen], run);
+#endif
+                mCmdLen += run;
+                mCmdIdx = mCmdLen;
+                used += run;
 
-            switch (ichar) 
+                /* Check if the received command exceeds he size of the buffer */
+                if( mCmdLen >= SHELL_CB_SIZE )
+                {
+                    SHELL_RESET();
+                }
+            }
+            else
             {
-            case 'D':   /* <- key */
-                ichar = CTL_CH('b');
-                esc_len = 0;
-                break;
-            case 'C':   /* -> key */
-                ichar = CTL_CH('f');
-                esc_len = 0;
-                break;  /* pass off to ^F handler */
-            case 'H':   /* Home key */
-                ichar = CTL_CH('a');
-                esc_len = 0;
-                break;  /* pass off to ^A handler */
-            case 'A':   /* up arrow */
-                ichar = CTL_CH('p');
-                esc_len = 0;
-                break;  /* pass off to ^P handler */
-            case 'B':   /* down arrow */
-                ichar = CTL_CH('n');
-                esc_len = 0;
-                break;  /* pass off to ^N handler */
-            default:
-//                esc_save[esc_len] = ichar;
-                esc_len++;
-//                cread_add_str(esc_save, esc_len, mInsert, &mCmdIdx, &mCmdLen, mCmdBuf, mCmdLen);
-                esc_len = 0;
-                continue;
+                used++;
+                ret = shell_EditChr(ichar);
             }
         }
 
-        switch (ichar)
+        (void)Serial_RxConsume(gShellSerMgrIf, used);
+    }
+
+    if( ret == 0 )
+    {
+        mCmdBuf[mCmdLen] = '\0';    /* lose the newline */
+#if SHELL_MAX_HIST
+        if( !mRawMode )
+        {
+            hist_add(mCmdBuf);
+        }
+#endif
+    }
+
+    return ret;
+}
+
+/*! *********************************************************************************
+* \brief  Returns the number of characters which can be copied as they are into the
+*         command buffer: printable characters, or anything but a line end or ^C
+*
+* \param [in]   pData      pointer to the received characters
+* \param [in]   size       number of received characters
+* \param [in]   printable  TRUE to stop at the first character which is not printable
+*
+* \return       uint16_t   the number of characters
+*
+********************************************************************************** */
+static uint16_t shell_RunLength( uint8_t *pData, uint16_t size, bool_t printable )
+{
+    uint16_t i;
+
+    for( i = 0; i < size; i++ )
+    {
+        if( printable ? ((pData[i] < ' ') || (pData[i] >= (uint8_t)DEL7)) :
+                        ((pData[i] == '\n') || (pData[i] == '\r') || (pData[i] == CTL_CH('c'))) )
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/*! *********************************************************************************
+* \brief  Line editor: processes one received character, other than a line end
+*
+* \param [in]   ichar    the received character
+*
+* \return       int16_t  -1 - CTRL + C was pressed
+*                        -2 - the character was processed
+*
+********************************************************************************** */
+static int16_t shell_EditChr( char ichar )
+{
+    uint16_t wlen;
+
+    /* handle standard linux xterm esc sequences for arrow key, etc.*/
+    if (mEscLen != 0)
+    {
+        if (mEscLen == 1) 
         {
-        case 0x1b:
-            if (esc_len == 0) 
+            if (ichar == '[')
             {
-//                esc_save[esc_len] = ichar;
-                esc_len++;
-            }
-            else 
+//                    esc_save[mEscLen] = ichar;
+                mEscLen++;
+            } 
+            else
             {
-                shell_write("impossible condition #876\n");
-                esc_len = 0;
+//                    cread_add_str(esc_save, mEscLen, mInsert, &mCmdIdx, &mCmdLen, mCmdBuf, mCmdLen);
+                mEscLen = 0;
             }
+            return -2;
+        }
+
+        switch (ichar) 
+        {
+        case 'D':   /* <- key */
+            ichar = CTL_CH('b');
+            mEscLen = 0;
             break;
-        case CTL_CH('a'):
-            BEGINNING_OF_LINE();
-            break;
-        case CTL_CH('c'):   /* ^C - break */
-            SHELL_RESET();
-            return (-1);
-            break; /* have to follow MISRA */
-        case CTL_CH('f'):
-            if( mCmdIdx < mCmdLen )
+        case 'C':   /* -> key */
+            ichar = CTL_CH('f');
+            mEscLen = 0;
+            break;  /* pass off to ^F handler */
+        case 'H':   /* Home key */
+            ichar = CTL_CH('a');
+            mEscLen = 0;
+            break;  /* pass off to ^A handler */
+        case 'A':   /* up arrow */
+            ichar = CTL_CH('p');
+            mEscLen = 0;
+            break;  /* pass off to ^P handler */
+        case 'B':   /* down arrow */
+            ichar = CTL_CH('n');
+            mEscLen = 0;
+            break;  /* pass off to ^N handler */
+        default:
+//                esc_save[mEscLen] = ichar;
+            mEscLen++;
+//                cread_add_str(esc_save, mEscLen, mInsert, &mCmdIdx, &mCmdLen, mCmdBuf, mCmdLen);
+            mEscLen = 0;
+            return -2;
+        }
+    }
+
+    switch (ichar)
+    {
+    case 0x1b:
+        if (mEscLen == 0) 
+        {
+//                esc_save[mEscLen] = ichar;
+            mEscLen++;
+        }
+        else 
+        {
+            shell_write("impossible condition #876\n");
+            mEscLen = 0;
+        }
+        break;
+    case CTL_CH('a'):
+        BEGINNING_OF_LINE();
+        break;
+    case CTL_CH('c'):   /* ^C - break */
+        SHELL_RESET();
+        return (-1);
+        break; /* have to follow MISRA */
+    case CTL_CH('f'):
+        if( mCmdIdx < mCmdLen )
+        {
+            shell_putc(mCmdBuf[mCmdIdx]);
+            mCmdIdx++;
+        }
+        break;
+    case CTL_CH('b'):
+        if( mCmdIdx )
+        {
+            shell_putc(CTL_BACKSPACE);
+            mCmdIdx--;
+        }
+        break;
+    case CTL_CH('d'):
+        if (mCmdIdx < mCmdLen)
+        {
+            wlen = mCmdLen - mCmdIdx - 1;
+            if (wlen)
             {
-                shell_putc(mCmdBuf[mCmdIdx]);
-                mCmdIdx++;
+                FLib_MemInPlaceCpy(&mCmdBuf[mCmdIdx],&mCmdBuf[mCmdIdx+1],wlen);
+                shell_writeN(mCmdBuf + mCmdIdx, wlen);
             }
-            break;
-        case CTL_CH('b'):
-            if( mCmdIdx )
+            shell_putc(' ');
+            do 
             {
                 shell_putc(CTL_BACKSPACE);
-                mCmdIdx--;
-            }
-            break;
-        case CTL_CH('d'):
-            if (mCmdIdx < mCmdLen)
+            } while (wlen--);
+            mCmdLen--;
+        }
+        break;
+    case CTL_CH('k'):
+        shell_erase_to_eol();
+        break;
+    case CTL_CH('e'):
+        REFRESH_TO_EOL();
+        break;
+    case CTL_CH('o'):
+        mInsert = !mInsert;
+        break;
+    case CTL_CH('x'):
+    case CTL_CH('u'):
+        BEGINNING_OF_LINE();
+        shell_erase_to_eol();
+        break;
+    case DEL:
+    case DEL7:
+    case 8:
+        if (mCmdIdx)
+        {
+            wlen = mCmdLen - mCmdIdx;
+            mCmdIdx--;
+            FLib_MemInPlaceCpy(&mCmdBuf[mCmdIdx], &mCmdBuf[mCmdIdx+1], wlen);
+            shell_putc(CTL_BACKSPACE);
+            shell_writeN(mCmdBuf + mCmdIdx, wlen);
+            shell_putc(' ');
+            do
             {
-                wlen = mCmdLen - mCmdIdx - 1;
-                if (wlen)
-                {
-                    FLib_MemInPlaceCpy(&mCmdBuf[mCmdIdx],&mCmdBuf[mCmdIdx+1],wlen);
-                    shell_writeN(mCmdBuf + mCmdIdx, wlen);
-                }
-                shell_putc(' ');
-                do 
-                {
-                    shell_putc(CTL_BACKSPACE);
-                } while (wlen--);
-                mCmdLen--;
+                shell_putc(CTL_BACKSPACE);
+            } while (wlen--);
+            mCmdLen--;
+        }
+        break;
+        
+    case CTL_CH('p'):
+    case CTL_CH('n'):
+        {
+#if SHELL_MAX_HIST
+            char *hline;
+            mEscLen = 0;
+            if (ichar == CTL_CH('p'))
+            {
+                hline = hist_prev();
             }
-            break;
-        case CTL_CH('k'):
-            shell_erase_to_eol();
-            break;
-        case CTL_CH('e'):
-            REFRESH_TO_EOL();
-            break;
-        case CTL_CH('o'):
-            mInsert = !mInsert;
-            break;
-        case CTL_CH('x'):
-        case CTL_CH('u'):
-            BEGINNING_OF_LINE();
-            shell_erase_to_eol();
-            break;
-        case DEL:
-        case DEL7:
-        case 8:
-            if (mCmdIdx)
+            else
             {
-                wlen = mCmdLen - mCmdIdx;
-                mCmdIdx--;
-                FLib_MemInPlaceCpy(&mCmdBuf[mCmdIdx], &mCmdBuf[mCmdIdx+1], wlen);
-                shell_putc(CTL_BACKSPACE);
-                shell_writeN(mCmdBuf + mCmdIdx, wlen);
-                shell_putc(' ');
-                do
-                {
-                    shell_putc(CTL_BACKSPACE);
-                } while (wlen--);
-                mCmdLen--;
+                hline = hist_next();
             }
-            break;
-            
-        case CTL_CH('p'):
-        case CTL_CH('n'):
+            if (!hline)
             {
-#if SHELL_MAX_HIST
-                char *hline;
-                esc_len = 0;
-                if (ichar == CTL_CH('p'))
-                {
-                    hline = hist_prev();
-                }
-                else
-                {
-                    hline = hist_next();
-                }
-                if (!hline)
-                {
-                    SHELL_BEEP();
-                    continue;
-                }
-                /* nuke the current line */
-                /* first, go home */
-                BEGINNING_OF_LINE();
-                shell_erase_to_eol();
-                /* copy new line into place and display */
-                strcpy(mCmdBuf, hline);
-                mCmdLen = strlen(mCmdBuf);
-                REFRESH_TO_EOL();
-#endif /* SHELL_CONFIG_USE_HIST */
-                continue;
-                break; /* have to follow MISRA */
+                SHELL_BEEP();
+                return -2;
             }
+            /* nuke the current line */
+            /* first, go home */
+            BEGINNING_OF_LINE();
+            shell_erase_to_eol();
+            /* copy new line into place and display */
+            strcpy(mCmdBuf, hline);
+            mCmdLen = strlen(mCmdBuf);
+            REFRESH_TO_EOL();
+#endif /* SHELL_CONFIG_USE_HIST */
+            return -2;
+            break; /* have to follow MISRA */
+        }
 
-        case '\t': 
+    case '\t': 
 #if SHELL_USE_AUTO_COMPLETE
+        {
+            uint16_t col;
+            /* do not autocomplete when in the middle */
+            if (mCmdIdx < mCmdLen)
             {
-                uint16_t col;
-                /* do not autocomplete when in the middle */
-                if (mCmdIdx < mCmdLen)
-                {
-                    SHELL_BEEP();
-                    break;
-                }
-                mCmdBuf[mCmdIdx] = '\0';
-                col = strlen(pPrompt) + mCmdLen;
-                wlen = mCmdIdx;
-                if( cmd_auto_complete(pPrompt, mCmdBuf, (uint8_t*)&wlen, (uint8_t*)&col) )
-                {
-                    col = wlen - mCmdIdx;
-                    mCmdIdx += col;
-                    mCmdLen += col;
-                }
+                SHELL_BEEP();
                 break;
             }
-#else
+            mCmdBuf[mCmdIdx] = '\0';
+            col = strlen(pPrompt) + mCmdLen;
+            wlen = mCmdIdx;
+            if( cmd_auto_complete(pPrompt, mCmdBuf, (uint8_t*)&wlen, (uint8_t*)&col) )
             {
-                continue;
+                col = wlen - mCmdIdx;
+                mCmdIdx += col;
+                mCmdLen += col;
             }
+            break;
+        }
+#else
+        {
+            return -2;
+        }
 #endif
-        default:
-            /* Add a character to the command buffer */
-            if( (mCmdIdx < mCmdLen) && mInsert )
-            {
-                uint16_t len = mCmdLen - mCmdIdx;
-                FLib_MemInPlaceCpy( &mCmdBuf[mCmdIdx+1],        
-                                   &mCmdBuf[mCmdIdx], len );   
-                mCmdBuf[mCmdIdx] = ichar;                           
-                shell_writeN(mCmdBuf + mCmdIdx, len+1);         
-                mCmdLen++;                                      
-                mCmdIdx++;                                      
-                while( len )                                    
-                {                                               
-                    shell_putc(CTL_BACKSPACE);                  
-                    len--;                                      
-                }                                               
-            }                                                   
-            else                                                
-            {                                                   
-                if( mCmdLen == mCmdIdx )                        
-                    mCmdLen++;                                  
-                mCmdBuf[mCmdIdx++] = ichar;         
+    default:
+        /* Add a character to the command buffer */
+        if( (mCmdIdx < mCmdLen) && mInsert )
+        {
+            uint16_t len = mCmdLen - mCmdIdx;
+            FLib_MemInPlaceCpy( &mCmdBuf[mCmdIdx+1],        
+                               &mCmdBuf[mCmdIdx], len );   
+            mCmdBuf[mCmdIdx] = ichar;                           
+            shell_writeN(mCmdBuf + mCmdIdx, len+1);         
+            mCmdLen++;                                      
+            mCmdIdx++;                                      
+            while( len )                                    
+            {                                               
+                shell_putc(CTL_BACKSPACE);                  
+                len--;                                      
+            }                                               
+        }                                                   
+        else                                                
+        {                                                   
+            if( mCmdLen == mCmdIdx )                        
+                mCmdLen++;                                  
+            mCmdBuf[mCmdIdx++] = ichar;         
 #if SHELL_USE_ECHO
-                shell_putc(ichar);
+            shell_putc(ichar);
 #endif
-            }
+        }
 
-            /* Check if the received command exceeds he size of the buffer */
-            if( mCmdLen >= SHELL_CB_SIZE )
-            {
-                SHELL_RESET();
-            }
-            break;
+        /* Check if the received command exceeds he size of the buffer */
+        if( mCmdLen >= SHELL_CB_SIZE )
+        {
+            SHELL_RESET();
         }
+        break;
     }
 
-    mCmdBuf[mCmdLen] = '\0';    /* lose the newline */
-#if SHELL_MAX_HIST
-    hist_add(mCmdBuf);
-#endif
-    return 0;
+    return -2;
+}
+
+/*! *********************************************************************************
+* \brief  Returns the entry of the command index which holds the command, or the
+*         free entry where it must be inserted
+*
+* \param [in]   name      the command name
+*
+* \return       uint16_t  index of mShellCmdIndex
+*
+********************************************************************************** */
+static uint16_t shell_cmd_slot( const char *name )
+{
+    uint32_t hash = 2166136261U;
+    const char *pCh = name;
+    uint16_t slot;
+
+    /* FNV-1a */
+    while( *pCh )
+    {
+        hash = (hash ^ (uint8_t)*pCh++) * 16777619U;
+    }
+
+    slot = hash % SHELL_CMD_INDEX_SIZE;
+
+    /* Linear probing. The index is never full, so the search always ends */
+    while( mShellCmdIndex[slot] &&
+           strcmp(name, gpCmdTable[mShellCmdIndex[slot] - 1]->name) )
+    {
+        slot++;
+        if( slot == SHELL_CMD_INDEX_SIZE )
+        {
+            slot = 0;
+        }
+    }
+
+    return slot;
+}
+
+/*! *********************************************************************************
+* \brief  Rebuilds the command index from gpCmdTable
+*
+********************************************************************************** */
+static void shell_cmd_index_rebuild( void )
+{
+    uint16_t i;
+
+    FLib_MemSet(mShellCmdIndex, 0, sizeof(mShellCmdIndex));
+
+    for( i=0; i<SHELL_MAX_COMMANDS; i++ )
+    {
+        if( gpCmdTable[i] )
+        {
+            mShellCmdIndex[shell_cmd_slot(gpCmdTable[i]->name)] = i + 1;
+        }
+    }
 }
 
 /*! *********************************************************************************
@@ -1037,4 +1419,154 @@ static void shell_erase_to_eol(void)
         mCmdLen = mCmdIdx;
     }
 }
+
+/*! *********************************************************************************
+* \brief  Sends data over the serial interface
+*
+* \param[in]  pData pointer to the data
+* \param[in]  n number of bytes
+*
+* \remarks With SHELL_ASYNC_OUTPUT the data is copied into the output ring buffer,
+*          and the function returns before it was sent. If there is no room, the
+*          write is discarded, or the caller waits (SHELL_OUT_FULL_POLICY). Interrupts,
+*          the Serial Manager task and bare metal applications never wait.
+*
+********************************************************************************** */
+static void shell_out( uint8_t *pData, uint16_t n )
+{
+#if SHELL_ASYNC_OUTPUT
+    uint16_t count;
+    uint16_t chunk;
+
+    while( n )
+    {
+        OSA_InterruptDisable();
+
+        count = SHELL_OUT_BUF_SIZE - mShellOutCount;
+        if( count > n )
+        {
+            count = n;
+        }
+
+#if SHELL_OUT_FULL_POLICY == SHELL_OUT_BLOCK
+        if( (count < n) &&
+            (!gUseRtos_c || __get_IPSR() || (OSA_TaskGetId() == mShellSerMgrTaskId)) )
+#else
+        if( count < n )
+#endif
+        {
+            mShellOutStats.droppedBytes += n;
+            mShellOutStats.droppedWrites++;
+            OSA_InterruptEnable();
+            break;
+        }
+
+        chunk = SHELL_OUT_BUF_SIZE - mShellOutHead;
+        if( chunk > count )
+        {
+            chunk = count;
+        }
+        FLib_MemCpy(&mShellOutBuf[mShellOutHead], pData, chunk);
+        FLib_MemCpy(mShellOutBuf, pData + chunk, count - chunk);
+        mShellOutHead = (mShellOutHead + count) % SHELL_OUT_BUF_SIZE;
+        mShellOutCount += count;
+
+        if( mShellOutCount > mShellOutStats.maxUsed )
+        {
+            mShellOutStats.maxUsed = mShellOutCount;
+        }
+
+        OSA_InterruptEnable();
+
+        pData += count;
+        n -= count;
+        shell_out_kick();
+
+#if SHELL_OUT_FULL_POLICY == SHELL_OUT_BLOCK
+        if( n )
+        {
+            /* Let the Serial Manager drain the buffer */
+            OSA_TimeDelay(1);
+        }
+#endif
+    }
+#else
+    Serial_SyncWrite(gShellSerMgrIf, pData, n);
+#endif
+}
+
+#if SHELL_ASYNC_OUTPUT
+/*! *********************************************************************************
+* \brief  Starts sending the oldest bytes of the output ring buffer, if no
+*         transmission is in progress
+*
+********************************************************************************** */
+static void shell_out_kick( void )
+{
+    uint16_t tail = 0;
+    uint16_t chunk = 0;
+
+    OSA_InterruptDisable();
+    if( !mShellOutSending && mShellOutCount )
+    {
+        tail = (mShellOutHead + SHELL_OUT_BUF_SIZE - mShellOutCount) % SHELL_OUT_BUF_SIZE;
+        chunk = SHELL_OUT_BUF_SIZE - tail;
+        if( chunk > mShellOutCount )
+        {
+            chunk = mShellOutCount;
+        }
+        mShellOutSending = chunk;
+    }
+    OSA_InterruptEnable();
+
+    if( chunk )
+    {
+        if( gSerial_Success_c != Serial_AsyncWrite(gShellSerMgrIf, &mShellOutBuf[tail], chunk,
+                                                   shell_out_tx_done, NULL) )
+        {
+            /* The Serial Manager Tx queue is full. Nothing else may follow to send
+               the buffered bytes, so retry after a while */
+            mShellOutSending = 0;
+            if( gTmrInvalidTimerID_c != mShellOutRetryTmr )
+            {
+                (void)TMR_StartSingleShotTimer(mShellOutRetryTmr, mShellOutRetryMs_c,
+                                               shell_out_retry, NULL);
+            }
+        }
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Serial Manager Tx callback: releases the bytes sent and sends the next chunk
+*
+* \param[in]  params unused
+*
+********************************************************************************** */
+static void shell_out_tx_done( void *params )
+{
+    (void)params;
+
+    OSA_InterruptDisable();
+    mShellOutCount -= mShellOutSending;
+    mShellOutSending = 0;
+    OSA_InterruptEnable();
+
+#if SHELL_OUT_FULL_POLICY == SHELL_OUT_BLOCK
+    mShellSerMgrTaskId = OSA_TaskGetId();
+#endif
+    shell_out_kick();
+}
+
+/*! *********************************************************************************
+* \brief  Timer callback: sends the buffered bytes which could not be queued before
+*
+* \param[in]  params unused
+*
+********************************************************************************** */
+static void shell_out_retry( void *params )
+{
+    (void)params;
+    shell_out_kick();
+}
+#endif /* SHELL_ASYNC_OUTPUT */
 #endif /* SHELL_ENABLED */
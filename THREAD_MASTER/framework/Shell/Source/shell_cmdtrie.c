@@ -0,0 +1,404 @@
+/*!
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+*
+* \file
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* o Redistributions of source code must retain the above copyright notice, this list
+*   of conditions and the following disclaimer.
+*
+* o Redistributions in binary form must reproduce the above copyright notice, this
+*   list of conditions and the following disclaimer in the documentation and/or
+*   other materials provided with the distribution.
+*
+* o Neither the name of Freescale Semiconductor, Inc. nor the names of its
+*   contributors may be used to endorse or promote products derived from this
+*   software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "shell.h"
+#include "FunctionLib.h"
+#include <string.h>
+
+#if (SHELL_ENABLED && (SHELL_USE_AUTO_COMPLETE || SHELL_USE_HELP))
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+/* Each command adds at most a leaf and the node which splits an edge */
+#define SHELL_TRIE_SIZE         (2 * SHELL_MAX_COMMANDS + 1)
+#define TRIE_ROOT               (0)
+/* The root is never a child or a sibling, so 0 also means "no node" for links */
+#define TRIE_NONE               (0xFFFF)
+
+/************************************************************************************
+*************************************************************************************
+* Private type definitions
+*************************************************************************************
+************************************************************************************/
+/* Node of the radix tree of the command names. The edge to a node holds one or
+   more characters, which point inside one of the command names. */
+typedef struct
+{
+    const char  *pLabel;    /* characters of the edge to this node */
+    uint8_t     len;        /* number of characters of the edge */
+    uint8_t     cmd;        /* gpCmdTable index + 1 of the command ending here, 0 - none */
+    uint8_t     count;      /* number of commands in the subtree */
+    uint16_t    parent;
+    uint16_t    child;      /* first child, the children are sorted by their first character */
+    uint16_t    sibling;    /* next child of the parent */
+}shellTrieNode_t;
+
+/************************************************************************************
+*************************************************************************************
+* Private prototypes
+*************************************************************************************
+************************************************************************************/
+void cmd_trie_insert(uint8_t idx);
+cmd_tbl_t * cmd_trie_next(uint32_t *pIter);
+static uint16_t trie_walk(const char *pPrefix, uint8_t *pDepth);
+static uint16_t trie_successor(uint16_t subtree, uint16_t node);
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+static shellTrieNode_t mShellTrie[SHELL_TRIE_SIZE];
+static uint16_t        mShellTrieUsed;
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  Rebuilds the command name index from gpCmdTable
+*
+********************************************************************************** */
+void cmd_trie_rebuild(void)
+{
+    uint8_t i;
+
+    FLib_MemSet(mShellTrie, 0, sizeof(mShellTrie));
+    mShellTrieUsed = 1;
+
+    for( i=0; i<SHELL_MAX_COMMANDS; i++ )
+    {
+        if( gpCmdTable[i] )
+        {
+            cmd_trie_insert(i);
+        }
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Adds a command to the command name index
+*
+* \param[in]  idx  the gpCmdTable index of the command
+*
+* \remarks The command names must be unique
+*
+********************************************************************************** */
+void cmd_trie_insert(uint8_t idx)
+{
+    const char *pName = gpCmdTable[idx]->name;
+    uint16_t node = TRIE_ROOT;
+    uint16_t *pLink;
+    uint16_t child;
+    uint16_t mid;
+    uint8_t  m;
+
+    while( 1 )
+    {
+        mShellTrie[node].count++;
+
+        if( '\0' == *pName )
+        {
+            mShellTrie[node].cmd = idx + 1;
+            return;
+        }
+
+        /* Search the edge starting with the next character, the children are sorted */
+        pLink = &mShellTrie[node].child;
+        while( *pLink && (mShellTrie[*pLink].pLabel[0] < *pName) )
+        {
+            pLink = &mShellTrie[*pLink].sibling;
+        }
+        child = *pLink;
+
+        if( !child || (mShellTrie[child].pLabel[0] != *pName) )
+        {
+            /* New leaf */
+            child = mShellTrieUsed++;
+            mShellTrie[child].pLabel = pName;
+            mShellTrie[child].len = strlen(pName);
+            mShellTrie[child].cmd = idx + 1;
+            mShellTrie[child].count = 1;
+            mShellTrie[child].parent = node;
+            mShellTrie[child].sibling = *pLink;
+            *pLink = child;
+            return;
+        }
+
+        m = 1;
+        while( (m < mShellTrie[child].len) && (mShellTrie[child].pLabel[m] == pName[m]) )
+        {
+            m++;
+        }
+
+        if( m < mShellTrie[child].len )
+        {
+            /* The name leaves the edge: split it */
+            mid = mShellTrieUsed++;
+            mShellTrie[mid].pLabel = mShellTrie[child].pLabel;
+            mShellTrie[mid].len = m;
+            mShellTrie[mid].cmd = 0;
+            mShellTrie[mid].count = mShellTrie[child].count;
+            mShellTrie[mid].parent = node;
+            mShellTrie[mid].child = child;
+            mShellTrie[mid].sibling = mShellTrie[child].sibling;
+            *pLink = mid;
+
+            mShellTrie[child].pLabel += m;
+            mShellTrie[child].len -= m;
+            mShellTrie[child].parent = mid;
+            mShellTrie[child].sibling = 0;
+            child = mid;
+        }
+
+        node = child;
+        pName += m;
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Counts the commands starting with a prefix
+*
+* \param[in]  pPrefix  NULL terminated prefix
+* \param[out] pCommon  length of the prefix which is common to all these commands
+*
+* \return  uint8_t  the number of commands
+*
+********************************************************************************** */
+uint8_t cmd_trie_prefix(const char *pPrefix, uint8_t *pCommon)
+{
+    uint16_t node = trie_walk(pPrefix, pCommon);
+
+    return (TRIE_NONE == node) ? 0 : mShellTrie[node].count;
+}
+
+/*! *********************************************************************************
+* \brief  Returns the first command starting with a prefix, in alphabetical order
+*
+* \param[in]  pPrefix  NULL terminated prefix
+* \param[out] pIter    iterator for cmd_trie_next()
+*
+* \return  cmd_tbl_t*  pointer to the command, or NULL
+*
+********************************************************************************** */
+cmd_tbl_t * cmd_trie_first(const char *pPrefix, uint32_t *pIter)
+{
+    uint8_t depth;
+    uint16_t node = trie_walk(pPrefix, &depth);
+
+    /* The subtree and the next node to visit */
+    *pIter = ((uint32_t)node << 16) | node;
+
+    return cmd_trie_next(pIter);
+}
+
+/*! *********************************************************************************
+* \brief  Returns the next command of the cmd_trie_first() search
+*
+* \param[in,out] pIter  iterator
+*
+* \return  cmd_tbl_t*  pointer to the command, or NULL
+*
+********************************************************************************** */
+cmd_tbl_t * cmd_trie_next(uint32_t *pIter)
+{
+    uint16_t subtree = *pIter >> 16;
+    uint16_t node = *pIter & 0xFFFF;
+    cmd_tbl_t *pCmd = NULL;
+
+    while( (NULL == pCmd) && (TRIE_NONE != node) )
+    {
+        if( mShellTrie[node].cmd )
+        {
+            pCmd = gpCmdTable[mShellTrie[node].cmd - 1];
+        }
+        node = trie_successor(subtree, node);
+    }
+
+    *pIter = ((uint32_t)subtree << 16) | node;
+    return pCmd;
+}
+
+/*! *********************************************************************************
+* \brief  Lists the names of the commands starting with a prefix, in alphabetical order
+*
+* \param[in]  pPrefix  NULL terminated prefix
+* \param[out] cmdv     table with the names, NULL terminated. If there are too many
+*                      commands, the last name is "..."
+* \param[in]  maxv     the number of entries of cmdv, at least 2
+*
+* \return  uint8_t  the number of names
+*
+********************************************************************************** */
+uint8_t cmd_trie_list(const char *pPrefix, char *cmdv[], uint8_t maxv)
+{
+    uint32_t iter;
+    cmd_tbl_t *cmdtp = cmd_trie_first(pPrefix, &iter);
+    uint8_t n_found = 0;
+
+    while( cmdtp )
+    {
+        /* too many! */
+        if( n_found >= maxv - 2 )
+        {
+            cmdv[n_found++] = "...";
+            break;
+        }
+        cmdv[n_found++] = cmdtp->name;
+        cmdtp = cmd_trie_next(&iter);
+    }
+    cmdv[n_found] = NULL;
+
+    return n_found;
+}
+
+/*! *********************************************************************************
+* \brief  Searches a command by its full name
+*
+* \param[in]  pName  NULL terminated command name
+*
+* \return  cmd_tbl_t*  pointer to the command, or NULL
+*
+********************************************************************************** */
+cmd_tbl_t * cmd_trie_find(const char *pName)
+{
+    uint8_t depth;
+    uint16_t node = trie_walk(pName, &depth);
+
+    /* The name must end with the edge of the node, not inside it */
+    if( (TRIE_NONE == node) || !mShellTrie[node].cmd || (strlen(pName) != depth) )
+    {
+        return NULL;
+    }
+
+    return gpCmdTable[mShellTrie[node].cmd - 1];
+}
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  Follows a prefix from the root
+*
+* \param[in]  pPrefix  NULL terminated prefix
+* \param[out] pDepth   length of the path to the returned node
+*
+* \return  uint16_t  the highest node whose subtree holds all the names starting with
+*                    the prefix, or TRIE_NONE
+*
+********************************************************************************** */
+static uint16_t trie_walk(const char *pPrefix, uint8_t *pDepth)
+{
+    uint16_t node = TRIE_ROOT;
+    uint8_t m;
+
+    *pDepth = 0;
+
+    while( *pPrefix )
+    {
+        node = mShellTrie[node].child;
+        while( node && (mShellTrie[node].pLabel[0] != *pPrefix) )
+        {
+            node = mShellTrie[node].sibling;
+        }
+        if( !node )
+        {
+            return TRIE_NONE;
+        }
+
+        for( m = 1; (m < mShellTrie[node].len) && pPrefix[m]; m++ )
+        {
+            if( mShellTrie[node].pLabel[m] != pPrefix[m] )
+            {
+                return TRIE_NONE;
+            }
+        }
+
+        /* The prefix may end inside the edge */
+        *pDepth += mShellTrie[node].len;
+        pPrefix += m;
+    }
+
+    /* Unlike the other nodes, the root can have a single child */
+    if( (TRIE_ROOT == node) && !mShellTrie[node].cmd && mShellTrie[node].child &&
+        !mShellTrie[mShellTrie[node].child].sibling )
+    {
+        node = mShellTrie[node].child;
+        *pDepth = mShellTrie[node].len;
+    }
+
+    return node;
+}
+
+/*! *********************************************************************************
+* \brief  Returns the next node of the subtree, in depth first order
+*
+* \param[in]  subtree  the root of the subtree
+* \param[in]  node     the current node
+*
+* \return  uint16_t  the next node, or TRIE_NONE
+*
+********************************************************************************** */
+static uint16_t trie_successor(uint16_t subtree, uint16_t node)
+{
+    if( mShellTrie[node].child )
+    {
+        return mShellTrie[node].child;
+    }
+
+    while( node != subtree )
+    {
+        if( mShellTrie[node].sibling )
+        {
+            return mShellTrie[node].sibling;
+        }
+        node = mShellTrie[node].parent;
+    }
+
+    return TRIE_NONE;
+}
+#endif
+
+/*******************************************************************************
+ * EOF
+ ******************************************************************************/
@@ -0,0 +1,465 @@
+/*!
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+*
+* \file
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* o Redistributions of source code must retain the above copyright notice, this list
+*   of conditions and the following disclaimer.
+*
+* o Redistributions in binary form must reproduce the above copyright notice, this
+*   list of conditions and the following disclaimer in the documentation and/or
+*   other materials provided with the distribution.
+*
+* o Neither the name of Freescale Semiconductor, Inc. nor the names of its
+*   contributors may be used to endorse or promote products derived from this
+*   software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/************************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+************************************************************************************/
+#include "shell.h"
+#include "FunctionLib.h"
+#include "MemManager.h"
+#include <string.h>
+
+#if SHELL_ENABLED
+#if (SHELL_MAX_JOBS < 1) || (SHELL_MAX_JOBS > 254)
+#error "SHELL_MAX_JOBS must be between 1 and 254"
+#endif
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+/* Not a job ID: a free entry, or a command which cannot become a job */
+#define JOB_ID_NONE             (0xFF)
+
+/************************************************************************************
+*************************************************************************************
+* Private type definitions
+*************************************************************************************
+************************************************************************************/
+typedef struct
+{
+    int8_t      (*cmd)(uint8_t argc, char * argv[]);  /* called with argc = 0 to cancel the job */
+    char        *name;      /* NULL for the lines handled by the fallback handler */
+    uint32_t    order;      /* the most recent job has the highest value */
+    uint8_t     id;         /* 0 - free entry */
+    bool_t      legacy;     /* the command did not read its job ID: see shell_cmd_finished() */
+}shellJob_t;
+
+/************************************************************************************
+*************************************************************************************
+* Private prototypes
+*************************************************************************************
+************************************************************************************/
+static int8_t DoJobs(uint8_t argc, char * argv[]);
+static shellJob_t * job_find(uint8_t jobId);
+
+extern void shell_async_line_begin(void);
+extern void shell_async_line_end(void);
+
+/************************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+************************************************************************************/
+static shellJob_t mShellJobs[SHELL_MAX_JOBS];
+static uint32_t   mShellJobOrder;
+static uint8_t    mShellJobNextId;
+static uint8_t    mShellJobId;      /* job of the command being executed or cancelled */
+static bool_t     mShellJobCancel;  /* a job is being cancelled */
+static bool_t     mShellJobIdRead;  /* the command being executed called shell_job_id() */
+
+const cmd_tbl_t CommandFun_Jobs = 
+{
+    .name = "jobs",
+    .maxargs = 3,
+    .repeatable = 1,
+    .cmd = DoJobs,
+#if SHELL_USE_HELP
+    .usage = "list or cancel the asynchronous commands",
+    .help = "\r\n"
+            "   - list the running jobs\r\n"
+            "jobs kill <id>\r\n"
+            "   - cancel a job\r\n",
+#endif
+#if SHELL_USE_AUTO_COMPLETE
+    .complete = NULL
+#endif
+};
+
+/************************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  This function will initialize the SHELL job table
+*
+********************************************************************************** */
+void job_init(void)
+{
+    shell_register_function((cmd_tbl_t*)&CommandFun_Jobs);
+    FLib_MemSet(mShellJobs, 0, sizeof(mShellJobs));
+    mShellJobNextId = 1;
+    mShellJobId = 0;
+}
+
+/*! *********************************************************************************
+* \brief  Selects the ID of the job which is created if the next command returns
+*         CMD_RET_ASYNC. Called before a command is executed.
+*
+********************************************************************************** */
+void job_prepare(void)
+{
+    uint8_t id = mShellJobNextId;
+
+    mShellJobIdRead = FALSE;
+
+    if( NULL == job_find(JOB_ID_NONE) )
+    {
+        mShellJobId = JOB_ID_NONE;
+        return;
+    }
+
+    /* Skip 0 and the IDs still in use */
+    while( (0 == id) || (JOB_ID_NONE == id) || job_find(id) )
+    {
+        id++;
+    }
+    mShellJobId = id;
+}
+
+/*! *********************************************************************************
+* \brief  Creates a job if the command was not completed. Called after a command
+*         was executed.
+*
+* \param[in]  ret    the value returned by the command
+* \param[in]  pfCmd  the command handler, called with argc = 0 to cancel the job
+* \param[in]  pName  the command name, or NULL
+*
+********************************************************************************** */
+void job_command_done(int8_t ret, int8_t (*pfCmd)(uint8_t argc, char * argv[]), char *pName)
+{
+    shellJob_t *pJob;
+
+    if( ret == CMD_RET_ASYNC )
+    {
+        pJob = job_find(JOB_ID_NONE);
+
+        if( (JOB_ID_NONE == mShellJobId) || (NULL == pJob) )
+        {
+            /* The command could not be cancelled later: stop it now */
+            mShellJobCancel = TRUE;
+            pfCmd(0, NULL);
+            mShellJobCancel = FALSE;
+            shell_write("** Too many jobs (max. ");
+            shell_writeDec(SHELL_MAX_JOBS);
+            shell_write(") **\r\n");
+        }
+        else
+        {
+            pJob->cmd = pfCmd;
+            pJob->name = pName;
+            pJob->order = ++mShellJobOrder;
+            pJob->id = mShellJobId;
+            pJob->legacy = !mShellJobIdRead;
+            mShellJobNextId = mShellJobId + 1;
+            shell_job_write(pJob->id, pName ? pName : "Started");
+        }
+    }
+
+    mShellJobId = 0;
+}
+
+/*! *********************************************************************************
+* \brief  Cancels a job: its handler is called with argc = 0
+*
+* \param[in]  jobId  the job ID, or 0 for the most recent job
+*
+* \return  bool_t  FALSE if there is no such job
+*
+********************************************************************************** */
+bool_t job_cancel(uint8_t jobId)
+{
+    shellJob_t *pJob = job_find(jobId);
+    uint8_t prevId = mShellJobId;
+
+    if( (NULL == pJob) || (JOB_ID_NONE == jobId) )
+    {
+        return FALSE;
+    }
+
+    /* The job is released first, so it does not report its end while it is cancelled */
+    jobId = pJob->id;
+    pJob->id = 0;
+    mShellJobId = jobId;
+    mShellJobCancel = TRUE;
+    pJob->cmd(0, NULL);
+    mShellJobCancel = FALSE;
+    mShellJobId = prevId;
+    shell_job_write(jobId, "Cancelled");
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief  Returns the job ID of the command being executed, which is used if the
+*         command returns CMD_RET_ASYNC, or the ID of the job being cancelled
+*
+* \return  uint8_t  the job ID, or 0 if no job can be created
+*
+* \remarks A command which calls it must end its job with shell_job_finished()
+*
+********************************************************************************** */
+uint8_t shell_job_id(void)
+{
+    if( !mShellJobCancel )
+    {
+        mShellJobIdRead = TRUE;
+    }
+    return (JOB_ID_NONE == mShellJobId) ? 0 : mShellJobId;
+}
+
+/*! *********************************************************************************
+* \brief  Prints a line of a job: "[<id>] <line>"
+*
+* \param[in]  jobId  the job ID
+* \param[in]  pLine  NULL terminated string, without line end
+*
+* \remarks The prompt and the edited line are displayed again after the line
+*
+********************************************************************************** */
+void shell_job_write(uint8_t jobId, char *pLine)
+{
+    shell_async_line_begin();
+    shell_putc('[');
+    shell_writeDec(jobId);
+    shell_writeN("] ", 2);
+    shell_write(pLine);
+    SHELL_NEWLINE();
+    shell_async_line_end();
+}
+
+/*! *********************************************************************************
+* \brief  Prints a formated line of a job: "[<id>] <line>"
+*
+* \param[in]  jobId  the job ID
+* \param[in]  format string defining the output, without line end
+* \param[in]  ... variable number of parameters
+*
+********************************************************************************** */
+#if SHELL_USE_PRINTF
+#include <stdio.h>
+#include <stdarg.h>
+
+void shell_job_printf(uint8_t jobId, char * format,...)
+{
+    va_list ap;
+    char *pStr = (char*)MEM_BufferAlloc(SHELL_CB_SIZE);
+
+    if(!pStr)
+        return;
+
+    va_start(ap, format);
+    (void)vsnprintf(pStr, SHELL_CB_SIZE, format, ap);
+    va_end(ap);
+    shell_job_write(jobId, pStr);
+    MEM_BufferFree(pStr);
+}
+#endif
+
+/*! *********************************************************************************
+* \brief  Notify shell that a job has finished
+*
+* \param[in]  jobId  the job ID, as returned by shell_job_id() when the command
+*                    was started
+*
+* \remarks Nothing is done if the job was cancelled
+*
+********************************************************************************** */
+void shell_job_finished(uint8_t jobId)
+{
+    shellJob_t *pJob;
+
+    if( (0 == jobId) || (JOB_ID_NONE == jobId) )
+    {
+        /* Not a job */
+        return;
+    }
+
+    pJob = job_find(jobId);
+    if( NULL != pJob )
+    {
+        pJob->id = 0;
+        shell_job_write(jobId, "Done");
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Notify shell that the async command has finished
+*
+* \remarks For the commands which do not call shell_job_id(): the job of such a
+*          command is finished. If several of them are running, the caller cannot
+*          be told apart and the oldest one is finished, with a warning.
+*
+********************************************************************************** */
+void shell_cmd_finished(void)
+{
+    shellJob_t *pJob = NULL;
+    bool_t several = FALSE;
+    uint8_t i;
+
+    if( mShellJobCancel || mShellJobId )
+    {
+        /* Called by the command being executed, which is not a job yet, or by the
+           command being cancelled, which was already released */
+        return;
+    }
+
+    for( i = 0; i < SHELL_MAX_JOBS; i++ )
+    {
+        if( mShellJobs[i].id && mShellJobs[i].legacy )
+        {
+            if( NULL != pJob )
+            {
+                several = TRUE;
+            }
+            if( (NULL == pJob) || (mShellJobs[i].order < pJob->order) )
+            {
+                pJob = &mShellJobs[i];
+            }
+        }
+    }
+
+    if( NULL != pJob )
+    {
+        i = pJob->id;
+        pJob->id = 0;
+        shell_job_write(i, several ? "Done (assumed: several jobs do not know their ID)" : "Done");
+    }
+}
+
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+
+/*! *********************************************************************************
+* \brief  Searches the job table
+*
+* \param[in]  jobId  the job ID, 0 for the most recent job, or JOB_ID_NONE for a free entry
+*
+* \return  shellJob_t*  pointer to the entry, or NULL
+*
+********************************************************************************** */
+static shellJob_t * job_find(uint8_t jobId)
+{
+    shellJob_t *pJob = NULL;
+    uint8_t i;
+
+    for( i = 0; i < SHELL_MAX_JOBS; i++ )
+    {
+        if( JOB_ID_NONE == jobId )
+        {
+            if( 0 == mShellJobs[i].id )
+            {
+                return &mShellJobs[i];
+            }
+        }
+        else if( 0 == mShellJobs[i].id )
+        {
+            continue;
+        }
+        else if( jobId == mShellJobs[i].id )
+        {
+            return &mShellJobs[i];
+        }
+        else if( (0 == jobId) && ((NULL == pJob) || (mShellJobs[i].order > pJob->order)) )
+        {
+            pJob = &mShellJobs[i];
+        }
+    }
+
+    return pJob;
+}
+
+/*! *********************************************************************************
+* \brief  This function will list the jobs, or cancel one
+*
+* \param[in]  argc  The number of arguments
+* \param[in]  argv  table with command argumens
+*
+* \return  int8_t  command status (command_ret_t)
+*
+********************************************************************************** */
+static int8_t DoJobs(uint8_t argc, char * argv[])
+{
+    uint32_t id = 0;
+    char *pDigit;
+    uint8_t i;
+
+    if( argc == 1 )
+    {
+        for( i = 0; i < SHELL_MAX_JOBS; i++ )
+        {
+            if( mShellJobs[i].id )
+            {
+                shell_putc('[');
+                shell_writeDec(mShellJobs[i].id);
+                shell_writeN("] ", 2);
+                shell_write(mShellJobs[i].name ? mShellJobs[i].name : "-");
+                SHELL_NEWLINE();
+            }
+        }
+        return CMD_RET_SUCCESS;
+    }
+
+    if( (argc != 3) || strcmp(argv[1], "kill") )
+    {
+        return CMD_RET_USAGE;
+    }
+
+    for( pDigit = argv[2]; *pDigit; pDigit++ )
+    {
+        if( (*pDigit < '0') || (*pDigit > '9') || (id > 0xFF) )
+        {
+            return CMD_RET_USAGE;
+        }
+        id = id * 10 + (*pDigit - '0');
+    }
+
+    if( (0 == id) || (id >= JOB_ID_NONE) || !job_cancel((uint8_t)id) )
+    {
+        shell_write("No such job\r\n");
+        return CMD_RET_FAILURE;
+    }
+
+    return CMD_RET_SUCCESS;
+}
+#endif /* SHELL_ENABLED */
+
+ /*******************************************************************************
+ * EOF
+ ******************************************************************************/
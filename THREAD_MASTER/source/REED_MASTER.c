@@ -71,6 +71,50 @@ Private macros
 
 #define APP_DEFAULT_DEST_ADDR                   in6addr_realmlocal_allthreadnodes
 
+/* Host batch protocol (see APP_BatchFrame) */
+#define APP_BATCH_MAX_REQS                      4       /* frames in progress */
+#define APP_BATCH_MAX_OPS                       12      /* (slave, command) pairs in progress */
+#define APP_BATCH_TICK_MS                       100
+#define APP_BATCH_OP_TIMEOUT_MS                 1500    /* as the ACK timer of the single commands */
+#define APP_BATCH_DISCOVERY_MS                  1500
+
+/*==================================================================================================
+Private type definitions
+==================================================================================================*/
+#if THREAD_USE_SHELL
+/* Frame received from the host, passed to the application task */
+typedef struct appBatchFrame_tag
+{
+    uint16_t id;
+    uint8_t  count;                             /* 0 for a discovery */
+    char     pairs[APP_BATCH_MAX_OPS][2];       /* slave digit, command letter */
+}appBatchFrame_t;
+
+/* Frame in progress */
+typedef struct appBatchReq_tag
+{
+    uint16_t id;
+    uint8_t  total;
+    uint8_t  done;
+    uint8_t  ok;
+    uint8_t  ticks;                             /* discovery time left */
+    bool_t   discovery;
+    bool_t   inUse;
+}appBatchReq_t;
+
+/* (slave, command) pair waiting for the CoAP ACK */
+typedef struct appBatchOp_tag
+{
+    coapSession_t * volatile pSession;          /* NULL once closed by the CoAP module */
+    uint8_t        req;                         /* index in mBatchReqs */
+    uint8_t        pos;                         /* position of the pair in the frame */
+    uint8_t        ticks;                       /* time left */
+    volatile bool_t acked;
+    bool_t         local;                       /* processed by this device, no ACK */
+    bool_t         inUse;
+}appBatchOp_t;
+#endif
+
 /*==================================================================================================
 Private global variables declarations
 ==================================================================================================*/
@@ -80,6 +124,15 @@ static instanceId_t mThrInstanceId = gInvalidInstanceId_c;    /*!< Thread Instan
 #define SLAVE_NUM_MAX 6
 uint8_t slave_count = 0;
 static ipAddr_t slaveIP[SLAVE_NUM_MAX] = {0};
+
+#if THREAD_USE_SHELL
+static appBatchReq_t mBatchReqs[APP_BATCH_MAX_REQS];
+static appBatchOp_t mBatchOps[APP_BATCH_MAX_OPS];
+/* Pair being sent by APP_SendLedCommand(), NULL for the single commands */
+static appBatchOp_t *mpBatchOp = NULL;
+static tmrTimerID_t mBatchTimerId = gTmrInvalidTimerID_c;
+static bool_t mBatchDiscovery = FALSE;
+#endif
 /*==================================================================================================
 Private prototypes
 ==================================================================================================*/
@@ -101,6 +154,18 @@ static void APP_CoapTextCb(coapSessionStatus_t sessionStatus, void *pData, coapS
 static void APP_CoapAddrCb(coapSessionStatus_t sessionStatus, void *pData, coapSession_t *pSession, uint32_t dataLen);
 static void APP_CoapACKcb(coapSessionStatus_t sessionStatus, void *pData, coapSession_t *pSession, uint32_t dataLen);
 static void APP_ACKTimerCb(void *pParam);
+static void APP_GetActiveSlaves(void *pParam);
+static void APP_SerialCommand(char * command);
+#if THREAD_USE_SHELL
+static int8_t APP_ShellCommand(uint8_t argc, char *argv[]);
+static int8_t APP_BatchFrame(uint8_t argc, char *argv[]);
+static void APP_BatchStart(void *param);
+static void APP_BatchOpDone(appBatchOp_t *pOp, bool_t success);
+static void APP_BatchCoapAckCb(coapSessionStatus_t sessionStatus, void *pData, coapSession_t *pSession, uint32_t dataLen);
+static void APP_BatchUpdate(void *param);
+static void APP_BatchTimerCb(void *param);
+static void APP_BatchTick(void *param);
+#endif
 
 static void App_RestoreLeaderLed(void *param);
 #if LARGE_NETWORK
@@ -175,6 +240,10 @@ void App_Init(void)
 
     /* Use one instance ID for application */
     mThrInstanceId = gThrDefaultInstanceId_c;
+#if THREAD_USE_SHELL
+    /* Host commands which are not shell commands */
+    shell_register_fallback(APP_ShellCommand);
+#endif
     //COAP_SetMaxRetransmitCount(mThrInstanceId, 5);
 #if THR_ENABLE_EVENT_MONITORING
     /* Initialize event monitoring */
@@ -578,6 +647,16 @@ static void APP_SendLedCommand
             COAP_SetUriPath(pSession,(coapUriPath_t *)&gAPP_LED_URI_PATH);
 
 			coapMessageType = gCoapMsgTypeConPost_c;
+#if THREAD_USE_SHELL
+            if(mpBatchOp)
+            {
+                /* Pair of a batch frame, completed by APP_BatchCoapAckCb() or on timeout */
+                pSession->pCallback = APP_BatchCoapAckCb;
+                mpBatchOp->pSession = pSession;
+                COAP_Send(pSession, coapMessageType, pCommand, dataLen);
+                return;
+            }
+#endif
 			pSession->pCallback = APP_CoapACKcb;
 			ACK_status = FALSE;
             COAP_Send(pSession, coapMessageType, pCommand, dataLen);
@@ -597,6 +676,12 @@ static void APP_SendLedCommand
     else
     {
         APP_ProcessLedCmd(pCommand, dataLen);
+#if THREAD_USE_SHELL
+        if(mpBatchOp)
+        {
+            mpBatchOp->local = TRUE;
+        }
+#endif
     }
 }
 
@@ -619,7 +704,7 @@ static void APP_ReportSlavesNum
 	shell_printf("%d\n", slave_count);
 }
 
-void APP_GetActiveSlaves
+static void APP_GetActiveSlaves
 (
 	void *pParam
 )
@@ -643,14 +728,12 @@ void APP_GetActiveSlaves
 }
 
 
-void APP_SerialCommand(char * command)
+static void APP_SerialCommand(char * command)
 {
 	uint8_t slave_num = 0;
-	switch(command[0])
+	if((command[0] >= '0') && (command[0] < '0' + SLAVE_NUM_MAX))
 	{
-		case '0': slave_num = 0; break;
-		case '1': slave_num = 1; break;
-		case '2': slave_num = 2; break;
+		slave_num = command[0] - '0';
 	}
 	switch(command[1])
 	{
@@ -660,6 +743,416 @@ void APP_SerialCommand(char * command)
 	}
 }
 
+#if THREAD_USE_SHELL
+/*!*************************************************************************************************
+\private
+\fn     static int8_t APP_ShellCommand(uint8_t argc, char *argv[])
+\brief  Shell fallback handler: processes the host commands, which are not shell commands.
+
+\param  [in]    argc       Number of words in the line
+\param  [in]    argv       Words of the line
+
+\return         int8_t     CMD_RET_SUCCESS
+***************************************************************************************************/
+static int8_t APP_ShellCommand
+(
+    uint8_t argc,
+    char *argv[]
+)
+{
+    if(argv[0][0] == '#')
+    {
+        return APP_BatchFrame(argc, argv);
+    }
+
+    if(!strcmp(argv[0], "G0"))
+    {
+        APP_GetActiveSlaves(NULL);
+    }
+    else
+    {
+        APP_SerialCommand(argv[0]);
+    }
+    return CMD_RET_SUCCESS;
+}
+
+/*==================================================================================================
+  Host batch protocol:
+
+  The host sends one frame per line, with a request ID chosen by the host (0 to 65535):
+      #<id> <slave><cmd>[,<slave><cmd>...]     up to APP_BATCH_MAX_OPS pairs
+      #<id> G                                  slave discovery (as "G0")
+      #<id> Q                                  end of the session
+  <slave> is the slave index (digit), <cmd> the command of the single commands:
+  x - RGB on, y - flash, z - color wheel.
+
+  Every reply line starts with '@' and the request ID:
+      @<id> A <n>           the frame was accepted, <n> pairs are in progress
+      @<id> E <err>         the frame was rejected: 1 - syntax error, 2 - busy
+      @<id> <pos> S|F       pair <pos> of the frame (from 0) was acknowledged or failed
+      @<id> D <ok> <n>      all the pairs are complete, <ok> of <n> succeeded
+      @<id> N <count>       end of the discovery, <count> slaves replied
+      @<id> Q               end of the session, the shell is back to the normal mode
+  The discovery rebuilds the slave table: it is rejected (busy) while pairs are in progress,
+  and the pair frames are rejected during the discovery.
+  The events of different frames may be interleaved. The first valid frame switches the shell
+  to the raw line mode (no echo), until the end of the session. The frames in progress
+  are not affected by the end of the session.
+==================================================================================================*/
+/*!*************************************************************************************************
+\private
+\fn     static int8_t APP_BatchFrame(uint8_t argc, char *argv[])
+\brief  Parses a frame of the host and passes it to the application task.
+
+\param  [in]    argc       Number of words in the line
+\param  [in]    argv       Words of the line
+
+\return         int8_t     CMD_RET_SUCCESS
+***************************************************************************************************/
+static int8_t APP_BatchFrame
+(
+    uint8_t argc,
+    char *argv[]
+)
+{
+    appBatchFrame_t *pFrame;
+    char *pCh = argv[0] + 1;
+    uint32_t id = 0;
+    uint8_t error = 0;
+
+    while((*pCh >= '0') && (*pCh <= '9') && (id <= 0xFFFF))
+    {
+        id = id * 10 + (*pCh++ - '0');
+    }
+    if((pCh == argv[0] + 1) || *pCh || (id > 0xFFFF))
+    {
+        shell_write("@? E 1\r\n");
+        return CMD_RET_SUCCESS;
+    }
+
+    if((argc == 2) && !strcmp(argv[1], "Q"))
+    {
+        shell_printf("@%u Q\r\n", (unsigned int)id);
+        shell_set_raw_mode(FALSE);
+        return CMD_RET_SUCCESS;
+    }
+
+    pFrame = MEM_BufferAlloc(sizeof(appBatchFrame_t));
+    if(!pFrame)
+    {
+        error = 2;
+    }
+    else if(argc != 2)
+    {
+        error = 1;
+    }
+    else
+    {
+        pFrame->id = (uint16_t)id;
+        pFrame->count = 0;
+
+        if(strcmp(argv[1], "G"))
+        {
+            /* <slave><cmd>[,<slave><cmd>...] */
+            for(pCh = argv[1]; !error; pCh += 3)
+            {
+                if((pFrame->count == APP_BATCH_MAX_OPS) ||
+                   (pCh[0] < '0') || (pCh[0] >= '0' + SLAVE_NUM_MAX) ||
+                   ((pCh[1] != 'x') && (pCh[1] != 'y') && (pCh[1] != 'z')) ||
+                   ((pCh[2] != ',') && (pCh[2] != '\0')))
+                {
+                    error = 1;
+                    break;
+                }
+                pFrame->pairs[pFrame->count][0] = pCh[0];
+                pFrame->pairs[pFrame->count][1] = pCh[1];
+                pFrame->count++;
+                if(pCh[2] == '\0')
+                {
+                    break;
+                }
+            }
+        }
+
+        if(!error && !NWKU_SendMsg(APP_BatchStart, pFrame, mpAppThreadMsgQueue))
+        {
+            error = 2;
+        }
+    }
+
+    if(error)
+    {
+        if(pFrame)
+        {
+            MEM_BufferFree(pFrame);
+        }
+        shell_printf("@%u E %u\r\n", (unsigned int)id, error);
+    }
+
+    /* A malformed line does not switch the shell to the raw line mode */
+    if(1 != error)
+    {
+        shell_set_raw_mode(TRUE);
+    }
+
+    return CMD_RET_SUCCESS;
+}
+
+/*!*************************************************************************************************
+\private
+\fn     static void APP_BatchStart(void *param)
+\brief  Starts the pairs of a frame. Runs in the application task.
+
+\param  [in]    param      Pointer to the frame (appBatchFrame_t), freed here
+***************************************************************************************************/
+static void APP_BatchStart
+(
+    void *param
+)
+{
+    appBatchFrame_t *pFrame = (appBatchFrame_t *)param;
+    appBatchReq_t *pReq = NULL;
+    appBatchOp_t *pOp;
+    uint8_t freeOps = 0;
+    uint8_t req;
+    uint8_t i;
+
+    for(i = 0; i < APP_BATCH_MAX_OPS; i++)
+    {
+        if(!mBatchOps[i].inUse)
+        {
+            freeOps++;
+        }
+    }
+    for(req = 0; req < APP_BATCH_MAX_REQS; req++)
+    {
+        if(!mBatchReqs[req].inUse)
+        {
+            pReq = &mBatchReqs[req];
+            break;
+        }
+    }
+
+    if(mBatchTimerId == gTmrInvalidTimerID_c)
+    {
+        mBatchTimerId = TMR_AllocateTimer();
+    }
+
+    if(!pReq || (freeOps < pFrame->count) || (mBatchTimerId == gTmrInvalidTimerID_c) ||
+       mBatchDiscovery || (!pFrame->count && (freeOps < APP_BATCH_MAX_OPS)))
+    {
+        shell_printf("@%u E 2\r\n", pFrame->id);
+        MEM_BufferFree(pFrame);
+        return;
+    }
+
+    FLib_MemSet(pReq, 0, sizeof(appBatchReq_t));
+    pReq->id = pFrame->id;
+    pReq->total = pFrame->count;
+    pReq->inUse = TRUE;
+    shell_printf("@%u A %u\r\n", pReq->id, pReq->total);
+
+    if(!pFrame->count)
+    {
+        pReq->discovery = TRUE;
+        pReq->ticks = APP_BATCH_DISCOVERY_MS / APP_BATCH_TICK_MS;
+        mBatchDiscovery = TRUE;
+        APP_GetActiveSlaves(NULL);
+    }
+
+    for(i = 0, pOp = mBatchOps; i < pFrame->count; pOp++)
+    {
+        if(pOp->inUse)
+        {
+            continue;
+        }
+
+        FLib_MemSet(pOp, 0, sizeof(appBatchOp_t));
+        pOp->req = req;
+        pOp->pos = i;
+        pOp->ticks = APP_BATCH_OP_TIMEOUT_MS / APP_BATCH_TICK_MS;
+        pOp->inUse = TRUE;
+
+        mpBatchOp = pOp;
+        APP_SerialCommand(pFrame->pairs[i]);
+        mpBatchOp = NULL;
+
+        if(pOp->local || !pOp->pSession)
+        {
+            APP_BatchOpDone(pOp, pOp->local);
+        }
+        i++;
+    }
+
+    MEM_BufferFree(pFrame);
+
+    /* Restarting the timer would delay the next tick */
+    if(pReq->inUse && !TMR_IsTimerActive(mBatchTimerId))
+    {
+        (void)TMR_StartIntervalTimer(mBatchTimerId, APP_BATCH_TICK_MS, APP_BatchTimerCb, NULL);
+    }
+}
+
+/*!*************************************************************************************************
+\private
+\fn     static void APP_BatchOpDone(appBatchOp_t *pOp, bool_t success)
+\brief  Reports the completion of a pair, and of its frame if it was the last one.
+
+\param  [in]    pOp        Pointer to the pair
+\param  [in]    success    TRUE if the pair was acknowledged
+***************************************************************************************************/
+static void APP_BatchOpDone
+(
+    appBatchOp_t *pOp,
+    bool_t success
+)
+{
+    appBatchReq_t *pReq = &mBatchReqs[pOp->req];
+
+    pOp->inUse = FALSE;
+    pOp->pSession = NULL;
+
+    shell_printf("@%u %u %c\r\n", pReq->id, pOp->pos, success ? 'S' : 'F');
+
+    pReq->done++;
+    if(success)
+    {
+        pReq->ok++;
+    }
+    if(pReq->done == pReq->total)
+    {
+        shell_printf("@%u D %u %u\r\n", pReq->id, pReq->ok, pReq->total);
+        pReq->inUse = FALSE;
+    }
+}
+
+/*!*************************************************************************************************
+\private
+\fn     static void APP_BatchCoapAckCb(coapSessionStatus_t sessionStatus, void *pData,
+                                       coapSession_t *pSession, uint32_t dataLen)
+\brief  CoAP callback of the batch pairs: marks the pair as acknowledged. The CoAP module
+        closes the session, so it is forgotten.
+
+\param  [in]    sessionStatus   Status for CoAP session
+\param  [in]    pData           Pointer to CoAP message payload
+\param  [in]    pSession        Pointer to CoAP session
+\param  [in]    dataLen         Length of CoAP payload
+***************************************************************************************************/
+static void APP_BatchCoapAckCb
+(
+    coapSessionStatus_t sessionStatus,
+    void *pData,
+    coapSession_t *pSession,
+    uint32_t dataLen
+)
+{
+    uint8_t i;
+
+    for(i = 0; i < APP_BATCH_MAX_OPS; i++)
+    {
+        if(mBatchOps[i].inUse && (mBatchOps[i].pSession == pSession))
+        {
+            mBatchOps[i].pSession = NULL;
+            /* The failures are reported on timeout */
+            if(gCoapFailure_c != sessionStatus)
+            {
+                mBatchOps[i].acked = TRUE;
+                (void)NWKU_SendMsg(APP_BatchUpdate, NULL, mpAppThreadMsgQueue);
+            }
+            break;
+        }
+    }
+}
+
+/*!*************************************************************************************************
+\private
+\fn     static void APP_BatchUpdate(void *param)
+\brief  Reports the pairs acknowledged. Runs in the application task.
+
+\param  [in]    param    Not used
+***************************************************************************************************/
+static void APP_BatchUpdate
+(
+    void *param
+)
+{
+    uint8_t i;
+
+    for(i = 0; i < APP_BATCH_MAX_OPS; i++)
+    {
+        if(mBatchOps[i].inUse && mBatchOps[i].acked)
+        {
+            APP_BatchOpDone(&mBatchOps[i], TRUE);
+        }
+    }
+}
+
+/*!*************************************************************************************************
+\private
+\fn     static void APP_BatchTimerCb(void *param)
+\brief  Batch protocol timer callback.
+
+\param  [in]    param    Not used
+***************************************************************************************************/
+static void APP_BatchTimerCb
+(
+    void *param
+)
+{
+    (void)NWKU_SendMsg(APP_BatchTick, NULL, mpAppThreadMsgQueue);
+}
+
+/*!*************************************************************************************************
+\private
+\fn     static void APP_BatchTick(void *param)
+\brief  Handles the pair timeouts and the end of the discovery. Runs in the application task.
+
+\param  [in]    param    Not used
+***************************************************************************************************/
+static void APP_BatchTick
+(
+    void *param
+)
+{
+    appBatchOp_t *pOp;
+    appBatchReq_t *pReq;
+    bool_t pending = FALSE;
+    uint8_t i;
+
+    /* An ACK may be waiting for APP_BatchUpdate() */
+    APP_BatchUpdate(NULL);
+
+    for(i = 0, pOp = mBatchOps; i < APP_BATCH_MAX_OPS; i++, pOp++)
+    {
+        if(pOp->inUse && !--pOp->ticks)
+        {
+            /* Only a session which is still open is closed */
+            if(pOp->pSession)
+            {
+                COAP_CloseSession(pOp->pSession);
+            }
+            APP_BatchOpDone(pOp, pOp->acked);
+        }
+    }
+
+    for(i = 0, pReq = mBatchReqs; i < APP_BATCH_MAX_REQS; i++, pReq++)
+    {
+        if(pReq->inUse && pReq->discovery && !--pReq->ticks)
+        {
+            shell_printf("@%u N %u\r\n", pReq->id, slave_count);
+            pReq->inUse = FALSE;
+            mBatchDiscovery = FALSE;
+        }
+        pending |= pReq->inUse;
+    }
+
+    if(!pending)
+    {
+        (void)TMR_StopTimer(mBatchTimerId);
+    }
+}
+#endif
+
 
 /*!*************************************************************************************************
 \private
@@ -826,8 +1319,17 @@ static void APP_CoapAddrCb
     {
         char addrStr[INET6_ADDRSTRLEN];
         ntop(AF_INET6, &pSession->remoteAddr, addrStr, INET6_ADDRSTRLEN);
-        slaveIP[slave_count++] = pSession->remoteAddr;
-        shell_printf("%d", slave_count);
+        if(slave_count < SLAVE_NUM_MAX)
+        {
+            slaveIP[slave_count++] = pSession->remoteAddr;
+        }
+#if THREAD_USE_SHELL
+        /* The batch discovery reports the count once, at the end */
+        if(!mBatchDiscovery)
+#endif
+        {
+            shell_printf("%d", slave_count);
+        }
         // In serial just read 3 characters
 #ifdef SHELL_DEBUG
         shell_write("\r");
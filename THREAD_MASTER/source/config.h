@@ -53,6 +53,11 @@ CONFIG APPLICATION
 #define COAP_OBSERVE_CLIENT       0
 #define SHELL_DUT_COMMISSIONER    0
 
+/* Send the shell output in the background: it is printed from CoAP and timer callbacks */
+#define SHELL_ASYNC_OUTPUT        1
+/* The callbacks cannot wait for the output buffer: the lines which do not fit are lost */
+#define SHELL_OUT_FULL_POLICY     SHELL_OUT_DROP
+
 /* Enable CoAP Observe Server */
 #define COAP_OBSERVE_SERVER       0
 #endif
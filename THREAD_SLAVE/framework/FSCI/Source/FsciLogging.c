@@ -45,6 +45,7 @@
 #include "FunctionLib.h"
 #include "MemManager.h"
 #include "SerialManager.h"
+#include "Panic.h"
 
 #include <stdio.h>
 #include <stdarg.h>
@@ -61,6 +62,45 @@
                             gFsciTimestampSize_c - 1)
 #define gFsciFileLogSize_c 220
 
+#if gFsciUseBinLog_c
+#ifndef gFsciBinLogMaxArgs_c
+#define gFsciBinLogMaxArgs_c        8
+#endif
+
+#ifndef gFsciBinLogFlushMs_c
+#define gFsciBinLogFlushMs_c        20 /* milliseconds, records are batched meanwhile */
+#endif
+
+#ifndef gFsciBinLogTaskPriority_c
+#define gFsciBinLogTaskPriority_c   (6)
+#endif
+
+#ifndef gFsciBinLogTaskStackSize_c
+#define gFsciBinLogTaskStackSize_c  (512) /* bytes */
+#endif
+
+#if (gFsciBinLogBufferSize_c & (gFsciBinLogBufferSize_c - 1))
+#error gFsciBinLogBufferSize_c must be a power of 2
+#endif
+
+#define mFsciBinLogWords_c          (gFsciBinLogBufferSize_c / sizeof(uint32_t))
+#define mFsciBinLogIdx(i)           ((i) & (mFsciBinLogWords_c - 1))
+/* Record: header (words | argc << 8), format string address, timestamp, arguments */
+#define mFsciBinLogHdrWords_c       3
+
+#define mFsciBinLogPending_c        (1 << 0)  /* a record was written in the empty ring */
+#define mFsciBinLogHalfFull_c       (1 << 1)
+#endif
+
+/************************************************************************************
+*************************************************************************************
+* Private prototypes
+*************************************************************************************
+************************************************************************************/
+#if gFsciUseBinLog_c && !defined(FWK_SMALL_RAM_CONFIG)
+static void FSCI_BinLogTask(osaTaskParam_t argument);
+#endif
+
 
 /************************************************************************************
 *************************************************************************************
@@ -70,6 +110,24 @@
 
 extern uint8_t gFsciTxDisable;
 
+#if gFsciUseBinLog_c && !defined(FWK_SMALL_RAM_CONFIG)
+extern const uint8_t gUseRtos_c;
+#endif
+
+#if gFsciUseBinLog_c
+/* Ring of log records. The indexes are free running, and a record is valid
+   once its header word is written. The sent words are cleared to 0 */
+static volatile uint32_t mFsciBinLogRing[mFsciBinLogWords_c];
+static volatile uint32_t mFsciBinLogHead;
+static volatile uint32_t mFsciBinLogTail;
+static volatile uint16_t mFsciBinLogDropped;
+
+#if !defined(FWK_SMALL_RAM_CONFIG)
+OSA_TASK_DEFINE( FSCI_BinLogTask, gFsciBinLogTaskPriority_c, 1, gFsciBinLogTaskStackSize_c, FALSE );
+static osaEventId_t mFsciBinLogEventId;
+#endif
+#endif
+
 
 /************************************************************************************
 *************************************************************************************
@@ -282,4 +340,212 @@ void FSCI_LogToFile (char *fileName, uint8_t *pData, uint16_t dataSize, uint8_t
 }
 #endif /* gFsciUseFileDataLog_c */
 
+#if gFsciUseBinLog_c
+/*! *********************************************************************************
+* \brief   Initializes the deferred binary logging, and creates the task which
+*          sends the records. With FWK_SMALL_RAM_CONFIG there is no task, and the
+*          application must call FSCI_BinLogFlush().
+*
+********************************************************************************** */
+void FSCI_BinLogInit (void)
+{
+    TMR_TimeStampInit();
+
+#if !defined(FWK_SMALL_RAM_CONFIG)
+    mFsciBinLogEventId = OSA_EventCreate(TRUE);
+    if( (NULL == mFsciBinLogEventId) ||
+        (NULL == OSA_TaskCreate(OSA_TASK(FSCI_BinLogTask), NULL)) )
+    {
+        panic( ID_PANIC(0,0), (uint32_t)FSCI_BinLogInit, 0, 0 );
+    }
+#endif
+}
+
+/*! *********************************************************************************
+* \brief   Records a log message, to be formatted by the host. Only the address of
+*          the format string, a timestamp and the arguments are stored, so the
+*          function can be called from interrupts. Interrupts are disabled only
+*          while the space is reserved. The records are sent in batches by a low
+*          priority task, and the host tool expands them using the string table of
+*          the ELF file.
+*
+* \param[in] fmt - printf style format string. It must be a string literal (or a
+*                  constant string): the host reads it from the ELF file. Each
+*                  argument is stored as 32 bits, %s arguments must also point
+*                  to constant strings, 64-bit and floating point values are not
+*                  supported.
+* \param[in] argc - the number of arguments, at most gFsciBinLogMaxArgs_c
+* \param[in] ... - the arguments
+*
+* \remarks If the ring is full, the record is dropped and counted. The count is
+*          reported to the host in the next packet.
+*
+********************************************************************************** */
+void FSCI_LogBinary (const char *fmt, uint32_t argc, ...)
+{
+    va_list  argp;
+    uint32_t words;
+    uint32_t used;
+    uint32_t idx;
+    uint32_t i;
+
+    if( argc > gFsciBinLogMaxArgs_c )
+    {
+        argc = gFsciBinLogMaxArgs_c;
+    }
+    words = mFsciBinLogHdrWords_c + argc;
+
+    OSA_InterruptDisable();
+    used = mFsciBinLogHead - mFsciBinLogTail;
+    if( used + words > mFsciBinLogWords_c )
+    {
+        if( mFsciBinLogDropped < 0xFFFF )
+        {
+            mFsciBinLogDropped++;
+        }
+        OSA_InterruptEnable();
+        return;
+    }
+    idx = mFsciBinLogHead;
+    mFsciBinLogHead = idx + words;
+    OSA_InterruptEnable();
+
+    mFsciBinLogRing[mFsciBinLogIdx(idx + 1)] = (uint32_t)fmt;
+    mFsciBinLogRing[mFsciBinLogIdx(idx + 2)] = (uint32_t)TMR_GetTimestamp();
+
+    va_start(argp, argc);
+    for( i = 0; i < argc; i++ )
+    {
+        mFsciBinLogRing[mFsciBinLogIdx(idx + mFsciBinLogHdrWords_c + i)] = va_arg(argp, uint32_t);
+    }
+    va_end(argp);
+
+    /* The record becomes visible to the sender */
+    mFsciBinLogRing[mFsciBinLogIdx(idx)] = words | (argc << 8);
+
+#if !defined(FWK_SMALL_RAM_CONFIG)
+    if( 0 == used )
+    {
+        (void)OSA_EventSet(mFsciBinLogEventId, mFsciBinLogPending_c);
+    }
+    else if( (used < mFsciBinLogWords_c / 2) && (used + words >= mFsciBinLogWords_c / 2) )
+    {
+        (void)OSA_EventSet(mFsciBinLogEventId, mFsciBinLogHalfFull_c);
+    }
+#endif
+}
+
+/*! *********************************************************************************
+* \brief   Sends the complete log records, as many as fit in each FSCI packet.
+*          Payload: number of records dropped since the previous packet (2 bytes),
+*          followed by the records (little endian 32-bit words).
+*
+* \remarks Must not be called from more than one context at a time.
+*
+********************************************************************************** */
+void FSCI_BinLogFlush (void)
+{
+    clientPacket_t *pFsciData = NULL;
+    uint32_t tail = mFsciBinLogTail;
+    uint32_t record;
+    uint32_t words;
+    uint32_t i;
+    uint16_t len = 0;
+    uint16_t dropped;
+
+    if( gFsciTxDisable )
+    {
+        return;
+    }
+
+    while( tail != mFsciBinLogHead )
+    {
+        record = mFsciBinLogRing[mFsciBinLogIdx(tail)];
+        if( 0 == record )
+        {
+            /* The record is still being written */
+            break;
+        }
+        words = record & 0xFF;
+
+        if( pFsciData && (len + words * sizeof(uint32_t) > gFsciMaxPayloadLen_c) )
+        {
+            pFsciData->structured.header.len = len;
+            FSCI_transmitFormatedPacket( pFsciData, gFsciLoggingInterface_c );
+            pFsciData = NULL;
+        }
+
+        if( NULL == pFsciData )
+        {
+            pFsciData = MEM_BufferAlloc(sizeof(clientPacket_t));
+            if( NULL == pFsciData )
+            {
+                /* Retried on the next flush */
+                break;
+            }
+            pFsciData->structured.header.opGroup = gFSCI_LoggingOpcodeGroup_c;
+            pFsciData->structured.header.opCode = gFSCI_BinLogOpCode_c;
+
+            OSA_InterruptDisable();
+            dropped = mFsciBinLogDropped;
+            mFsciBinLogDropped = 0;
+            OSA_InterruptEnable();
+
+            pFsciData->structured.payload[0] = (uint8_t)dropped;
+            pFsciData->structured.payload[1] = (uint8_t)(dropped >> 8);
+            len = sizeof(dropped);
+        }
+
+        for( i = 0; i < words; i++ )
+        {
+            record = mFsciBinLogRing[mFsciBinLogIdx(tail + i)];
+            mFsciBinLogRing[mFsciBinLogIdx(tail + i)] = 0;
+            FLib_MemCpy(&pFsciData->structured.payload[len], &record, sizeof(record));
+            len += sizeof(record);
+        }
+
+        /* Release the space */
+        tail += words;
+        mFsciBinLogTail = tail;
+    }
+
+    if( pFsciData )
+    {
+        pFsciData->structured.header.len = len;
+        FSCI_transmitFormatedPacket( pFsciData, gFsciLoggingInterface_c );
+    }
+}
+
+#if !defined(FWK_SMALL_RAM_CONFIG)
+/*! *********************************************************************************
+* \brief   Sends the log records. After the first record, waits for more records
+*          to be batched in the same packet, unless the ring gets half full.
+*
+* \param[in] argument unused
+*
+********************************************************************************** */
+static void FSCI_BinLogTask(osaTaskParam_t argument)
+{
+    osaEventFlags_t flags;
+
+    while( 1 )
+    {
+        if( mFsciBinLogTail == mFsciBinLogHead )
+        {
+            (void)OSA_EventWait(mFsciBinLogEventId, mFsciBinLogPending_c, FALSE, osaWaitForever_c, &flags);
+        }
+
+        (void)OSA_EventWait(mFsciBinLogEventId, mFsciBinLogHalfFull_c, FALSE, gFsciBinLogFlushMs_c, &flags);
+        FSCI_BinLogFlush();
+
+        /* For BareMetal break the while(1) after 1 run */
+        if( gUseRtos_c == 0 )
+        {
+            break;
+        }
+    }
+}
+#endif
+#endif /* gFsciUseBinLog_c */
+
 #endif /* gFsciIncluded_c */
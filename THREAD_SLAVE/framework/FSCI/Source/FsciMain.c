@@ -43,7 +43,10 @@
 #include "FsciCommands.h"
 #include "FsciCommunication.h"
 #include "MemManager.h"
+#include "FunctionLib.h"
 #include "Messaging.h"
+#include "TimersManager.h"
+#include "fsl_os_abstraction.h"
 
 #if gFsciIncluded_c
 /************************************************************************************
@@ -51,7 +54,11 @@
 * Private macros
 *************************************************************************************
 ************************************************************************************/
+#if (gFsciOpCodeHashSize_c & (gFsciOpCodeHashSize_c - 1)) || (gFsciOpCodeHashSize_c < 2 * gFsciMaxOpCodes_c)
+#error gFsciOpCodeHashSize_c must be a power of 2, at least 2 * gFsciMaxOpCodes_c
+#endif
 
+#define mFsciOpCodeHash(slot, OC) ((((uint32_t)(OC) * 31U) + ((uint32_t)(slot) * 7U)) & (gFsciOpCodeHashSize_c - 1))
 
 /************************************************************************************
 *************************************************************************************
@@ -66,6 +73,32 @@ gFsciOpGroup_t *FSCI_GetReqOpGroup(opGroup_t OG, uint8_t fsciInterface);
 * Private type definitions
 *************************************************************************************
 ************************************************************************************/
+/* defines the OpCode handler table entry */
+typedef struct fsciOpCodeEntry_tag
+{
+    pfMsgHandler_t pfOpCodeHandler;
+    void*          param;
+    uint8_t        opGroupSlot; /* gReqOpGroupTable index + 1, 0 if the entry is free */
+    opCode_t       opCode;
+} fsciOpCodeEntry_t;
+
+static fsciOpCodeEntry_t *FSCI_FindOpCodeEntry(uint8_t opGroupSlot, opCode_t OC);
+
+#if gFsciMonitorFilter_c
+/* defines a monitor subscription */
+typedef struct fsciMonitorSub_tag
+{
+    fsciMonitorStats_t stats;
+    uint64_t       windowStart; /* timestamp of the current rate limit window */
+    uint16_t       maxRate;     /* events per second, 0 if not limited */
+    uint16_t       windowCount; /* events sent in the current rate limit window */
+    uint8_t        sampleRate;  /* one of sampleRate events is sent */
+    uint8_t        sampleCount;
+} fsciMonitorSub_t;
+
+static bool_t FSCI_MonitorFilter(opGroup_t opGroup, uint16_t opCode);
+static void FSCI_MonitorUpdateOpGroups(void);
+#endif
 
 
 /************************************************************************************
@@ -76,6 +109,21 @@ gFsciOpGroup_t *FSCI_GetReqOpGroup(opGroup_t OG, uint8_t fsciInterface);
 static uint8_t  mFsciSrcInterface = mFsciInvalidInterface_c;
 gFsciOpGroup_t  gReqOpGroupTable[gFsciMaxOpGroups_c];
 uint8_t         gNumberOfOG = 0;
+/* gReqOpGroupTable index + 1 of every OpGroup, for each interface. 0 if not registered */
+static uint8_t  mFsciOpGroupIndex[gFsciMaxInterfaces_c][256];
+/* Open addressing hash table of the OpCode handlers, keyed by OpGroup slot and OpCode */
+static fsciOpCodeEntry_t mFsciOpCodeTable[gFsciOpCodeHashSize_c];
+static uint8_t  mFsciOpCodeCount[gFsciMaxOpGroups_c];
+static uint8_t  mFsciNumberOfOC = 0;
+
+#if gFsciMonitorFilter_c
+/* Monitored events are filtered once the host made a subscription */
+static bool_t   mFsciMonitorFilterOn = FALSE;
+/* Bitmap of the OpGroups having at least one subscription */
+static uint32_t mFsciMonitorOpGroups[256/32];
+static fsciMonitorSub_t mFsciMonitorSubs[gFsciMonitorMaxSubscriptions_c];
+static uint8_t  mFsciMonitorSubCount = 0;
+#endif
 
 /************************************************************************************
 *************************************************************************************
@@ -93,6 +141,14 @@ void FSCI_Init( void* argument  )
 {
     /* Initialize the communication interface */
     FSCI_commInit( argument );
+
+#if gFsciUseBinLog_c
+    FSCI_BinLogInit();
+#endif
+
+#if gFsciOtaPipelineDepth_c
+    FSCI_OtaPipelineInit();
+#endif
 }
 
 /*! *********************************************************************************
@@ -141,9 +197,12 @@ gFsciStatus_t FSCI_ProcessRxPkt (clientPacket_t* pPacket, uint32_t fsciInterface
 #endif
 
 /*! *********************************************************************************
-* \brief   This calls the handler for a specific OpGroup
+* \brief   This calls the monitor handler of an OpGroup. If the SAP is in monitor
+*          mode and the host subscribed to some events, the handler is called only
+*          for the subscribed events, see FSCI_MonitorSubscribe().
 *
 * \param[in] opGroup the OpGroup of the message
+* \param[in] opCode the OpCode of the event, or gFsciMonitorAnyOpCode_c if unknown
 * \param[in] pData a pointer to the message payload
 * \param[in] param a pointer to a parameter to be passed to the handler function
 * \param[in] fsciInterface the interface on which the data should be printed
@@ -151,7 +210,7 @@ gFsciStatus_t FSCI_ProcessRxPkt (clientPacket_t* pPacket, uint32_t fsciInterface
 * \return Returns the status of the call process.
 *
 ********************************************************************************** */
-gFsciStatus_t FSCI_Monitor (opGroup_t opGroup, void *pData, void* param, uint32_t fsciInterface)
+static gFsciStatus_t FSCI_MonitorEvent (opGroup_t opGroup, uint16_t opCode, void *pData, void* param, uint32_t fsciInterface)
 {
     gFsciStatus_t status = gFsciSuccess_c;
 #if gFsciIncluded_c
@@ -175,6 +234,12 @@ gFsciStatus_t FSCI_Monitor (opGroup_t opGroup, void *pData, void* param, uint32_
         {
             status = gFsciSAPDisabled_c;
         }
+#if gFsciMonitorFilter_c
+        else if ( (gFsciMonitorMode_c == p->mode) && !FSCI_MonitorFilter(opGroup, opCode) )
+        {
+            /* The host is not interested in this event */
+        }
+#endif
         else
         {
             
@@ -191,9 +256,45 @@ gFsciStatus_t FSCI_Monitor (opGroup_t opGroup, void *pData, void* param, uint32_
         }
     }
 #endif /* gFsciIncluded_c */
+    (void)opCode;
     return status;
 }
 
+/*! *********************************************************************************
+* \brief   This calls the handler for a specific OpGroup. The event matches only
+*          the subscriptions to all the OpCodes of the OpGroup.
+*
+* \param[in] opGroup the OpGroup of the message
+* \param[in] pData a pointer to the message payload
+* \param[in] param a pointer to a parameter to be passed to the handler function
+* \param[in] fsciInterface the interface on which the data should be printed
+*
+* \return Returns the status of the call process.
+*
+********************************************************************************** */
+gFsciStatus_t FSCI_Monitor (opGroup_t opGroup, void *pData, void* param, uint32_t fsciInterface)
+{
+    return FSCI_MonitorEvent(opGroup, gFsciMonitorAnyOpCode_c, pData, param, fsciInterface);
+}
+
+/*! *********************************************************************************
+* \brief   This calls the handler for a specific OpGroup, for an event which can be
+*          filtered by OpCode
+*
+* \param[in] opGroup the OpGroup of the message
+* \param[in] opCode the OpCode of the event sent to the host
+* \param[in] pData a pointer to the message payload
+* \param[in] param a pointer to a parameter to be passed to the handler function
+* \param[in] fsciInterface the interface on which the data should be printed
+*
+* \return Returns the status of the call process.
+*
+********************************************************************************** */
+gFsciStatus_t FSCI_MonitorOpCode (opGroup_t opGroup, opCode_t opCode, void *pData, void* param, uint32_t fsciInterface)
+{
+    return FSCI_MonitorEvent(opGroup, opCode, pData, param, fsciInterface);
+}
+
 #if gFsciIncluded_c
 /*! *********************************************************************************
 * \brief   This calls the handler for a specific OpGroup
@@ -208,6 +309,8 @@ gFsciStatus_t FSCI_Monitor (opGroup_t opGroup, void *pData, void* param, uint32_
 gFsciStatus_t FSCI_CallRegisteredFunc( opGroup_t opGroup, void *pData, uint32_t fsciInterface )
 {
     gFsciOpGroup_t *pOGtable;
+    fsciOpCodeEntry_t *pOCentry = NULL;
+    uint8_t slot;
     gFsciStatus_t status = gFsciSuccess_c;
     extern uint8_t mFsciErrorReported;
 
@@ -226,9 +329,24 @@ gFsciStatus_t FSCI_CallRegisteredFunc( opGroup_t opGroup, void *pData, uint32_t
     }
     else
     {
+        /* A handler registered for the OpCode takes precedence over the OpGroup handler */
+        slot = (uint8_t)(pOGtable - gReqOpGroupTable);
+        if ( mFsciOpCodeCount[slot] )
+        {
+            pOCentry = FSCI_FindOpCodeEntry( slot + 1, ((clientPacket_t*)pData)->structured.header.opCode );
+            if ( 0 == pOCentry->opGroupSlot )
+            {
+                pOCentry = NULL;
+            }
+        }
+
         /* Execute request */
         mFsciSrcInterface = fsciInterface;
-        if ( pOGtable->pfOpGroupHandler )
+        if ( pOCentry )
+        {
+            pOCentry->pfOpCodeHandler( pData, pOCentry->param, fsciInterface );
+        }
+        else if ( pOGtable->pfOpGroupHandler )
         {
             pOGtable->pfOpGroupHandler( pData, pOGtable->param, fsciInterface );
         }
@@ -271,11 +389,209 @@ gFsciStatus_t FSCI_RegisterOpGroup (opGroup_t opGroup,
         gReqOpGroupTable[gNumberOfOG].param = param;
         gReqOpGroupTable[gNumberOfOG].fsciInterfaceId = fsciInterface;
         gNumberOfOG++;
+        mFsciOpGroupIndex[fsciInterface][opGroup] = gNumberOfOG;
+    }
+#endif /* gFsciIncluded_c */
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   This function registers the handler function for a specific OpCode of an
+*          OpGroup. Packets carrying this OpCode are no longer passed to the OpGroup
+*          handler. The OpGroup must be registered first, and its mode still applies.
+*
+* \param[in] opGroup the OpGroup of the message
+* \param[in] opCode the OpCode to be registered
+* \param[in] pfHandler pointer to the message handler function
+* \param[in] param a pointer to a parameter to be passed to the handler function
+* \param[in] fsciInterface the interface on which the OpGroup was registered
+*
+* \return Returns the status of the registration process.
+*
+********************************************************************************** */
+gFsciStatus_t FSCI_RegisterOpCode (opGroup_t opGroup,
+                                   opCode_t opCode,
+                                   pfMsgHandler_t pfHandler,
+                                   void* param,
+                                   uint32_t fsciInterface)
+{
+    gFsciStatus_t status = gFsciSuccess_c;
+#if gFsciIncluded_c
+    gFsciOpGroup_t *pOGtable = FSCI_GetReqOpGroup(opGroup, fsciInterface);
+    fsciOpCodeEntry_t *pOCentry;
+    uint8_t slot;
+
+    if ( NULL == pOGtable )
+    {
+        status = gFsciUnknownOpcodeGroup_c;
+    }
+    else if ( (NULL == pfHandler) || (mFsciNumberOfOC >= gFsciMaxOpCodes_c) )
+    {
+        status = gFsciError_c;
+    }
+    else
+    {
+        slot = (uint8_t)(pOGtable - gReqOpGroupTable);
+        pOCentry = FSCI_FindOpCodeEntry(slot + 1, opCode);
+
+        if ( pOCentry->opGroupSlot ) /* The OpCode is already registered */
+        {
+            status = gFsciError_c;
+        }
+        else
+        {
+            pOCentry->pfOpCodeHandler = pfHandler;
+            pOCentry->param = param;
+            pOCentry->opCode = opCode;
+            pOCentry->opGroupSlot = slot + 1;
+            mFsciOpCodeCount[slot]++;
+            mFsciNumberOfOC++;
+        }
+    }
+#endif /* gFsciIncluded_c */
+    return status;
+}
+
+#if gFsciMonitorFilter_c
+/*! *********************************************************************************
+* \brief   This function subscribes to a monitored event. After the first subscription,
+*          the handlers of the SAPs in monitor mode are called only for the subscribed
+*          events. An existing subscription is updated.
+*
+* \param[in] opGroup the OpGroup passed to FSCI_Monitor()
+* \param[in] opCode the OpCode passed to FSCI_MonitorOpCode(), or gFsciMonitorAnyOpCode_c
+*                   for all the events of the OpGroup
+* \param[in] sampleRate one of sampleRate events is sent. 0 or 1: all the events
+* \param[in] maxRate maximum number of events sent per second. 0: no limit
+*
+* \return Returns the status of the subscription.
+*
+********************************************************************************** */
+gFsciStatus_t FSCI_MonitorSubscribe (opGroup_t opGroup, uint16_t opCode, uint8_t sampleRate, uint16_t maxRate)
+{
+    gFsciStatus_t status = gFsciSuccess_c;
+#if gFsciIncluded_c
+    fsciMonitorSub_t *pSub = NULL;
+    uint32_t i;
+
+    if ( opCode > gFsciMonitorAnyOpCode_c )
+    {
+        return gFsciError_c;
+    }
+
+    OSA_InterruptDisable();
+    for ( i = 0; i < mFsciMonitorSubCount; i++ )
+    {
+        if ( (mFsciMonitorSubs[i].stats.opGroup == opGroup) && (mFsciMonitorSubs[i].stats.opCode == opCode) )
+        {
+            pSub = &mFsciMonitorSubs[i];
+            break;
+        }
+    }
+
+    if ( (NULL == pSub) && (mFsciMonitorSubCount < gFsciMonitorMaxSubscriptions_c) )
+    {
+        pSub = &mFsciMonitorSubs[mFsciMonitorSubCount++];
+        FLib_MemSet(pSub, 0, sizeof(fsciMonitorSub_t));
+        pSub->stats.opGroup = opGroup;
+        pSub->stats.opCode = opCode;
+    }
+
+    if ( NULL == pSub )
+    {
+        status = gFsciTooBig_c;
     }
+    else
+    {
+        pSub->sampleRate = sampleRate;
+        pSub->sampleCount = 0;
+        pSub->maxRate = maxRate;
+        pSub->windowCount = 0;
+        pSub->windowStart = 0;
+        mFsciMonitorFilterOn = TRUE;
+        FSCI_MonitorUpdateOpGroups();
+    }
+    OSA_InterruptEnable();
+#endif /* gFsciIncluded_c */
+    return status;
+}
+
+/*! *********************************************************************************
+* \brief   This function removes a subscription made with FSCI_MonitorSubscribe()
+*
+* \param[in] opGroup the OpGroup of the subscription
+* \param[in] opCode the OpCode of the subscription
+*
+* \return Returns the status of the operation.
+*
+********************************************************************************** */
+gFsciStatus_t FSCI_MonitorUnsubscribe (opGroup_t opGroup, uint16_t opCode)
+{
+    gFsciStatus_t status = gFsciError_c;
+#if gFsciIncluded_c
+    uint32_t i;
+
+    OSA_InterruptDisable();
+    for ( i = 0; i < mFsciMonitorSubCount; i++ )
+    {
+        if ( (mFsciMonitorSubs[i].stats.opGroup == opGroup) && (mFsciMonitorSubs[i].stats.opCode == opCode) )
+        {
+            /* Keep the table compact */
+            mFsciMonitorSubCount--;
+            mFsciMonitorSubs[i] = mFsciMonitorSubs[mFsciMonitorSubCount];
+            FSCI_MonitorUpdateOpGroups();
+            status = gFsciSuccess_c;
+            break;
+        }
+    }
+    OSA_InterruptEnable();
 #endif /* gFsciIncluded_c */
     return status;
 }
 
+/*! *********************************************************************************
+* \brief   This function removes all the subscriptions
+*
+* \param[in] monitorAll TRUE to call the monitor handlers for all the events, as
+*                       before any subscription. FALSE to call them for no event.
+*
+********************************************************************************** */
+void FSCI_MonitorFilterReset (bool_t monitorAll)
+{
+#if gFsciIncluded_c
+    OSA_InterruptDisable();
+    mFsciMonitorSubCount = 0;
+    mFsciMonitorFilterOn = !monitorAll;
+    FSCI_MonitorUpdateOpGroups();
+    OSA_InterruptEnable();
+#endif /* gFsciIncluded_c */
+}
+
+/*! *********************************************************************************
+* \brief   This function reads the counters of a subscription
+*
+* \param[in]  index the index of the subscription
+* \param[out] pStats the counters of the subscription
+*
+* \return Returns FALSE if there is no subscription with this index
+*
+********************************************************************************** */
+bool_t FSCI_MonitorGetStats (uint8_t index, fsciMonitorStats_t *pStats)
+{
+    bool_t found = FALSE;
+#if gFsciIncluded_c
+    OSA_InterruptDisable();
+    if ( index < mFsciMonitorSubCount )
+    {
+        *pStats = mFsciMonitorSubs[index].stats;
+        found = TRUE;
+    }
+    OSA_InterruptEnable();
+#endif /* gFsciIncluded_c */
+    return found;
+}
+#endif /* gFsciMonitorFilter_c */
+
 /************************************************************************************
 *************************************************************************************
 * Private functions
@@ -283,7 +599,9 @@ gFsciStatus_t FSCI_RegisterOpGroup (opGroup_t opGroup,
 ************************************************************************************/
 #if gFsciIncluded_c
 /*! *********************************************************************************
-* \brief   This function searches for an OpGroup in the gReqOpGroupTable
+* \brief   This function searches for an OpGroup in the gReqOpGroupTable.
+*          The lookup goes through the per interface index, so its cost does not
+*          depend on the number of registered OpGroups.
 *
 * \param[in]  OG the OpGroup to be found
 * \param[in]  intf the interface on which the handler was registered
@@ -294,19 +612,150 @@ gFsciStatus_t FSCI_RegisterOpGroup (opGroup_t opGroup,
 ********************************************************************************** */
 gFsciOpGroup_t *FSCI_GetReqOpGroup( opGroup_t OG, uint8_t fsciInterface )
 {
-    uint32_t index;
     gFsciOpGroup_t *p = NULL;
 
-    for ( index = 0; index < gNumberOfOG; index++ )
+    if ( (fsciInterface < gFsciMaxInterfaces_c) && mFsciOpGroupIndex[fsciInterface][OG] )
+    {
+        p = &gReqOpGroupTable[mFsciOpGroupIndex[fsciInterface][OG] - 1];
+    }
+
+    return p;
+}
+
+/*! *********************************************************************************
+* \brief   This function searches for an OpCode handler in the mFsciOpCodeTable
+*
+* \param[in]  opGroupSlot the gReqOpGroupTable index + 1 of the OpGroup
+* \param[in]  OC the OpCode to be found
+*
+* \return  Returns a pointer to the matching entry, or to the free entry where the
+*          OpCode would be stored if it is not registered (opGroupSlot is 0)
+*
+********************************************************************************** */
+static fsciOpCodeEntry_t *FSCI_FindOpCodeEntry( uint8_t opGroupSlot, opCode_t OC )
+{
+    uint32_t index = mFsciOpCodeHash(opGroupSlot, OC);
+    fsciOpCodeEntry_t *p;
+
+    /* The table is never more than half full, so a free entry is always found */
+    for ( ;; )
     {
-        if ( (gReqOpGroupTable[index].opGroup == OG) &&
-             (gReqOpGroupTable[index].fsciInterfaceId == fsciInterface) )
+        p = &mFsciOpCodeTable[index];
+        if ( (0 == p->opGroupSlot) || ((p->opGroupSlot == opGroupSlot) && (p->opCode == OC)) )
         {
-            p = (gFsciOpGroup_t*)&gReqOpGroupTable[index];
             break;
         }
+        index = (index + 1) & (gFsciOpCodeHashSize_c - 1);
     }
 
     return p;
 }
+
+#if gFsciMonitorFilter_c
+/*! *********************************************************************************
+* \brief   This function checks if a monitored event must be sent to the host.
+*          The subscription to the OpCode takes precedence over the subscription
+*          to the whole OpGroup. The sampling and the rate limit are applied here.
+*
+* \param[in]  opGroup the OpGroup of the event
+* \param[in]  opCode the OpCode of the event, or gFsciMonitorAnyOpCode_c if unknown
+*
+* \return  Returns TRUE if the monitor handler must be called
+*
+********************************************************************************** */
+static bool_t FSCI_MonitorFilter( opGroup_t opGroup, uint16_t opCode )
+{
+    fsciMonitorSub_t *pSub = NULL;
+    bool_t send;
+    uint64_t now;
+    uint32_t i;
+
+    if ( !mFsciMonitorFilterOn )
+    {
+        return TRUE;
+    }
+
+    /* Fast path: nobody subscribed to this OpGroup */
+    if ( 0 == (mFsciMonitorOpGroups[opGroup >> 5] & (1UL << (opGroup & 0x1F))) )
+    {
+        return FALSE;
+    }
+
+    OSA_InterruptDisable();
+    for ( i = 0; i < mFsciMonitorSubCount; i++ )
+    {
+        if ( mFsciMonitorSubs[i].stats.opGroup == opGroup )
+        {
+            if ( mFsciMonitorSubs[i].stats.opCode == opCode )
+            {
+                pSub = &mFsciMonitorSubs[i];
+                break;
+            }
+            else if ( gFsciMonitorAnyOpCode_c == mFsciMonitorSubs[i].stats.opCode )
+            {
+                pSub = &mFsciMonitorSubs[i];
+            }
+        }
+    }
+
+    send = (NULL != pSub);
+    if ( send && (pSub->sampleRate > 1) )
+    {
+        if ( ++pSub->sampleCount < pSub->sampleRate )
+        {
+            send = FALSE;
+        }
+        else
+        {
+            pSub->sampleCount = 0;
+        }
+    }
+
+    if ( send && pSub->maxRate )
+    {
+        now = TMR_GetTimestamp();
+        if ( (now - pSub->windowStart) >= 1000000 )
+        {
+            pSub->windowStart = now;
+            pSub->windowCount = 0;
+        }
+
+        if ( pSub->windowCount >= pSub->maxRate )
+        {
+            send = FALSE;
+        }
+        else
+        {
+            pSub->windowCount++;
+        }
+    }
+
+    if ( send )
+    {
+        pSub->stats.sent++;
+    }
+    else if ( pSub )
+    {
+        pSub->stats.dropped++;
+    }
+    OSA_InterruptEnable();
+
+    return send;
+}
+
+/*! *********************************************************************************
+* \brief   This function rebuilds the bitmap of the subscribed OpGroups
+*
+********************************************************************************** */
+static void FSCI_MonitorUpdateOpGroups( void )
+{
+    uint32_t i;
+
+    FLib_MemSet(mFsciMonitorOpGroups, 0, sizeof(mFsciMonitorOpGroups));
+    for ( i = 0; i < mFsciMonitorSubCount; i++ )
+    {
+        mFsciMonitorOpGroups[mFsciMonitorSubs[i].stats.opGroup >> 5] |= 1UL << (mFsciMonitorSubs[i].stats.opGroup & 0x1F);
+    }
+}
+#endif /* gFsciMonitorFilter_c */
 #endif /* gFsciIncluded_c */
\ No newline at end of file
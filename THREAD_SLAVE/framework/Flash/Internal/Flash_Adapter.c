@@ -58,6 +58,9 @@
 
 /* Generator for CRC calculations. */
 #define POLGEN  0x1021              
+
+/* Address of the write combining buffer when no phrase is buffered */
+#define mFA_WcNoPhrase_c             0xFFFFFFFFUL
 /*! *********************************************************************************
 *************************************************************************************
 * Private type definitions
@@ -73,6 +76,9 @@ static uint32_t NV_FlashProgramAdaptation(uint32_t dest, uint32_t size, uint8_t*
 static uint8_t  NV_VerifyCrcOverHWParameters(hardwareParameters_t* pHwParams);
 static uint16_t NV_ComputeCrcOverHWParameters(hardwareParameters_t* pHwParams);
 static void NV_Flash_WaitForCSEndAndDisableInterrupts(void);
+#if gNvWriteCombining_c
+static uint32_t NV_FlashWcFlush(void);
+#endif
 /*! *********************************************************************************
 *************************************************************************************
 * Public memory declarations
@@ -89,6 +95,11 @@ static osaSemaphoreId_t       mFlashAdapterSemaphoreId;
 #endif
 static volatile uint8_t mFA_CSFlag = 0;
 static volatile uint8_t mFA_SemWaitCount = 0;
+#if gNvWriteCombining_c
+/* Phrase being gathered by NV_FlashProgramUnaligned() and its flash address */
+static uint8_t  mFA_WcBuffer[PGM_SIZE_BYTE];
+static uint32_t mFA_WcAddress = mFA_WcNoPhrase_c;
+#endif
 /*****************************************************************************
  *****************************************************************************
  * Private functions
@@ -186,6 +197,27 @@ static uint32_t NV_FlashProgramAdaptation(uint32_t dest, uint32_t size, uint8_t*
   return status;
 }
 
+#if gNvWriteCombining_c
+/*! *********************************************************************************
+ * \brief  Program the phrase held by the write combining buffer, if any.
+ *         Must be called with the flash command sequence protection taken.
+ *
+ * \return error code
+ *
+********************************************************************************** */
+static uint32_t NV_FlashWcFlush(void)
+{
+    uint32_t status = kStatus_FLASH_Success;
+    
+    if(mFA_WcAddress != mFA_WcNoPhrase_c)
+    {
+        status = NV_FlashProgramAdaptation(mFA_WcAddress, PGM_SIZE_BYTE, mFA_WcBuffer);
+        mFA_WcAddress = mFA_WcNoPhrase_c;
+    }
+    return status;
+}
+#endif
+
 /*! *********************************************************************************
  * \brief  Verifies if the CRC field matches computed CRC over stored values 
  * 
@@ -348,6 +380,10 @@ uint32_t NV_FlashVerifyErase ( uint32_t start, uint32_t lengthInBytes, flash_mar
   uint32_t status;
 #if gNvDisableIntCmdSeq_c
     NV_Flash_WaitForCSEndAndDisableInterrupts();
+#endif
+#if gNvWriteCombining_c
+    status = NV_FlashWcFlush();
+    if(status == kStatus_FLASH_Success)
 #endif
     status = FLASH_VerifyErase(&gFlashConfig, start, lengthInBytes, margin);
 #if gNvDisableIntCmdSeq_c
@@ -375,6 +411,11 @@ uint32_t NV_FlashProgram (         uint32_t dest,
     #if gNvDisableIntCmdSeq_c
         NV_Flash_WaitForCSEndAndDisableInterrupts();
     #endif
+    #if gNvWriteCombining_c
+    /* the buffered phrase was written first, keep the program order */
+    status = NV_FlashWcFlush();
+    if(status == kStatus_FLASH_Success)
+    #endif
     status = NV_FlashProgramAdaptation(dest, size, pData);
     #if gNvDisableIntCmdSeq_c
         OSA_InterruptEnable();
@@ -393,7 +434,86 @@ uint32_t NV_FlashProgram (         uint32_t dest,
  *
  * \return error code
  *
+ * \remarks When gNvWriteCombining_c is enabled, the bytes which do not fill a
+ *          whole phrase are gathered in RAM and are programmed together with
+ *          the next adjacent write, or when the write buffer is flushed.
+ *
 ********************************************************************************** */
+#if gNvWriteCombining_c
+uint32_t NV_FlashProgramUnaligned(
+                                  uint32_t dest,
+                                  uint32_t size,
+                                  uint8_t* pData)
+{
+    uint32_t phrase;
+    uint32_t bytes;
+    uint32_t status = kStatus_FLASH_Success;
+
+#if gNvDisableIntCmdSeq_c
+    NV_Flash_WaitForCSEndAndDisableInterrupts();
+#endif
+    while( size )
+    {
+        phrase = dest & ~(PGM_SIZE_BYTE - 1U);
+        bytes  = dest - phrase;
+
+        if( (bytes == 0) && (size >= PGM_SIZE_BYTE) && (phrase != mFA_WcAddress) )
+        {
+            /* whole phrases are programmed directly, after the buffered one */
+            status = NV_FlashWcFlush();
+            if( status != kStatus_FLASH_Success )
+            {
+                break;
+            }
+            bytes = size & ~(PGM_SIZE_BYTE - 1U);
+            status = NV_FlashProgramAdaptation(dest, bytes, pData);
+            if( status != kStatus_FLASH_Success )
+            {
+                break;
+            }
+        }
+        else
+        {
+            if( phrase != mFA_WcAddress )
+            {
+                status = NV_FlashWcFlush();
+                if( status != kStatus_FLASH_Success )
+                {
+                    break;
+                }
+                FLib_MemCpy(mFA_WcBuffer, (void*)phrase, PGM_SIZE_BYTE);
+                mFA_WcAddress = phrase;
+            }
+
+            FLib_MemCpy(&mFA_WcBuffer[bytes], pData, (PGM_SIZE_BYTE - bytes) < size ? (PGM_SIZE_BYTE - bytes) : size);
+
+            if( (PGM_SIZE_BYTE - bytes) <= size )
+            {
+                /* the phrase is complete */
+                bytes = PGM_SIZE_BYTE - bytes;
+                status = NV_FlashWcFlush();
+                if( status != kStatus_FLASH_Success )
+                {
+                    break;
+                }
+            }
+            else
+            {
+                bytes = size;
+            }
+        }
+
+        dest  += bytes;
+        pData += bytes;
+        size  -= bytes;
+    }
+#if gNvDisableIntCmdSeq_c
+    OSA_InterruptEnable();
+#endif
+
+    return status;
+}
+#else
 uint32_t NV_FlashProgramUnaligned(
                                   uint32_t dest,
                                   uint32_t size,
@@ -471,6 +591,31 @@ uint32_t NV_FlashProgramUnaligned(
     
     return kStatus_FLASH_Success;
 }
+#endif /* gNvWriteCombining_c */
+
+/*! *********************************************************************************
+ * \brief  Program the phrase gathered by NV_FlashProgramUnaligned(), if any.
+ *
+ * \return error code
+ *
+********************************************************************************** */
+uint32_t NV_FlashFlushWriteBuffer(void)
+{
+    uint32_t status = kStatus_FLASH_Success;
+#if gNvWriteCombining_c
+    if(mFA_WcAddress != mFA_WcNoPhrase_c)
+    {
+#if gNvDisableIntCmdSeq_c
+        NV_Flash_WaitForCSEndAndDisableInterrupts();
+#endif
+        status = NV_FlashWcFlush();
+#if gNvDisableIntCmdSeq_c
+        OSA_InterruptEnable();
+#endif
+    }
+#endif
+    return status;
+}
 
 /*! *********************************************************************************
  * \brief  Erase to 0xFF one ore more FLASH sectors.
@@ -485,9 +630,21 @@ uint32_t NV_FlashProgramUnaligned(
 ********************************************************************************** */
 uint32_t NV_FlashEraseSector(uint32_t dest, uint32_t size)
 {
-    uint32_t status;
+    uint32_t status = kStatus_FLASH_Success;
 #if gNvDisableIntCmdSeq_c
     NV_Flash_WaitForCSEndAndDisableInterrupts();
+#endif
+#if gNvWriteCombining_c
+    if((mFA_WcAddress >= dest) && (mFA_WcAddress - dest < size))
+    {
+        /* the buffered phrase would be erased anyway */
+        mFA_WcAddress = mFA_WcNoPhrase_c;
+    }
+    else
+    {
+        status = NV_FlashWcFlush();
+    }
+    if(status == kStatus_FLASH_Success)
 #endif
     status = FLASH_Erase(&gFlashConfig, dest, size, kFLASH_ApiEraseKey);
 #if gNvDisableIntCmdSeq_c
@@ -552,6 +709,12 @@ uint32_t NV_WriteHWParameters(hardwareParameters_t *pHwParams)
             status = NV_FlashProgramUnaligned((uint32_t)FREESCALE_PROD_DATA_BASE_ADDR,
                                               sizeof(hardwareParameters_t),
                                               (uint8_t*)pHwParams);
+#if gNvWriteCombining_c
+            if( 0 == status )
+            {
+                status = NV_FlashFlushWriteBuffer();
+            }
+#endif
         }
     }
     return status;
@@ -96,6 +96,12 @@
  */
 #define gNvCopyAll_c                   0xFFFFU
 
+/*
+ * Name: gNvPendingSavesHashSize_c
+ * Description: the number of entry ID buckets used to index the pending saves queue
+ */
+#define gNvPendingSavesHashSize_c      gNvPendingSavesQueueSize_c
+
 /*
  * Name: gNvFlexFormatBufferSize_c
  * Description: the size of the buffer used for FlexNVM formating. The FlexRAM
@@ -200,7 +206,11 @@ typedef enum NVM_VirtualPageID_tag
 {
     gFirstVirtualPage_c = 0,
     gSecondVirtualPage_c,
+#if gNvCircularLog_d
+    gVirtualPageNone_c = gNvCircularLogPagesCount_c
+#else
     gVirtualPageNone_c
+#endif
 } NVM_VirtualPageID_t;
 
 /*
@@ -226,6 +236,38 @@ typedef struct NVM_ErasePageCmdStatus_tag
     uint32_t NvSectorAddress;
 } NVM_ErasePageCmdStatus_t;
 
+/*
+ * Name: NVM_CopyPageCmdStatus_t
+ * Description: progress of a page copy performed in several steps
+ */
+typedef struct NVM_CopyPageCmdStatus_tag
+{
+    bool_t NvCopyInProgress;
+    NVM_VirtualPageID_t NvDstPageId;
+    NvTableEntryId_t NvSkipEntryId;
+    uint32_t NvSrcMetaAddress;
+    uint32_t NvDstMetaAddress;
+    uint32_t NvDstRecordAddress;
+#if gNvUseExtendedFeatureSet_d
+    bool_t NvTableUpgraded;
+#endif
+#if gNvCircularLog_d
+    uint32_t NvMovedBytesCount;    /* bytes written to the active page by the reclaim of the oldest log page */
+#endif
+} NVM_CopyPageCmdStatus_t;
+
+/*
+ * Name: NVM_UnmirroredCacheEntry_t
+ * Description: location of the most recent record of an unmirrored element
+ */
+typedef struct NVM_UnmirroredCacheEntry_tag
+{
+    NvTableEntryId_t entryId;      /* gNvInvalidDataEntry_c if the cache entry is free */
+    uint16_t elementIndex;
+    uint16_t recordOffset;         /* offset in the active page, 0 if the element was erased */
+    uint32_t lastUse;              /* value of the cache use counter at the last hit */
+} NVM_UnmirroredCacheEntry_t;
+
 /*
  * Name: NVM_TableEntryInfo_t
  * Description: table entry indexes type definition
@@ -247,6 +289,9 @@ typedef struct NVM_SaveQueue_tag
     index_t  Head;    /* read index */
     index_t  Tail;    /* write index */
     uint8_t EntriesCount; /* entries count */
+    uint8_t HashHead[gNvPendingSavesHashSize_c];  /* first queued request (slot + 1) of each entry ID bucket, 0 if none */
+    uint8_t HashNext[gNvPendingSavesQueueSize_c]; /* next queued request (slot + 1) in the same bucket, 0 if none */
+    uint32_t InvalidSlots[(gNvPendingSavesQueueSize_c + 31) / 32]; /* bitmap of the cancelled requests still in queue */
 } NVM_SaveQueue_t;
 
 /*
@@ -68,10 +68,42 @@
 #define gSerialMgrRxBufSize_c               (32)
 #endif
 
+/* Defines what happens when a byte is received and the Rx buffer is full:
+1 - the new byte is dropped, so the buffered data is never overwritten
+0 - the oldest byte from the Rx buffer is discarded */
+#ifndef gSerialMgrLosslessRx_c
+#define gSerialMgrLosslessRx_c              (1)
+#endif
+
+/* Default Rx buffer fill levels (in percents) used for flow control.
+Above the high watermark the sender is throttled, below the low watermark it is resumed */
+#ifndef gSerialMgrRxHighWatermark_c
+#define gSerialMgrRxHighWatermark_c         (75)
+#endif
+#ifndef gSerialMgrRxLowWatermark_c
+#define gSerialMgrRxLowWatermark_c          (25)
+#endif
+
 #ifndef gSerialMgrTxQueueSize_c
 #define gSerialMgrTxQueueSize_c             (5)
 #endif
 
+/* Size of the Tx staging buffers used to merge small writes into a single transfer.
+Two buffers of this size are allocated for each interface. 0 - means that Tx coalescing is disabled */
+#ifndef gSerialMgrTxCoalescingBufSize_c
+#define gSerialMgrTxCoalescingBufSize_c     (0)
+#endif
+
+/* Writes up to this number of bytes are merged into the Tx staging buffer */
+#ifndef gSerialMgrTxCoalescingMaxWrite_c
+#define gSerialMgrTxCoalescingMaxWrite_c    (16)
+#endif
+
+/* Time (in milliseconds) without new writes after which the staged data is sent */
+#ifndef gSerialMgrTxCoalescingTimeout_c
+#define gSerialMgrTxCoalescingTimeout_c     (2)
+#endif
+
 /* Enables/Disables parameter checking */
 #ifndef gSerialMgr_ParamValidation_d
 #define gSerialMgr_ParamValidation_d        (1)
@@ -106,6 +138,9 @@
 #ifndef gSerialMgrUseCustomInterface_c
 #define gSerialMgrUseCustomInterface_c      (0)
 #endif
+#ifndef gSerialMgrUseMux_c
+#define gSerialMgrUseMux_c                  (0) /* channel multiplexer, see SerialMux.h */
+#endif
 
 #if gSerialMgrUseSPI_c
 #ifndef gSerialMgrUseFSCIHdr_c
@@ -176,7 +211,8 @@ typedef enum{
     gSerialMgrSPISlave_c  = 7,
     gSerialMgrLpuart_c    = 8,
     gSerialMgrLpsci_c     = 9,
-    gSerialMgrCustom_c    = 10
+    gSerialMgrCustom_c    = 10,
+    gSerialMgrMux_c       = 11
 }serialInterfaceType_t;
 
 /* Define if the Tx is blocking or not */
@@ -196,6 +232,37 @@ BigEndian=1/LittleEndian=0, newline, commas or spaces (between bytes) */
 /* Serial Manager callback type */
 typedef void (*pSerialCallBack_t)(void* param);
 
+/* Segment of a scatter/gather transmission (see Serial_AsyncWriteV) */
+typedef struct serialSegment_tag{
+    uint8_t          *pData;
+    uint16_t          dataSize;
+    pSerialCallBack_t releaseCb;     /* called when the segment was sent, may be NULL */
+    void             *pReleaseParam;
+}serialSegment_t;
+
+/* Tx coalescing statistics of a serial interface */
+typedef struct serialTxStatistics_tag{
+    uint32_t mergedWrites;   /* writes copied into the Tx staging buffer */
+    uint32_t transfersSaved; /* transfers avoided by sending merged writes together */
+    uint32_t flushes;        /* transfers of the Tx staging buffer */
+}serialTxStatistics_t;
+
+/* Rx flow control events */
+typedef enum{
+    gSerialRxAboveHighWatermark_c = 0,
+    gSerialRxBelowLowWatermark_c  = 1
+}serialRxFlowEvent_t;
+
+/* Rx flow control callback type. Called from ISR context for gSerialRxAboveHighWatermark_c */
+typedef void (*pSerialRxFlowCallBack_t)(void* param, serialRxFlowEvent_t event);
+
+/* Rx statistics of a serial interface */
+typedef struct serialRxStatistics_tag{
+    uint32_t overruns;  /* bytes lost by the HW because they were not read in time */
+    uint32_t drops;     /* bytes discarded because the Rx buffer was full */
+    uint32_t throttles; /* number of times the high watermark was reached */
+}serialRxStatistics_t;
+
 /* Supported baudrates for UART */
 typedef enum{
     gUARTBaudRate1200_c   =   1200UL,
@@ -272,10 +339,20 @@ serialStatus_t Serial_SetBaudRate (uint8_t InterfaceId, uint32_t baudRate);
 serialStatus_t Serial_RxBufferByteCount (uint8_t InterfaceId, uint16_t *bytesCount);
 serialStatus_t Serial_SetRxCallBack (uint8_t InterfaceId, pSerialCallBack_t cb, void *pRxParam);
 serialStatus_t Serial_Read (uint8_t InterfaceId, uint8_t *pData, uint16_t dataSize, uint16_t *bytesRead);
+serialStatus_t Serial_RxPeek (uint8_t InterfaceId, uint8_t **ppData, uint16_t *pSize);
+serialStatus_t Serial_RxConsume (uint8_t InterfaceId, uint16_t count);
+serialStatus_t Serial_SetRxBuffer (uint8_t InterfaceId, uint8_t *pBuffer, uint16_t size);
+serialStatus_t Serial_SetRxWatermarks (uint8_t InterfaceId, uint16_t highWatermark, uint16_t lowWatermark,
+                                       pSerialRxFlowCallBack_t cb, void *pParam);
+serialStatus_t Serial_GetRxStatistics (uint8_t InterfaceId, serialRxStatistics_t *pStats);
 
 serialStatus_t Serial_SyncWrite (uint8_t InterfaceId, uint8_t *pBuf, uint16_t bufLen);
 serialStatus_t Serial_AsyncWrite (uint8_t InterfaceId, uint8_t *pBuf, uint16_t bufLen,
                                   pSerialCallBack_t cb, void *pTxParam);
+serialStatus_t Serial_AsyncWriteV (uint8_t InterfaceId, const serialSegment_t *pSegments, uint8_t count);
+serialStatus_t Serial_SetTxCoalescing (uint8_t InterfaceId, bool_t enable);
+serialStatus_t Serial_TxFlush (uint8_t InterfaceId);
+serialStatus_t Serial_GetTxStatistics (uint8_t InterfaceId, serialTxStatistics_t *pStats);
 
 serialStatus_t Serial_Print (uint8_t InterfaceId, char * pString, serialBlock_t allowToBlock);
 serialStatus_t Serial_PrintHex (uint8_t InterfaceId, uint8_t *hex, uint8_t len, uint8_t flags);
@@ -285,11 +362,13 @@ serialStatus_t Serial_EnableLowPowerWakeup( serialInterfaceType_t interfaceType)
 serialStatus_t Serial_DisableLowPowerWakeup( serialInterfaceType_t interfaceType);
 bool_t Serial_IsWakeUpSource( serialInterfaceType_t interfaceType);
 
-/* SerialManager API for a custom interface */
-#if gSerialMgrUseCustomInterface_c
+/* SerialManager API for a custom interface and for the channel multiplexer */
+#if gSerialMgrUseCustomInterface_c || gSerialMgrUseMux_c
 uint32_t Serial_CustomReceiveData(uint8_t InterfaceId, uint8_t *pRxData, uint32_t size);
-extern uint32_t Serial_CustomSendData(uint8_t *pData, uint32_t size);
 void Serial_CustomSendCompleted(uint32_t InterfaceId);
 #endif
+#if gSerialMgrUseCustomInterface_c
+extern uint32_t Serial_CustomSendData(uint8_t *pData, uint32_t size);
+#endif
 
 #endif /* __SERIAL_MANAGER_H__ */
@@ -0,0 +1,636 @@
+/*!
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+*
+* \file
+*
+* This is the source file for the serial channel multiplexer.
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* o Redistributions of source code must retain the above copyright notice, this list
+*   of conditions and the following disclaimer.
+*
+* o Redistributions in binary form must reproduce the above copyright notice, this
+*   list of conditions and the following disclaimer in the documentation and/or
+*   other materials provided with the distribution.
+*
+* o Neither the name of Freescale Semiconductor, Inc. nor the names of its
+*   contributors may be used to endorse or promote products derived from this
+*   software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*! *********************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+********************************************************************************** */
+#include "SerialManager.h"
+#include "SerialMux.h"
+#include "FunctionLib.h"
+#include "fsl_os_abstraction.h"
+
+#if (gSerialManagerMaxInterfaces_c) && (gSerialMgrUseMux_c)
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+********************************************************************************** */
+#if (gSerialMuxMaxChannels_c > 16) || (gSerialMuxMaxPayload_c > 255)
+#error The channel multiplexer supports up to 16 channels and 255 bytes of payload
+#endif
+
+#if (gSerialMgrTxQueueSize_c < 3)
+#error The channel multiplexer needs 3 Tx queue entries of the physical interface
+#endif
+
+#define mSerialMuxSync_c         (0xA5)
+#define mSerialMuxHdrSize_c      (3)
+#define mSerialMuxTypeData_c     (0)
+#define mSerialMuxTypeCredit_c   (1)
+#define mSerialMuxCreditSize_c   (2)
+
+#define mSerialMuxNoChannel_c    (0xFF)
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private type definitions
+*************************************************************************************
+********************************************************************************** */
+typedef enum{
+    mMuxRxSync_c,
+    mMuxRxHeader_c,
+    mMuxRxLength_c,
+    mMuxRxPayload_c,
+    mMuxRxChecksum_c
+}serialMuxRxState_t;
+
+typedef struct serialMuxChannel_tag{
+    uint8_t   interfaceId;     /* virtual interface, gSerialMgrInvalidIdx_c if the channel is closed */
+    uint8_t   priority;
+    uint8_t   creditPending;   /* the Rx credit must be sent to the peer */
+    uint8_t  *pTxData;         /* remaining data of the virtual interface transfer */
+    uint16_t  txLeft;
+    uint16_t  txSent;          /* payload bytes sent since start-up (modulo 2^16) */
+    uint16_t  txLimit;         /* payload bytes the peer accepts since start-up */
+    uint16_t  rxReceived;      /* payload bytes received since start-up */
+    uint16_t  rxLimit;         /* payload bytes granted to the peer */
+}serialMuxChannel_t;
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private prototypes
+*************************************************************************************
+********************************************************************************** */
+static void SerialMux_TxSchedule(void);
+static void SerialMux_TxDone(void *param);
+static void SerialMux_RxCallback(void *param);
+static void SerialMux_RxByte(uint8_t byte);
+static void SerialMux_RxFrame(void);
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+********************************************************************************** */
+static uint8_t            mMuxInterfaceId = gSerialMgrInvalidIdx_c;
+static serialMuxChannel_t mMuxChannels[gSerialMuxMaxChannels_c];
+static serialMuxStatistics_t mMuxStats;
+
+/* Frame in transmission. Only one frame is queued on the physical interface at
+a time, so that the next frame is chosen by priority when it was sent */
+static volatile uint8_t   mMuxTxBusy;
+static uint8_t            mMuxTxChannel;
+static uint8_t            mMuxTxType;
+static uint8_t            mMuxTxPayloadSize;
+static uint8_t            mMuxTxLastChannel;
+static uint8_t            mMuxTxHeader[mSerialMuxHdrSize_c + mSerialMuxCreditSize_c];
+static uint8_t            mMuxTxChecksum;
+
+/* Frame in reception */
+static serialMuxRxState_t mMuxRxState;
+static uint8_t            mMuxRxHeader;
+static uint8_t            mMuxRxLength;
+static uint8_t            mMuxRxCount;
+static uint8_t            mMuxRxChecksum;
+static uint8_t            mMuxRxPayload[gSerialMuxMaxPayload_c];
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+********************************************************************************** */
+
+/*! *********************************************************************************
+* \brief   Starts the channel multiplexer on a physical interface. The interface
+*          must not be used directly after this call.
+*
+* \param[in] phyInterfaceId the physical interface number
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t SerialMux_Init( uint8_t phyInterfaceId )
+{
+    uint32_t i;
+
+#if gSerialMgr_ParamValidation_d
+    if( phyInterfaceId >= gSerialManagerMaxInterfaces_c )
+    {
+        return gSerial_InvalidParameter_c;
+    }
+#endif
+
+    for( i = 0; i < gSerialMuxMaxChannels_c; i++ )
+    {
+        mMuxChannels[i].interfaceId = gSerialMgrInvalidIdx_c;
+        mMuxChannels[i].priority = 0;
+        mMuxChannels[i].creditPending = 0;
+        mMuxChannels[i].pTxData = NULL;
+        mMuxChannels[i].txLeft = 0;
+        mMuxChannels[i].txSent = 0;
+        mMuxChannels[i].txLimit = gSerialMuxRxWindow_c;
+        mMuxChannels[i].rxReceived = 0;
+        mMuxChannels[i].rxLimit = gSerialMuxRxWindow_c;
+    }
+
+    FLib_MemSet(&mMuxStats, 0x00, sizeof(mMuxStats));
+    mMuxTxBusy = 0;
+    mMuxTxLastChannel = 0;
+    mMuxRxState = mMuxRxSync_c;
+    mMuxInterfaceId = phyInterfaceId;
+
+    return Serial_SetRxCallBack(phyInterfaceId, SerialMux_RxCallback, NULL);
+}
+
+/*! *********************************************************************************
+* \brief   Sets the priority of a channel. When several channels have data to send,
+*          the next frame is taken from the channel with the highest priority.
+*          Channels with the same priority are served in turns.
+*
+* \param[in] channel the channel number
+* \param[in] priority the priority of the channel (0 - lowest)
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t SerialMux_SetPriority( uint8_t channel, uint8_t priority )
+{
+    if( channel >= gSerialMuxMaxChannels_c )
+    {
+        return gSerial_InvalidParameter_c;
+    }
+
+    mMuxChannels[channel].priority = priority;
+    return gSerial_Success_c;
+}
+
+/*! *********************************************************************************
+* \brief   Returns the channel multiplexer counters
+*
+* \param[out] pStats pointer to location where to store the counters
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t SerialMux_GetStatistics( serialMuxStatistics_t *pStats )
+{
+    if( NULL == pStats )
+    {
+        return gSerial_InvalidParameter_c;
+    }
+
+    OSA_InterruptDisable();
+    *pStats = mMuxStats;
+    OSA_InterruptEnable();
+    return gSerial_Success_c;
+}
+
+/*! *********************************************************************************
+* \brief   Binds a channel to a virtual interface. Called by Serial_InitInterface()
+*
+* \param[in] channel the channel number
+* \param[in] InterfaceId the virtual interface number
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t SerialMux_OpenChannel( uint8_t channel, uint8_t InterfaceId )
+{
+    if( (gSerialMgrInvalidIdx_c == mMuxInterfaceId) || (channel >= gSerialMuxMaxChannels_c) )
+    {
+        return gSerial_InvalidInterface_c;
+    }
+
+    if( gSerialMgrInvalidIdx_c != mMuxChannels[channel].interfaceId )
+    {
+        return gSerial_InterfaceInUse_c;
+    }
+
+    mMuxChannels[channel].interfaceId = InterfaceId;
+    return gSerial_Success_c;
+}
+
+/*! *********************************************************************************
+* \brief   Starts the transmission of a virtual interface buffer. The buffer is
+*          split into frames, and Serial_CustomSendCompleted() is called after
+*          the last one was sent.
+*
+* \param[in] channel the channel number
+* \param[in] pData pointer to the data
+* \param[in] size the number of bytes to be sent
+*
+* \return The status of the operation
+*
+********************************************************************************** */
+serialStatus_t SerialMux_SendData( uint8_t channel, uint8_t *pData, uint16_t size )
+{
+    serialMuxChannel_t *pCh;
+
+    if( (channel >= gSerialMuxMaxChannels_c) || (0 == size) )
+    {
+        return gSerial_InvalidParameter_c;
+    }
+
+    pCh = &mMuxChannels[channel];
+
+    OSA_InterruptDisable();
+    if( pCh->txLeft )
+    {
+        OSA_InterruptEnable();
+        return gSerial_InterfaceInUse_c;
+    }
+    pCh->pTxData = pData;
+    pCh->txLeft = size;
+    OSA_InterruptEnable();
+
+    SerialMux_TxSchedule();
+    return gSerial_Success_c;
+}
+
+/*! *********************************************************************************
+* \brief   Called after the application read data of a channel. Gives the peer
+*          credit for the freed space.
+*
+* \param[in] channel the channel number
+*
+********************************************************************************** */
+void SerialMux_RxConsumed( uint8_t channel )
+{
+    serialMuxChannel_t *pCh;
+    uint16_t pending = 0;
+    uint16_t limit;
+    bool_t send = FALSE;
+
+    if( channel >= gSerialMuxMaxChannels_c )
+    {
+        return;
+    }
+
+    pCh = &mMuxChannels[channel];
+    (void)Serial_RxBufferByteCount(pCh->interfaceId, &pending);
+
+    OSA_InterruptDisable();
+    limit = pCh->rxReceived - pending + gSerialMuxRxWindow_c;
+    /* Avoid a credit frame for each byte read */
+    if( ((uint16_t)(limit - pCh->rxLimit) >= (gSerialMuxRxWindow_c / 2)) ||
+        ((0 == pending) && (limit != pCh->rxLimit)) )
+    {
+        pCh->rxLimit = limit;
+        pCh->creditPending = 1;
+        send = TRUE;
+    }
+    OSA_InterruptEnable();
+
+    if( send )
+    {
+        SerialMux_TxSchedule();
+    }
+}
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+********************************************************************************** */
+
+/*! *********************************************************************************
+* \brief   Sends the next frame if the physical interface is free. Pending credit
+*          frames go first, followed by data of the highest priority channel which
+*          has credit.
+*
+********************************************************************************** */
+static void SerialMux_TxSchedule(void)
+{
+    serialMuxChannel_t *pCh;
+    serialSegment_t segments[3];
+    uint8_t count = 0;
+    uint8_t best = mSerialMuxNoChannel_c;
+    uint16_t credit;
+    uint32_t i, c;
+
+    OSA_InterruptDisable();
+    if( mMuxTxBusy || (gSerialMgrInvalidIdx_c == mMuxInterfaceId) )
+    {
+        OSA_InterruptEnable();
+        return;
+    }
+
+    for( i = 0; i < gSerialMuxMaxChannels_c; i++ )
+    {
+        if( mMuxChannels[i].creditPending )
+        {
+            pCh = &mMuxChannels[i];
+            pCh->creditPending = 0;
+            mMuxTxType = mSerialMuxTypeCredit_c;
+            mMuxTxPayloadSize = mSerialMuxCreditSize_c;
+            mMuxTxHeader[mSerialMuxHdrSize_c] = (uint8_t)pCh->rxLimit;
+            mMuxTxHeader[mSerialMuxHdrSize_c + 1] = (uint8_t)(pCh->rxLimit >> 8);
+            best = i;
+            break;
+        }
+    }
+
+    if( mSerialMuxNoChannel_c == best )
+    {
+        /* Start after the last served channel, so that equal priorities take turns */
+        for( i = 1; i <= gSerialMuxMaxChannels_c; i++ )
+        {
+            c = (mMuxTxLastChannel + i) % gSerialMuxMaxChannels_c;
+            pCh = &mMuxChannels[c];
+
+            if( pCh->txLeft && (pCh->txLimit != pCh->txSent) &&
+                ((mSerialMuxNoChannel_c == best) || (pCh->priority > mMuxChannels[best].priority)) )
+            {
+                best = c;
+            }
+        }
+
+        if( mSerialMuxNoChannel_c == best )
+        {
+            OSA_InterruptEnable();
+            return;
+        }
+
+        pCh = &mMuxChannels[best];
+        credit = pCh->txLimit - pCh->txSent;
+        mMuxTxType = mSerialMuxTypeData_c;
+        mMuxTxPayloadSize = gSerialMuxMaxPayload_c;
+        if( mMuxTxPayloadSize > pCh->txLeft )
+        {
+            mMuxTxPayloadSize = pCh->txLeft;
+        }
+        if( mMuxTxPayloadSize > credit )
+        {
+            mMuxTxPayloadSize = credit;
+        }
+        mMuxTxLastChannel = best;
+    }
+
+    mMuxTxBusy = 1;
+    mMuxTxChannel = best;
+    OSA_InterruptEnable();
+
+    mMuxTxHeader[0] = mSerialMuxSync_c;
+    mMuxTxHeader[1] = (uint8_t)((mMuxTxType << 4) | best);
+    mMuxTxHeader[2] = mMuxTxPayloadSize;
+    mMuxTxChecksum = mMuxTxHeader[1] ^ mMuxTxHeader[2];
+
+    if( mSerialMuxTypeCredit_c == mMuxTxType )
+    {
+        mMuxTxChecksum ^= mMuxTxHeader[3] ^ mMuxTxHeader[4];
+        segments[count].pData = mMuxTxHeader;
+        segments[count].dataSize = mSerialMuxHdrSize_c + mSerialMuxCreditSize_c;
+        segments[count].releaseCb = NULL;
+        count++;
+    }
+    else
+    {
+        pCh = &mMuxChannels[best];
+        for( i = 0; i < mMuxTxPayloadSize; i++ )
+        {
+            mMuxTxChecksum ^= pCh->pTxData[i];
+        }
+
+        segments[count].pData = mMuxTxHeader;
+        segments[count].dataSize = mSerialMuxHdrSize_c;
+        segments[count].releaseCb = NULL;
+        count++;
+        /* The payload is sent directly from the buffer of the virtual interface */
+        segments[count].pData = pCh->pTxData;
+        segments[count].dataSize = mMuxTxPayloadSize;
+        segments[count].releaseCb = NULL;
+        count++;
+    }
+
+    segments[count].pData = &mMuxTxChecksum;
+    segments[count].dataSize = 1;
+    segments[count].releaseCb = SerialMux_TxDone;
+    segments[count].pReleaseParam = NULL;
+    count++;
+
+    if( gSerial_Success_c != Serial_AsyncWriteV(mMuxInterfaceId, segments, count) )
+    {
+        OSA_InterruptDisable();
+        if( mSerialMuxTypeCredit_c == mMuxTxType )
+        {
+            mMuxChannels[best].creditPending = 1;
+        }
+        mMuxTxBusy = 0;
+        OSA_InterruptEnable();
+    }
+}
+
+/*! *********************************************************************************
+* \brief   Called by the Serial Manager when a frame was sent on the physical
+*          interface
+*
+* \param[in] param not used
+*
+********************************************************************************** */
+static void SerialMux_TxDone(void *param)
+{
+    serialMuxChannel_t *pCh = &mMuxChannels[mMuxTxChannel];
+    uint8_t completed = gSerialMgrInvalidIdx_c;
+
+    (void)param;
+
+    OSA_InterruptDisable();
+    if( mSerialMuxTypeData_c == mMuxTxType )
+    {
+        pCh->pTxData += mMuxTxPayloadSize;
+        pCh->txLeft -= mMuxTxPayloadSize;
+        pCh->txSent += mMuxTxPayloadSize;
+        if( 0 == pCh->txLeft )
+        {
+            completed = pCh->interfaceId;
+        }
+    }
+    mMuxStats.txFrames++;
+    mMuxTxBusy = 0;
+    OSA_InterruptEnable();
+
+    if( gSerialMgrInvalidIdx_c != completed )
+    {
+        Serial_CustomSendCompleted(completed);
+    }
+
+    SerialMux_TxSchedule();
+}
+
+/*! *********************************************************************************
+* \brief   Rx callback of the physical interface. Parses all the received bytes.
+*
+* \param[in] param not used
+*
+********************************************************************************** */
+static void SerialMux_RxCallback(void *param)
+{
+    uint8_t *pData;
+    uint16_t size;
+    uint16_t i;
+
+    (void)param;
+
+    while( (gSerial_Success_c == Serial_RxPeek(mMuxInterfaceId, &pData, &size)) && size )
+    {
+        for( i = 0; i < size; i++ )
+        {
+            SerialMux_RxByte(pData[i]);
+        }
+        (void)Serial_RxConsume(mMuxInterfaceId, size);
+    }
+}
+
+/*! *********************************************************************************
+* \brief   Frame parser state machine
+*
+* \param[in] byte the received byte
+*
+********************************************************************************** */
+static void SerialMux_RxByte(uint8_t byte)
+{
+    switch( mMuxRxState )
+    {
+    case mMuxRxSync_c:
+        if( mSerialMuxSync_c == byte )
+        {
+            mMuxRxState = mMuxRxHeader_c;
+        }
+        break;
+
+    case mMuxRxHeader_c:
+        mMuxRxHeader = byte;
+        mMuxRxChecksum = byte;
+        mMuxRxState = mMuxRxLength_c;
+        break;
+
+    case mMuxRxLength_c:
+        if( byte > gSerialMuxMaxPayload_c )
+        {
+            mMuxStats.rxErrors++;
+            mMuxRxState = mMuxRxSync_c;
+            break;
+        }
+        mMuxRxLength = byte;
+        mMuxRxCount = 0;
+        mMuxRxChecksum ^= byte;
+        mMuxRxState = (byte) ? mMuxRxPayload_c : mMuxRxChecksum_c;
+        break;
+
+    case mMuxRxPayload_c:
+        mMuxRxPayload[mMuxRxCount++] = byte;
+        mMuxRxChecksum ^= byte;
+        if( mMuxRxCount == mMuxRxLength )
+        {
+            mMuxRxState = mMuxRxChecksum_c;
+        }
+        break;
+
+    default:
+        if( byte == mMuxRxChecksum )
+        {
+            SerialMux_RxFrame();
+        }
+        else
+        {
+            mMuxStats.rxErrors++;
+        }
+        mMuxRxState = mMuxRxSync_c;
+        break;
+    }
+}
+
+/*! *********************************************************************************
+* \brief   Handles a valid frame received from the peer
+*
+********************************************************************************** */
+static void SerialMux_RxFrame(void)
+{
+    uint8_t channel = mMuxRxHeader & 0x0F;
+    uint8_t type = mMuxRxHeader >> 4;
+    serialMuxChannel_t *pCh;
+
+    if( channel >= gSerialMuxMaxChannels_c )
+    {
+        mMuxStats.rxErrors++;
+        return;
+    }
+
+    pCh = &mMuxChannels[channel];
+    mMuxStats.rxFrames++;
+
+    if( mSerialMuxTypeData_c == type )
+    {
+        if( (uint16_t)(pCh->rxLimit - pCh->rxReceived) < mMuxRxLength )
+        {
+            /* The peer did not respect the credit */
+            mMuxStats.rxOverflows += mMuxRxLength - (uint16_t)(pCh->rxLimit - pCh->rxReceived);
+        }
+        pCh->rxReceived += mMuxRxLength;
+
+        if( gSerialMgrInvalidIdx_c == pCh->interfaceId )
+        {
+            mMuxStats.rxOverflows += mMuxRxLength;
+        }
+        else
+        {
+            mMuxStats.rxOverflows += Serial_CustomReceiveData(pCh->interfaceId, mMuxRxPayload, mMuxRxLength);
+        }
+    }
+    else if( mSerialMuxTypeCredit_c == type )
+    {
+        if( mSerialMuxCreditSize_c == mMuxRxLength )
+        {
+            OSA_InterruptDisable();
+            pCh->txLimit = (uint16_t)mMuxRxPayload[0] | ((uint16_t)mMuxRxPayload[1] << 8);
+            OSA_InterruptEnable();
+        }
+        else
+        {
+            /* Credit request */
+            pCh->creditPending = 1;
+        }
+        SerialMux_TxSchedule();
+    }
+    else
+    {
+        mMuxStats.rxErrors++;
+    }
+}
+
+#endif /* (gSerialManagerMaxInterfaces_c) && (gSerialMgrUseMux_c) */
@@ -109,6 +109,8 @@ uint32_t LPUART_Initialize(uint32_t instance, uartState_t *pState)
        pState->pTxData = NULL;
        pState->rxSize = 0;
        pState->txSize = 0;
+       pState->rxOverruns = 0;
+       pState->rtsHook = NULL;
        
        BOARD_InitLPUART();
        LPUART_GetDefaultConfig(&config);
@@ -243,6 +245,40 @@ uint32_t  LPUART_InstallTxCalback(uint32_t instance, uartCallback_t cb, uint32_t
     return status;
 }
 
+/************************************************************************************/
+uint32_t  LPUART_InstallRtsHook(uint32_t instance, uartRtsHook_t hook)
+{
+    uint32_t status = gUartSuccess_c;
+#if FSL_FEATURE_SOC_LPUART_COUNT
+    if( (instance >= FSL_FEATURE_SOC_LPUART_COUNT) || (NULL == pLpuartStates[instance]) )
+    {
+        status = gUartInvalidParameter_c;
+    }
+    else
+    {
+        pLpuartStates[instance]->rtsHook = hook;
+    }
+#endif
+    return status;
+}
+
+/************************************************************************************/
+uint32_t LPUART_SetRxFlowControl(uint32_t instance, uint32_t rxReady)
+{
+    uint32_t status = gUartSuccess_c;
+#if FSL_FEATURE_SOC_LPUART_COUNT
+    if( (instance >= FSL_FEATURE_SOC_LPUART_COUNT) || (NULL == pLpuartStates[instance]) )
+    {
+        status = gUartInvalidParameter_c;
+    }
+    else if( NULL != pLpuartStates[instance]->rtsHook )
+    {
+        pLpuartStates[instance]->rtsHook(instance, rxReady);
+    }
+#endif
+    return status;
+}
+
 /************************************************************************************/
 uint32_t LPUART_IsTxActive(uint32_t instance)
 {
@@ -335,6 +371,8 @@ uint32_t UART_Initialize(uint32_t instance, uartState_t *pState)
        pState->pTxData = NULL;
        pState->rxSize = 0;
        pState->txSize = 0;
+       pState->rxOverruns = 0;
+       pState->rtsHook = NULL;
        
        BOARD_InitUART();
        UART_GetDefaultConfig(&config);
@@ -469,6 +507,40 @@ uint32_t UART_InstallTxCalback(uint32_t instance, uartCallback_t cb, uint32_t cb
     return status;
 }
 
+/************************************************************************************/
+uint32_t  UART_InstallRtsHook(uint32_t instance, uartRtsHook_t hook)
+{
+    uint32_t status = gUartSuccess_c;
+#if FSL_FEATURE_SOC_UART_COUNT
+    if( (instance >= FSL_FEATURE_SOC_UART_COUNT) || (NULL == pUartStates[instance]) )
+    {
+        status = gUartInvalidParameter_c;
+    }
+    else
+    {
+        pUartStates[instance]->rtsHook = hook;
+    }
+#endif
+    return status;
+}
+
+/************************************************************************************/
+uint32_t UART_SetRxFlowControl(uint32_t instance, uint32_t rxReady)
+{
+    uint32_t status = gUartSuccess_c;
+#if FSL_FEATURE_SOC_UART_COUNT
+    if( (instance >= FSL_FEATURE_SOC_UART_COUNT) || (NULL == pUartStates[instance]) )
+    {
+        status = gUartInvalidParameter_c;
+    }
+    else if( NULL != pUartStates[instance]->rtsHook )
+    {
+        pUartStates[instance]->rtsHook(instance, rxReady);
+    }
+#endif
+    return status;
+}
+
 /************************************************************************************/
 uint32_t UART_IsTxActive(uint32_t instance)
 {
@@ -562,6 +634,8 @@ uint32_t LPSCI_Initialize(uint32_t instance, uartState_t *pState)
        pState->pTxData = NULL;
        pState->rxSize = 0;
        pState->txSize = 0;
+       pState->rxOverruns = 0;
+       pState->rtsHook = NULL;
        
        BOARD_InitLPSCI();
        LPSCI_GetDefaultConfig(&config);
@@ -696,6 +770,40 @@ uint32_t LPSCI_InstallTxCalback(uint32_t instance, uartCallback_t cb, uint32_t c
     return status;
 }
 
+/************************************************************************************/
+uint32_t  LPSCI_InstallRtsHook(uint32_t instance, uartRtsHook_t hook)
+{
+    uint32_t status = gUartSuccess_c;
+#if FSL_FEATURE_SOC_LPSCI_COUNT
+    if( (instance >= FSL_FEATURE_SOC_LPSCI_COUNT) || (NULL == pLpsciStates[instance]) )
+    {
+        status = gUartInvalidParameter_c;
+    }
+    else
+    {
+        pLpsciStates[instance]->rtsHook = hook;
+    }
+#endif
+    return status;
+}
+
+/************************************************************************************/
+uint32_t LPSCI_SetRxFlowControl(uint32_t instance, uint32_t rxReady)
+{
+    uint32_t status = gUartSuccess_c;
+#if FSL_FEATURE_SOC_LPSCI_COUNT
+    if( (instance >= FSL_FEATURE_SOC_LPSCI_COUNT) || (NULL == pLpsciStates[instance]) )
+    {
+        status = gUartInvalidParameter_c;
+    }
+    else if( NULL != pLpsciStates[instance]->rtsHook )
+    {
+        pLpsciStates[instance]->rtsHook(instance, rxReady);
+    }
+#endif
+    return status;
+}
+
 /************************************************************************************/
 uint32_t LPSCI_IsTxActive(uint32_t instance)
 {
@@ -834,6 +942,7 @@ static void LPUART_ISR(void)
             if( kLPUART_RxOverrunFlag & LPUART_GetStatusFlags(base) )
             {
                 LPUART_ClearStatusFlags(base, kLPUART_RxOverrunFlag);
+                pState->rxOverruns++;
             }
             break;
         }
@@ -903,6 +1012,7 @@ static void UART_ISR(void)
             if( kUART_RxOverrunFlag & UART_GetStatusFlags(base) )
             {
                 UART_ClearStatusFlags(base, kUART_RxOverrunFlag);
+                pState->rxOverruns++;
             }
             break;
         }
@@ -972,6 +1082,7 @@ static void LPSCI_ISR(void)
             if( kLPSCI_RxOverrunFlag & LPSCI_GetStatusFlags(base) )
             {
                 LPSCI_ClearStatusFlags(base, kLPSCI_RxOverrunFlag);
+                pState->rxOverruns++;
             }
             break;
         } /* if( irq == mLpsciIrqs[instance] ) */
@@ -69,6 +69,30 @@
 #define SHELL_USE_ECHO                (1)
 #endif
 
+/* send the output in the background: the data is copied into a ring buffer and
+   sent with Serial_AsyncWrite(). If set to 0, the caller waits for the Tx to finish */
+#ifndef SHELL_ASYNC_OUTPUT
+#define SHELL_ASYNC_OUTPUT            (0)
+#endif
+
+/* output ring buffer size */
+#ifndef SHELL_OUT_BUF_SIZE
+#define SHELL_OUT_BUF_SIZE            (512)
+#endif
+
+/* what to do when the output ring buffer is full */
+#define SHELL_OUT_DROP                (0)    /* discard the whole write */
+#define SHELL_OUT_BLOCK               (1)    /* wait for space, or drop if the caller cannot wait */
+
+#ifndef SHELL_OUT_FULL_POLICY
+#define SHELL_OUT_FULL_POLICY         (SHELL_OUT_BLOCK)
+#endif
+
+/* maximum number of asynchronous commands (jobs) running at the same time */
+#ifndef SHELL_MAX_JOBS
+#define SHELL_MAX_JOBS                (4)
+#endif
+
 /* consult buffer size */
 #ifndef SHELL_CB_SIZE
 #define SHELL_CB_SIZE                 (64)
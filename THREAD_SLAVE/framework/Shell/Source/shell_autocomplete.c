@@ -40,11 +40,21 @@
 #include "FunctionLib.h"
 
 #if (SHELL_ENABLED && SHELL_USE_AUTO_COMPLETE)
+/************************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+************************************************************************************/
+/* The common prefix of the matchs must be computed from their list */
+#define COMMON_PREFIX_UNKNOWN   (0xFF)
+
 /************************************************************************************
 *************************************************************************************
 * Private prototypes
 *************************************************************************************
 ************************************************************************************/
+extern uint8_t cmd_trie_prefix(const char *pPrefix, uint8_t *pCommon);
+extern uint8_t cmd_trie_list(const char *pPrefix, char *cmdv[], uint8_t maxv);
   
 /************************************************************************************
 *************************************************************************************
@@ -60,17 +70,18 @@
 * \param[in]  last_char  The Last character received
 * \param[in]  maxv       The maximun number of matchs
 * \param[in]  cmdv       Table with possible matchs
+* \param[out] pCommon    The number of common characters of the matchs, or
+*                        COMMON_PREFIX_UNKNOWN
 *
 * \return  int8_t  The number of possible matchs
 *
 ********************************************************************************** */
-static int8_t complete_cmdv(uint8_t argc, char * argv[], char last_char, uint8_t maxv, char *cmdv[])
+static int8_t complete_cmdv(uint8_t argc, char * argv[], char last_char, uint8_t maxv, char *cmdv[], uint8_t *pCommon)
 {
     cmd_tbl_t *cmdtp;
-    uint8_t i;
-    uint8_t n_found = 0;
 
     cmdv[0] = NULL;
+    *pCommon = COMMON_PREFIX_UNKNOWN;
 
     /* sanity */
     if (maxv < 2)
@@ -90,29 +101,14 @@ static int8_t complete_cmdv(uint8_t argc, char * argv[], char last_char, uint8_t
     /*
     * one or no arguments
     * If no arguments, output full list of commands.
-    * Some commands allow length modifiers (like "cp.b");
-    * compare command name only until first dot.
+    * The command name index gives the matchs and their common prefix
+    * without scanning the command table.
     */
-    for(i=0; i<SHELL_MAX_COMMANDS; i++)
+    if( !cmd_trie_prefix(argc ? argv[0] : "", pCommon) )
     {
-        if( gpCmdTable[i] && gpCmdTable[i]->name )
-        {
-            if( argc && !FLib_MemCmp(argv[0], gpCmdTable[i]->name, strlen(argv[0])) )
-            {
-                continue;
-            }
-
-            /* too many! */
-            if (n_found >= maxv - 2)
-            {
-                cmdv[n_found++] = "...";
-                break;
-            }
-            cmdv[n_found++] = gpCmdTable[i]->name;
-        }
+        return 0;
     }
-    cmdv[n_found] = NULL;
-    return n_found;
+    return cmd_trie_list(argc ? argv[0] : "", cmdv, maxv);
 }
 
 /*! *********************************************************************************
@@ -227,6 +223,7 @@ int8_t cmd_auto_complete(char * prompt, char * buf, uint8_t * np, uint8_t * colp
     char *sep;
     int i, j, k, len, seplen, argc;
     uint8_t cnt;
+    uint8_t common;
     char last_char;
 
     cnt = strlen(buf);
@@ -247,7 +244,7 @@ int8_t cmd_auto_complete(char * prompt, char * buf, uint8_t * np, uint8_t * colp
     /* separate into argv */
     argc = make_argv(tmp_buf, NumberOfElements(argv), argv);
     /* do the completion and return the possible completions */
-    i = complete_cmdv(argc, argv, last_char, NumberOfElements(cmdv), cmdv);
+    i = complete_cmdv(argc, argv, last_char, NumberOfElements(cmdv), cmdv, &common);
     /* no match; bell and out */
     if (i == 0)
     {
@@ -273,7 +270,8 @@ int8_t cmd_auto_complete(char * prompt, char * buf, uint8_t * np, uint8_t * colp
         sep = " ";
         seplen = 1;
     }
-    else if ((i > 1) && ((j = find_common_prefix(cmdv, i)) != 0))
+    else if ((i > 1) &&
+             ((j = (common != COMMON_PREFIX_UNKNOWN) ? common : find_common_prefix(cmdv, i)) != 0))
     {   /* more */
         k = strlen(argv[argc - 1]);
         j -= k;
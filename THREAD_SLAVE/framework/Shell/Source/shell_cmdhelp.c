@@ -51,7 +51,11 @@ static int8_t DoHelp(uint8_t argc, char * argv[]);
 static int8_t DoVer(uint8_t argc, char * argv[]);
 #if SHELL_USE_AUTO_COMPLETE
 static int8_t DoHelpComplete(uint8_t argc, char * argv[], char last_char, uint8_t maxv, char * cmdv[]);
+extern uint8_t cmd_trie_list(const char *pPrefix, char *cmdv[], uint8_t maxv);
 #endif
+extern cmd_tbl_t * cmd_trie_first(const char *pPrefix, uint32_t *pIter);
+extern cmd_tbl_t * cmd_trie_next(uint32_t *pIter);
+extern cmd_tbl_t * cmd_trie_find(const char *pName);
 
 /************************************************************************************
 *************************************************************************************
@@ -137,67 +141,57 @@ static int8_t DoVer(uint8_t argc, char * argv[])
 ********************************************************************************** */
 static int8_t DoHelp(uint8_t argc, char * argv[])
 {
-    uint16_t i;
+    cmd_tbl_t *cmdtp;
+    uint32_t iter;
 
     if (argc == 1)
     {
         char * pStr = MEM_BufferAlloc( mShellMaxCmdLen + 2 );
-        
-        if( pStr )
+
+        /* The commands are listed in alphabetical order */
+        for( cmdtp = cmd_trie_first("", &iter); cmdtp; cmdtp = cmd_trie_next(&iter) )
         {
-            for( i=0; i<SHELL_MAX_COMMANDS; i++ )
+            if( pStr )
             {
-                if( gpCmdTable[i] )
-                {
-                    uint16_t len = strlen(gpCmdTable[i]->name);
-                    
-                    FLib_MemCpy( pStr, gpCmdTable[i]->name, len );
-                    FLib_MemSet( &pStr[len], ' ', mShellMaxCmdLen - len + 2); 
-                    shell_writeN(pStr, mShellMaxCmdLen + 2);
-                    shell_write(gpCmdTable[i]->usage);
-                    SHELL_NEWLINE();
-                }
-            }
+                uint16_t len = strlen(cmdtp->name);
 
-            MEM_BufferFree(pStr);
-        }
-        else
-        {
-            for( i=0; i<SHELL_MAX_COMMANDS; i++ )
+                FLib_MemCpy( pStr, cmdtp->name, len );
+                FLib_MemSet( &pStr[len], ' ', mShellMaxCmdLen - len + 2);
+                shell_writeN(pStr, mShellMaxCmdLen + 2);
+            }
+            else
             {
-                if( gpCmdTable[i] )
-                {
-                    shell_write(gpCmdTable[i]->name);
-                    shell_writeN(" ", 1);
-                    shell_write(gpCmdTable[i]->usage);
-                    SHELL_NEWLINE();
-                }
+                shell_write(cmdtp->name);
+                shell_writeN(" ", 1);
             }
+            shell_write(cmdtp->usage);
+            SHELL_NEWLINE();
+        }
+
+        if( pStr )
+        {
+            MEM_BufferFree(pStr);
         }
     }
     else if (argc == 2)
     {
-        for( i=0; i<SHELL_MAX_COMMANDS; i++ )
-        {
-            if( gpCmdTable[i] && !strcmp(argv[1], gpCmdTable[i]->name))
-            {
-                if (gpCmdTable[i]->help != NULL)
-                {
-                    shell_write(gpCmdTable[i]->name);
-                    shell_writeN(" - ", 3);
-                    shell_write(gpCmdTable[i]->help);
-                    SHELL_NEWLINE();
-                    return CMD_RET_SUCCESS;
-                }
-                else
-                {
-                    shell_write ("- No additional help available.\r\n");
-                    return CMD_RET_SUCCESS;
-                }
-            }
+        cmdtp = cmd_trie_find(argv[1]);
 
+        if( NULL == cmdtp )
+        {
+            shell_write( "- No command available.\r\n" );
+        }
+        else if (cmdtp->help != NULL)
+        {
+            shell_write(cmdtp->name);
+            shell_writeN(" - ", 3);
+            shell_write(cmdtp->help);
+            SHELL_NEWLINE();
+        }
+        else
+        {
+            shell_write ("- No additional help available.\r\n");
         }
-        shell_write( "- No command available.\r\n" );
     }
     return CMD_RET_SUCCESS;
 }
@@ -218,22 +212,12 @@ static int8_t DoHelp(uint8_t argc, char * argv[])
 ********************************************************************************** */
 static int8_t DoHelpComplete(uint8_t argc, char * argv[], char last_char, uint8_t maxv, char * cmdv[])
 {
-    uint8_t str_len;
     uint8_t found = 0;
-    uint8_t i;
-    str_len = strlen(argv[argc-1]);
 
     switch(argc)
     {
         case 2:
-            for( i=0; i<SHELL_MAX_COMMANDS; i++ )
-            {
-                if(gpCmdTable[i] && !strncmp(argv[argc-1], gpCmdTable[i]->name, str_len))
-                {
-                    cmdv[found] = gpCmdTable[i]->name;
-                    found++;
-                }  
-            }
+            found = cmd_trie_list(argv[argc-1], cmdv, maxv);
             break;
         default:
             break;
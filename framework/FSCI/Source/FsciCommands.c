@@ -47,6 +47,7 @@
 #include "MemManager.h"
 #include "ModuleInfo.h"
 #include "Flash_Adapter.h"
+#include "Panic.h"
 
 #if gFSCI_IncludeMacCommands_c
     #include "FsciMacCommands.h"
@@ -85,6 +86,57 @@ extern uint32_t _RAM_END_[];
 #define __WEAK_FUNC __weak
 #endif
 
+#if gFsciUseBulkTransfer_c
+#ifndef gFsciBulkTxSlots_c
+#define gFsciBulkTxSlots_c        2 /* chunks of a streamed read queued to the SMGR */
+#endif
+
+#ifndef gFsciBulkWriteCredits_c
+#define gFsciBulkWriteCredits_c   2 /* chunks of a streamed write sent ahead, without gFsciTxAck_c */
+#endif
+
+#define mFsciBulkSeqSize_c        sizeof(uint16_t)
+#define mFsciBulkMaxChunk_c       (gFsciMaxPayloadLen_c - mFsciBulkSeqSize_c)
+/* Fsci-BulkEnd.Indication: status, length, CRC32 */
+#define mFsciBulkEndLen_c         (sizeof(uint8_t) + 2*sizeof(uint32_t))
+#define mFsciBulkFlagErase_c      (1 << 0)
+#endif
+
+#if gFsciUseBulkTransfer_c || gFsciOtaPipelineDepth_c
+#define mFsciCrc32Init_c          (0xFFFFFFFFUL)
+#endif
+
+#if gFsciOtaPipelineDepth_c
+#ifndef gFsciOtaTaskPriority_c
+#define gFsciOtaTaskPriority_c    (5)  /* lower than the SMGR task, which keeps receiving */
+#endif
+
+#ifndef gFsciOtaTaskStackSize_c
+#define gFsciOtaTaskStackSize_c   (1024) /* bytes */
+#endif
+
+/* Staged chunks, and the other OTA requests queued behind them */
+#define mFsciOtaQueueSize_c       (gFsciOtaPipelineDepth_c + 2)
+/* Fsci-OtaPushImageChunkSeq.Request: sequence number, CRC32, data */
+#define mFsciOtaChunkHdrSize_c    (sizeof(uint16_t) + sizeof(uint32_t))
+/* Confirm: status, sequence number, next sequence number expected, window */
+#define mFsciOtaChunkCnfLen_c     (sizeof(uint8_t) + 2*sizeof(uint16_t) + sizeof(uint8_t))
+#define mFsciOtaEvent_c           (1 << 0)
+#endif
+
+#if gFsciMonitorFilter_c
+/* Fsci-SetMonitorFilter.Request actions */
+#define mFsciMonitorAll_c         (0)
+#define mFsciMonitorNone_c        (1)
+#define mFsciMonitorSubscribe_c   (2)
+#define mFsciMonitorUnsubscribe_c (3)
+/* Fsci-SetMonitorFilter.Request: action, OpGroup, OpCode, flags, sample rate, max rate */
+#define mFsciMonitorFilterLen_c   (5*sizeof(uint8_t) + sizeof(uint16_t))
+#define mFsciMonitorFlagAnyOC_c   (1 << 0)
+/* Fsci-GetMonitorStats confirm entry: OpGroup, OpCode, flags, sent, dropped */
+#define mFsciMonitorStatsLen_c    (3*sizeof(uint8_t) + 2*sizeof(uint32_t))
+#endif
+
 /************************************************************************************
 *************************************************************************************
 * Private prototypes
@@ -96,6 +148,30 @@ extern void Mac_SetExtendedAddress(uint8_t *pAddr, instanceId_t instanceId);
 extern uint8_t PhyGetLastRxLqiValue(void);
 extern gFsciOpGroup_t *FSCI_GetReqOpGroup(opGroup_t OG, uint8_t fsciInterface);
 
+#if gFsciUseBulkTransfer_c
+static bool_t FSCI_BulkInRam(uint32_t address, uint32_t length);
+static bool_t FSCI_BulkInFlash(uint32_t address, uint32_t length);
+static uint16_t FSCI_BulkReadChunk(void);
+static void FSCI_BulkReadPump(void);
+#if !gFsciRxAck_c
+static void FSCI_BulkTxDone(void *param);
+#endif
+static bool_t FSCI_BulkWrite(uint32_t address, uint8_t *pData, uint16_t length);
+static void FSCI_BulkEnd(void);
+#endif
+
+#if gFsciUseBulkTransfer_c || gFsciOtaPipelineDepth_c
+static uint32_t FSCI_Crc32(uint32_t crc, const uint8_t *pData, uint32_t length);
+#endif
+
+#if gFsciOtaPipelineDepth_c
+static void FSCI_OtaChunkConfirm(clientPacket_t *pPkt, uint8_t status, uint16_t seq, uint32_t fsciInterface);
+static void FSCI_OtaPipelineRun(void);
+#if !defined(FWK_SMALL_RAM_CONFIG)
+static void FSCI_OtaTask(osaTaskParam_t argument);
+#endif
+#endif
+
 /************************************************************************************
 *************************************************************************************
 * Private type definitions
@@ -107,6 +183,43 @@ typedef PACKED_STRUCT FsciWakeUpConfig_tag
     uint32_t deepSleepDuration;    /* The deep sleep duration in 802.15.4 phy symbols (16 us) */
 }FsciWakeUpConfig_t;
 
+#if gFsciUseBulkTransfer_c
+typedef enum
+{
+    mFsciBulkIdle_c,
+    mFsciBulkRead_c,
+    mFsciBulkWrite_c
+}fsciBulkState_t;
+
+/* Streamed read or write */
+typedef struct fsciBulk_tag
+{
+    uint32_t start;
+    uint32_t address;          /* next address to read or write */
+    uint32_t length;
+    uint32_t remaining;
+    uint32_t crc;              /* CRC32 of the data transferred so far */
+    uint16_t seq;              /* sequence number of the next chunk */
+    uint16_t chunkSize;
+    uint8_t  state;            /* fsciBulkState_t */
+    uint8_t  status;           /* gFsciSuccess_c until an error, or an abort */
+    uint8_t  fsciInterface;
+    uint8_t  slotsBusy;        /* bitmap of the chunk buffers queued to the SMGR */
+    bool_t   flash;            /* the write programs the FLASH */
+    bool_t   pumping;
+    bool_t   repump;
+}fsciBulk_t;
+#endif
+
+#if gFsciOtaPipelineDepth_c
+/* OTA request waiting for the OTA module */
+typedef struct fsciOtaQueueEntry_tag
+{
+    clientPacket_t *pPacket;
+    uint8_t         fsciInterface;
+}fsciOtaQueueEntry_t;
+#endif
+
 /************************************************************************************
 *************************************************************************************
 * Public memory declarations
@@ -124,6 +237,7 @@ bool_t (*pfFSCI_OtaSupportCalback)(clientPacket_t* pPacket) = NULL;
 extern uint8_t gNumberOfOG;
 extern gFsciOpGroup_t gReqOpGroupTable[];
 extern uint16_t gFreeMessagesCount;
+extern uint8_t gFsciTxDisable;
 
 /* FSCI Error message */
 static gFsciErrorMsg_t mFsciErrorMsg = {
@@ -236,7 +350,20 @@ static const gFsciOpCode_t FSCI_ReqOCtable[] =
 
     {mFsciLowLevelMemoryWriteBlock_c,        FSCI_WriteMemoryBlock},
     {mFsciLowLevelMemoryReadBlock_c,         FSCI_ReadMemoryBlock},
+#if gFsciUseBulkTransfer_c
+    {mFsciLowLevelBulkReadReq_c,             FSCI_BulkReadReqFunc},
+    {mFsciLowLevelBulkWriteReq_c,            FSCI_BulkWriteReqFunc},
+    {mFsciLowLevelBulkData_c,                FSCI_BulkDataReqFunc},
+    {mFsciLowLevelBulkEnd_c,                 FSCI_BulkAbortReqFunc},
+#endif
     {mFsciLowLevelPing_c,                    FSCI_Ping},
+#if gFsciTxWindowSize_c > 1
+    {mFsciMsgSetTxWindowReq_c,               FSCI_MsgSetTxWindowReqFunc},
+#endif
+#if gFsciMonitorFilter_c
+    {mFsciMsgSetMonitorFilterReq_c,          FSCI_MsgSetMonitorFilterReqFunc},
+    {mFsciMsgGetMonitorStatsReq_c,           FSCI_MsgGetMonitorStatsReqFunc},
+#endif
 
     {mFsciOtaSupportImageNotifyReq_c,        FSCI_OtaSupportHandlerFunc},
     {mFsciOtaSupportStartImageReq_c,         FSCI_OtaSupportHandlerFunc},
@@ -248,6 +375,9 @@ static const gFsciOpCode_t FSCI_ReqOCtable[] =
     {mFsciOtaSupportSetFileVerPoliciesReq_c, FSCI_OtaSupportHandlerFunc},
     {mFsciOtaSupportAbortOTAUpgradeReq_c,    FSCI_OtaSupportHandlerFunc},
     {mFsciOtaSupportGetClientInfo_c,         FSCI_OtaSupportHandlerFunc},
+#if gFsciOtaPipelineDepth_c
+    {mFsciOtaSupportPushImageChunkSeqReq_c,  FSCI_OtaSupportHandlerFunc},
+#endif
 
 /* Bootloader cmd */
     {mFsciEnableBootloaderReq_c,             FSCI_EnableBootloaderFunc},
@@ -262,6 +392,10 @@ static const gFsciOpCode_t FSCI_ReqOCtable[] =
     {mFsciGetSwVersions_c,                   FSCI_ReadModVer},
 };
 
+/* FSCI_ReqOCtable index + 1 of every OpCode, 0 if the OpCode is not handled */
+static uint8_t mFsciReqOCIndex[256];
+static bool_t  mFsciReqOCIndexReady = FALSE;
+
 /* Used for maintaining backward compatibillity */
 static const opGroup_t mFsciModeSelectSAPs[] =
 {
@@ -276,6 +410,40 @@ static const opGroup_t mFsciModeSelectSAPs[] =
     gFSCI_ZdpSapId_c,
 };
 
+#if gFsciUseBulkTransfer_c
+static fsciBulk_t mFsciBulk;
+/* Payload of the chunk being built */
+static uint8_t mFsciBulkPayload[gFsciMaxPayloadLen_c];
+#if !gFsciRxAck_c
+static uint8_t mFsciBulkFrames[gFsciBulkTxSlots_c][FSCI_EncodedPacketSize(gFsciMaxPayloadLen_c)];
+#endif
+#endif
+
+#if gFsciOtaPipelineDepth_c
+/* Filled by the SMGR task, emptied by the OTA task */
+static fsciOtaQueueEntry_t mFsciOtaQueue[mFsciOtaQueueSize_c];
+static uint8_t             mFsciOtaQueueHead;
+static uint8_t             mFsciOtaQueueTail;
+static volatile uint8_t    mFsciOtaQueueCount;
+static volatile uint8_t    mFsciOtaChunksStaged;  /* chunks queued or being programmed */
+static uint16_t            mFsciOtaNextSeq;       /* sequence number of the next chunk accepted */
+
+#if !defined(FWK_SMALL_RAM_CONFIG)
+OSA_TASK_DEFINE( FSCI_OtaTask, gFsciOtaTaskPriority_c, 1, gFsciOtaTaskStackSize_c, FALSE );
+static osaEventId_t mFsciOtaEventId;
+extern const uint8_t gUseRtos_c;
+#endif
+#endif
+
+#if gFsciUseBulkTransfer_c || gFsciOtaPipelineDepth_c
+/* CRC32 of each 4-bit value */
+static const uint32_t mFsciCrc32Table[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+#endif
+
 #if gFSCI_IncludeLpmCommands_c
 uint8_t mFsciInterfaceToSendWakeUp;
 static FsciWakeUpConfig_t  mFsciWakeUpConfig =
@@ -303,23 +471,29 @@ void fsciMsgHandler( void* pData, uint32_t fsciInterface )
 {
     uint32_t i;
 
-    /* Call the handler function for the received OpCode */
-    for ( i = 0; i < NumberOfElements(FSCI_ReqOCtable); i++ )
+    if( !mFsciReqOCIndexReady )
     {
-        if( FSCI_ReqOCtable[i].opCode == ((clientPacket_t*)pData)->structured.header.opCode )
+        /* Walk the table backwards, so that the first entry of a duplicated OpCode is used */
+        for ( i = NumberOfElements(FSCI_ReqOCtable); i > 0; i-- )
         {
-            if( FSCI_ReqOCtable[i].pfOpCodeHandle( pData, fsciInterface ) )
-            {
-                /* Reuse received message */
-                ((clientPacket_t*)pData)->structured.header.opGroup = gFSCI_CnfOpcodeGroup_c;
-                FSCI_transmitFormatedPacket( pData, fsciInterface );
-            }
-            break;
+            mFsciReqOCIndex[FSCI_ReqOCtable[i - 1].opCode] = (uint8_t)i;
         }
+        mFsciReqOCIndexReady = TRUE;
     }
 
-    /* If handler function was not found, send error message */
-    if( i >= NumberOfElements(FSCI_ReqOCtable) )
+    /* Call the handler function for the received OpCode */
+    i = mFsciReqOCIndex[((clientPacket_t*)pData)->structured.header.opCode];
+
+    if( i )
+    {
+        if( FSCI_ReqOCtable[i - 1].pfOpCodeHandle( pData, fsciInterface ) )
+        {
+            /* Reuse received message */
+            ((clientPacket_t*)pData)->structured.header.opGroup = gFSCI_CnfOpcodeGroup_c;
+            FSCI_transmitFormatedPacket( pData, fsciInterface );
+        }
+    }
+    else /* If handler function was not found, send error message */
     {
         MEM_BufferFree( pData );
         FSCI_Error( gFsciUnknownOpcode_c, fsciInterface );
@@ -358,7 +532,7 @@ void FSCI_Error(uint8_t errorCode, uint32_t fsciInterface)
 #endif
         }
         
-        Serial_SyncWrite( gFsciSerialInterfaces[fsciInterface], (uint8_t*)&mFsciErrorMsg, size );
+        FSCI_WriteUnsequenced( fsciInterface, (uint8_t*)&mFsciErrorMsg, size );
         
         mFsciErrorReported = TRUE;
     }
@@ -393,7 +567,7 @@ void FSCI_Ack(uint8_t checksum, uint32_t fsciInterface)
 #endif
     }
 
-    Serial_SyncWrite( gFsciSerialInterfaces[fsciInterface], (uint8_t*)&mFsciAckMsg, size );
+    FSCI_WriteUnsequenced( fsciInterface, (uint8_t*)&mFsciAckMsg, size );
 }
 #endif 
 
@@ -609,6 +783,294 @@ bool_t FSCI_ReadMemoryBlock(void* pData, uint32_t fsciInterface)
     return FALSE;
 }
 
+#if gFsciUseBulkTransfer_c
+/*! *********************************************************************************
+* \brief   Starts a streamed read of a RAM or FLASH memory range.
+*          Payload contains the packet received over the serial interface
+*          bytes 0-3 --> start address for reading
+*          bytes 4-7 --> number of bytes to read
+*          bytes 8-9 --> optional, maximum number of bytes per chunk
+*          The confirm holds the status, the length and the chunk size. Then, the
+*          data is sent in Fsci-BulkData.Indication packets (sequence number on
+*          2 bytes, starting from 0, followed by the data), and the transfer ends
+*          with a Fsci-BulkEnd.Indication (status, number of bytes sent, CRC32).
+*          Without gFsciRxAck_c, the chunks are sent back to back as fast as the
+*          serial interface allows. Otherwise, each chunk is acknowledged, and the
+*          windowed mode keeps several chunks in flight.
+*
+* \param[in] pData pointer to location of the received data
+* \param[in] fsciInterface the interface on which the packet was received
+*
+* \return  FALSE, the confirm is sent by the function
+*
+********************************************************************************** */
+bool_t FSCI_BulkReadReqFunc(void* pData, uint32_t fsciInterface)
+{
+    clientPacket_t *pPkt = pData;
+    uint32_t address = 0;
+    uint32_t length = 0;
+    uint16_t chunkSize = mFsciBulkMaxChunk_c;
+    uint8_t  status = gFsciSuccess_c;
+
+    if( (pPkt->structured.header.len < 2*sizeof(uint32_t)) ||
+        (mFsciBulkIdle_c != mFsciBulk.state) || gFsciTxDisable )
+    {
+        status = gFsciError_c;
+    }
+    else
+    {
+        FLib_MemCpy(&address, pPkt->structured.payload, sizeof(uint32_t));
+        FLib_MemCpy(&length, &pPkt->structured.payload[sizeof(uint32_t)], sizeof(uint32_t));
+
+        if( pPkt->structured.header.len >= 2*sizeof(uint32_t) + sizeof(uint16_t) )
+        {
+            FLib_MemCpy(&chunkSize, &pPkt->structured.payload[2*sizeof(uint32_t)], sizeof(uint16_t));
+            if( (0 == chunkSize) || (chunkSize > mFsciBulkMaxChunk_c) )
+            {
+                chunkSize = mFsciBulkMaxChunk_c;
+            }
+        }
+
+        if( !FSCI_BulkInRam(address, length) && !FSCI_BulkInFlash(address, length) )
+        {
+            status = gFsciError_c;
+        }
+    }
+
+    pPkt->structured.header.opGroup = gFSCI_CnfOpcodeGroup_c;
+    pPkt->structured.header.len = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint16_t);
+    pPkt->structured.payload[0] = status;
+    FLib_MemCpy(&pPkt->structured.payload[1], &length, sizeof(uint32_t));
+    FLib_MemCpy(&pPkt->structured.payload[1 + sizeof(uint32_t)], &chunkSize, sizeof(uint16_t));
+    FSCI_transmitFormatedPacket( pPkt, fsciInterface );
+
+    if( gFsciSuccess_c == status )
+    {
+        /* Data waiting in the write buffer of the flash is read from the flash */
+        (void)NV_FlashFlushWriteBuffer();
+
+        mFsciBulk.state = mFsciBulkRead_c;
+        mFsciBulk.status = gFsciSuccess_c;
+        mFsciBulk.fsciInterface = (uint8_t)fsciInterface;
+        mFsciBulk.start = address;
+        mFsciBulk.address = address;
+        mFsciBulk.length = length;
+        mFsciBulk.remaining = length;
+        mFsciBulk.crc = mFsciCrc32Init_c;
+        mFsciBulk.seq = 0;
+        mFsciBulk.chunkSize = chunkSize;
+        FSCI_BulkReadPump();
+    }
+
+    return FALSE;
+}
+
+/*! *********************************************************************************
+* \brief   Starts a streamed write of a RAM memory range, or a FLASH memory range
+*          when gFsciBulkFlashWrite_c is enabled.
+*          Payload contains the packet received over the serial interface
+*          bytes 0-3 --> start address for writing
+*          bytes 4-7 --> number of bytes to write
+*          byte  8   --> optional, bit 0 set erases the FLASH sectors first. The
+*                        start address must then be at the start of a sector.
+*          The confirm holds the status, the maximum number of bytes per chunk, and
+*          the number of chunks the host may send before waiting for a
+*          Fsci-BulkData.Indication. With gFsciTxAck_c, this number is 0: the chunks
+*          are paced by the FSCI acknowledgements, and no indication is sent.
+*          The data is sent in Fsci-BulkData.Request packets, see
+*          FSCI_BulkDataReqFunc(). In FLASH, all chunks except the last one must
+*          hold a multiple of the FLASH write unit.
+*
+* \param[in] pData pointer to location of the received data
+* \param[in] fsciInterface the interface on which the packet was received
+*
+* \return  TRUE in order to recycle the received message
+*
+********************************************************************************** */
+bool_t FSCI_BulkWriteReqFunc(void* pData, uint32_t fsciInterface)
+{
+    clientPacket_t *pPkt = pData;
+    uint32_t address = 0;
+    uint32_t length = 0;
+    uint16_t chunkSize = mFsciBulkMaxChunk_c;
+    uint8_t  flags = 0;
+    uint8_t  status = gFsciSuccess_c;
+
+    if( (pPkt->structured.header.len < 2*sizeof(uint32_t)) ||
+        (mFsciBulkIdle_c != mFsciBulk.state) )
+    {
+        status = gFsciError_c;
+    }
+    else
+    {
+        FLib_MemCpy(&address, pPkt->structured.payload, sizeof(uint32_t));
+        FLib_MemCpy(&length, &pPkt->structured.payload[sizeof(uint32_t)], sizeof(uint32_t));
+
+        if( pPkt->structured.header.len > 2*sizeof(uint32_t) )
+        {
+            flags = pPkt->structured.payload[2*sizeof(uint32_t)];
+        }
+
+        mFsciBulk.flash = FALSE;
+
+        if( FSCI_BulkInRam(address, length) )
+        {
+            /* Only the FLASH is erased */
+            (void)flags;
+        }
+#if gFsciBulkFlashWrite_c
+        else if( FSCI_BulkInFlash(address, length) )
+        {
+            uint32_t eraseLength = (length + P_SECTOR_SIZE - 1U) & ~(P_SECTOR_SIZE - 1U);
+
+            mFsciBulk.flash = TRUE;
+            chunkSize &= ~(PGM_SIZE_BYTE - 1U);
+
+            if( (flags & mFsciBulkFlagErase_c) &&
+                ( (address & (P_SECTOR_SIZE - 1U)) || !FSCI_BulkInFlash(address, eraseLength) ||
+                  (kStatus_FLASH_Success != NV_FlashEraseSector(address, eraseLength)) ) )
+            {
+                status = gFsciError_c;
+            }
+        }
+#endif
+        else
+        {
+            status = gFsciError_c;
+        }
+    }
+
+    if( gFsciSuccess_c == status )
+    {
+        mFsciBulk.state = mFsciBulkWrite_c;
+        mFsciBulk.status = gFsciSuccess_c;
+        mFsciBulk.fsciInterface = (uint8_t)fsciInterface;
+        mFsciBulk.start = address;
+        mFsciBulk.address = address;
+        mFsciBulk.length = length;
+        mFsciBulk.remaining = length;
+        mFsciBulk.crc = mFsciCrc32Init_c;
+        mFsciBulk.seq = 0;
+        mFsciBulk.chunkSize = chunkSize;
+    }
+
+    pPkt->structured.header.len = sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint8_t);
+    pPkt->structured.payload[0] = status;
+    FLib_MemCpy(&pPkt->structured.payload[1], &chunkSize, sizeof(uint16_t));
+#if gFsciTxAck_c
+    pPkt->structured.payload[1 + sizeof(uint16_t)] = 0;
+#else
+    pPkt->structured.payload[1 + sizeof(uint16_t)] = gFsciBulkWriteCredits_c;
+#endif
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief   Receives a chunk of a streamed write.
+*          Payload contains the packet received over the serial interface
+*          bytes 0-1 --> sequence number, starting from 0
+*          bytes 2+  --> data, at most the chunk size of the Fsci-BulkWrite.Confirm
+*          Without gFsciTxAck_c, a Fsci-BulkData.Indication holding the sequence
+*          number is sent once the chunk is written, except for the last one. When
+*          all the data is written, or on error, a Fsci-BulkEnd.Indication is sent
+*          (status, number of bytes written, CRC32 of the memory range written).
+*
+* \param[in] pData pointer to location of the received data
+* \param[in] fsciInterface the interface on which the packet was received
+*
+* \return  FALSE, the received message is freed
+*
+********************************************************************************** */
+bool_t FSCI_BulkDataReqFunc(void* pData, uint32_t fsciInterface)
+{
+    clientPacket_t *pPkt = pData;
+    uint16_t len = pPkt->structured.header.len;
+    uint16_t seq = 0;
+
+    if( (mFsciBulkWrite_c != mFsciBulk.state) || (fsciInterface != mFsciBulk.fsciInterface) )
+    {
+        MEM_BufferFree(pData);
+        FSCI_Error(gFsciError_c, fsciInterface);
+        return FALSE;
+    }
+
+    if( len >= mFsciBulkSeqSize_c )
+    {
+        FLib_MemCpy(&seq, pPkt->structured.payload, mFsciBulkSeqSize_c);
+        len -= mFsciBulkSeqSize_c;
+    }
+
+    if( (pPkt->structured.header.len < mFsciBulkSeqSize_c) || (seq != mFsciBulk.seq) ||
+        (len > mFsciBulk.chunkSize) || (len > mFsciBulk.remaining) ||
+        (mFsciBulk.flash && (len & (PGM_SIZE_BYTE - 1U)) && (len != mFsciBulk.remaining)) ||
+        !FSCI_BulkWrite(mFsciBulk.address, &pPkt->structured.payload[mFsciBulkSeqSize_c], len) )
+    {
+        mFsciBulk.status = gFsciError_c;
+    }
+    else
+    {
+        mFsciBulk.crc = FSCI_Crc32(mFsciBulk.crc, &pPkt->structured.payload[mFsciBulkSeqSize_c], len);
+        mFsciBulk.address += len;
+        mFsciBulk.remaining -= len;
+        mFsciBulk.seq++;
+    }
+
+    MEM_BufferFree(pData);
+
+    if( (gFsciSuccess_c != mFsciBulk.status) || !mFsciBulk.remaining )
+    {
+        FSCI_BulkEnd();
+    }
+#if !gFsciTxAck_c
+    else
+    {
+        /* Give back the credit of the chunk */
+        FLib_MemCpy(mFsciBulkPayload, &seq, mFsciBulkSeqSize_c);
+        FSCI_transmitPayload(gFSCI_CnfOpcodeGroup_c, mFsciLowLevelBulkData_c,
+                             mFsciBulkPayload, mFsciBulkSeqSize_c, fsciInterface);
+    }
+#endif
+
+    return FALSE;
+}
+
+/*! *********************************************************************************
+* \brief   Aborts the ongoing streamed read or write. The Fsci-BulkEnd.Indication
+*          is sent with the gFsciError_c status once the chunks already queued
+*          are sent.
+*
+* \param[in] pData pointer to location of the received data
+* \param[in] fsciInterface the interface on which the packet was received
+*
+* \return  FALSE, the received message is freed
+*
+********************************************************************************** */
+bool_t FSCI_BulkAbortReqFunc(void* pData, uint32_t fsciInterface)
+{
+    MEM_BufferFree(pData);
+
+    if( (mFsciBulkIdle_c == mFsciBulk.state) || (fsciInterface != mFsciBulk.fsciInterface) )
+    {
+        FSCI_Error(gFsciError_c, fsciInterface);
+    }
+    else
+    {
+        mFsciBulk.status = gFsciError_c;
+
+        if( mFsciBulkRead_c == mFsciBulk.state )
+        {
+            FSCI_BulkReadPump();
+        }
+        else
+        {
+            FSCI_BulkEnd();
+        }
+    }
+
+    return FALSE;
+}
+#endif /* gFsciUseBulkTransfer_c */
+
 /*! *********************************************************************************
 * \brief  This function simply echoes back the payload
 *
@@ -626,6 +1088,142 @@ bool_t  FSCI_Ping(void* pData, uint32_t fsciInterface)
     return TRUE;
 }
 
+#if gFsciTxWindowSize_c > 1
+/*! *********************************************************************************
+* \brief  Sets the number of packets sent before waiting for an ACK.
+*         Payload: byte 0 --> requested window size. 0 or 1 selects stop-and-wait.
+*         The confirm holds the status and the window size used, and is sent with
+*         the previous settings. The host must not send other packets until the
+*         confirm is received and acknowledged. Then, both sides switch to the new
+*         settings, and the sequence numbers restart from 0.
+*
+* \param[in] pData pointer to location of the received data
+* \param[in] fsciInterface the interface on which the packet was received
+*
+* \return  FALSE, the confirm is sent by the function
+*
+********************************************************************************** */
+bool_t FSCI_MsgSetTxWindowReqFunc(void* pData, uint32_t fsciInterface)
+{
+    uint8_t window = 0;
+
+    if( ((clientPacket_t*)pData)->structured.header.len )
+    {
+        window = ((clientPacket_t*)pData)->structured.payload[0];
+    }
+
+    if( window > gFsciTxWindowSize_c )
+    {
+        window = gFsciTxWindowSize_c;
+    }
+    else if( window < 2 )
+    {
+        window = 1;
+    }
+
+    ((clientPacket_t*)pData)->structured.header.opGroup = gFSCI_CnfOpcodeGroup_c;
+    ((clientPacket_t*)pData)->structured.header.len = 2;
+    ((clientPacket_t*)pData)->structured.payload[0] = gFsciSuccess_c;
+    ((clientPacket_t*)pData)->structured.payload[1] = window;
+    FSCI_transmitFormatedPacket( pData, fsciInterface );
+
+    FSCI_SetTxWindow( fsciInterface, window );
+    return FALSE;
+}
+#endif
+
+#if gFsciMonitorFilter_c
+/*! *********************************************************************************
+* \brief  Selects the monitored events sent to the host.
+*         Payload: byte 0    --> action: 0 monitor all the events (no filtering),
+*                                1 monitor no event, 2 subscribe, 3 unsubscribe
+*                  byte 1    --> OpGroup passed to FSCI_Monitor()
+*                  byte 2    --> OpCode passed to FSCI_MonitorOpCode()
+*                  byte 3    --> flags: bit 0 set for all the OpCodes of the OpGroup
+*                  byte 4    --> one of N events is sent, 0 or 1: all
+*                  bytes 5-6 --> maximum events per second, 0: no limit
+*         Bytes 1-6 are needed only to subscribe or unsubscribe.
+*
+* \param[in] pData pointer to location of the received data
+* \param[in] fsciInterface the interface on which the packet was received
+*
+* \return  TRUE in order to send the status in the received message
+*
+********************************************************************************** */
+bool_t FSCI_MsgSetMonitorFilterReqFunc(void* pData, uint32_t fsciInterface)
+{
+    clientPacket_t *pPkt = pData;
+    uint8_t *p = pPkt->structured.payload;
+    uint16_t opCode;
+    uint16_t maxRate;
+    uint8_t status = gFsciError_c;
+
+    if( (pPkt->structured.header.len >= 1) && (p[0] <= mFsciMonitorNone_c) )
+    {
+        FSCI_MonitorFilterReset( mFsciMonitorAll_c == p[0] );
+        status = gFsciSuccess_c;
+    }
+    else if( pPkt->structured.header.len >= mFsciMonitorFilterLen_c )
+    {
+        opCode = (p[3] & mFsciMonitorFlagAnyOC_c) ? gFsciMonitorAnyOpCode_c : p[2];
+        FLib_MemCpy(&maxRate, &p[5], sizeof(uint16_t));
+
+        if( mFsciMonitorSubscribe_c == p[0] )
+        {
+            status = FSCI_MonitorSubscribe( p[1], opCode, p[4], maxRate );
+        }
+        else if( mFsciMonitorUnsubscribe_c == p[0] )
+        {
+            status = FSCI_MonitorUnsubscribe( p[1], opCode );
+        }
+    }
+
+    pPkt->structured.header.len = sizeof(clientPacketStatus_t);
+    pPkt->structured.payload[0] = status;
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief  Sends the counters of the monitor subscriptions.
+*         Confirm: status, number of subscriptions, then for each subscription
+*         the OpGroup, the OpCode, the flags, and the number of events sent and
+*         dropped (4 bytes each).
+*
+* \param[in] pData pointer to location of the received data
+* \param[in] fsciInterface the interface on which the packet was received
+*
+* \return  FALSE, the confirm is sent by the function
+*
+********************************************************************************** */
+bool_t FSCI_MsgGetMonitorStatsReqFunc(void* pData, uint32_t fsciInterface)
+{
+    uint8_t payload[2 + gFsciMonitorMaxSubscriptions_c * mFsciMonitorStatsLen_c];
+    fsciMonitorStats_t stats;
+    uint16_t len = 2;
+    uint8_t count = 0;
+
+    MEM_BufferFree(pData);
+
+    while( ((len + mFsciMonitorStatsLen_c) <= gFsciMaxPayloadLen_c) &&
+           FSCI_MonitorGetStats(count, &stats) )
+    {
+        payload[len++] = stats.opGroup;
+        payload[len++] = (uint8_t)stats.opCode;
+        payload[len++] = (gFsciMonitorAnyOpCode_c == stats.opCode) ? mFsciMonitorFlagAnyOC_c : 0;
+        FLib_MemCpy(&payload[len], &stats.sent, sizeof(uint32_t));
+        len += sizeof(uint32_t);
+        FLib_MemCpy(&payload[len], &stats.dropped, sizeof(uint32_t));
+        len += sizeof(uint32_t);
+        count++;
+    }
+
+    payload[0] = gFsciSuccess_c;
+    payload[1] = count;
+    FSCI_transmitPayload( gFSCI_CnfOpcodeGroup_c, mFsciMsgGetMonitorStatsReq_c, payload, len, fsciInterface );
+    return FALSE;
+}
+#endif
+
 /*! *********************************************************************************
 * \brief  This function resets the MCU
 *
@@ -1030,6 +1628,76 @@ bool_t FSCI_OtaSupportHandlerFunc(void* pData, uint32_t fsciInterface)
 #if gFSCI_IncludeMacCommands_c && gFsciHost_802_15_4_c
     Serial_SyncWrite( gFsciSerialInterfaces[fsciHostGetMacInterfaceId(fsciGetMacInstanceId(fsciInterface))], 
                       pData, sizeof(clientPacketHdr_t) + ((clientPacket_t*)pData)->structured.header.len + 1);
+#elif gFsciOtaPipelineDepth_c
+    clientPacket_t *pPkt = pData;
+    uint16_t seq = 0;
+    uint32_t crc = 0;
+    uint8_t  status = gFsciSuccess_c;
+
+    if( mFsciOtaSupportPushImageChunkSeqReq_c == pPkt->structured.header.opCode )
+    {
+        if( pPkt->structured.header.len >= mFsciOtaChunkHdrSize_c )
+        {
+            FLib_MemCpy(&seq, pPkt->structured.payload, sizeof(uint16_t));
+            FLib_MemCpy(&crc, &pPkt->structured.payload[sizeof(uint16_t)], sizeof(uint32_t));
+        }
+
+        if( (pPkt->structured.header.len < mFsciOtaChunkHdrSize_c) || (seq != mFsciOtaNextSeq) )
+        {
+            status = gFsciError_c;
+        }
+        else if( (mFsciOtaChunksStaged >= gFsciOtaPipelineDepth_c) ||
+                 (mFsciOtaQueueCount >= mFsciOtaQueueSize_c) )
+        {
+            status = gFsciOutOfMessages_c;
+        }
+        else if( crc != ~FSCI_Crc32(mFsciCrc32Init_c, &pPkt->structured.payload[mFsciOtaChunkHdrSize_c],
+                                    pPkt->structured.header.len - mFsciOtaChunkHdrSize_c) )
+        {
+            status = gFsciError_c;
+        }
+
+        if( gFsciSuccess_c != status )
+        {
+            /* The host sends again the chunks starting from the next sequence number expected */
+            FSCI_OtaChunkConfirm(pPkt, status, seq, fsciInterface);
+            return FALSE;
+        }
+
+        mFsciOtaNextSeq++;
+        OSA_InterruptDisable();
+        mFsciOtaChunksStaged++;
+        OSA_InterruptEnable();
+    }
+    else
+    {
+        if( mFsciOtaQueueCount >= mFsciOtaQueueSize_c )
+        {
+            MEM_BufferFree(pData);
+            FSCI_Error(gFsciOutOfMessages_c, fsciInterface);
+            return FALSE;
+        }
+
+        if( mFsciOtaSupportStartImageReq_c == pPkt->structured.header.opCode )
+        {
+            mFsciOtaNextSeq = 0;
+        }
+    }
+
+    /* The requests are handed to the OTA module in order, by the OTA task */
+    mFsciOtaQueue[mFsciOtaQueueTail].pPacket = pPkt;
+    mFsciOtaQueue[mFsciOtaQueueTail].fsciInterface = (uint8_t)fsciInterface;
+    mFsciOtaQueueTail = (mFsciOtaQueueTail + 1) % mFsciOtaQueueSize_c;
+    OSA_InterruptDisable();
+    mFsciOtaQueueCount++;
+    OSA_InterruptEnable();
+
+#if defined(FWK_SMALL_RAM_CONFIG)
+    FSCI_OtaPipelineRun();
+#else
+    (void)OSA_EventSet(mFsciOtaEventId, mFsciOtaEvent_c);
+#endif
+    return FALSE;
 #else
     if( pfFSCI_OtaSupportCalback )
     {
@@ -1042,6 +1710,37 @@ bool_t FSCI_OtaSupportHandlerFunc(void* pData, uint32_t fsciInterface)
     MEM_BufferFree(pData);
     return FALSE;
 }
+
+#if gFsciOtaPipelineDepth_c
+/*! *********************************************************************************
+* \brief  Creates the task which hands the OTA requests to the OTA module.
+*         The image chunks can be sent in Fsci-OtaPushImageChunkSeq.Request packets:
+*         bytes 0-1 --> sequence number, 0 for the first chunk after a
+*                       Fsci-OtaStartImage.Request
+*         bytes 2-5 --> CRC32 of the data
+*         bytes 6+  --> data, as in a Fsci-OtaPushImageChunk.Request
+*         Up to gFsciOtaPipelineDepth_c chunks are kept in their receive buffers,
+*         and the host may send them without waiting for the confirms. Each chunk
+*         is confirmed once processed by the OTA module, while the next ones are
+*         received. The confirm holds the status, the sequence number of the
+*         chunk, the next sequence number expected and gFsciOtaPipelineDepth_c.
+*         A chunk out of sequence, with a wrong CRC, or received while the window
+*         is full is rejected, and the host sends again the chunks from the next
+*         sequence number expected.
+*
+********************************************************************************** */
+void FSCI_OtaPipelineInit(void)
+{
+#if !defined(FWK_SMALL_RAM_CONFIG)
+    mFsciOtaEventId = OSA_EventCreate(TRUE);
+    if( (NULL == mFsciOtaEventId) ||
+        (NULL == OSA_TaskCreate(OSA_TASK(FSCI_OtaTask), NULL)) )
+    {
+        panic( ID_PANIC(0,0), (uint32_t)FSCI_OtaPipelineInit, 0, 0 );
+    }
+#endif
+}
+#endif
 /*! *********************************************************************************
 * \brief  This function handles the requests for enable the MSD Bootloader
 *
@@ -1065,4 +1764,372 @@ bool_t FSCI_EnableBootloaderFunc(void* pData, uint32_t fsciInterface)
 }
 
 
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
+
+#if gFsciUseBulkTransfer_c
+/*! *********************************************************************************
+* \brief  Checks that a memory range is inside the RAM.
+*
+* \param[in] address start of the range
+* \param[in] length length of the range
+*
+* \return  TRUE if the range is inside the RAM
+*
+********************************************************************************** */
+static bool_t FSCI_BulkInRam(uint32_t address, uint32_t length)
+{
+    /* mRamEndAddress_c is the last byte of the RAM */
+    return (mRamStartAddress_c <= address) && (address <= mRamEndAddress_c) &&
+           ((0 == length) || (length - 1 <= mRamEndAddress_c - address));
+}
+
+/*! *********************************************************************************
+* \brief  Checks that a memory range is inside the FLASH.
+*
+* \param[in] address start of the range
+* \param[in] length length of the range
+*
+* \return  TRUE if the range is inside the FLASH
+*
+********************************************************************************** */
+static bool_t FSCI_BulkInFlash(uint32_t address, uint32_t length)
+{
+    return (mFlashStartAddress_c <= address) && (address < mFlashEndAddress_c) &&
+           (length <= mFlashEndAddress_c - address);
+}
+
+/*! *********************************************************************************
+* \brief  Builds the payload of the next chunk of a streamed read. The data is copied,
+*         so that the checksum and the CRC match the data sent.
+*
+* \return  the length of the payload
+*
+********************************************************************************** */
+static uint16_t FSCI_BulkReadChunk(void)
+{
+    uint16_t len = mFsciBulk.chunkSize;
+
+    if( mFsciBulk.remaining < len )
+    {
+        len = (uint16_t)mFsciBulk.remaining;
+    }
+
+    FLib_MemCpy(mFsciBulkPayload, &mFsciBulk.seq, mFsciBulkSeqSize_c);
+    FLib_MemCpy(&mFsciBulkPayload[mFsciBulkSeqSize_c], (void*)mFsciBulk.address, len);
+    mFsciBulk.crc = FSCI_Crc32(mFsciBulk.crc, &mFsciBulkPayload[mFsciBulkSeqSize_c], len);
+    mFsciBulk.address += len;
+    mFsciBulk.remaining -= len;
+    mFsciBulk.seq++;
+
+    return len + mFsciBulkSeqSize_c;
+}
+
+/*! *********************************************************************************
+* \brief  Sends the chunks of a streamed read. Without gFsciRxAck_c, the chunks are
+*         built in gFsciBulkTxSlots_c static buffers, and the function is called
+*         again each time the SMGR releases a buffer. With gFsciRxAck_c, all the
+*         chunks are sent by this call, paced by the FSCI acknowledgements.
+*         Once all the data was sent, the Fsci-BulkEnd.Indication is sent.
+*
+********************************************************************************** */
+static void FSCI_BulkReadPump(void)
+{
+    uint16_t len;
+#if gFsciRxAck_c
+    uint8_t *pFrame;
+
+    /* An abort received while a chunk waits for its acknowledgement only sets the
+     * status: the active pump ends the transfer */
+    if( mFsciBulk.pumping || (mFsciBulkRead_c != mFsciBulk.state) )
+    {
+        return;
+    }
+
+    mFsciBulk.pumping = TRUE;
+    while( mFsciBulk.remaining && (gFsciSuccess_c == mFsciBulk.status) )
+    {
+        pFrame = MEM_BufferAlloc( FSCI_EncodedPacketSize(mFsciBulk.chunkSize + mFsciBulkSeqSize_c) );
+        if( NULL == pFrame )
+        {
+            mFsciBulk.status = gFsciOutOfMessages_c;
+            break;
+        }
+
+        len = FSCI_BulkReadChunk();
+        len = FSCI_EncodePayload(gFSCI_CnfOpcodeGroup_c, mFsciLowLevelBulkData_c,
+                                 mFsciBulkPayload, len, mFsciBulk.fsciInterface, pFrame);
+        FSCI_transmitEncodedPacket(pFrame, len, mFsciBulk.fsciInterface);
+    }
+    mFsciBulk.pumping = FALSE;
+
+    FSCI_BulkEnd();
+#else
+    uint32_t slot;
+
+    /* The SMGR may release a buffer while a chunk is queued */
+    if( mFsciBulk.pumping )
+    {
+        mFsciBulk.repump = TRUE;
+        return;
+    }
+
+    mFsciBulk.pumping = TRUE;
+    do
+    {
+        mFsciBulk.repump = FALSE;
+
+        for( slot = 0; slot < gFsciBulkTxSlots_c; slot++ )
+        {
+            if( !mFsciBulk.remaining || (gFsciSuccess_c != mFsciBulk.status) )
+            {
+                break;
+            }
+
+            if( mFsciBulk.slotsBusy & (1U << slot) )
+            {
+                continue;
+            }
+
+            len = FSCI_BulkReadChunk();
+            len = FSCI_EncodePayload(gFSCI_CnfOpcodeGroup_c, mFsciLowLevelBulkData_c,
+                                     mFsciBulkPayload, len, mFsciBulk.fsciInterface, mFsciBulkFrames[slot]);
+            mFsciBulk.slotsBusy |= (1U << slot);
+
+            if( gSerial_Success_c != Serial_AsyncWrite(gFsciSerialInterfaces[mFsciBulk.fsciInterface],
+                                                       mFsciBulkFrames[slot], len,
+                                                       FSCI_BulkTxDone, (void*)slot) )
+            {
+                mFsciBulk.slotsBusy &= ~(1U << slot);
+                mFsciBulk.status = gFsciError_c;
+            }
+        }
+    } while( mFsciBulk.repump );
+    mFsciBulk.pumping = FALSE;
+
+    if( (mFsciBulkRead_c == mFsciBulk.state) && !mFsciBulk.slotsBusy &&
+        (!mFsciBulk.remaining || (gFsciSuccess_c != mFsciBulk.status)) )
+    {
+        FSCI_BulkEnd();
+    }
+#endif
+}
+
+#if !gFsciRxAck_c
+/*! *********************************************************************************
+* \brief  Called by the SMGR when a chunk of a streamed read was sent
+*
+* \param[in] param the index of the buffer of the chunk
+*
+********************************************************************************** */
+static void FSCI_BulkTxDone(void *param)
+{
+    mFsciBulk.slotsBusy &= ~(1U << (uint32_t)param);
+    FSCI_BulkReadPump();
+}
+#endif
+
+/*! *********************************************************************************
+* \brief  Writes a chunk of a streamed write in RAM, or in FLASH.
+*
+* \param[in] address destination address
+* \param[in] pData pointer to the data
+* \param[in] length length of the data
+*
+* \return  TRUE if the data was written
+*
+********************************************************************************** */
+static bool_t FSCI_BulkWrite(uint32_t address, uint8_t *pData, uint16_t length)
+{
+#if gFsciBulkFlashWrite_c
+    if( mFsciBulk.flash )
+    {
+        return (kStatus_FLASH_Success == NV_FlashProgramUnaligned(address, length, pData));
+    }
+#endif
+
+    FLib_MemCpy((void*)address, pData, length);
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief  Ends the streamed read or write, and sends the Fsci-BulkEnd.Indication:
+*         status, number of bytes transferred and CRC32 of these bytes. For a write,
+*         the CRC is computed again over the memory written, and the status is
+*         gFsciError_c if it differs from the CRC of the data received.
+*
+********************************************************************************** */
+static void FSCI_BulkEnd(void)
+{
+    uint32_t length = mFsciBulk.length - mFsciBulk.remaining;
+    uint32_t crc = mFsciBulk.crc;
+
+    /* The transfer was already ended */
+    if( mFsciBulkIdle_c == mFsciBulk.state )
+    {
+        return;
+    }
+
+    if( mFsciBulkWrite_c == mFsciBulk.state )
+    {
+#if gFsciBulkFlashWrite_c
+        if( mFsciBulk.flash )
+        {
+            /* Program the last phrase */
+            if( kStatus_FLASH_Success != NV_FlashFlushWriteBuffer() )
+            {
+                mFsciBulk.status = gFsciError_c;
+            }
+        }
+#endif
+        crc = FSCI_Crc32(mFsciCrc32Init_c, (uint8_t*)mFsciBulk.start, length);
+        if( crc != mFsciBulk.crc )
+        {
+            mFsciBulk.status = gFsciError_c;
+        }
+    }
+
+    crc = ~crc;
+    mFsciBulkPayload[0] = mFsciBulk.status;
+    FLib_MemCpy(&mFsciBulkPayload[1], &length, sizeof(uint32_t));
+    FLib_MemCpy(&mFsciBulkPayload[1 + sizeof(uint32_t)], &crc, sizeof(uint32_t));
+    mFsciBulk.state = mFsciBulkIdle_c;
+
+    FSCI_transmitPayload(gFSCI_CnfOpcodeGroup_c, mFsciLowLevelBulkEnd_c,
+                         mFsciBulkPayload, mFsciBulkEndLen_c, mFsciBulk.fsciInterface);
+}
+#endif /* gFsciUseBulkTransfer_c */
+
+#if gFsciUseBulkTransfer_c || gFsciOtaPipelineDepth_c
+/*! *********************************************************************************
+* \brief  Updates a CRC32 (IEEE 802.3, as computed by zlib) with a block of data.
+*         The CRC starts from mFsciCrc32Init_c, and is inverted at the end.
+*
+* \param[in] crc the CRC of the previous data
+* \param[in] pData pointer to the data
+* \param[in] length length of the data
+*
+* \return  the updated CRC
+*
+********************************************************************************** */
+static uint32_t FSCI_Crc32(uint32_t crc, const uint8_t *pData, uint32_t length)
+{
+    while( length-- )
+    {
+        crc ^= *pData++;
+        crc = (crc >> 4) ^ mFsciCrc32Table[crc & 0x0F];
+        crc = (crc >> 4) ^ mFsciCrc32Table[crc & 0x0F];
+    }
+
+    return crc;
+}
+#endif
+
+#if gFsciOtaPipelineDepth_c
+/*! *********************************************************************************
+* \brief  Sends the confirm of a Fsci-OtaPushImageChunkSeq.Request
+*
+* \param[in] pPkt the received packet, reused for the confirm
+* \param[in] status the status of the chunk
+* \param[in] seq the sequence number of the chunk
+* \param[in] fsciInterface the interface on which the packet was received
+*
+********************************************************************************** */
+static void FSCI_OtaChunkConfirm(clientPacket_t *pPkt, uint8_t status, uint16_t seq, uint32_t fsciInterface)
+{
+    uint16_t nextSeq = mFsciOtaNextSeq;
+
+    pPkt->structured.header.opGroup = gFSCI_CnfOpcodeGroup_c;
+    pPkt->structured.header.opCode = mFsciOtaSupportPushImageChunkSeqReq_c;
+    pPkt->structured.header.len = mFsciOtaChunkCnfLen_c;
+    pPkt->structured.payload[0] = status;
+    FLib_MemCpy(&pPkt->structured.payload[1], &seq, sizeof(uint16_t));
+    FLib_MemCpy(&pPkt->structured.payload[1 + sizeof(uint16_t)], &nextSeq, sizeof(uint16_t));
+    pPkt->structured.payload[1 + 2*sizeof(uint16_t)] = gFsciOtaPipelineDepth_c;
+    FSCI_transmitFormatedPacket( pPkt, fsciInterface );
+}
+
+/*! *********************************************************************************
+* \brief  Hands the queued OTA requests to the OTA module. The staged chunks are
+*         passed as Fsci-OtaPushImageChunk.Request packets.
+*
+********************************************************************************** */
+static void FSCI_OtaPipelineRun(void)
+{
+    clientPacket_t *pPkt;
+    uint32_t fsciInterface;
+    uint16_t seq;
+    uint8_t  status;
+
+    while( mFsciOtaQueueCount )
+    {
+        pPkt = mFsciOtaQueue[mFsciOtaQueueHead].pPacket;
+        fsciInterface = mFsciOtaQueue[mFsciOtaQueueHead].fsciInterface;
+        mFsciOtaQueueHead = (mFsciOtaQueueHead + 1) % mFsciOtaQueueSize_c;
+
+        if( mFsciOtaSupportPushImageChunkSeqReq_c == pPkt->structured.header.opCode )
+        {
+            FLib_MemCpy(&seq, pPkt->structured.payload, sizeof(uint16_t));
+            pPkt->structured.header.len -= mFsciOtaChunkHdrSize_c;
+            FLib_MemInPlaceCpy(pPkt->structured.payload, &pPkt->structured.payload[mFsciOtaChunkHdrSize_c],
+                               pPkt->structured.header.len);
+            pPkt->structured.header.opCode = mFsciOtaSupportPushImageChunkReq_c;
+
+            status = gFsciRequestIsDisabled_c;
+            if( pfFSCI_OtaSupportCalback && pfFSCI_OtaSupportCalback(pPkt) )
+            {
+                status = pPkt->structured.payload[0];
+            }
+
+            OSA_InterruptDisable();
+            mFsciOtaChunksStaged--;
+            OSA_InterruptEnable();
+            FSCI_OtaChunkConfirm(pPkt, status, seq, fsciInterface);
+        }
+        else if( pfFSCI_OtaSupportCalback && pfFSCI_OtaSupportCalback(pPkt) )
+        {
+            pPkt->structured.header.opGroup = gFSCI_CnfOpcodeGroup_c;
+            FSCI_transmitFormatedPacket( pPkt, fsciInterface );
+        }
+        else
+        {
+            MEM_BufferFree(pPkt);
+        }
+
+        OSA_InterruptDisable();
+        mFsciOtaQueueCount--;
+        OSA_InterruptEnable();
+    }
+}
+
+#if !defined(FWK_SMALL_RAM_CONFIG)
+/*! *********************************************************************************
+* \brief  Task handing the OTA requests to the OTA module. The FLASH is programmed
+*         by this task, while the SMGR task receives the next chunks.
+*
+* \param[in] argument not used
+*
+********************************************************************************** */
+static void FSCI_OtaTask(osaTaskParam_t argument)
+{
+    osaEventFlags_t flags;
+
+    while( 1 )
+    {
+        (void)OSA_EventWait(mFsciOtaEventId, mFsciOtaEvent_c, FALSE, osaWaitForever_c, &flags);
+        FSCI_OtaPipelineRun();
+
+        /* For BareMetal break the while(1) after 1 run */
+        if( gUseRtos_c == 0 )
+        {
+            break;
+        }
+    }
+}
+#endif
+#endif /* gFsciOtaPipelineDepth_c */
+
 #endif /* gFsciIncluded_c */
\ No newline at end of file
@@ -95,12 +95,20 @@ enum {
     mFsciOtaSupportQueryImageRsp_c          = 0xC3,
     mFsciOtaSupportImageNotifyReq_c         = 0xC4,
     mFsciOtaSupportGetClientInfo_c          = 0xC5,            
+    mFsciOtaSupportPushImageChunkSeqReq_c   = 0xC6, /* Fsci-OtaPushImageChunkSeq.Request    */
 
     mFsciEnableBootloaderReq_c              = 0xCF,
     
     mFsciLowLevelMemoryWriteBlock_c         = 0x30, /* Fsci-WriteRAMMemoryBlock.Request     */
     mFsciLowLevelMemoryReadBlock_c          = 0x31, /* Fsci-ReadMemoryBlock.Request         */
+    mFsciLowLevelBulkReadReq_c              = 0x32, /* Fsci-BulkRead.Request                */
+    mFsciLowLevelBulkWriteReq_c             = 0x33, /* Fsci-BulkWrite.Request               */
+    mFsciLowLevelBulkData_c                 = 0x34, /* Fsci-BulkData.Request/Indication     */
+    mFsciLowLevelBulkEnd_c                  = 0x35, /* Fsci-BulkAbort.Request/BulkEnd.Indication */
+    mFsciMsgSetMonitorFilterReq_c           = 0x36, /* Fsci-SetMonitorFilter.Request        */
+    mFsciMsgGetMonitorStatsReq_c            = 0x37, /* Fsci-GetMonitorStats.Request         */
     mFsciLowLevelPing_c                     = 0x38, /* Fsci-Ping.Request                    */
+    mFsciMsgSetTxWindowReq_c                = 0x39, /* Fsci-SetTxWindow.Request             */
 
     mFsciMsgGetApsDeviceKeyPairSet_c        = 0x3B,  /* Fsci-GetApsDeviceKeyPairSet         */
     mFsciMsgGetApsDeviceKey_c               = 0x3C,
@@ -211,6 +219,10 @@ bool_t FSCI_MsgGetNVPageHdrReqFunc            (void* pData, uint32_t fsciInterfa
 bool_t FSCI_MsgNVSaveReqFunc                  (void* pData, uint32_t fsciInterface);
 bool_t FSCI_WriteMemoryBlock                  (void* pData, uint32_t fsciInterface);
 bool_t FSCI_ReadMemoryBlock                   (void* pData, uint32_t fsciInterface);
+bool_t FSCI_BulkReadReqFunc                   (void* pData, uint32_t fsciInterface);
+bool_t FSCI_BulkWriteReqFunc                  (void* pData, uint32_t fsciInterface);
+bool_t FSCI_BulkDataReqFunc                   (void* pData, uint32_t fsciInterface);
+bool_t FSCI_BulkAbortReqFunc                  (void* pData, uint32_t fsciInterface);
 bool_t FSCI_Ping                              (void* pData, uint32_t fsciInterface);
 bool_t FSCI_MsgResetCPUReqFunc                (void* pData, uint32_t fsciInterface);
 bool_t FSCI_MsgWriteExtendedAdrReqFunc        (void* pData, uint32_t fsciInterface);
@@ -218,10 +230,17 @@ bool_t FSCI_MsgReadExtendedAdrReqFunc         (void* pData, uint32_t fsciInterfa
 bool_t FSCI_GetLastLqiValue                   (void* pData, uint32_t fsciInterface);
 bool_t FSCI_MsgAllowDeviceToSleepReqFunc      (void* pData, uint32_t fsciInterface);
 bool_t FSCI_MsgGetWakeUpReasonReqFunc         (void* pData, uint32_t fsciInterface);
+bool_t FSCI_MsgSetTxWindowReqFunc             (void* pData, uint32_t fsciInterface);
+bool_t FSCI_MsgSetMonitorFilterReqFunc        (void* pData, uint32_t fsciInterface);
+bool_t FSCI_MsgGetMonitorStatsReqFunc         (void* pData, uint32_t fsciInterface);
 bool_t FSCI_ReadUniqueId                      (void* pData, uint32_t fsciInterface);
 bool_t FSCI_ReadMCUId                         (void* pData, uint32_t fsciInterface);
 bool_t FSCI_ReadModVer                        (void* pData, uint32_t fsciInterface);
 bool_t FSCI_OtaSupportHandlerFunc             (void* pData, uint32_t fsciInterface);
 bool_t FSCI_EnableBootloaderFunc              (void* pData, uint32_t fsciInterface);
 
+#if gFsciOtaPipelineDepth_c
+void FSCI_OtaPipelineInit(void);
+#endif
+
 #endif /* _FSCI_COMMANDS_H_ */
\ No newline at end of file
@@ -60,7 +60,6 @@
 *************************************************************************************
 ************************************************************************************/
 #define gFsciUseBlockingTx_c 1
-#define MIN_VALID_PACKET_LEN (sizeof(clientPacketHdr_t))
 #define FSCI_txCallback MEM_BufferFree
 #define FSCI_rxCallback FSCI_receivePacket
 
@@ -76,13 +75,21 @@
 #define mFsciRxRestartTimeoutMs_c 50 /* milliseconds */
 #endif
 
+#ifndef mFsciTxWindowTickMs_c
+#define mFsciTxWindowTickMs_c     10 /* milliseconds, retransmission check period */
+#endif
+
+/* Longest packet sent without a sequence number (ACK or error message) */
+#define mFsciMaxUnsequencedLen_c  (16)
+
+#define mFsciSeq(n)         ((uint8_t)(n) & (gFSCI_SeqModulo_c - 1))
+#define mFsciWindowSlot(n)  ((n) & (gFsciTxWindowSize_c - 1))
+
 /************************************************************************************
 *************************************************************************************
 * Private prototypes
 *************************************************************************************
 ************************************************************************************/
-fsci_packetStatus_t FSCI_checkPacket( clientPacket_t *pData, uint16_t bytes, uint8_t* pVIntf );
-
 #if gFsciRxAck_c && gFsciRxAckTimeoutUseTmr_c
 static void FSCI_RxAckExpireCb(void *param);
 #endif
@@ -92,6 +99,19 @@ static void FSCI_RxRxTimeoutCb(void *param);
 #endif
 
 static void FSCI_SendPacketToSerialManager(uint32_t fsciInterface, uint8_t *pPacket, uint16_t packetLen);
+static void FSCI_DeliverPacket(clientPacket_t *pPacket, uint32_t fsciInterface);
+
+#if gFsciTxWindowSize_c > 1
+static bool_t FSCI_TxWindowSend(uint32_t fsciInterface, uint8_t *pFrame, uint16_t frameLen);
+static void FSCI_TxWindowTransmit(uint32_t fsciInterface, fsciTxWindowEntry_t *pEntry);
+static void FSCI_TxWindowTxDone(void *param);
+static void FSCI_TxWindowRelease(fsciTxWindowEntry_t *pEntry);
+static void FSCI_TxWindowService(uint32_t fsciInterface);
+static void FSCI_TxWindowPoll(void *param);
+static void FSCI_TxWindowReset(uint32_t fsciInterface);
+static void FSCI_RxWindowInput(uint32_t fsciInterface, clientPacket_t *pPacket, uint8_t seq);
+static void FSCI_RxWindowFlush(uint32_t fsciInterface);
+#endif
 
 /************************************************************************************
 *************************************************************************************
@@ -258,6 +278,17 @@ void FSCI_commInit( void* initStruct )
             mFsciCommData[i].ackReceived = FALSE;
             mFsciCommData[i].ackWaitOngoing = FALSE;
 #endif
+
+#if gFsciTxWindowSize_c > 1
+            /* The windowed mode is enabled by the host, see FSCI_SetTxWindow() */
+            mFsciCommData[i].txWindowTmr = TMR_AllocateTimer();
+            if( gTmrInvalidTimerID_c == mFsciCommData[i].txWindowTmr )
+            {
+                panic( ID_PANIC(0,0), (uint32_t)FSCI_commInit, 0, 0 );
+                break;
+            }
+            TMR_TimeStampInit();
+#endif
             
 #if gFsciRxTimeout_c
 #if mFsciRxTimeoutUsePolling_c
@@ -290,9 +321,13 @@ void FSCI_receivePacket( void* param )
     uint64_t            currentTs = 0;
 #endif  
     fsciComm_t          *pCommData = &mFsciCommData[(uint32_t)param];
-    uint16_t            readBytes;
+    uint8_t             serialInterface = gFsciSerialInterfaces[(uint32_t)param];
+    clientPacket_t      *pPacket;
     fsci_packetStatus_t status;
-    uint8_t             virtualInterfaceId;
+    uint8_t             *pData;
+    uint16_t            size;
+    uint16_t            used;
+    bool_t              wasBusy;
     uint8_t             c;
     
 #if gFsciRxTimeout_c
@@ -316,32 +351,36 @@ void FSCI_receivePacket( void* param )
         NvClearCriticalSection();
 #endif                                                  
         pCommData->rxOngoing = FALSE;
-        if( pCommData->pPacketFromClient != (clientPacket_t*)&pCommData->pktHeader )
-        {
-            MEM_BufferFree(pCommData->pPacketFromClient);
-        }
-
-        pCommData->pPacketFromClient = NULL;        
+        FSCI_ParserReset(&pCommData->rxParser);
     }
 #endif    
-    
-    if( gSerial_Success_c != Serial_GetByteFromRxBuffer( gFsciSerialInterfaces[(uint32_t)param], &c, &readBytes ) )
+
+#if gFsciTxWindowSize_c > 1
+    /* Drop the packets received out of order, if the windowed mode was left */
+    if( !pCommData->window && pCommData->rxReorderCnt )
     {
-        return;
+        FSCI_RxWindowFlush((uint32_t)param);
     }
-
-    while( readBytes )
+#endif
+    
+    /* Parse the received data in place, one contiguous chunk at a time */
+    while( (gSerial_Success_c == Serial_RxPeek(serialInterface, &pData, &size)) && size )
     {
 #if gFsciRxTimeout_c
         timerRestartEn = TRUE;
 #endif    
-        if( NULL == pCommData->pPacketFromClient )
+        wasBusy = FSCI_ParserBusy(&pCommData->rxParser);
+        status = FSCI_ParserInput(&pCommData->rxParser, pData, size, &used);
+        /* Checksum of a received packet */
+        c = used ? pData[used - 1] : 0;
+        /* The parsed bytes are released before the packet is handled, since the
+           handler may receive data too (e.g. while waiting for an ACK) */
+        (void)Serial_RxConsume(serialInterface, used);
+
+        if( PACKET_IS_TO_SHORT == status )
         {
-            pCommData->bytesReceived = 0;
-            if( c == gFSCI_StartMarker_c )
+            if( !wasBusy && FSCI_ParserBusy(&pCommData->rxParser) )
             {
-                pCommData->pPacketFromClient = (clientPacket_t*)&pCommData->pktHeader;
-                pCommData->bytesReceived++;
 #if gNvStorageIncluded_d
                 NvSetCriticalSection();
 #endif                
@@ -349,167 +388,74 @@ void FSCI_receivePacket( void* param )
                 pCommData->rxOngoing = TRUE;
 #endif                
             }
+            continue;
         }
-        else
-        {
-            pCommData->pPacketFromClient->raw[pCommData->bytesReceived++] = c;
-
-#if gFsciUseEscapeSeq_c
-            FSCI_decodeEscapeSeq( pCommData->pPacketFromClient->raw, pCommData->bytesReceived );
-#endif
 
-            /* call the check pachet function to see if we have a valid packet */
-            status = FSCI_checkPacket( pCommData->pPacketFromClient, pCommData->bytesReceived, &virtualInterfaceId );
-
-            if( (pCommData->bytesReceived == sizeof(clientPacketHdr_t)) && (status == PACKET_IS_TO_SHORT) )
-            {
-                pCommData->pPacketFromClient = MEM_BufferAlloc( sizeof(clientPacketHdr_t) + pCommData->pktHeader.len + 2 );
-                if( NULL != pCommData->pPacketFromClient )
-                {
-                    FLib_MemCpy(pCommData->pPacketFromClient, &pCommData->pktHeader, sizeof(clientPacketHdr_t));
-                }
-                else
-                {
+        /* The packet ended. If it also started in this chunk, the critical section was not entered */
 #if gNvStorageIncluded_d
-                    NvClearCriticalSection();
+        if( wasBusy )
+        {
+            NvClearCriticalSection();
+        }
 #endif                    
 #if gFsciRxTimeout_c
 #if !mFsciRxTimeoutUsePolling_c
-                    (void)TMR_StopTimer(pCommData->rxRestartTmr);
+        (void)TMR_StopTimer(pCommData->rxRestartTmr);
 #endif
-                    pCommData->rxOngoing = FALSE;
+        pCommData->rxOngoing = FALSE;
 #endif
-                }
-            }
 
-            if( status == PACKET_IS_VALID )
-            {
-#if gNvStorageIncluded_d
-                NvClearCriticalSection();
-#endif              
-#if gFsciRxTimeout_c
-#if !mFsciRxTimeoutUsePolling_c
-                (void)TMR_StopTimer(pCommData->rxRestartTmr);
-#endif
-                pCommData->rxOngoing = FALSE;
-#endif              
+        if( PACKET_IS_VALID != status )
+        {
+            /* The parser dropped the packet and searches for the next start marker */
+            continue;
+        }
+
+        pPacket = FSCI_ParserTakePacket(&pCommData->rxParser);
+
 #if gFsciRxAck_c
-                /* Check for ACK packet */
-                if( ( gFSCI_CnfOpcodeGroup_c == pCommData->pktHeader.opGroup ) &&
-                    ( mFsciMsgAck_c == pCommData->pktHeader.opCode ) )
+        /* Check for ACK packet */
+        if( ( gFSCI_CnfOpcodeGroup_c == pPacket->structured.header.opGroup ) &&
+            ( mFsciMsgAck_c == pPacket->structured.header.opCode ) )
+        {
+#if gFsciTxWindowSize_c > 1
+            if( pCommData->window )
+            {
+                /* Cumulative ACK: the sequence byte holds the next sequence number expected by the host */
+                pCommData->txAckSeq = pCommData->rxParser.seq;
+                MEM_BufferFree(pPacket);
+                FSCI_TxWindowPoll(param);
+                if( pCommData->ackWaitOngoing )
                 {
-                    pCommData->ackReceived = TRUE;
-                    MEM_BufferFree(pCommData->pPacketFromClient);   
-                    pCommData->pPacketFromClient = NULL;
-                    /* Do not process any other packets for now */
                     break;
                 }
-                else
-#endif
-                {     
-                    mFsciSrcInterface = FSCI_GetFsciInterface((uint32_t)param, virtualInterfaceId); 
-#if gFsciTxAck_c
-                    FSCI_Ack(c, mFsciSrcInterface);
-#endif      
-#if gFsciHostSupport_c
-                    if( gFsciHostWaitingSyncRsp &&
-                      ( gFsciHostWaitingOpGroup == pCommData->pPacketFromClient->structured.header.opGroup ) &&
-                      ( gFsciHostWaitingOpCode == pCommData->pPacketFromClient->structured.header.opCode ) )
-                    {
-                        /* Save packet to be processed by caller */
-                        pFsciHostSyncRsp = pCommData->pPacketFromClient;
-#if gFsciHostSyncUseEvent_c
-                        OSA_EventSet(gFsciHostSyncRspEventId, gFSCIHost_RspReady_c);
-#endif
-                    }
-                    else
-#endif                  
-                    {
-                        FSCI_ProcessRxPkt(pCommData->pPacketFromClient, mFsciSrcInterface);
-                    }
-                }
-                pCommData->pPacketFromClient = NULL;
+                continue;
             }
-            else if (status == FRAMING_ERROR)
-            {
-#if 0
-                uint16_t i;
-
-                /* If there appears to be a framing error, search the data received for */
-                /* the next STX and try again. */
-                c = 0;
-                for (i = 0; i < pCommData->bytesReceived; ++i)
-                {
-                    if (pCommData->pPacketFromClient->raw[i] == gFSCI_StartMarker_c)
-                    {
-                        c = gFSCI_StartMarker_c;
-                        pCommData->bytesReceived -= i;
-                        FLib_MemCpy( pCommData->pPacketFromClient->raw,
-                                    pCommData->pPacketFromClient->raw + i,
-                                    pCommData->bytesReceived);
-#if 0
-                        /* If a payload buffer was alocated, and the new payload is larger than the buffer's size,
-                        * then a new buffer must be allocated. The received data is copied into the new buffer,
-                        * and the old one is freed.
-                        */
-                        if( (void*)pCommData->pPacketFromClient != (void*)&pCommData->pktHeader &&
-                            pCommData->bytesReceived >= sizeof(clientPacketHdr_t) &&
-                            pCommData->pPacketFromClient->structured.header.len > MEM_BufferGetSize(pCommData->pPacketFromClient) 
-                          )
-                        {
-                            clientPacket_t *p;
-                            p = MEM_BufferAlloc( sizeof(clientPacketHdr_t) + pCommData->pPacketFromClient->structured.header.len + 2 );
-                            
-                            if( NULL != p )
-                            {
-                                FLib_MemCpy(p->raw,
-                                            pCommData->pPacketFromClient->raw,
-                                            pCommData->bytesReceived);
-                            }
-                            
-                            MEM_BufferFree( pCommData->pPacketFromClient );                                
-                            pCommData->pPacketFromClient = p;
-                        }
-#endif
-                        break;
-                    }
-                }
-
-                if( c != gFSCI_StartMarker_c )
 #endif
-                {
-                    if( pCommData->pPacketFromClient != (clientPacket_t*)&pCommData->pktHeader )
-                    {
-                        MEM_BufferFree(pCommData->pPacketFromClient);
-                    }
-
-                    pCommData->pPacketFromClient = NULL;
-                    
-#if gNvStorageIncluded_d
-                    NvClearCriticalSection();
-#endif                    
-#if gFsciRxTimeout_c
-#if !mFsciRxTimeoutUsePolling_c
-                    (void)TMR_StopTimer(pCommData->rxRestartTmr);
-#endif
-                    pCommData->rxOngoing = FALSE;
+            pCommData->ackReceived = TRUE;
+            MEM_BufferFree(pPacket);   
+            /* Do not process any other packets for now */
+            break;
+        }
+        else
 #endif
-                }
-                
-            } /* if (status == FRAMING_ERROR) */
-            else
+        {     
+            mFsciSrcInterface = FSCI_GetFsciInterface((uint32_t)param, pCommData->rxParser.virtualInterface); 
+#if gFsciTxWindowSize_c > 1
+            if( pCommData->window )
             {
-                /* fix MISRA-C 2004 error */
+                FSCI_RxWindowInput(mFsciSrcInterface, pPacket, pCommData->rxParser.seq);
+                continue;
             }
-            
-        }  /* if (!startOfFrameSeen) */
-
-        if ( gSerial_Success_c != Serial_GetByteFromRxBuffer( gFsciSerialInterfaces[(uint32_t)param], &c, &readBytes ) )
-        {
-            break;
+#endif
+#if gFsciTxAck_c
+            FSCI_Ack(c, mFsciSrcInterface);
+#else
+            (void)c;
+#endif      
+            FSCI_DeliverPacket(pPacket, mFsciSrcInterface);
         }
-
-    } /* while (j < size) */
+    }
     
 #if gFsciRxTimeout_c
     if( timerRestartEn && pCommData->rxOngoing )
@@ -576,30 +522,46 @@ void FSCI_transmitFormatedPacket( void *pPacket, uint32_t fsciInterface )
 void FSCI_transmitPayload( uint8_t OG, uint8_t OC, void *pMsg, uint16_t msgLen, uint32_t fsciInterface )
 {
     uint8_t* buffer_ptr = NULL;
-    uint16_t buffer_size, index;
-    uint8_t checksum, checksum2;
-    clientPacketHdr_t header;
-    uint32_t virtInterface = FSCI_GetVirtualInterface(fsciInterface);
+    uint16_t index;
 
     if( gFsciTxDisable || (msgLen > gFsciMaxPayloadLen_c) )
     {
         return;
     }
 
-    /* Compute size */
-    buffer_size = sizeof(clientPacketHdr_t) + msgLen + 2*sizeof(checksum);
-
-#if gFsciUseEscapeSeq_c
-    buffer_size = buffer_size*2;
-#endif
-
     /* Allocate buffer */
-    buffer_ptr = MEM_BufferAlloc( buffer_size );
+    buffer_ptr = MEM_BufferAlloc( FSCI_EncodedPacketSize(msgLen) );
     if( NULL == buffer_ptr )
     {
         return;
     }
 
+    index = FSCI_EncodePayload( OG, OC, pMsg, msgLen, fsciInterface, buffer_ptr );
+
+    /* send message to Serial Manager */
+    FSCI_SendPacketToSerialManager(fsciInterface, buffer_ptr, index);
+}
+
+/*! *********************************************************************************
+* \brief  Builds a packet ready to be sent over the serial interface
+*
+* \param[in] OG operation Group
+* \param[in] OC operation Code
+* \param[in] pMsg pointer to payload
+* \param[in] msgLen length of the payload, at most gFsciMaxPayloadLen_c
+* \param[in] fsciInterface the interface on which the packet will be sent
+* \param[out] pOut buffer of at least FSCI_EncodedPacketSize(msgLen) bytes
+*
+* \return the length of the packet
+*
+********************************************************************************** */
+uint16_t FSCI_EncodePayload( uint8_t OG, uint8_t OC, void *pMsg, uint16_t msgLen, uint32_t fsciInterface, uint8_t *pOut )
+{
+    uint16_t index;
+    uint8_t checksum, checksum2 = 0;
+    clientPacketHdr_t header;
+    uint32_t virtInterface = FSCI_GetVirtualInterface(fsciInterface);
+
     /* Message header */
     header.startMarker = gFSCI_StartMarker_c;
     header.opGroup = OG;
@@ -617,32 +579,46 @@ void FSCI_transmitPayload( uint8_t OG, uint8_t OC, void *pMsg, uint16_t msgLen,
 
     index = 0;
 #if gFsciUseEscapeSeq_c
-    index += FSCI_encodeEscapeSeq( (uint8_t*)&header, sizeof(header), &buffer_ptr[index] );
-    index += FSCI_encodeEscapeSeq( pMsg, msgLen, &buffer_ptr[index]);
+    index += FSCI_encodeEscapeSeq( (uint8_t*)&header, sizeof(header), &pOut[index] );
+    index += FSCI_encodeEscapeSeq( pMsg, msgLen, &pOut[index]);
     /* Store the Checksum*/
-    index += FSCI_encodeEscapeSeq( (uint8_t*)&checksum, sizeof(checksum), &buffer_ptr[index] );
+    index += FSCI_encodeEscapeSeq( (uint8_t*)&checksum, sizeof(checksum), &pOut[index] );
     if( virtInterface )
     {
-        index += FSCI_encodeEscapeSeq( (uint8_t*)&checksum2, sizeof(checksum2), &buffer_ptr[index] );
+        index += FSCI_encodeEscapeSeq( (uint8_t*)&checksum2, sizeof(checksum2), &pOut[index] );
     }
-    buffer_ptr[index++] = gFSCI_EndMarker_c;
+    pOut[index++] = gFSCI_EndMarker_c;
 
 #else /* gFsciUseEscapeSeq_c */
-    FLib_MemCpy( &buffer_ptr[index], &header, sizeof(header) );
+    FLib_MemCpy( &pOut[index], &header, sizeof(header) );
     index += sizeof(header);
-    FLib_MemCpy( &buffer_ptr[index], pMsg, msgLen );
+    FLib_MemCpy( &pOut[index], pMsg, msgLen );
     index += msgLen;
     /* Store the Checksum */
-    buffer_ptr[index++] = checksum;
+    pOut[index++] = checksum;
     if( virtInterface )
     {
-        buffer_ptr[index++] = checksum2;
+        pOut[index++] = checksum2;
     }
     
 #endif /* gFsciUseEscapeSeq_c */
 
-    /* send message to Serial Manager */
-    FSCI_SendPacketToSerialManager(fsciInterface, buffer_ptr, index);
+    return index;
+}
+
+/*! *********************************************************************************
+* \brief  Sends a packet built with FSCI_EncodePayload(). In the acknowledged modes,
+*         the function returns once the packet was acknowledged, or the window
+*         has room for it.
+*
+* \param[in] pFrame packet allocated with MEM_BufferAlloc(), freed by FSCI
+* \param[in] frameLen length of the packet
+* \param[in] fsciInterface the interface on which the packet should be sent
+*
+********************************************************************************** */
+void FSCI_transmitEncodedPacket( uint8_t *pFrame, uint16_t frameLen, uint32_t fsciInterface )
+{
+    FSCI_SendPacketToSerialManager(fsciInterface, pFrame, frameLen);
 }
 
 /*! *********************************************************************************
@@ -695,237 +671,148 @@ uint8_t* FSCI_GetFormattedPacket(uint8_t OG, uint8_t OC, void *pMsg, uint16_t ms
     }
 }
 
-/************************************************************************************
-*************************************************************************************
-* Private functions
-*************************************************************************************
-************************************************************************************/
-
 /*! *********************************************************************************
-* \brief  Returnd the virtual interface associated with the specified fsciInterface.
+* \brief  Sends a packet which is not acknowledged by the host (ACK or error message).
+*         In the windowed mode, the sequence byte holds the cumulative ACK.
 *
 * \param[in] fsciInterface the interface on which the packet should be sent
-*
-* \return the Virtual Interface Id
+* \param[in] pFrame pointer to the formatted packet
+* \param[in] frameLen the length of the formatted packet
 *
 ********************************************************************************** */
-uint32_t FSCI_GetVirtualInterface(uint32_t fsciInterface)
+void FSCI_WriteUnsequenced( uint32_t fsciInterface, uint8_t *pFrame, uint16_t frameLen )
 {
-#if gFsciMaxVirtualInterfaces_c
-    return gFsciVirtualInterfaces[fsciInterface];
-#else
-    return 0;
-#endif
-}
+#if gFsciTxWindowSize_c > 1
+    uint8_t frame[mFsciMaxUnsequencedLen_c + 1];
 
-/*! *********************************************************************************
-* \brief  Determines the FSCI interface for a received packet.
-*
-* \param[in] hwInterface the serial interface on which the packet was received.
-* \param[in] virtualInterface the virtual interface of the received packet
-*
-* \return the FSCI interface
-*
-********************************************************************************** */
-uint32_t FSCI_GetFsciInterface(uint32_t hwInterface, uint32_t virtualInterface)
-{
-#if gFsciMaxVirtualInterfaces_c
-    uint32_t i;
-    
-    for( i = 0; i < gFsciMaxInterfaces_c; i++)
+    if( mFsciCommData[fsciInterface].window && (frameLen <= mFsciMaxUnsequencedLen_c) )
     {
-        if( (virtualInterface == gFsciVirtualInterfaces[i]) && (hwInterface == gFsciSerialInterfaces[i]) )
-        {
-            hwInterface = i;
-            break;
-        }
+        frame[0] = pFrame[0];
+        frame[1] = FSCI_SeqExtEncode(mFsciCommData[fsciInterface].rxNextSeq);
+        FLib_MemCpy(&frame[2], &pFrame[1], frameLen - 1);
+        pFrame = frame;
+        frameLen++;
     }
 #endif
-    return hwInterface;
+    Serial_SyncWrite( gFsciSerialInterfaces[fsciInterface], pFrame, frameLen );
 }
 
+#if gFsciTxWindowSize_c > 1
 /*! *********************************************************************************
-* \brief  Checks to see if we have a valid packet
-*
-* \param[in] pData The message containing the incoming data packet to be handled.
-* \param[in] bytes the number of bytes inside the buffer
-* \param[Out] pVIntf pointer to the location where the virtual interface Id will be stored
+* \brief  Changes the number of packets sent before waiting for an ACK. The packets
+*         already sent are acknowledged first, then both sequence numbers restart
+*         from 0. A window of 0 or 1 restores the stop-and-wait mode.
 *
-* \return the status of the packet
+* \param[in] fsciInterface the fsci interface
+* \param[in] window the new window size, limited to gFsciTxWindowSize_c
 *
 ********************************************************************************** */
-fsci_packetStatus_t FSCI_checkPacket( clientPacket_t *pData, uint16_t bytes, uint8_t* pVIntf )
+void FSCI_SetTxWindow( uint32_t fsciInterface, uint8_t window )
 {
-    uint8_t checksum = 0;
-    uint16_t len;
+    fsciComm_t *pCommData = &mFsciCommData[fsciInterface];
+    /* Fails if the caller already holds the mutex, while waiting for an ACK */
+    bool_t locked = (osaStatus_Success == OSA_MutexLock(pCommData->syncTxRxAckMutexId, osaWaitForever_c));
 
-    if ( bytes < MIN_VALID_PACKET_LEN )
+    pCommData->ackWaitOngoing = TRUE;
+    while( pCommData->window && (pCommData->txBase != pCommData->txNextSeq) )
     {
-        return PACKET_IS_TO_SHORT;            /* Too short to be valid. */
+        FSCI_receivePacket((void*)fsciInterface);
+        FSCI_TxWindowService(fsciInterface);
     }
+    pCommData->ackWaitOngoing = FALSE;
 
-    if ( bytes >= sizeof(clientPacket_t) )
-    {
-        return FRAMING_ERROR;
-    }
+    FSCI_TxWindowReset(fsciInterface);
+    FSCI_RxWindowFlush(fsciInterface);
+    pCommData->rxNextSeq = 0;
 
-    if ( NULL == pData )
+    if( window > 1 )
     {
-        return INTERNAL_ERROR;
+        pCommData->window = (window > gFsciTxWindowSize_c) ? gFsciTxWindowSize_c : window;
+        pCommData->rxParser.seqExt = TRUE;
     }
 
-    /* The packet's len field does not count the STX, the opcode group, the */
-    /* opcode, the len field, or the checksum. */
-    len = pData->structured.header.len;
-    
-    /* If the length appears to be too long, it might be because the external */
-    /* client is sending a packet that is too long, or it might be that we're */
-    /* out of sync with the external client. Assume we're out of sync. */
-    if ( len > gFsciMaxPayloadLen_c )
+    if( locked )
     {
-        return FRAMING_ERROR;
-    }    
-    
-    if ( bytes < len + sizeof(clientPacketHdr_t) + sizeof(checksum) )
-    {
-        return PACKET_IS_TO_SHORT;
-    }
-
-    /* If the length looks right, make sure that the checksum is correct. */
-    if( bytes >= len + sizeof(clientPacketHdr_t) + sizeof(checksum) )
-    {
-        checksum = FSCI_computeChecksum(pData->raw+1, len + sizeof(clientPacketHdr_t)-1);
-        *pVIntf = pData->structured.payload[len] - checksum;
-    }
-    
-    if( bytes == len + sizeof(clientPacketHdr_t) + sizeof(checksum) )
-    {
-        if( 0 == *pVIntf )
-        {
-            return PACKET_IS_VALID;
-        }
-#if gFsciMaxVirtualInterfaces_c
-        else 
-        {
-            if( *pVIntf < gFsciMaxVirtualInterfaces_c )
-            {
-                return PACKET_IS_TO_SHORT;
-            }
-        }
-#endif
-    }
-
-#if gFsciMaxVirtualInterfaces_c
-    /* Check virtual interface */
-    if( bytes == len + sizeof(clientPacketHdr_t) + 2*sizeof(checksum) )
-    {
-        checksum ^= checksum + *pVIntf;
-        if( pData->structured.payload[len+1] == checksum )
-        {
-            return PACKET_IS_VALID;
-        }
+        OSA_MutexUnlock(pCommData->syncTxRxAckMutexId);
     }
+}
 #endif
 
-    return FRAMING_ERROR;
-}
+/************************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+************************************************************************************/
 
 /*! *********************************************************************************
-* \brief  This function performs a XOR over the message to compute the CRC
-*
-* \param[in]  pBuffer - pointer to the messae
-* \param[in]  size - the length of the message
+* \brief  Passes a received packet to the waiting host request, or to its handler
 *
-* \return  the CRC of the message
+* \param[in]  pPacket pointer to the received packet
+* \param[in]  fsciInterface the interface on which the packet was received
 *
 ********************************************************************************** */
-uint8_t FSCI_computeChecksum( void *pBuffer, uint16_t size )
+static void FSCI_DeliverPacket(clientPacket_t *pPacket, uint32_t fsciInterface)
 {
-    uint16_t index;
-    uint8_t  checksum = 0;
-
-    for ( index = 0; index < size; index++ )
+#if gFsciHostSupport_c
+    if( gFsciHostWaitingSyncRsp &&
+      ( gFsciHostWaitingOpGroup == pPacket->structured.header.opGroup ) &&
+      ( gFsciHostWaitingOpCode == pPacket->structured.header.opCode ) )
     {
-        checksum ^= ((uint8_t*)pBuffer)[index];
+        /* Save packet to be processed by caller */
+        pFsciHostSyncRsp = pPacket;
+#if gFsciHostSyncUseEvent_c
+        OSA_EventSet(gFsciHostSyncRspEventId, gFSCIHost_RspReady_c);
+#endif
+    }
+    else
+#endif                  
+    {
+        FSCI_ProcessRxPkt(pPacket, fsciInterface);
     }
-
-    return checksum;
 }
 
 /*! *********************************************************************************
-* \brief  This function performs the encoding of a message, using the Escape Sequence
+* \brief  Returnd the virtual interface associated with the specified fsciInterface.
 *
-* \param[in]  pDataIn, pointer to the messae to be encoded
-* \param[in]  len, the length of the message
-* \param[out]  pDataOut, pointer to the encoded message
+* \param[in] fsciInterface the interface on which the packet should be sent
 *
-* \return  The number of bytes added in the new buffer
+* \return the Virtual Interface Id
 *
 ********************************************************************************** */
-#if gFsciUseEscapeSeq_c
-uint32_t FSCI_encodeEscapeSeq( uint8_t* pDataIn, uint32_t len, uint8_t* pDataOut )
+uint32_t FSCI_GetVirtualInterface(uint32_t fsciInterface)
 {
-    uint32_t index, new_index = 0;
-
-    if( NULL != pDataOut )
-    {
-        for ( index = 0; index < len; index++ )
-        {
-            if( (pDataIn[index] == gFSCI_StartMarker_c) ||
-               (pDataIn[index] == gFSCI_EndMarker_c)    ||
-                   (pDataIn[index] == gFSCI_EscapeChar_c) )
-            {
-                pDataOut[new_index++] = gFSCI_EscapeChar_c;
-                pDataOut[new_index++] = pDataIn[index] ^ gFSCI_EscapeChar_c;
-            }
-            else
-            {
-                pDataOut[new_index++] = pDataIn[index];
-            }
-        }
-    }
-
-    return new_index;
-}
+#if gFsciMaxVirtualInterfaces_c
+    return gFsciVirtualInterfaces[fsciInterface];
+#else
+    return 0;
 #endif
+}
 
 /*! *********************************************************************************
-* \brief  This function performs the decoding of a message, using the Escape Sequence
+* \brief  Determines the FSCI interface for a received packet.
 *
-* \param[in]  pData pointer to the messae to be encoded
-* \param[in]  len the length of the message
+* \param[in] hwInterface the serial interface on which the packet was received.
+* \param[in] virtualInterface the virtual interface of the received packet
 *
+* \return the FSCI interface
 *
 ********************************************************************************** */
-#if gFsciUseEscapeSeq_c
-void FSCI_decodeEscapeSeq( uint8_t* pData, uint32_t len )
+uint32_t FSCI_GetFsciInterface(uint32_t hwInterface, uint32_t virtualInterface)
 {
-    uint32_t index, new_index;
-
-    /* Find the first gFSCI_EscapeChar_c */
-    for ( index = 0; index < len; index++ )
-        if ( pData[index] == gFSCI_EscapeChar_c )
-            break;
-
-    new_index = index;
-
-    /* If a gFSCI_EscapeChar_c was found, decode the packet in place */
-    while ( index < len )
+#if gFsciMaxVirtualInterfaces_c
+    uint32_t i;
+    
+    for( i = 0; i < gFsciMaxInterfaces_c; i++)
     {
-        if ( pData[index] == gFSCI_EscapeChar_c )
-        {
-            index++; /* skip over the gFSCI_EscapeChar_c */
-
-            if ( index < len )
-                pData[new_index++] = pData[index++] ^ gFSCI_EscapeChar_c;
-        }
-        else if ( new_index != index )
+        if( (virtualInterface == gFsciVirtualInterfaces[i]) && (hwInterface == gFsciSerialInterfaces[i]) )
         {
-            pData[new_index++] = pData[index++];
+            hwInterface = i;
+            break;
         }
     }
-}
 #endif
+    return hwInterface;
+}
 
 #if gFsciRxAck_c && gFsciRxAckTimeoutUseTmr_c
 /*! *********************************************************************************
@@ -981,6 +868,14 @@ static void FSCI_SendPacketToSerialManager(uint32_t fsciInterface, uint8_t *pPac
 
     OSA_MutexLock(pCommData->syncTxRxAckMutexId, osaWaitForever_c);
     
+#if gFsciTxWindowSize_c > 1
+    if( pCommData->window && FSCI_TxWindowSend(fsciInterface, pPacket, packetLen) )
+    {
+        OSA_MutexUnlock(pCommData->syncTxRxAckMutexId);
+        return;
+    }
+#endif
+
     pCommData->ackReceived = FALSE;
     pCommData->txRetryCnt = mFsciTxRetryCnt_c;
     
@@ -989,13 +884,6 @@ static void FSCI_SendPacketToSerialManager(uint32_t fsciInterface, uint8_t *pPac
         Serial_SyncWrite(gFsciSerialInterfaces[fsciInterface], pPacket, packetLen);
         pCommData->ackWaitOngoing = TRUE;
         
-        /* Allow the FSCI interface to receive ACK packet, 
-           if last packet was received on the same interface */
-        if( mFsciSrcInterface == fsciInterface )
-        {
-            pCommData->pPacketFromClient = NULL;
-        }
-        
 #if gFsciRxAckTimeoutUseTmr_c     
         /* Start timer for ACK wait */
         TMR_StartSingleShotTimer(pCommData->ackWaitTmr, mFsciRxAckTimeoutMs_c, FSCI_RxAckExpireCb, (void*)fsciInterface);
@@ -1060,4 +948,336 @@ static void FSCI_SendPacketToSerialManager(uint32_t fsciInterface, uint8_t *pPac
 #endif /* gFsciRxAck_c */ 
 }
 
+#if gFsciTxWindowSize_c > 1
+/*! *********************************************************************************
+* \brief  Sends a packet in the windowed mode. Waits only if the window is full.
+*         The caller must hold the Tx mutex.
+*
+* \param[in]  fsciInterface fsci interface on which the packet is to be sent
+* \param[in]  pFrame formatted packet, freed once it is acknowledged
+* \param[in]  frameLen lenght of the formatted packet in bytes
+*
+* \return TRUE if the packet was sent, FALSE if the windowed mode was left
+*
+********************************************************************************** */
+static bool_t FSCI_TxWindowSend(uint32_t fsciInterface, uint8_t *pFrame, uint16_t frameLen)
+{
+    fsciComm_t          *pCommData = &mFsciCommData[fsciInterface];
+    fsciTxWindowEntry_t *pEntry;
+
+    /* Wait for room in the window. The entry of an acknowledged packet is reused
+       only after the SMGR has released the packet */
+    pCommData->ackWaitOngoing = TRUE;
+    while( pCommData->window &&
+           ( (mFsciSeq(pCommData->txNextSeq - pCommData->txBase) >= pCommData->window) ||
+             (NULL != pCommData->txWindow[mFsciWindowSlot(pCommData->txNextSeq)].pFrame) ) )
+    {
+        FSCI_receivePacket((void*)fsciInterface);
+        FSCI_TxWindowService(fsciInterface);
+    }
+    pCommData->ackWaitOngoing = FALSE;
+
+    if( !pCommData->window )
+    {
+        /* The host stopped answering */
+        return FALSE;
+    }
+
+    pEntry = &pCommData->txWindow[mFsciWindowSlot(pCommData->txNextSeq)];
+    pEntry->pFrame = pFrame;
+    pEntry->frameLen = frameLen;
+    pEntry->seqExt = FSCI_SeqExtEncode(pCommData->txNextSeq);
+    pEntry->retries = mFsciTxRetryCnt_c - 1;
+    pEntry->txPending = 0;
+    pEntry->acked = FALSE;
+    pCommData->txNextSeq = mFsciSeq(pCommData->txNextSeq + 1);
+
+    FSCI_TxWindowTransmit(fsciInterface, pEntry);
+
+    if( !TMR_IsTimerActive(pCommData->txWindowTmr) )
+    {
+        (void)TMR_StartIntervalTimer(pCommData->txWindowTmr, mFsciTxWindowTickMs_c,
+                                     FSCI_TxWindowPoll, (void*)fsciInterface);
+    }
+
+    return TRUE;
+}
+
+/*! *********************************************************************************
+* \brief  Sends a packet of the window, with its sequence byte after the start marker
+*
+* \param[in]  fsciInterface fsci interface on which the packet is to be sent
+* \param[in]  pEntry the window entry of the packet
+*
+********************************************************************************** */
+static void FSCI_TxWindowTransmit(uint32_t fsciInterface, fsciTxWindowEntry_t *pEntry)
+{
+    serialSegment_t segments[3];
+
+    segments[0].pData = pEntry->pFrame;
+    segments[0].dataSize = 1;
+    segments[0].releaseCb = NULL;
+    segments[0].pReleaseParam = NULL;
+    segments[1].pData = &pEntry->seqExt;
+    segments[1].dataSize = 1;
+    segments[1].releaseCb = NULL;
+    segments[1].pReleaseParam = NULL;
+    segments[2].pData = pEntry->pFrame + 1;
+    segments[2].dataSize = pEntry->frameLen - 1;
+    segments[2].releaseCb = FSCI_TxWindowTxDone;
+    segments[2].pReleaseParam = pEntry;
+
+    pEntry->deadline = TMR_GetTimestamp() + (uint64_t)mFsciRxAckTimeoutMs_c * 1000;
+
+    OSA_InterruptDisable();
+    pEntry->txPending++;
+    OSA_InterruptEnable();
+
+    if( gSerial_Success_c != Serial_AsyncWriteV(gFsciSerialInterfaces[fsciInterface], segments, 3) )
+    {
+        /* Sent again when the deadline expires */
+        OSA_InterruptDisable();
+        pEntry->txPending--;
+        OSA_InterruptEnable();
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Called by the SMGR when a packet of the window was sent
+*
+* \param[in]  param the window entry of the packet
+*
+********************************************************************************** */
+static void FSCI_TxWindowTxDone(void *param)
+{
+    fsciTxWindowEntry_t *pEntry = (fsciTxWindowEntry_t*)param;
+    uint8_t *pFrame = NULL;
+
+    OSA_InterruptDisable();
+    pEntry->txPending--;
+    if( pEntry->acked && !pEntry->txPending )
+    {
+        pFrame = pEntry->pFrame;
+        pEntry->pFrame = NULL;
+    }
+    OSA_InterruptEnable();
+
+    if( pFrame )
+    {
+        MEM_BufferFree(pFrame);
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Frees an acknowledged packet of the window, or lets the SMGR free it if it
+*         is still being sent
+*
+* \param[in]  pEntry the window entry of the packet
+*
+********************************************************************************** */
+static void FSCI_TxWindowRelease(fsciTxWindowEntry_t *pEntry)
+{
+    uint8_t *pFrame = NULL;
+
+    OSA_InterruptDisable();
+    pEntry->acked = TRUE;
+    if( !pEntry->txPending )
+    {
+        pFrame = pEntry->pFrame;
+        pEntry->pFrame = NULL;
+    }
+    OSA_InterruptEnable();
+
+    if( pFrame )
+    {
+        MEM_BufferFree(pFrame);
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Releases the acknowledged packets, and sends again the ones whose ACK
+*         timed out. Only the expired packets are sent again, since the host keeps
+*         the packets received out of order. The caller must hold the Tx mutex.
+*
+* \param[in]  fsciInterface the fsci interface
+*
+********************************************************************************** */
+static void FSCI_TxWindowService(uint32_t fsciInterface)
+{
+    fsciComm_t          *pCommData = &mFsciCommData[fsciInterface];
+    fsciTxWindowEntry_t *pEntry;
+    uint64_t             currentTs;
+    uint8_t              seq;
+    uint8_t              acked = mFsciSeq(pCommData->txAckSeq - pCommData->txBase);
+
+    /* Ignore ACKs for packets which were not sent */
+    if( acked > mFsciSeq(pCommData->txNextSeq - pCommData->txBase) )
+    {
+        acked = 0;
+    }
+
+    while( acked-- )
+    {
+        FSCI_TxWindowRelease(&pCommData->txWindow[mFsciWindowSlot(pCommData->txBase)]);
+        pCommData->txBase = mFsciSeq(pCommData->txBase + 1);
+    }
+
+    if( pCommData->txBase == pCommData->txNextSeq )
+    {
+        (void)TMR_StopTimer(pCommData->txWindowTmr);
+        return;
+    }
+
+    currentTs = TMR_GetTimestamp();
+
+    for( seq = pCommData->txBase; seq != pCommData->txNextSeq; seq = mFsciSeq(seq + 1) )
+    {
+        pEntry = &pCommData->txWindow[mFsciWindowSlot(seq)];
+
+        if( currentTs < pEntry->deadline )
+        {
+            continue;
+        }
+
+        if( 0 == pEntry->retries )
+        {
+            /* The host stopped answering. Fall back to the stop-and-wait mode */
+            FSCI_TxWindowReset(fsciInterface);
+            break;
+        }
+
+        pEntry->retries--;
+        FSCI_TxWindowTransmit(fsciInterface, pEntry);
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Services the window if the Tx mutex is free. Called when an ACK is
+*         received, and periodically while packets are waiting for an ACK.
+*
+* \param[in]  param the fsci interface
+*
+********************************************************************************** */
+static void FSCI_TxWindowPoll(void *param)
+{
+    fsciComm_t *pCommData = &mFsciCommData[(uint32_t)param];
+
+    /* Otherwise the mutex owner services the window while it waits */
+    if( osaStatus_Success == OSA_MutexLock(pCommData->syncTxRxAckMutexId, 0) )
+    {
+        FSCI_TxWindowService((uint32_t)param);
+        OSA_MutexUnlock(pCommData->syncTxRxAckMutexId);
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Drops the packets of the window and leaves the windowed mode.
+*         The caller must hold the Tx mutex.
+*
+* \param[in]  fsciInterface the fsci interface
+*
+********************************************************************************** */
+static void FSCI_TxWindowReset(uint32_t fsciInterface)
+{
+    fsciComm_t *pCommData = &mFsciCommData[fsciInterface];
+    uint32_t    i;
+
+    (void)TMR_StopTimer(pCommData->txWindowTmr);
+
+    for( i = 0; i < gFsciTxWindowSize_c; i++ )
+    {
+        if( pCommData->txWindow[i].pFrame )
+        {
+            FSCI_TxWindowRelease(&pCommData->txWindow[i]);
+        }
+    }
+
+    pCommData->window = 0;
+    pCommData->rxParser.seqExt = FALSE;
+    pCommData->txBase = 0;
+    pCommData->txNextSeq = 0;
+    pCommData->txAckSeq = 0;
+}
+
+/*! *********************************************************************************
+* \brief  Handles a packet received in the windowed mode. The packets received out
+*         of order are kept until the missing ones arrive. The cumulative ACK is
+*         sent before the packets are handled.
+*
+* \param[in]  fsciInterface the interface on which the packet was received
+* \param[in]  pPacket pointer to the received packet
+* \param[in]  seq the sequence number of the packet
+*
+********************************************************************************** */
+static void FSCI_RxWindowInput(uint32_t fsciInterface, clientPacket_t *pPacket, uint8_t seq)
+{
+    fsciComm_t     *pCommData = &mFsciCommData[fsciInterface];
+    clientPacket_t *pInOrder[gFsciTxWindowSize_c];
+    clientPacket_t *pNext;
+    uint8_t         offset = mFsciSeq(seq - pCommData->rxNextSeq);
+    uint8_t         checksum = pPacket->structured.payload[pPacket->structured.header.len];
+    uint32_t        count = 0;
+    uint32_t        i;
+
+    if( 0 == offset )
+    {
+        /* Deliver the packet, and the ones received ahead of it */
+        pInOrder[count++] = pPacket;
+        pCommData->rxNextSeq = mFsciSeq(seq + 1);
+
+        while( count < gFsciTxWindowSize_c )
+        {
+            pNext = pCommData->rxReorder[mFsciWindowSlot(pCommData->rxNextSeq)];
+            if( NULL == pNext )
+            {
+                break;
+            }
+            pCommData->rxReorder[mFsciWindowSlot(pCommData->rxNextSeq)] = NULL;
+            pCommData->rxReorderCnt--;
+            pInOrder[count++] = pNext;
+            pCommData->rxNextSeq = mFsciSeq(pCommData->rxNextSeq + 1);
+        }
+    }
+    else if( (offset < pCommData->window) && (NULL == pCommData->rxReorder[mFsciWindowSlot(seq)]) )
+    {
+        pCommData->rxReorder[mFsciWindowSlot(seq)] = pPacket;
+        pCommData->rxReorderCnt++;
+    }
+    else
+    {
+        /* Already received, or outside of the window */
+        MEM_BufferFree(pPacket);
+    }
+
+    FSCI_Ack(checksum, fsciInterface);
+
+    for( i = 0; i < count; i++ )
+    {
+        FSCI_DeliverPacket(pInOrder[i], fsciInterface);
+    }
+}
+
+/*! *********************************************************************************
+* \brief  Drops the packets received out of order
+*
+* \param[in]  fsciInterface the fsci interface
+*
+********************************************************************************** */
+static void FSCI_RxWindowFlush(uint32_t fsciInterface)
+{
+    fsciComm_t *pCommData = &mFsciCommData[fsciInterface];
+    uint32_t    i;
+
+    for( i = 0; i < gFsciTxWindowSize_c; i++ )
+    {
+        if( pCommData->rxReorder[i] )
+        {
+            MEM_BufferFree(pCommData->rxReorder[i]);
+            pCommData->rxReorder[i] = NULL;
+        }
+    }
+    pCommData->rxReorderCnt = 0;
+}
+#endif /* gFsciTxWindowSize_c > 1 */
+
 #endif /* gFsciIncluded_c */
@@ -103,7 +103,79 @@
  */
 #ifndef gNvMinimumFreeBytesCountStart_c
 #define gNvMinimumFreeBytesCountStart_c    128
-#endif  
+#endif
+
+/*
+ * Name: gNvCompactionFillWatermark_c
+ * Description: active page fill level (in percents) above which the idle task starts
+ *              the page copy in background, before a save finds the page full.
+ *              Set it to 0 to start the page copy only when the page is full.
+ */
+#ifndef gNvCompactionFillWatermark_c
+#define gNvCompactionFillWatermark_c       90
+#endif
+
+/*
+ * Name: gNvCompactionMetasPerStep_c
+ * Description: the count of source page meta information tags processed by one
+ *              page copy step performed by the idle task
+ */
+#ifndef gNvCompactionMetasPerStep_c
+#define gNvCompactionMetasPerStep_c        4
+#endif
+
+/*
+ * Name: gNvCompactionTimeBudget_c
+ * Description: time (in microseconds) that one NvIdle() call may spend on page copy
+ *              and page erase steps. At least one step is performed on each call.
+ */
+#ifndef gNvCompactionTimeBudget_c
+#define gNvCompactionTimeBudget_c          2000
+#endif
+
+/*
+ * Name: gNvCircularLog_d
+ * Description: enables/disables the circular log mode. The NV storage is split in
+ *              gNvCircularLogPagesCount_c log pages written in turn; when the free
+ *              pages run low, the oldest page is reclaimed: its latest records are
+ *              moved to the active page and it is erased. A compaction then moves
+ *              only one log page instead of the whole storage.
+ *              Not available with FlexNVM, gNvUseExtendedFeatureSet_d or
+ *              gUnmirroredFeatureSet_d. The flash layout differs from the two
+ *              pages one, so switching the mode formats the NV storage.
+ */
+#ifndef gNvCircularLog_d
+#define gNvCircularLog_d                   FALSE
+#endif
+
+/*
+ * Name: gNvCircularLogPagesCount_c
+ * Description: the count of log pages used by the circular log mode (at least 3).
+ *              NV_STORAGE_MAX_SECTORS from the linker file must be a multiple of it;
+ *              a log page must fit the largest table entry.
+ */
+#ifndef gNvCircularLogPagesCount_c
+#define gNvCircularLogPagesCount_c         8
+#endif
+
+/*
+ * Name: gNvWearStatisticsSectorsCount_c
+ * Description: the count of NV storage sectors (all virtual pages) whose erase
+ *              count is tracked and reported by NvGetPagesStatistics()
+ */
+#ifndef gNvWearStatisticsSectorsCount_c
+#define gNvWearStatisticsSectorsCount_c    16
+#endif
+
+/*
+ * Name: gNvUnmirroredCacheEntries_c
+ * Description: the count of unmirrored element locations kept in the restore
+ *              cache (least recently used entry is replaced). Used only if
+ *              gUnmirroredFeatureSet_d is TRUE. Set it to 0 to disable the cache.
+ */
+#ifndef gNvUnmirroredCacheEntries_c
+#define gNvUnmirroredCacheEntries_c        8
+#endif
       
 /*
  * Name: gNvUseExtendedFeatureSet_d
@@ -365,7 +437,7 @@ typedef uint16_t NvTableEntryId_t;
 typedef struct NVM_DatasetInfo_tag
 {
     bool_t saveNextInterval;
-    NvSaveInterval_t ticksToNextSave;
+    uint32_t nextSaveTick;
     NvSaveCounter_t countsToNextSave;
 #if gUnmirroredFeatureSet_d
     uint16_t elementIndex;
@@ -441,12 +513,24 @@ typedef enum NVM_Status_tag
 /*
  * Name: NVM_Statistics_t
  * Description: structure used to store pages statistic information
- *              (erase cycle count of each page)  
+ *              (erase cycle count of each page, sector wear and page
+ *              reclaim counters since the module initialisation).
+ *              In circular log mode both page erase cycle counts hold the
+ *              average erase cycle count of a log page and a page copy is
+ *              the reclaim of the oldest log page.
  */
 typedef struct NVM_Statistics_tag
 {
     uint32_t FirstPageEraseCyclesCount;
     uint32_t SecondPageEraseCyclesCount;
+    uint32_t PageCopiesCount;           /* page copies (reclaims) performed */
+    uint32_t ReclaimedBytesCount;       /* bytes freed by the page copies */
+    uint32_t SectorErasesCount;         /* sectors erased */
+    uint32_t BlankSectorsSkippedCount;  /* sector erases avoided because the sector was blank */
+    uint8_t  SectorsCount;              /* valid entries of SectorEraseCyclesCount */
+    uint32_t SectorEraseCyclesCount[gNvWearStatisticsSectorsCount_c]; /* erases of each sector */
+    uint32_t UnmirroredCacheHitsCount;   /* unmirrored element restores served by the cache */
+    uint32_t UnmirroredCacheMissesCount; /* unmirrored element restores that parsed the meta information */
 } NVM_Statistics_t;
 
 
@@ -780,8 +864,9 @@ extern bool_t NvIsDataSetDirty
  * Name: NvGetStatistics
  * Description:       
  * Parameter(s): [OUT] ptrStat - pointer to a memory location where the pages
- *                               statistics (erase cycles of each page) will 
- *                               be stored
+ *                               statistics (erase cycles of each page, erase
+ *                               count of each sector and page reclaim
+ *                               counters) will be stored
  * Return: -
  *****************************************************************************/
 extern void NvGetPagesStatistics
@@ -0,0 +1,124 @@
+/*!
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+*
+* \file
+*
+* This is the header file for the serial channel multiplexer.
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* o Redistributions of source code must retain the above copyright notice, this list
+*   of conditions and the following disclaimer.
+*
+* o Redistributions in binary form must reproduce the above copyright notice, this
+*   list of conditions and the following disclaimer in the documentation and/or
+*   other materials provided with the distribution.
+*
+* o Neither the name of Freescale Semiconductor, Inc. nor the names of its
+*   contributors may be used to endorse or promote products derived from this
+*   software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __SERIAL_MUX_H__
+#define __SERIAL_MUX_H__
+
+/*! *********************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+********************************************************************************** */
+#include "EmbeddedTypes.h"
+#include "SerialManager.h"
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public macros
+*************************************************************************************
+********************************************************************************** */
+
+/*
+ * The multiplexer carries several logical channels over one physical serial
+ * interface. Each channel is opened as a virtual SerialManager interface:
+ *
+ *     Serial_InitInterface(&phyId, gSerialMgrUart_c, 0);
+ *     SerialMux_Init(phyId);
+ *     Serial_InitInterface(&shellId, gSerialMgrMux_c, 0);   <- channel 0
+ *     Serial_InitInterface(&fsciId, gSerialMgrMux_c, 1);    <- channel 1
+ *
+ * so gSerialManagerMaxInterfaces_c must count the physical interface and all
+ * channels. The virtual interfaces are used with the regular Serial_xxx API,
+ * each with its own Rx buffer and Rx callback.
+ *
+ * Frame format on the physical interface:
+ *
+ *     | 0xA5 | type:4 channel:4 | length | payload[length] | checksum |
+ *
+ * The checksum is the XOR of the type/channel, length and payload bytes.
+ * Data frames (type 0) carry at most gSerialMuxMaxPayload_c bytes, so a long
+ * transfer of a low priority channel is interleaved with the frames of higher
+ * priority channels.
+ *
+ * Credit frames (type 1) carry the 16 bit little endian count of payload
+ * bytes the receiver accepts on that channel since start-up (modulo 2^16).
+ * The sender never exceeds it. Both ends start with gSerialMuxRxWindow_c
+ * bytes of credit. An empty credit frame asks the peer to resend its credit.
+ */
+
+/* The number of logical channels (max 16) */
+#ifndef gSerialMuxMaxChannels_c
+#define gSerialMuxMaxChannels_c             (4)
+#endif
+
+/* Maximum payload of a data frame */
+#ifndef gSerialMuxMaxPayload_c
+#define gSerialMuxMaxPayload_c              (64)
+#endif
+
+/* Number of received bytes each channel can hold before the application reads them.
+Must not exceed the Rx buffer capacity of the virtual interfaces */
+#ifndef gSerialMuxRxWindow_c
+#define gSerialMuxRxWindow_c                (gSerialMgrRxBufSize_c / 2)
+#endif
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+********************************************************************************** */
+
+/* Channel multiplexer statistics */
+typedef struct serialMuxStatistics_tag{
+    uint32_t txFrames;
+    uint32_t rxFrames;
+    uint32_t rxErrors;       /* frames with bad length or checksum */
+    uint32_t rxOverflows;    /* payload bytes received without credit or not stored */
+}serialMuxStatistics_t;
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+********************************************************************************** */
+serialStatus_t SerialMux_Init (uint8_t phyInterfaceId);
+serialStatus_t SerialMux_SetPriority (uint8_t channel, uint8_t priority);
+serialStatus_t SerialMux_GetStatistics (serialMuxStatistics_t *pStats);
+
+/* Used by the Serial Manager for the gSerialMgrMux_c interfaces */
+serialStatus_t SerialMux_OpenChannel (uint8_t channel, uint8_t InterfaceId);
+serialStatus_t SerialMux_SendData (uint8_t channel, uint8_t *pData, uint16_t size);
+void           SerialMux_RxConsumed (uint8_t channel);
+
+#endif /* __SERIAL_MUX_H__ */
@@ -0,0 +1,549 @@
+/*!
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+*
+* \file
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* o Redistributions of source code must retain the above copyright notice, this list
+*   of conditions and the following disclaimer.
+*
+* o Redistributions in binary form must reproduce the above copyright notice, this
+*   list of conditions and the following disclaimer in the documentation and/or
+*   other materials provided with the distribution.
+*
+* o Neither the name of Freescale Semiconductor, Inc. nor the names of its
+*   contributors may be used to endorse or promote products derived from this
+*   software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* posix_openpt(), cfmakeraw() and clock_nanosleep() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+/*! *********************************************************************************
+*************************************************************************************
+* Include
+*************************************************************************************
+********************************************************************************** */
+#include "EmbeddedTypes.h"
+#include "SerialManager.h"
+#include "POSIX_Adapter.h"
+#include "fsl_os_abstraction.h"
+
+#if (gSerialMgrUseCustomInterface_c) && (defined(__unix__) || defined(__APPLE__))
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private macros
+*************************************************************************************
+********************************************************************************** */
+#define mPosixBitsPerByte_c      (10)   /* start + 8 data + stop */
+#define mPosixRxChunk_c          (256)
+#define mPosixRxRetryUs_c        (1000) /* retry period while the Rx buffer is full */
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private prototypes
+*************************************************************************************
+********************************************************************************** */
+static void *POSIX_SerialRxThread(void *param);
+static void *POSIX_SerialTxThread(void *param);
+static void  POSIX_SerialPace(struct timespec *pNext, uint32_t bytes);
+static uint32_t POSIX_SerialChunk(uint32_t size);
+static uint32_t POSIX_SerialStart(uint8_t InterfaceId, uint32_t baudrate, int fd, bool_t listening);
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private memory declarations
+*************************************************************************************
+********************************************************************************** */
+static pthread_mutex_t mPosixLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  mPosixCond = PTHREAD_COND_INITIALIZER;
+static pthread_t       mPosixRxThread;
+static pthread_t       mPosixTxThread;
+static volatile bool_t mPosixRunning;
+static uint8_t         mPosixInterfaceId = gSerialMgrInvalidIdx_c;
+static int             mPosixListenFd = -1;   /* Unix socket waiting for a connection */
+static int             mPosixFd = -1;         /* pty master or connected socket */
+static volatile uint32_t mPosixByteNs;        /* duration of one byte, 0 - no throttling */
+
+/* Transfer requested by the Serial Manager */
+static uint8_t        *mPosixTxData;
+static uint32_t        mPosixTxSize;
+
+static posixSerialStatistics_t mPosixStats;
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+********************************************************************************** */
+
+/*! *********************************************************************************
+* \brief   Creates a pseudo-terminal for a custom interface
+*
+* \param[in] InterfaceId the Serial Manager interface (of gSerialMgrCustom_c type)
+* \param[in] baudrate the emulated baud rate, 0 for no throttling
+* \param[out] pSlaveName location where to store the name of the slave device
+* \param[in] nameSize the size of the pSlaveName location
+*
+* \return gPosixSerialSuccess_c if the operation was successful
+*
+********************************************************************************** */
+uint32_t POSIX_SerialOpenPty(uint8_t InterfaceId, uint32_t baudrate, char *pSlaveName, uint32_t nameSize)
+{
+    struct termios tio;
+    const char *pName;
+    int fd;
+
+    if( (NULL == pSlaveName) || (0 == nameSize) )
+    {
+        return gPosixSerialInvalidParameter_c;
+    }
+
+    fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if( (fd < 0) || grantpt(fd) || unlockpt(fd) || (NULL == (pName = ptsname(fd))) )
+    {
+        if( fd >= 0 )
+        {
+            close(fd);
+        }
+        return gPosixSerialError_c;
+    }
+
+    /* Binary data, no echo or line editing */
+    if( 0 == tcgetattr(fd, &tio) )
+    {
+        cfmakeraw(&tio);
+        (void)tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    strncpy(pSlaveName, pName, nameSize - 1);
+    pSlaveName[nameSize - 1] = '\0';
+
+    return POSIX_SerialStart(InterfaceId, baudrate, fd, FALSE);
+}
+
+/*! *********************************************************************************
+* \brief   Creates a Unix domain socket for a custom interface. The first client
+*          that connects to the socket is the peer of the interface.
+*
+* \param[in] InterfaceId the Serial Manager interface (of gSerialMgrCustom_c type)
+* \param[in] baudrate the emulated baud rate, 0 for no throttling
+* \param[in] pPath the path of the socket
+*
+* \return gPosixSerialSuccess_c if the operation was successful
+*
+********************************************************************************** */
+uint32_t POSIX_SerialOpenSocket(uint8_t InterfaceId, uint32_t baudrate, const char *pPath)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if( (NULL == pPath) || (strlen(pPath) >= sizeof(addr.sun_path)) )
+    {
+        return gPosixSerialInvalidParameter_c;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, pPath);
+    (void)unlink(pPath);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if( (fd < 0) || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(fd, 1) )
+    {
+        if( fd >= 0 )
+        {
+            close(fd);
+        }
+        return gPosixSerialError_c;
+    }
+
+    return POSIX_SerialStart(InterfaceId, baudrate, fd, TRUE);
+}
+
+/*! *********************************************************************************
+* \brief   Changes the emulated baud rate
+*
+* \param[in] baudrate the new baud rate, 0 for no throttling
+*
+* \return gPosixSerialSuccess_c
+*
+********************************************************************************** */
+uint32_t POSIX_SerialSetBaudrate(uint32_t baudrate)
+{
+    mPosixByteNs = baudrate ? (uint32_t)((1000000000ULL * mPosixBitsPerByte_c) / baudrate) : 0;
+    return gPosixSerialSuccess_c;
+}
+
+/*! *********************************************************************************
+* \brief   Returns the adapter counters
+*
+* \param[out] pStats location where to store the counters
+*
+* \return gPosixSerialSuccess_c if the operation was successful
+*
+********************************************************************************** */
+uint32_t POSIX_SerialGetStatistics(posixSerialStatistics_t *pStats)
+{
+    if( NULL == pStats )
+    {
+        return gPosixSerialInvalidParameter_c;
+    }
+
+    pthread_mutex_lock(&mPosixLock);
+    *pStats = mPosixStats;
+    pthread_mutex_unlock(&mPosixLock);
+    return gPosixSerialSuccess_c;
+}
+
+/*! *********************************************************************************
+* \brief   Stops the adapter threads and closes the host file descriptors
+*
+* \return gPosixSerialSuccess_c
+*
+********************************************************************************** */
+uint32_t POSIX_SerialClose(void)
+{
+    if( !mPosixRunning )
+    {
+        return gPosixSerialSuccess_c;
+    }
+
+    pthread_mutex_lock(&mPosixLock);
+    mPosixRunning = FALSE;
+    pthread_cond_broadcast(&mPosixCond);
+    pthread_mutex_unlock(&mPosixLock);
+
+    /* Unblock the Rx thread */
+    if( mPosixListenFd >= 0 )
+    {
+        (void)shutdown(mPosixListenFd, SHUT_RDWR);
+    }
+    if( mPosixFd >= 0 )
+    {
+        (void)shutdown(mPosixFd, SHUT_RDWR);
+    }
+    (void)pthread_cancel(mPosixRxThread);
+
+    (void)pthread_join(mPosixRxThread, NULL);
+    (void)pthread_join(mPosixTxThread, NULL);
+
+    if( mPosixListenFd >= 0 )
+    {
+        close(mPosixListenFd);
+        mPosixListenFd = -1;
+    }
+    if( mPosixFd >= 0 )
+    {
+        close(mPosixFd);
+        mPosixFd = -1;
+    }
+    mPosixInterfaceId = gSerialMgrInvalidIdx_c;
+    return gPosixSerialSuccess_c;
+}
+
+/*! *********************************************************************************
+* \brief   Called by the Serial Manager to send data on the custom interface
+*
+* \param[in] pData pointer to the data
+* \param[in] size the number of bytes to be sent
+*
+* \return 0 if the transfer was started
+*
+********************************************************************************** */
+uint32_t Serial_CustomSendData(uint8_t *pData, uint32_t size)
+{
+    uint32_t status = gPosixSerialSuccess_c;
+
+    pthread_mutex_lock(&mPosixLock);
+    if( !mPosixRunning )
+    {
+        status = gPosixSerialError_c;
+    }
+    else if( mPosixTxSize )
+    {
+        status = gPosixSerialBusy_c;
+    }
+    else
+    {
+        mPosixTxData = pData;
+        mPosixTxSize = size;
+        pthread_cond_broadcast(&mPosixCond);
+    }
+    pthread_mutex_unlock(&mPosixLock);
+
+    return status;
+}
+
+/*! *********************************************************************************
+*************************************************************************************
+* Private functions
+*************************************************************************************
+********************************************************************************** */
+
+/*! *********************************************************************************
+* \brief   Starts the adapter threads on an opened file descriptor
+*
+********************************************************************************** */
+static uint32_t POSIX_SerialStart(uint8_t InterfaceId, uint32_t baudrate, int fd, bool_t listening)
+{
+    if( mPosixRunning )
+    {
+        close(fd);
+        return gPosixSerialBusy_c;
+    }
+
+    (void)POSIX_SerialSetBaudrate(baudrate);
+    memset(&mPosixStats, 0, sizeof(mPosixStats));
+    mPosixInterfaceId = InterfaceId;
+    mPosixTxSize = 0;
+    mPosixListenFd = listening ? fd : -1;
+    mPosixFd = listening ? -1 : fd;
+    mPosixRunning = TRUE;
+
+    if( pthread_create(&mPosixRxThread, NULL, POSIX_SerialRxThread, NULL) )
+    {
+        mPosixRunning = FALSE;
+        close(fd);
+        return gPosixSerialError_c;
+    }
+
+    if( pthread_create(&mPosixTxThread, NULL, POSIX_SerialTxThread, NULL) )
+    {
+        mPosixRunning = FALSE;
+        (void)pthread_cancel(mPosixRxThread);
+        (void)pthread_join(mPosixRxThread, NULL);
+        close(fd);
+        mPosixListenFd = -1;
+        mPosixFd = -1;
+        return gPosixSerialError_c;
+    }
+
+    return gPosixSerialSuccess_c;
+}
+
+/*! *********************************************************************************
+* \brief   Receives data from the host, and stores it into the Rx buffer of the
+*          interface at the emulated baud rate
+*
+********************************************************************************** */
+static void *POSIX_SerialRxThread(void *param)
+{
+    uint8_t buf[mPosixRxChunk_c];
+    struct timespec next = {0, 0};
+    uint32_t count, offset, chunk, left;
+    ssize_t n;
+    int fd;
+
+    (void)param;
+
+    if( mPosixListenFd >= 0 )
+    {
+        fd = accept(mPosixListenFd, NULL, NULL);
+        pthread_mutex_lock(&mPosixLock);
+        mPosixFd = fd;
+        pthread_cond_broadcast(&mPosixCond);
+        pthread_mutex_unlock(&mPosixLock);
+    }
+
+    while( mPosixRunning && (mPosixFd >= 0) )
+    {
+        n = read(mPosixFd, buf, sizeof(buf));
+        if( n <= 0 )
+        {
+            if( (n < 0) && (EINTR == errno) )
+            {
+                continue;
+            }
+            /* For a pty, EIO means that no process has the slave open. Wait for one. */
+            if( (n < 0) && (EIO == errno) && (mPosixListenFd < 0) )
+            {
+                usleep(mPosixRxRetryUs_c * 10);
+                continue;
+            }
+            break;
+        }
+
+        count = (uint32_t)n;
+        offset = 0;
+        while( mPosixRunning && (offset < count) )
+        {
+            chunk = POSIX_SerialChunk(count - offset);
+            POSIX_SerialPace(&next, chunk);
+
+            /* Runs as the Rx interrupt: the tasks' critical sections exclude it */
+            OSA_InterruptDisable();
+            left = Serial_CustomReceiveData(mPosixInterfaceId, &buf[offset], chunk);
+            OSA_InterruptEnable();
+            offset += chunk - left;
+
+            pthread_mutex_lock(&mPosixLock);
+            mPosixStats.rxBytes += chunk - left;
+            if( left )
+            {
+                mPosixStats.rxStalls++;
+            }
+            pthread_mutex_unlock(&mPosixLock);
+
+            if( left )
+            {
+                /* The Rx buffer is full: stop reading the host until there is space */
+                usleep(mPosixRxRetryUs_c);
+                next.tv_sec = 0;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*! *********************************************************************************
+* \brief   Sends the transfers requested by the Serial Manager at the emulated
+*          baud rate, and notifies their completion
+*
+********************************************************************************** */
+static void *POSIX_SerialTxThread(void *param)
+{
+    struct timespec next = {0, 0};
+    uint8_t *pData;
+    uint32_t size, chunk;
+    ssize_t n;
+
+    (void)param;
+
+    for( ;; )
+    {
+        pthread_mutex_lock(&mPosixLock);
+        while( mPosixRunning && ((0 == mPosixTxSize) || (mPosixFd < 0)) )
+        {
+            pthread_cond_wait(&mPosixCond, &mPosixLock);
+        }
+        pData = mPosixTxData;
+        size = mPosixTxSize;
+        pthread_mutex_unlock(&mPosixLock);
+
+        if( !mPosixRunning )
+        {
+            break;
+        }
+
+        while( size )
+        {
+            chunk = POSIX_SerialChunk(size);
+            POSIX_SerialPace(&next, chunk);
+
+            n = write(mPosixFd, pData, chunk);
+            if( n < 0 )
+            {
+                if( EINTR == errno )
+                {
+                    continue;
+                }
+                /* The peer is gone, the data is dropped */
+                break;
+            }
+            pData += n;
+            size -= (uint32_t)n;
+        }
+
+        pthread_mutex_lock(&mPosixLock);
+        mPosixStats.txBytes += mPosixTxSize;
+        mPosixStats.txTransfers++;
+        mPosixTxSize = 0;
+        pthread_mutex_unlock(&mPosixLock);
+
+        OSA_InterruptDisable();
+        Serial_CustomSendCompleted(mPosixInterfaceId);
+        OSA_InterruptEnable();
+    }
+
+    return NULL;
+}
+
+/*! *********************************************************************************
+* \brief   Returns how many bytes are handled at once: about one millisecond of
+*          data at the emulated baud rate
+*
+********************************************************************************** */
+static uint32_t POSIX_SerialChunk(uint32_t size)
+{
+    uint32_t byteNs = mPosixByteNs;
+    uint32_t chunk;
+
+    if( 0 == byteNs )
+    {
+        return size;
+    }
+
+    chunk = 1000000 / byteNs;
+    if( 0 == chunk )
+    {
+        chunk = 1;
+    }
+    return (chunk < size) ? chunk : size;
+}
+
+/*! *********************************************************************************
+* \brief   Waits until the line is free for the next bytes
+*
+* \param[in,out] pNext time when the line becomes free. Zero for an idle line.
+* \param[in] bytes the number of bytes to be transferred
+*
+********************************************************************************** */
+static void POSIX_SerialPace(struct timespec *pNext, uint32_t bytes)
+{
+    struct timespec now;
+    uint64_t ns;
+
+    if( 0 == mPosixByteNs )
+    {
+        return;
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    /* The line was idle, there is nothing to catch up */
+    if( (pNext->tv_sec < now.tv_sec) ||
+        ((pNext->tv_sec == now.tv_sec) && (pNext->tv_nsec < now.tv_nsec)) )
+    {
+        *pNext = now;
+    }
+
+    ns = (uint64_t)pNext->tv_nsec + (uint64_t)bytes * mPosixByteNs;
+    pNext->tv_sec += (time_t)(ns / 1000000000ULL);
+    pNext->tv_nsec = (long)(ns % 1000000000ULL);
+
+    /* The bytes are transferred at the end of their transmission time */
+    while( EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, pNext, NULL) )
+    {
+    }
+}
+
+#endif /* (gSerialMgrUseCustomInterface_c) && (defined(__unix__) || defined(__APPLE__)) */
@@ -0,0 +1,87 @@
+/*!
+* Copyright (c) 2015, Freescale Semiconductor, Inc.
+* Copyright 2016-2017 NXP
+*
+* \file
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* o Redistributions of source code must retain the above copyright notice, this list
+*   of conditions and the following disclaimer.
+*
+* o Redistributions in binary form must reproduce the above copyright notice, this
+*   list of conditions and the following disclaimer in the documentation and/or
+*   other materials provided with the distribution.
+*
+* o Neither the name of Freescale Semiconductor, Inc. nor the names of its
+*   contributors may be used to endorse or promote products derived from this
+*   software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+* ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __POSIX_ADAPTER_H__
+#define __POSIX_ADAPTER_H__
+
+/*
+ * Maps the Serial Manager custom interface (gSerialMgrCustom_c) onto a
+ * pseudo-terminal or a Unix domain socket, so that the serial stack (Serial
+ * Manager, FSCI, shell) can be exercised with real traffic on a Linux host.
+ *
+ * Usage, with gSerialMgrUseCustomInterface_c enabled:
+ *
+ *     Serial_InitInterface(&id, gSerialMgrCustom_c, 0);
+ *     POSIX_SerialOpenPty(id, 115200, name, sizeof(name));  <- connect to "name"
+ *
+ * The adapter threads call Serial_CustomReceiveData() and
+ * Serial_CustomSendCompleted() the way the UART interrupts would, inside
+ * OSA_InterruptDisable()/OSA_InterruptEnable(). The host OS abstraction
+ * (tools/SerialHost/OSA_Posix.c) implements these with one recursive mutex, so
+ * the critical sections of the tasks exclude the adapter threads.
+ *
+ * Both directions are paced to the configured baud rate (10 bit times per
+ * byte, 0 - no throttling). When the Rx buffer of the interface is full, the
+ * adapter stops reading the host file descriptor, like RTS flow control.
+ */
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public type definitions
+*************************************************************************************
+********************************************************************************** */
+typedef struct posixSerialStatistics_tag {
+    uint64_t txBytes;
+    uint64_t rxBytes;
+    uint32_t txTransfers;
+    uint32_t rxStalls;      /* times the reception was paused because the Rx buffer was full */
+}posixSerialStatistics_t;
+
+enum posixSerialStatus_tag {
+    gPosixSerialSuccess_c,
+    gPosixSerialInvalidParameter_c,
+    gPosixSerialBusy_c,
+    gPosixSerialError_c
+};
+
+/*! *********************************************************************************
+*************************************************************************************
+* Public functions
+*************************************************************************************
+********************************************************************************** */
+uint32_t POSIX_SerialOpenPty(uint8_t InterfaceId, uint32_t baudrate, char *pSlaveName, uint32_t nameSize);
+uint32_t POSIX_SerialOpenSocket(uint8_t InterfaceId, uint32_t baudrate, const char *pPath);
+uint32_t POSIX_SerialSetBaudrate(uint32_t baudrate);
+uint32_t POSIX_SerialGetStatistics(posixSerialStatistics_t *pStats);
+uint32_t POSIX_SerialClose(void);
+
+#endif /* __POSIX_ADAPTER_H__ */
@@ -52,6 +52,10 @@ typedef struct uartState_tag uartState_t;
 
 typedef void (*uartCallback_t)(uartState_t* state);
 
+/* Drives the RTS line (or an equivalent signal) of a UART: rxReady is 0 when the
+   peer must stop sending, and 1 when the transmission can be resumed */
+typedef void (*uartRtsHook_t)(uint32_t instance, uint32_t rxReady);
+
 struct uartState_tag {
     uartCallback_t txCb;
     uartCallback_t rxCb;
@@ -61,6 +65,8 @@ struct uartState_tag {
     uint8_t *pRxData;
     volatile uint32_t txSize;
     volatile uint32_t rxSize;
+    volatile uint32_t rxOverruns; /* number of Rx overrun errors reported by the HW */
+    uartRtsHook_t rtsHook;
 };
 
 enum uartStatus_tag {
@@ -80,6 +86,8 @@ uint32_t UART_SendData(uint32_t instance, uint8_t* pData, uint32_t size);
 uint32_t UART_ReceiveData(uint32_t instance, uint8_t* pData, uint32_t size);
 uint32_t UART_InstallRxCalback(uint32_t instance, uartCallback_t cb, uint32_t cbParam);
 uint32_t UART_InstallTxCalback(uint32_t instance, uartCallback_t cb, uint32_t cbParam);
+uint32_t UART_InstallRtsHook(uint32_t instance, uartRtsHook_t hook);
+uint32_t UART_SetRxFlowControl(uint32_t instance, uint32_t rxReady);
 uint32_t UART_IsTxActive(uint32_t instance);
 uint32_t UART_EnableLowPowerWakeup(uint32_t instance);
 uint32_t UART_DisableLowPowerWakeup(uint32_t instance);
@@ -91,6 +99,8 @@ uint32_t LPUART_SendData(uint32_t instance, uint8_t* pData, uint32_t size);
 uint32_t LPUART_ReceiveData(uint32_t instance, uint8_t* pData, uint32_t size);
 uint32_t LPUART_InstallRxCalback(uint32_t instance, uartCallback_t cb, uint32_t cbParam);
 uint32_t LPUART_InstallTxCalback(uint32_t instance, uartCallback_t cb, uint32_t cbParam);
+uint32_t LPUART_InstallRtsHook(uint32_t instance, uartRtsHook_t hook);
+uint32_t LPUART_SetRxFlowControl(uint32_t instance, uint32_t rxReady);
 uint32_t LPUART_IsTxActive(uint32_t instance);
 uint32_t LPUART_EnableLowPowerWakeup(uint32_t instance);
 uint32_t LPUART_DisableLowPowerWakeup(uint32_t instance);
@@ -102,6 +112,8 @@ uint32_t LPSCI_SendData(uint32_t instance, uint8_t* pData, uint32_t size);
 uint32_t LPSCI_ReceiveData(uint32_t instance, uint8_t* pData, uint32_t size);
 uint32_t LPSCI_InstallRxCalback(uint32_t instance, uartCallback_t cb, uint32_t cbParam);
 uint32_t LPSCI_InstallTxCalback(uint32_t instance, uartCallback_t cb, uint32_t cbParam);
+uint32_t LPSCI_InstallRtsHook(uint32_t instance, uartRtsHook_t hook);
+uint32_t LPSCI_SetRxFlowControl(uint32_t instance, uint32_t rxReady);
 uint32_t LPSCI_IsTxActive(uint32_t instance);
 uint32_t LPSCI_EnableLowPowerWakeup(uint32_t instance);
 uint32_t LPSCI_DisableLowPowerWakeup(uint32_t instance);
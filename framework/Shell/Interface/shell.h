@@ -35,8 +35,6 @@
 
 #ifndef _SHELL_H
 #define _SHELL_H
-#include <stdint.h>
-extern void APP_SendLedRgbOn(uint8_t slaveNum);
 
 /************************************************************************************
 *************************************************************************************
@@ -84,10 +82,21 @@ typedef enum
 {
     CMD_RET_SUCCESS  = 0,    /* 0 = Success */
     CMD_RET_FAILURE  = 1,    /* 1 = Failure */
-    CMD_RET_ASYNC    = 2,    /* 2 = Success, do not refresh the prompt */
+    CMD_RET_ASYNC    = 2,    /* 2 = The command goes on as a job, see shell_job_id() */
     CMD_RET_USAGE    = -1,     /* Failure, please report 'usage' error */
 }command_ret_t;
 
+/* Handler of the input lines which do not start with a registered command */
+typedef int8_t (*pfShellFallback_t)(uint8_t argc, char * argv[]);
+
+/* Statistics of the asynchronous output (SHELL_ASYNC_OUTPUT) */
+typedef struct
+{
+    uint32_t    droppedBytes;   /* bytes discarded because the output buffer was full */
+    uint32_t    droppedWrites;  /* writes discarded, in full or in part */
+    uint16_t    maxUsed;        /* highest output buffer usage, in bytes */
+}shellOutStats_t;
+
 /************************************************************************************
 *************************************************************************************
 * Public memory declarations
@@ -106,12 +115,20 @@ extern void (*pfShellProcessCommand) (char * pCmd, uint16_t length);
 #if SHELL_ENABLED
 void shell_init(char* prompt);
 void shell_cmd_finished(void);
+uint8_t shell_job_id(void);
+void shell_job_finished(uint8_t jobId);
+void shell_job_write(uint8_t jobId, char *pLine);
+#if SHELL_USE_PRINTF
+void shell_job_printf(uint8_t jobId, char * format,...);
+#endif
 void shell_refresh(void);
 void shell_change_prompt(char* prompt);
 
 uint8_t shell_register_function(cmd_tbl_t * pAddress);
 void shell_register_function_array(cmd_tbl_t * pAddress, uint8_t num);
 uint8_t shell_unregister_function(char * name);
+void shell_register_fallback(pfShellFallback_t pfFallback);
+void shell_set_raw_mode(bool_t enable);
 
 void shell_write(char *pBuff);
 void shell_writeN(char *pBuff, uint16_t n);
@@ -124,6 +141,7 @@ void shell_putc(char c);
 #if SHELL_USE_PRINTF
 uint16_t shell_printf(char * format,...);
 #endif
+void shell_get_output_stats(shellOutStats_t *pStats, bool_t clear);
 cmd_tbl_t * shell_find_command( char * cmd );
 uint8_t make_argv(char *s, uint8_t argvsz, char * argv[]);
 char * shell_get_opt(uint8_t argc, char * argv[], char *pOption);
@@ -133,10 +151,15 @@ char * shell_get_opt(uint8_t argc, char * argv[], char *pOption);
 #define shell_init(prompt)
 #define shell_refresh()
 #define shell_cmd_finished()
+#define shell_job_id()                                 0
+#define shell_job_finished(jobId)
+#define shell_job_write(jobId,pLine)
 #define shell_change_prompt(prompt)
 #define shell_register_function(pAddress)              0
 #define shell_register_function_array(pAddress,num)
 #define shell_unregister_function(name)                0
+#define shell_register_fallback(pfFallback)
+#define shell_set_raw_mode(enable)
 #define shell_write(pBuff)
 #define shell_writeN(pBuff,n)
 #define shell_writeDec(nb)
@@ -145,11 +168,13 @@ char * shell_get_opt(uint8_t argc, char * argv[], char *pOption);
 #define shell_writeHexLe(pHex,len)
 #define shell_writeBool(boolValue)
 #define shell_putc(c)
+#define shell_get_output_stats(pStats,clear)
 #define shell_find_command(cmd) NULL
 #define make_argv(s,argvsz,argv) 0
 #define shell_get_opt(argc,argv,pOption) NULL
 #if SHELL_USE_PRINTF
 #define shell_printf printf
+#define shell_job_printf(jobId,...)
 #endif
 
 #endif /* SHELL_ENABLED */
@@ -0,0 +1,265 @@
+/*!
+* \file
+*
+* Host benchmark of the FSCI frame parser (framework/FSCI/Source/FsciParser.c).
+*
+* Packets with the maximum payload are received from a memory stream, once with
+* FSCI_ParserInput() over Rx buffer sized chunks, and once with the former
+* byte-by-byte reception, which decoded and checked the whole partial packet
+* after each byte.
+*
+* Build from this directory:
+*     cc -O2 -std=gnu99 -DgFsciIncluded_c=1 \
+*        -I../../framework/common -I../../framework/FSCI/Interface \
+*        -I../../framework/FSCI/Source -I../../framework/SerialManager/Interface \
+*        -I../../framework/FunctionLib -I../../framework/MemManager/Interface \
+*        -I../../framework/Lists -o fscibench FsciParserBench.c
+* Add -DgFsciUseEscapeSeq_c=1, -DgFsciLenHas2Bytes_c=1 -DgFsciMaxPayloadLen_c=1024
+* etc. to match the firmware configuration.
+*
+* Usage: fscibench [packets] [chunk size]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The parser is built into the benchmark, with the heap instead of the MemManager */
+#define MEM_BufferAlloc(numBytes) malloc(numBytes)
+#include "FsciParser.c"
+
+memStatus_t MEM_BufferFree(void* buffer)
+{
+    free(buffer);
+    return MEM_SUCCESS_c;
+}
+
+void FLib_MemCpy(void* pDst, void* pSrc, uint32_t cBytes)
+{
+    memcpy(pDst, pSrc, cBytes);
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t Encode(const uint8_t *pIn, size_t len, uint8_t *pOut)
+{
+#if gFsciUseEscapeSeq_c
+    size_t i, n = 0;
+
+    for( i = 0; i < len; i++ )
+    {
+        if( (gFSCI_StartMarker_c == pIn[i]) || (gFSCI_EndMarker_c == pIn[i]) ||
+            (gFSCI_EscapeChar_c == pIn[i]) )
+        {
+            pOut[n++] = gFSCI_EscapeChar_c;
+            pOut[n++] = pIn[i] ^ gFSCI_EscapeChar_c;
+        }
+        else
+        {
+            pOut[n++] = pIn[i];
+        }
+    }
+    return n;
+#else
+    memcpy(pOut, pIn, len);
+    return len;
+#endif
+}
+
+/* Builds one packet with the maximum payload, as sent by the host */
+static size_t BuildPacket(uint8_t *pOut)
+{
+    clientPacketHdr_t hdr;
+    uint8_t payload[gFsciMaxPayloadLen_c];
+    uint8_t checksum = 0;
+    size_t i, n = 0;
+
+    hdr.startMarker = gFSCI_StartMarker_c;
+    hdr.opGroup = 0xA3;
+    hdr.opCode = 0x01;
+    hdr.len = gFsciMaxPayloadLen_c;
+
+    for( i = 0; i < sizeof(payload); i++ )
+    {
+        payload[i] = (uint8_t)rand();
+    }
+    for( i = 1; i < sizeof(hdr); i++ )
+    {
+        checksum ^= ((uint8_t *)&hdr)[i];
+    }
+    for( i = 0; i < sizeof(payload); i++ )
+    {
+        checksum ^= payload[i];
+    }
+
+    pOut[n++] = gFSCI_StartMarker_c;
+    n += Encode((uint8_t *)&hdr + 1, sizeof(hdr) - 1, &pOut[n]);
+    n += Encode(payload, sizeof(payload), &pOut[n]);
+    n += Encode(&checksum, 1, &pOut[n]);
+#if gFsciUseEscapeSeq_c
+    pOut[n++] = gFSCI_EndMarker_c;
+#endif
+    return n;
+}
+
+/* Former reception: the whole partial packet is decoded and checked after each byte.
+   The received bytes are kept encoded and decoded again into the packet each time,
+   so an escape character at the end of the partial packet is not lost and a decoded
+   escape character is not decoded twice. */
+static uint32_t LegacyReceive(const uint8_t *pStream, size_t size)
+{
+    static union { clientPacket_t pkt; uint8_t raw[sizeof(clientPacket_t) + 1]; } buf;
+    static uint8_t rx[2 * sizeof(clientPacket_t)];
+    clientPacket_t *pPkt = &buf.pkt;
+    uint32_t packets = 0;
+    uint16_t bytes = 0;
+    uint16_t rxBytes = 0;
+    bool_t started = FALSE;
+    uint16_t len, index;
+    uint8_t checksum;
+    size_t k;
+
+    for( k = 0; k < size; k++ )
+    {
+        if( !started )
+        {
+            rxBytes = 0;
+            if( gFSCI_StartMarker_c == pStream[k] )
+            {
+                rx[rxBytes++] = pStream[k];
+                pPkt->raw[0] = pStream[k];
+                started = TRUE;
+            }
+            continue;
+        }
+
+        rx[rxBytes++] = pStream[k];
+
+#if gFsciUseEscapeSeq_c
+        /* FSCI_decodeEscapeSeq() of the whole partial packet */
+        bytes = 0;
+        for( index = 0; index < rxBytes; index++ )
+        {
+            if( gFSCI_EscapeChar_c == rx[index] )
+            {
+                if( index + 1 == rxBytes )
+                {
+                    /* The escaped byte is not received yet */
+                    break;
+                }
+                pPkt->raw[bytes++] = rx[++index] ^ gFSCI_EscapeChar_c;
+            }
+            else
+            {
+                pPkt->raw[bytes++] = rx[index];
+            }
+        }
+#else
+        pPkt->raw[rxBytes - 1] = pStream[k];
+        bytes = rxBytes;
+#endif
+
+        /* FSCI_checkPacket() */
+        if( bytes < sizeof(clientPacketHdr_t) )
+        {
+            continue;
+        }
+        len = pPkt->structured.header.len;
+        /* The former check used >=, which rejected packets with the maximum payload
+           when gFsci_TailBytes_c is 1. The cost is measured on accepted packets. */
+        if( (bytes > sizeof(clientPacket_t)) || (rxBytes >= sizeof(rx)) || (len > gFsciMaxPayloadLen_c) )
+        {
+            started = FALSE;
+            continue;
+        }
+        if( bytes < len + sizeof(clientPacketHdr_t) + 1 )
+        {
+            continue;
+        }
+        checksum = 0;
+        for( index = 1; index < len + sizeof(clientPacketHdr_t); index++ )
+        {
+            checksum ^= pPkt->raw[index];
+        }
+        if( pPkt->structured.payload[len] == checksum )
+        {
+            packets++;
+        }
+        started = FALSE;
+    }
+
+    return packets;
+}
+
+static uint32_t ParserReceive(const uint8_t *pStream, size_t size, uint16_t chunk)
+{
+    fsciRxParser_t parser;
+    uint32_t packets = 0;
+    uint16_t n, used;
+    size_t k = 0;
+
+    memset(&parser, 0, sizeof(parser));
+
+    while( k < size )
+    {
+        n = (size - k < chunk) ? (uint16_t)(size - k) : chunk;
+        if( PACKET_IS_VALID == FSCI_ParserInput(&parser, &pStream[k], n, &used) )
+        {
+            free(FSCI_ParserTakePacket(&parser));
+            packets++;
+        }
+        k += used;
+    }
+
+    return packets;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t count = (argc > 1) ? (uint32_t)atoi(argv[1]) : 20000;
+    uint16_t chunk = (argc > 2) ? (uint16_t)atoi(argv[2]) : 64;
+    size_t maxPacket = 2 * (sizeof(clientPacketHdr_t) + gFsciMaxPayloadLen_c + 2);
+    uint8_t *pStream;
+    size_t size = 0;
+    uint32_t i, ok;
+    double t, tLegacy, tParser;
+
+    pStream = malloc((size_t)count * maxPacket);
+    if( (NULL == pStream) || (0 == chunk) )
+    {
+        return 1;
+    }
+
+    srand(1);
+    for( i = 0; i < count; i++ )
+    {
+        size += BuildPacket(&pStream[size]);
+    }
+
+    printf("%u packets of %u bytes payload, %zu bytes, escape %u, Rx chunk %u bytes\n",
+           count, (unsigned)gFsciMaxPayloadLen_c, size, (unsigned)gFsciUseEscapeSeq_c, chunk);
+
+    t = Now();
+    ok = LegacyReceive(pStream, size);
+    tLegacy = Now() - t;
+    printf("byte by byte : %6u packets  %9.1f ns/packet  %8.2f MB/s\n",
+           ok, tLegacy * 1e9 / count, size / tLegacy / 1e6);
+
+    t = Now();
+    ok = ParserReceive(pStream, size, chunk);
+    tParser = Now() - t;
+    printf("single pass  : %6u packets  %9.1f ns/packet  %8.2f MB/s\n",
+           ok, tParser * 1e9 / count, size / tParser / 1e6);
+
+    printf("speed-up     : %.1fx\n", tLegacy / tParser);
+
+    free(pStream);
+    return 0;
+}
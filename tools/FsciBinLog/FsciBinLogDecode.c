@@ -0,0 +1,406 @@
+/*!
+* \file
+*
+* Host decoder of the FSCI deferred binary log (FSCI_LogBinary() in
+* framework/FSCI/Source/FsciLogging.c).
+*
+* The firmware only sends the address of each format string, a timestamp and
+* the raw 32-bit arguments. The format strings, and the strings passed to %s,
+* are read from the ELF file of the firmware. Other FSCI packets are skipped.
+*
+* Build: cc -std=c99 -O2 -o fscibinlog FsciBinLogDecode.c
+* Usage: fscibinlog [-e] [-l2] firmware.elf [capture | /dev/ttyACM0]
+*     -e   the firmware uses escape sequences (gFsciUseEscapeSeq_c)
+*     -l2  the FSCI length has 2 bytes (gFsciLenHas2Bytes_c)
+* Without an input file, the FSCI stream is read from stdin. A serial port must
+* be in raw mode and at the right speed (e.g. stty -F /dev/ttyACM0 raw 115200).
+*/
+
+#define _DEFAULT_SOURCE
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FSCI_START_MARKER   0x02
+#define FSCI_END_MARKER     0x03
+#define FSCI_ESCAPE_CHAR    0x7F
+#define FSCI_LOGGING_OG     0xB0
+#define FSCI_BIN_LOG_OC     0x10
+#define FSCI_MAX_PAYLOAD    2048
+
+#define BIN_LOG_HDR_WORDS   3
+
+/* ELF file of the firmware, loaded in memory */
+static uint8_t *mElf;
+static size_t   mElfSize;
+
+/* Packet reception */
+static int      mEscapeSeq;
+static int      mLenSize = 1;
+static uint8_t  mPacket[4 + FSCI_MAX_PAYLOAD + 1];
+static size_t   mPacketLen;
+static int      mInPacket;
+static int      mEscape;
+
+/* Timestamp extension to 64 bits */
+static uint64_t mTimeHigh;
+static uint32_t mLastTime;
+
+static uint32_t Get16(const uint8_t *p)
+{
+    return p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t Get32(const uint8_t *p)
+{
+    return Get16(p) | (Get16(p + 2) << 16);
+}
+
+static int LoadElf(const char *pPath)
+{
+    FILE *f = fopen(pPath, "rb");
+    long size;
+
+    if( NULL == f )
+    {
+        perror(pPath);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    mElf = malloc((size_t)size);
+    if( (NULL == mElf) || (fread(mElf, 1, (size_t)size, f) != (size_t)size) )
+    {
+        fclose(f);
+        fprintf(stderr, "%s: read error\n", pPath);
+        return -1;
+    }
+    fclose(f);
+    mElfSize = (size_t)size;
+
+    /* 32-bit little endian ELF */
+    if( (mElfSize < 52) || memcmp(mElf, "\x7f" "ELF", 4) || (mElf[4] != 1) || (mElf[5] != 1) )
+    {
+        fprintf(stderr, "%s: not a 32-bit little endian ELF file\n", pPath);
+        return -1;
+    }
+    return 0;
+}
+
+/* Returns the content of the firmware image at the given address, or NULL */
+static const char *ElfLookup(uint32_t addr)
+{
+    uint32_t shoff = Get32(&mElf[32]);
+    uint32_t shentsize = Get16(&mElf[46]);
+    uint32_t shnum = Get16(&mElf[48]);
+    const uint8_t *pSh;
+    uint32_t i;
+
+    for( i = 0; i < shnum; i++ )
+    {
+        pSh = &mElf[shoff + i * shentsize];
+        if( (size_t)(pSh - mElf) + 40 > mElfSize )
+        {
+            break;
+        }
+        /* SHF_ALLOC sections with data in the file (not SHT_NOBITS) */
+        if( (Get32(&pSh[8]) & 0x2) && (Get32(&pSh[4]) != 8) &&
+            (addr >= Get32(&pSh[12])) && (addr - Get32(&pSh[12]) < Get32(&pSh[20])) &&
+            (Get32(&pSh[16]) + Get32(&pSh[20]) <= mElfSize) )
+        {
+            return (const char *)&mElf[Get32(&pSh[16]) + addr - Get32(&pSh[12])];
+        }
+    }
+    return NULL;
+}
+
+/* printf() of a format string with 32-bit arguments */
+static void PrintRecord(const char *pFmt, const uint32_t *pArgs, uint32_t argc)
+{
+    char spec[32];
+    const char *pStr;
+    size_t n;
+    uint32_t arg = 0;
+
+    while( *pFmt )
+    {
+        if( ('%' != *pFmt) || ('%' == pFmt[1]) )
+        {
+            putchar(*pFmt);
+            pFmt += ('%' == *pFmt) ? 2 : 1;
+            continue;
+        }
+
+        /* Flags, width and precision are kept, length modifiers are dropped */
+        n = 0;
+        spec[n++] = *pFmt++;
+        while( *pFmt && strchr("-+ #0123456789.*", *pFmt) && (n < sizeof(spec) - 2) )
+        {
+            if( '*' == *pFmt )
+            {
+                n += (size_t)snprintf(&spec[n], sizeof(spec) - n - 1, "%d",
+                                      (int)(arg < argc ? pArgs[arg] : 0));
+                arg++;
+                pFmt++;
+                if( n > sizeof(spec) - 2 )
+                {
+                    n = sizeof(spec) - 2;
+                }
+                continue;
+            }
+            spec[n++] = *pFmt++;
+        }
+        while( *pFmt && strchr("hlzt", *pFmt) )
+        {
+            pFmt++;
+        }
+        if( !*pFmt )
+        {
+            break;
+        }
+        spec[n++] = *pFmt;
+        spec[n] = 0;
+
+        if( arg >= argc )
+        {
+            printf("<missing>");
+        }
+        else
+        {
+            switch( *pFmt )
+            {
+            case 's':
+                pStr = ElfLookup(pArgs[arg]);
+                if( pStr && memchr(pStr, 0, mElfSize - (size_t)((const uint8_t *)pStr - mElf)) )
+                {
+                    printf(spec, pStr);
+                }
+                else
+                {
+                    printf("<0x%08x>", pArgs[arg]);
+                }
+                break;
+            case 'd':
+            case 'i':
+            case 'c':
+                printf(spec, (int)pArgs[arg]);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                printf(spec, (unsigned int)pArgs[arg]);
+                break;
+            case 'p':
+                printf("0x%08x", pArgs[arg]);
+                break;
+            default:
+                /* Floating point values are not recorded */
+                printf("<%s?>", spec);
+                break;
+            }
+        }
+        arg++;
+        pFmt++;
+    }
+}
+
+static void HandleBinLog(const uint8_t *pPayload, size_t len)
+{
+    uint32_t args[256];
+    uint32_t record;
+    uint32_t words;
+    uint32_t argc;
+    uint32_t time;
+    uint32_t i;
+    const char *pFmt;
+    uint64_t ts;
+
+    if( len < 2 )
+    {
+        return;
+    }
+    if( Get16(pPayload) )
+    {
+        printf("*** %u log records dropped\n", Get16(pPayload));
+    }
+    pPayload += 2;
+    len -= 2;
+
+    while( len >= 4 * BIN_LOG_HDR_WORDS )
+    {
+        record = Get32(pPayload);
+        words = record & 0xFF;
+        argc = (record >> 8) & 0xFF;
+        if( (words != BIN_LOG_HDR_WORDS + argc) || (4 * words > len) )
+        {
+            printf("*** malformed log record\n");
+            return;
+        }
+
+        time = Get32(&pPayload[8]);
+        if( time < mLastTime )
+        {
+            mTimeHigh += 1ULL << 32;
+        }
+        mLastTime = time;
+        ts = mTimeHigh | time;
+
+        for( i = 0; i < argc; i++ )
+        {
+            args[i] = Get32(&pPayload[4 * (BIN_LOG_HDR_WORDS + i)]);
+        }
+
+        printf("[%6llu.%06llu] ", (unsigned long long)(ts / 1000000), (unsigned long long)(ts % 1000000));
+        pFmt = ElfLookup(Get32(&pPayload[4]));
+        if( pFmt )
+        {
+            PrintRecord(pFmt, args, argc);
+        }
+        else
+        {
+            printf("<unknown format 0x%08x>\n", Get32(&pPayload[4]));
+        }
+        fflush(stdout);
+
+        pPayload += 4 * words;
+        len -= 4 * words;
+    }
+}
+
+static void HandlePacket(void)
+{
+    size_t hdrLen = 3 + (size_t)mLenSize;
+    size_t payloadLen = (1 == mLenSize) ? mPacket[3] : Get16(&mPacket[3]);
+
+    if( (FSCI_LOGGING_OG == mPacket[1]) && (FSCI_BIN_LOG_OC == mPacket[2]) )
+    {
+        HandleBinLog(&mPacket[hdrLen], payloadLen);
+    }
+}
+
+/* Byte by byte FSCI packet reception */
+static void ReceiveByte(uint8_t c)
+{
+    size_t hdrLen = 3 + (size_t)mLenSize;
+    size_t payloadLen;
+    uint8_t checksum;
+    size_t i;
+
+    /* Without escape sequences, the start marker may also appear in the data */
+    if( (FSCI_START_MARKER == c) && (mEscapeSeq || !mInPacket) )
+    {
+        mInPacket = 1;
+        mEscape = 0;
+        mPacket[0] = c;
+        mPacketLen = 1;
+        return;
+    }
+    if( !mInPacket )
+    {
+        return;
+    }
+    if( mEscapeSeq )
+    {
+        if( FSCI_END_MARKER == c )
+        {
+            mInPacket = 0;
+            return;
+        }
+        if( FSCI_ESCAPE_CHAR == c )
+        {
+            mEscape = 1;
+            return;
+        }
+        if( mEscape )
+        {
+            mEscape = 0;
+            c ^= FSCI_ESCAPE_CHAR;
+        }
+    }
+
+    mPacket[mPacketLen++] = c;
+    if( mPacketLen < hdrLen )
+    {
+        return;
+    }
+
+    payloadLen = (1 == mLenSize) ? mPacket[3] : Get16(&mPacket[3]);
+    if( payloadLen > FSCI_MAX_PAYLOAD )
+    {
+        mInPacket = 0;
+        return;
+    }
+    if( mPacketLen < hdrLen + payloadLen + 1 )
+    {
+        return;
+    }
+
+    mInPacket = 0;
+    checksum = 0;
+    for( i = 1; i < hdrLen + payloadLen; i++ )
+    {
+        checksum ^= mPacket[i];
+    }
+    if( checksum == mPacket[hdrLen + payloadLen] )
+    {
+        HandlePacket();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t buf[512];
+    ssize_t n;
+    ssize_t i;
+    int fd = STDIN_FILENO;
+    int arg = 1;
+
+    for( ; (arg < argc) && ('-' == argv[arg][0]); arg++ )
+    {
+        if( !strcmp(argv[arg], "-e") )
+        {
+            mEscapeSeq = 1;
+        }
+        else if( !strcmp(argv[arg], "-l2") )
+        {
+            mLenSize = 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if( (arg >= argc) || (argc - arg > 2) )
+    {
+        fprintf(stderr, "usage: %s [-e] [-l2] firmware.elf [capture | /dev/ttyX]\n", argv[0]);
+        return 1;
+    }
+    if( LoadElf(argv[arg]) )
+    {
+        return 1;
+    }
+    if( argc - arg == 2 )
+    {
+        fd = open(argv[arg + 1], O_RDONLY);
+        if( fd < 0 )
+        {
+            perror(argv[arg + 1]);
+            return 1;
+        }
+    }
+
+    while( (n = read(fd, buf, sizeof(buf))) > 0 )
+    {
+        for( i = 0; i < n; i++ )
+        {
+            ReceiveByte(buf[i]);
+        }
+    }
+    return 0;
+}
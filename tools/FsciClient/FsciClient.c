@@ -0,0 +1,416 @@
+/*!
+* \file
+*
+* Host side FSCI client library. See FsciClient.h.
+*/
+
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* The framing of the firmware is built into the library, with the heap instead
+   of the MemManager */
+#define MEM_BufferAlloc(numBytes) malloc(numBytes)
+#include "FsciParser.c"
+
+#include "FsciClient.h"
+
+#define FSCI_CLIENT_CNF_OG         (gFSCI_CnfOpcodeGroup_c)
+#define FSCI_CLIENT_ACK_OC         (0xFD)
+#define FSCI_CLIENT_ERROR_OC       (0xFE)
+#define FSCI_CLIENT_HDR_SIZE       (sizeof(clientPacketHdr_t))
+#define FSCI_CLIENT_MAX_FRAME      (2 * (FSCI_CLIENT_HDR_SIZE + gFsciMaxPayloadLen_c + 2))
+
+typedef struct fsciClientSync_tag{
+    int             done;
+    int             status;
+    clientPacket_t *pRsp;
+}fsciClientSync_t;
+
+memStatus_t MEM_BufferFree(void* buffer)
+{
+    free(buffer);
+    return MEM_SUCCESS_c;
+}
+
+void FLib_MemCpy(void* pDst, void* pSrc, uint32_t cBytes)
+{
+    memcpy(pDst, pSrc, cBytes);
+}
+
+double FsciClient_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Builds a frame, as FSCI_EncodePayload() of the firmware */
+static size_t FsciClient_Encode(uint8_t OG, uint8_t OC, const void *pMsg, uint16_t msgLen,
+                                uint8_t *pOut, uint8_t *pChecksum)
+{
+    clientPacketHdr_t header;
+    uint8_t checksum;
+    size_t n = 0;
+
+    header.startMarker = gFSCI_StartMarker_c;
+    header.opGroup = OG;
+    header.opCode = OC;
+    header.len = msgLen;
+
+    checksum = FSCI_computeChecksum((uint8_t *)&header + 1, sizeof(header) - 1);
+    checksum ^= FSCI_computeChecksum((void *)pMsg, msgLen);
+    *pChecksum = checksum;
+
+    pOut[n++] = gFSCI_StartMarker_c;
+#if gFsciUseEscapeSeq_c
+    n += FSCI_encodeEscapeSeq((uint8_t *)&header + 1, sizeof(header) - 1, &pOut[n]);
+    n += FSCI_encodeEscapeSeq((uint8_t *)pMsg, msgLen, &pOut[n]);
+    n += FSCI_encodeEscapeSeq(&checksum, sizeof(checksum), &pOut[n]);
+    pOut[n++] = gFSCI_EndMarker_c;
+#else
+    memcpy(&pOut[n], (uint8_t *)&header + 1, sizeof(header) - 1);
+    n += sizeof(header) - 1;
+    memcpy(&pOut[n], pMsg, msgLen);
+    n += msgLen;
+    pOut[n++] = checksum;
+#endif
+    return n;
+}
+
+/* Sends a frame, without waiting for the ACK */
+static int FsciClient_Write(fsciClient_t *pClient, uint8_t OG, uint8_t OC, const void *pMsg,
+                            uint16_t msgLen, uint8_t *pChecksum)
+{
+    uint8_t frame[FSCI_CLIENT_MAX_FRAME];
+    size_t size = FsciClient_Encode(OG, OC, pMsg, msgLen, frame, pChecksum);
+
+    pClient->txPackets++;
+    return pClient->write(pClient->pIoParam, frame, size) ? FSCI_CLIENT_IO_ERROR : FSCI_CLIENT_OK;
+}
+
+/* Completes the oldest pending request waiting for this response */
+static int FsciClient_Complete(fsciClient_t *pClient, uint8_t OG, uint8_t OC, int status,
+                               const clientPacket_t *pRsp)
+{
+    fsciClientPending_t *pOldest = NULL;
+    fsciClientPending_t *p;
+    uint32_t i;
+
+    for( i = 0; i < FSCI_CLIENT_MAX_PENDING; i++ )
+    {
+        p = &pClient->pending[i];
+        if( p->inUse && (pRsp ? ((p->rspOG == OG) && (p->rspOC == OC)) : 1) &&
+            ((NULL == pOldest) || ((int32_t)(p->order - pOldest->order) < 0)) )
+        {
+            pOldest = p;
+        }
+    }
+
+    if( NULL == pOldest )
+    {
+        return 0;
+    }
+
+    pOldest->inUse = 0;
+    pClient->pendingCount--;
+    pOldest->cb(pOldest->pParam, status, pRsp, FsciClient_Now() - pOldest->sentAt);
+    return 1;
+}
+
+static void FsciClient_HandlePacket(fsciClient_t *pClient, clientPacket_t *pPacket)
+{
+    uint8_t OG = pPacket->structured.header.opGroup;
+    uint8_t OC = pPacket->structured.header.opCode;
+    uint8_t checksum;
+
+    pClient->rxPackets++;
+
+    if( (FSCI_CLIENT_CNF_OG == OG) && (FSCI_CLIENT_ACK_OC == OC) )
+    {
+        if( pClient->ackPending && pPacket->structured.header.len &&
+            (pPacket->structured.payload[0] == pClient->ackChecksum) )
+        {
+            pClient->ackPending = 0;
+        }
+        return;
+    }
+
+    if( pClient->flags & FSCI_CLIENT_RX_ACK )
+    {
+        /* The checksum of the received packet is stored at payload[len] */
+        (void)FsciClient_Write(pClient, FSCI_CLIENT_CNF_OG, FSCI_CLIENT_ACK_OC,
+                               &pPacket->structured.payload[pPacket->structured.header.len],
+                               sizeof(uint8_t), &checksum);
+    }
+
+    if( FsciClient_Complete(pClient, OG, OC, FSCI_CLIENT_OK, pPacket) )
+    {
+        return;
+    }
+
+    /* An error reported by the device fails the oldest request */
+    if( (FSCI_CLIENT_CNF_OG == OG) && (FSCI_CLIENT_ERROR_OC == OC) && pPacket->structured.header.len &&
+        FsciClient_Complete(pClient, 0, 0, pPacket->structured.payload[0], NULL) )
+    {
+        return;
+    }
+
+    pClient->unexpected++;
+    if( pClient->rxCb )
+    {
+        pClient->rxCb(pClient->pRxParam, pPacket);
+    }
+}
+
+static void FsciClient_Expire(fsciClient_t *pClient)
+{
+    fsciClientPending_t *p;
+    double now = FsciClient_Now();
+    uint32_t i;
+
+    for( i = 0; i < FSCI_CLIENT_MAX_PENDING; i++ )
+    {
+        p = &pClient->pending[i];
+        if( p->inUse && ((now - p->sentAt) * 1000 >= pClient->timeoutMs) )
+        {
+            p->inUse = 0;
+            pClient->pendingCount--;
+            pClient->timeouts++;
+            p->cb(p->pParam, FSCI_CLIENT_TIMEOUT, NULL, now - p->sentAt);
+        }
+    }
+}
+
+static void FsciClient_SyncCb(void *pParam, int status, const clientPacket_t *pRsp, double latency)
+{
+    fsciClientSync_t *pSync = pParam;
+    size_t size;
+
+    (void)latency;
+    pSync->done = 1;
+    pSync->status = status;
+    if( pRsp )
+    {
+        size = FSCI_CLIENT_HDR_SIZE + pRsp->structured.header.len + 1;
+        pSync->pRsp = malloc(size);
+        if( pSync->pRsp )
+        {
+            memcpy(pSync->pRsp, pRsp, size);
+        }
+    }
+}
+
+void FsciClient_Init(fsciClient_t *pClient, fsciClientWrite_t write, fsciClientRead_t read,
+                     void *pIoParam, uint32_t flags)
+{
+    memset(pClient, 0, sizeof(*pClient));
+    pClient->write = write;
+    pClient->read = read;
+    pClient->pIoParam = pIoParam;
+    pClient->flags = flags;
+    pClient->timeoutMs = 1000;
+    pClient->ackTimeoutMs = 100;
+    pClient->ackRetries = 3;
+}
+
+void FsciClient_SetRxCallback(fsciClient_t *pClient, fsciClientRxCb_t cb, void *pParam)
+{
+    pClient->rxCb = cb;
+    pClient->pRxParam = pParam;
+}
+
+/* Parses received data. The callbacks are called from here, and must not send */
+void FsciClient_Input(fsciClient_t *pClient, const uint8_t *pData, size_t size)
+{
+    fsci_packetStatus_t status;
+    clientPacket_t *pPacket;
+    uint16_t chunk;
+    uint16_t used;
+
+    while( size )
+    {
+        chunk = (size > 0xFFFF) ? 0xFFFF : (uint16_t)size;
+        status = FSCI_ParserInput(&pClient->parser, pData, chunk, &used);
+        pData += used;
+        size -= used;
+
+        if( PACKET_IS_VALID == status )
+        {
+            pPacket = FSCI_ParserTakePacket(&pClient->parser);
+            FsciClient_HandlePacket(pClient, pPacket);
+            free(pPacket);
+        }
+        else if( PACKET_IS_TO_SHORT != status )
+        {
+            pClient->rxErrors++;
+        }
+    }
+}
+
+/* Reads and handles the received data, then fails the requests which timed out.
+   Returns the number of bytes received, or a negative value on error */
+int FsciClient_Poll(fsciClient_t *pClient, int timeoutMs)
+{
+    uint8_t buf[1024];
+    int n = pClient->read(pClient->pIoParam, buf, sizeof(buf), timeoutMs);
+
+    if( n > 0 )
+    {
+        FsciClient_Input(pClient, buf, (size_t)n);
+    }
+    FsciClient_Expire(pClient);
+    return (n < 0) ? FSCI_CLIENT_IO_ERROR : n;
+}
+
+/* Sends a packet. If the device acknowledges the packets, waits for the ACK and
+   sends the packet again if needed */
+int FsciClient_Send(fsciClient_t *pClient, uint8_t OG, uint8_t OC, const void *pMsg, uint16_t msgLen)
+{
+    int retries = pClient->ackRetries;
+    double deadline;
+    int status;
+
+    if( msgLen > gFsciMaxPayloadLen_c )
+    {
+        return gFsciTooBig_c;
+    }
+
+    for( ;; )
+    {
+        status = FsciClient_Write(pClient, OG, OC, pMsg, msgLen, &pClient->ackChecksum);
+        if( (FSCI_CLIENT_OK != status) || !(pClient->flags & FSCI_CLIENT_TX_ACK) )
+        {
+            return status;
+        }
+
+        pClient->ackPending = 1;
+        deadline = FsciClient_Now() + pClient->ackTimeoutMs / 1000.0;
+        while( pClient->ackPending && (FsciClient_Now() < deadline) )
+        {
+            if( FsciClient_Poll(pClient, (int)((deadline - FsciClient_Now()) * 1000) + 1) < 0 )
+            {
+                pClient->ackPending = 0;
+                return FSCI_CLIENT_IO_ERROR;
+            }
+        }
+
+        if( !pClient->ackPending )
+        {
+            return FSCI_CLIENT_OK;
+        }
+        pClient->ackPending = 0;
+
+        if( 0 == retries-- )
+        {
+            return FSCI_CLIENT_NO_ACK;
+        }
+        pClient->retries++;
+    }
+}
+
+/* Sends a request. cb is called with the first packet received with the rspOG and
+   rspOC, with an error reported by the device, or after pClient->timeoutMs.
+   Returns FSCI_CLIENT_OK if the request was sent */
+int FsciClient_RequestAsync(fsciClient_t *pClient, uint8_t OG, uint8_t OC, const void *pMsg, uint16_t msgLen,
+                            uint8_t rspOG, uint8_t rspOC, fsciClientRspCb_t cb, void *pParam)
+{
+    fsciClientPending_t *p = NULL;
+    uint32_t i;
+    int status;
+
+    for( i = 0; i < FSCI_CLIENT_MAX_PENDING; i++ )
+    {
+        if( !pClient->pending[i].inUse )
+        {
+            p = &pClient->pending[i];
+            break;
+        }
+    }
+
+    if( NULL == p )
+    {
+        return FSCI_CLIENT_BUSY;
+    }
+
+    p->cb = cb;
+    p->pParam = pParam;
+    p->rspOG = rspOG;
+    p->rspOC = rspOC;
+    p->order = pClient->nextOrder++;
+    p->sentAt = FsciClient_Now();
+    p->inUse = 1;
+    pClient->pendingCount++;
+
+    status = FsciClient_Send(pClient, OG, OC, pMsg, msgLen);
+    if( FSCI_CLIENT_OK != status )
+    {
+        if( p->inUse )
+        {
+            p->inUse = 0;
+            pClient->pendingCount--;
+        }
+        else
+        {
+            /* The response arrived while waiting for the ACK, and cb was called */
+            status = FSCI_CLIENT_OK;
+        }
+    }
+    return status;
+}
+
+/* Sends a request and waits for the response. On success, *ppRsp holds a copy of
+   the response, to be freed with free() */
+int FsciClient_Request(fsciClient_t *pClient, uint8_t OG, uint8_t OC, const void *pMsg, uint16_t msgLen,
+                       uint8_t rspOG, uint8_t rspOC, clientPacket_t **ppRsp)
+{
+    fsciClientSync_t sync;
+    int status;
+
+    memset(&sync, 0, sizeof(sync));
+    status = FsciClient_RequestAsync(pClient, OG, OC, pMsg, msgLen, rspOG, rspOC, FsciClient_SyncCb, &sync);
+
+    while( (FSCI_CLIENT_OK == status) && !sync.done )
+    {
+        if( FsciClient_Poll(pClient, pClient->timeoutMs) < 0 )
+        {
+            status = FSCI_CLIENT_IO_ERROR;
+        }
+    }
+
+    if( sync.done )
+    {
+        status = sync.status;
+    }
+
+    if( ppRsp && (FSCI_CLIENT_OK == status) )
+    {
+        *ppRsp = sync.pRsp;
+    }
+    else
+    {
+        free(sync.pRsp);
+    }
+    return status;
+}
+
+/* Fails the pending requests, and frees the packet being received */
+void FsciClient_Close(fsciClient_t *pClient)
+{
+    fsciClientPending_t *p;
+    uint32_t i;
+
+    for( i = 0; i < FSCI_CLIENT_MAX_PENDING; i++ )
+    {
+        p = &pClient->pending[i];
+        if( p->inUse )
+        {
+            p->inUse = 0;
+            p->cb(p->pParam, FSCI_CLIENT_IO_ERROR, NULL, FsciClient_Now() - p->sentAt);
+        }
+    }
+    pClient->pendingCount = 0;
+    FSCI_ParserReset(&pClient->parser);
+}
@@ -0,0 +1,120 @@
+/*!
+* \file
+*
+* Host side FSCI client library.
+*
+* The framing is not re-implemented: FsciClient.c is built with the FSCI frame
+* parser and encoding functions of the firmware (framework/FSCI/Source/FsciParser.c),
+* so the library must be compiled with the same FSCI settings as the firmware
+* (gFsciUseEscapeSeq_c, gFsciLenHas2Bytes_c, gFsciMaxPayloadLen_c, ...).
+*
+* The library does not access the serial port itself: the application provides
+* a write function and a read function with a timeout.
+*
+* The stop-and-wait ACKs are supported (gFsciTxAck_c and gFsciRxAck_c of the
+* firmware, see the FSCI_CLIENT_xxx_ACK flags). The windowed mode and the virtual
+* interfaces are not.
+*
+* Build together with the application, e.g.:
+*     cc -O2 -std=gnu99 -DgFsciIncluded_c=1 \
+*        -I../../framework/common -I../../framework/FSCI/Interface \
+*        -I../../framework/FSCI/Source -I../../framework/SerialManager/Interface \
+*        -I../../framework/FunctionLib -I../../framework/MemManager/Interface \
+*        -I../../framework/Lists -o fsciload FsciLoad.c FsciClient.c -lm
+*/
+
+#ifndef __FSCI_CLIENT_H__
+#define __FSCI_CLIENT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FsciParser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FSCI_CLIENT_MAX_PENDING
+#define FSCI_CLIENT_MAX_PENDING    (64)    /* asynchronous requests waiting for a response */
+#endif
+
+/* Flags of FsciClient_Init() */
+#define FSCI_CLIENT_TX_ACK         (1 << 0) /* the device acknowledges each packet (gFsciTxAck_c) */
+#define FSCI_CLIENT_RX_ACK         (1 << 1) /* the device waits for an ACK of each packet (gFsciRxAck_c) */
+
+/* Status of a request, besides the gFsciStatus_t values reported by the device */
+#define FSCI_CLIENT_OK             (0)
+#define FSCI_CLIENT_TIMEOUT        (-1)
+#define FSCI_CLIENT_IO_ERROR       (-2)
+#define FSCI_CLIENT_BUSY           (-3)    /* too many pending requests */
+#define FSCI_CLIENT_NO_ACK         (-4)
+
+/* Writes data to the device. Returns 0 on success */
+typedef int (*fsciClientWrite_t)(void *pParam, const uint8_t *pData, size_t size);
+
+/* Reads the available data, waiting at most timeoutMs for the first byte.
+   Returns the number of bytes read, 0 on timeout, or a negative value on error */
+typedef int (*fsciClientRead_t)(void *pParam, uint8_t *pData, size_t size, int timeoutMs);
+
+/* Called when an asynchronous request completes. pRsp is NULL if status is not
+   FSCI_CLIENT_OK, and is valid only during the call. latency is in seconds */
+typedef void (*fsciClientRspCb_t)(void *pParam, int status, const clientPacket_t *pRsp, double latency);
+
+/* Called with the received packets which are not a response */
+typedef void (*fsciClientRxCb_t)(void *pParam, const clientPacket_t *pPacket);
+
+typedef struct fsciClientPending_tag{
+    fsciClientRspCb_t cb;
+    void             *pParam;
+    double            sentAt;
+    uint32_t          order;            /* responses with the same OpGroup/OpCode complete in order */
+    uint8_t           rspOG;
+    uint8_t           rspOC;
+    uint8_t           inUse;
+}fsciClientPending_t;
+
+typedef struct fsciClient_tag{
+    fsciClientWrite_t   write;
+    fsciClientRead_t    read;
+    void               *pIoParam;
+    fsciClientRxCb_t    rxCb;
+    void               *pRxParam;
+    uint32_t            flags;
+    int                 timeoutMs;      /* response timeout of the requests */
+    int                 ackTimeoutMs;
+    int                 ackRetries;
+
+    fsciRxParser_t      parser;
+    uint8_t             ackPending;     /* waiting for the ACK of the last packet sent */
+    uint8_t             ackChecksum;    /* checksum of the last packet sent */
+    fsciClientPending_t pending[FSCI_CLIENT_MAX_PENDING];
+    uint32_t            pendingCount;
+    uint32_t            nextOrder;
+
+    /* Statistics */
+    uint32_t            txPackets;
+    uint32_t            rxPackets;
+    uint32_t            rxErrors;       /* framing and checksum errors */
+    uint32_t            retries;        /* packets sent again for lack of ACK */
+    uint32_t            timeouts;
+    uint32_t            unexpected;     /* packets which are not a response */
+}fsciClient_t;
+
+void FsciClient_Init(fsciClient_t *pClient, fsciClientWrite_t write, fsciClientRead_t read,
+                     void *pIoParam, uint32_t flags);
+void FsciClient_SetRxCallback(fsciClient_t *pClient, fsciClientRxCb_t cb, void *pParam);
+void FsciClient_Input(fsciClient_t *pClient, const uint8_t *pData, size_t size);
+int  FsciClient_Poll(fsciClient_t *pClient, int timeoutMs);
+int  FsciClient_Send(fsciClient_t *pClient, uint8_t OG, uint8_t OC, const void *pMsg, uint16_t msgLen);
+int  FsciClient_RequestAsync(fsciClient_t *pClient, uint8_t OG, uint8_t OC, const void *pMsg, uint16_t msgLen,
+                             uint8_t rspOG, uint8_t rspOC, fsciClientRspCb_t cb, void *pParam);
+int  FsciClient_Request(fsciClient_t *pClient, uint8_t OG, uint8_t OC, const void *pMsg, uint16_t msgLen,
+                        uint8_t rspOG, uint8_t rspOC, clientPacket_t **ppRsp);
+void FsciClient_Close(fsciClient_t *pClient);
+double FsciClient_Now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FSCI_CLIENT_H__ */
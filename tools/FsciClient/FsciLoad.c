@@ -0,0 +1,504 @@
+/*!
+* \file
+*
+* FSCI load generator, built on the FSCI client library (FsciClient.h).
+*
+* Replays a weighted mix of requests against a device, or against an in-process
+* stand-in built with the same framing, and reports the throughput, the latency
+* percentiles and the error rates.
+*
+* Build: see FsciClient.h.
+* Usage: fsciload [options] /dev/ttyACM0 | standin
+*     -n count     number of requests (default 1000)
+*     -c count     requests in flight (default 1)
+*     -t ms        response timeout (default 1000)
+*     -b baud      serial port speed (default 115200)
+*     -A           the device acknowledges each packet (gFsciTxAck_c)
+*     -R           the device waits for an ACK of each packet (gFsciRxAck_c)
+*     -r OG:OC:len[:weight[:rspOG:rspOC]]
+*                  adds a request to the mix, with a random payload of len bytes.
+*                  Values are hexadecimal, except len and weight. The response is
+*                  expected on OG+1 with the same OC by default. Without -r, the
+*                  mix is Fsci-Ping.Request (A3:38) with 16 bytes.
+* The stand-in answers each request on OG+1 with the same OC, echoing the payload.
+*/
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "FsciClient.h"
+
+#define MAX_MIX             (16)
+
+typedef struct mixEntry_tag{
+    uint8_t  OG;
+    uint8_t  OC;
+    uint8_t  rspOG;
+    uint8_t  rspOC;
+    uint16_t len;
+    uint32_t weight;
+    uint32_t sent;
+    uint32_t errors;
+}mixEntry_t;
+
+/* In-process device */
+typedef struct standIn_tag{
+    fsciRxParser_t parser;
+    uint32_t       flags;
+    uint8_t        out[64 * 1024];
+    size_t         outHead;
+    size_t         outTail;
+}standIn_t;
+
+static mixEntry_t mMix[MAX_MIX];
+static uint32_t   mMixCount;
+static uint32_t   mMixWeight;
+
+static double    *mLatency;
+static uint32_t   mCompleted;
+static uint32_t   mFailed;
+static uint32_t   mInFlight;
+static uint64_t   mBytes;
+
+static int        mFd = -1;
+static standIn_t  mStandIn;
+
+/*** Serial port ***/
+
+static speed_t BaudToSpeed(long baud)
+{
+    switch( baud )
+    {
+    case 9600:    return B9600;
+    case 19200:   return B19200;
+    case 38400:   return B38400;
+    case 57600:   return B57600;
+    case 115200:  return B115200;
+    case 230400:  return B230400;
+    case 460800:  return B460800;
+    case 921600:  return B921600;
+    case 1000000: return B1000000;
+    default:      return B0;
+    }
+}
+
+static int SerialOpen(const char *pPath, long baud)
+{
+    struct termios tio;
+    speed_t speed = BaudToSpeed(baud);
+    int fd;
+
+    if( B0 == speed )
+    {
+        fprintf(stderr, "unsupported speed %ld\n", baud);
+        return -1;
+    }
+
+    fd = open(pPath, O_RDWR | O_NOCTTY);
+    if( fd < 0 )
+    {
+        perror(pPath);
+        return -1;
+    }
+
+    if( 0 == tcgetattr(fd, &tio) )
+    {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+        tcflush(fd, TCIOFLUSH);
+    }
+    return fd;
+}
+
+static int SerialWrite(void *pParam, const uint8_t *pData, size_t size)
+{
+    ssize_t n;
+
+    (void)pParam;
+    while( size )
+    {
+        n = write(mFd, pData, size);
+        if( n < 0 )
+        {
+            if( EINTR == errno )
+            {
+                continue;
+            }
+            return -1;
+        }
+        pData += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static int SerialRead(void *pParam, uint8_t *pData, size_t size, int timeoutMs)
+{
+    struct pollfd pfd;
+    int n;
+
+    (void)pParam;
+    pfd.fd = mFd;
+    pfd.events = POLLIN;
+    n = poll(&pfd, 1, timeoutMs);
+    if( n <= 0 )
+    {
+        return ((n < 0) && (EINTR != errno)) ? -1 : 0;
+    }
+    n = (int)read(mFd, pData, size);
+    return ((n < 0) && (EINTR == errno || EAGAIN == errno)) ? 0 : n;
+}
+
+/*** Stand-in ***/
+
+static void StandInOutput(standIn_t *pDev, const uint8_t *pData, size_t size)
+{
+    if( pDev->outTail + size > sizeof(pDev->out) )
+    {
+        /* The client did not read the responses: drop them, as a full UART would */
+        return;
+    }
+    memcpy(&pDev->out[pDev->outTail], pData, size);
+    pDev->outTail += size;
+}
+
+/* Sends a packet, as the firmware does */
+static void StandInSend(standIn_t *pDev, uint8_t OG, uint8_t OC, const uint8_t *pMsg, uint16_t len)
+{
+    clientPacketHdr_t header;
+    uint8_t frame[2 * (sizeof(clientPacketHdr_t) + gFsciMaxPayloadLen_c + 2)];
+    uint8_t checksum;
+    size_t n = 0;
+
+    header.startMarker = gFSCI_StartMarker_c;
+    header.opGroup = OG;
+    header.opCode = OC;
+    header.len = len;
+    checksum = FSCI_computeChecksum((uint8_t *)&header + 1, sizeof(header) - 1);
+    checksum ^= FSCI_computeChecksum((void *)pMsg, len);
+
+    frame[n++] = gFSCI_StartMarker_c;
+#if gFsciUseEscapeSeq_c
+    n += FSCI_encodeEscapeSeq((uint8_t *)&header + 1, sizeof(header) - 1, &frame[n]);
+    n += FSCI_encodeEscapeSeq((uint8_t *)pMsg, len, &frame[n]);
+    n += FSCI_encodeEscapeSeq(&checksum, sizeof(checksum), &frame[n]);
+    frame[n++] = gFSCI_EndMarker_c;
+#else
+    memcpy(&frame[n], (uint8_t *)&header + 1, sizeof(header) - 1);
+    n += sizeof(header) - 1;
+    memcpy(&frame[n], pMsg, len);
+    n += len;
+    frame[n++] = checksum;
+#endif
+    StandInOutput(pDev, frame, n);
+}
+
+static int StandInWrite(void *pParam, const uint8_t *pData, size_t size)
+{
+    standIn_t *pDev = pParam;
+    fsci_packetStatus_t status;
+    clientPacket_t *pPkt;
+    uint16_t used;
+
+    while( size )
+    {
+        status = FSCI_ParserInput(&pDev->parser, pData, (uint16_t)((size > 0xFFFF) ? 0xFFFF : size), &used);
+        pData += used;
+        size -= used;
+        if( PACKET_IS_VALID != status )
+        {
+            continue;
+        }
+
+        pPkt = FSCI_ParserTakePacket(&pDev->parser);
+        if( (gFSCI_CnfOpcodeGroup_c == pPkt->structured.header.opGroup) && (0xFD == pPkt->structured.header.opCode) )
+        {
+            /* ACK of the host */
+            free(pPkt);
+            continue;
+        }
+        if( pDev->flags & FSCI_CLIENT_TX_ACK )
+        {
+            StandInSend(pDev, gFSCI_CnfOpcodeGroup_c, 0xFD,
+                        &pPkt->structured.payload[pPkt->structured.header.len], 1);
+        }
+        StandInSend(pDev, (uint8_t)(pPkt->structured.header.opGroup + 1), pPkt->structured.header.opCode,
+                    pPkt->structured.payload, pPkt->structured.header.len);
+        free(pPkt);
+    }
+    return 0;
+}
+
+static int StandInRead(void *pParam, uint8_t *pData, size_t size, int timeoutMs)
+{
+    standIn_t *pDev = pParam;
+    size_t n = pDev->outTail - pDev->outHead;
+
+    (void)timeoutMs;
+    if( n > size )
+    {
+        n = size;
+    }
+    memcpy(pData, &pDev->out[pDev->outHead], n);
+    pDev->outHead += n;
+    if( pDev->outHead == pDev->outTail )
+    {
+        pDev->outHead = pDev->outTail = 0;
+    }
+    return (int)n;
+}
+
+/*** Load generation ***/
+
+static int ParseMix(const char *pArg)
+{
+    mixEntry_t *pEntry = &mMix[mMixCount];
+    unsigned int OG, OC, rspOG, rspOC, len, weight = 1;
+    int n;
+
+    if( mMixCount >= MAX_MIX )
+    {
+        return -1;
+    }
+
+    n = sscanf(pArg, "%x:%x:%u:%u:%x:%x", &OG, &OC, &len, &weight, &rspOG, &rspOC);
+    if( (n != 3) && (n != 4) && (n != 6) )
+    {
+        return -1;
+    }
+    if( n != 6 )
+    {
+        rspOG = OG + 1;
+        rspOC = OC;
+    }
+    if( (OG > 0xFF) || (OC > 0xFF) || (rspOG > 0xFF) || (rspOC > 0xFF) ||
+        (len > gFsciMaxPayloadLen_c) || (0 == weight) )
+    {
+        return -1;
+    }
+
+    pEntry->OG = (uint8_t)OG;
+    pEntry->OC = (uint8_t)OC;
+    pEntry->rspOG = (uint8_t)rspOG;
+    pEntry->rspOC = (uint8_t)rspOC;
+    pEntry->len = (uint16_t)len;
+    pEntry->weight = weight;
+    mMixWeight += weight;
+    mMixCount++;
+    return 0;
+}
+
+static mixEntry_t *PickRequest(void)
+{
+    uint32_t r = (uint32_t)rand() % mMixWeight;
+    uint32_t i;
+
+    for( i = 0; i < mMixCount - 1; i++ )
+    {
+        if( r < mMix[i].weight )
+        {
+            break;
+        }
+        r -= mMix[i].weight;
+    }
+    return &mMix[i];
+}
+
+static void ResponseCb(void *pParam, int status, const clientPacket_t *pRsp, double latency)
+{
+    mixEntry_t *pEntry = pParam;
+
+    mInFlight--;
+    if( FSCI_CLIENT_OK == status )
+    {
+        mLatency[mCompleted++] = latency;
+        mBytes += pEntry->len + pRsp->structured.header.len;
+    }
+    else
+    {
+        pEntry->errors++;
+        mFailed++;
+    }
+}
+
+static int CompareDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double Percentile(double p)
+{
+    uint32_t i = (uint32_t)(p / 100 * mCompleted);
+
+    if( i >= mCompleted )
+    {
+        i = mCompleted - 1;
+    }
+    return mLatency[i] * 1000;
+}
+
+static void Report(const fsciClient_t *pClient, double elapsed, uint32_t sendErrors)
+{
+    uint32_t total = mCompleted + mFailed + sendErrors;
+    uint32_t i;
+
+    printf("requests     : %u in %.3f s\n", total, elapsed);
+    printf("throughput   : %.1f requests/s, %.1f payload bytes/s\n",
+           mCompleted / elapsed, mBytes / elapsed);
+    if( mCompleted )
+    {
+        qsort(mLatency, mCompleted, sizeof(double), CompareDouble);
+        printf("latency (ms) : p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n",
+               Percentile(50), Percentile(90), Percentile(99), Percentile(99.9),
+               mLatency[mCompleted - 1] * 1000);
+    }
+    printf("errors       : %u (%.2f%%): %u timeouts, %u error status, %u not sent\n",
+           mFailed + sendErrors, total ? 100.0 * (mFailed + sendErrors) / total : 0.0,
+           pClient->timeouts, mFailed - pClient->timeouts, sendErrors);
+    printf("link         : %u packets sent, %u received, %u retries, %u Rx errors, %u unexpected\n",
+           pClient->txPackets, pClient->rxPackets, pClient->retries, pClient->rxErrors, pClient->unexpected);
+    for( i = 0; i < mMixCount; i++ )
+    {
+        printf("  %02X:%02X len %3u : %u sent, %u failed\n",
+               mMix[i].OG, mMix[i].OC, mMix[i].len, mMix[i].sent, mMix[i].errors);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    fsciClient_t client;
+    uint8_t payload[gFsciMaxPayloadLen_c];
+    mixEntry_t *pEntry;
+    uint32_t count = 1000;
+    uint32_t concurrency = 1;
+    uint32_t flags = 0;
+    uint32_t sent = 0;
+    uint32_t sendErrors = 0;
+    int timeoutMs = 1000;
+    long baud = 115200;
+    double start;
+    int status;
+    int opt;
+    uint32_t i;
+
+    while( (opt = getopt(argc, argv, "n:c:t:b:ARr:")) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n': count = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'c': concurrency = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 't': timeoutMs = atoi(optarg); break;
+        case 'b': baud = strtol(optarg, NULL, 0); break;
+        case 'A': flags |= FSCI_CLIENT_TX_ACK; break;
+        case 'R': flags |= FSCI_CLIENT_RX_ACK; break;
+        case 'r':
+            if( ParseMix(optarg) )
+            {
+                fprintf(stderr, "bad request: %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            optind = argc + 1;
+            break;
+        }
+    }
+
+    if( (optind != argc - 1) || !count || !concurrency || (concurrency > FSCI_CLIENT_MAX_PENDING) )
+    {
+        fprintf(stderr, "usage: %s [-n count] [-c count] [-t ms] [-b baud] [-A] [-R] "
+                        "[-r OG:OC:len[:weight[:rspOG:rspOC]]]... /dev/ttyX | standin\n", argv[0]);
+        return 1;
+    }
+    if( 0 == mMixCount )
+    {
+        (void)ParseMix("A3:38:16");
+    }
+
+    mLatency = malloc(count * sizeof(double));
+    if( NULL == mLatency )
+    {
+        return 1;
+    }
+
+    if( !strcmp(argv[optind], "standin") )
+    {
+        mStandIn.flags = flags;
+        FsciClient_Init(&client, StandInWrite, StandInRead, &mStandIn, flags);
+    }
+    else
+    {
+        mFd = SerialOpen(argv[optind], baud);
+        if( mFd < 0 )
+        {
+            return 1;
+        }
+        FsciClient_Init(&client, SerialWrite, SerialRead, NULL, flags);
+    }
+    client.timeoutMs = timeoutMs;
+
+    start = FsciClient_Now();
+    while( (sent < count) || mInFlight )
+    {
+        while( (sent < count) && (mInFlight < concurrency) )
+        {
+            pEntry = PickRequest();
+            for( i = 0; i < pEntry->len; i++ )
+            {
+                payload[i] = (uint8_t)rand();
+            }
+
+            mInFlight++;
+            status = FsciClient_RequestAsync(&client, pEntry->OG, pEntry->OC, payload, pEntry->len,
+                                             pEntry->rspOG, pEntry->rspOC, ResponseCb, pEntry);
+            if( FSCI_CLIENT_BUSY == status )
+            {
+                mInFlight--;
+                break;
+            }
+            sent++;
+            pEntry->sent++;
+            if( FSCI_CLIENT_OK != status )
+            {
+                /* The callback was not called */
+                mInFlight--;
+                pEntry->errors++;
+                sendErrors++;
+                if( FSCI_CLIENT_IO_ERROR == status )
+                {
+                    count = sent;
+                }
+            }
+        }
+
+        if( mInFlight && (FsciClient_Poll(&client, 10) < 0) )
+        {
+            fprintf(stderr, "read error\n");
+            FsciClient_Close(&client);
+            break;
+        }
+    }
+
+    Report(&client, FsciClient_Now() - start, sendErrors);
+    FsciClient_Close(&client);
+    if( mFd >= 0 )
+    {
+        close(mFd);
+    }
+    free(mLatency);
+    return 0;
+}
@@ -0,0 +1,464 @@
+/*!
+* \file
+*
+* Host OS abstraction on POSIX threads, for running the framework serial stack
+* on Linux (see SerialHostBench.c).
+*
+* Tasks are threads. OSA_InterruptDisable() and OSA_DisableIRQGlobal() take one
+* process wide recursive mutex, which the "interrupt" threads of the host
+* adapters (POSIX_Adapter.c) also take around their calls into the Serial
+* Manager, through the Serial_Custom* functions. So a critical section of a
+* task excludes the adapter threads, as it excludes the UART interrupts on the
+* target.
+*
+* Only the services used by the serial stack are implemented: tasks, events,
+* semaphores, mutexes, time and the interrupt lock. Message queues return
+* errors.
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "EmbeddedTypes.h"
+#include "fsl_os_abstraction.h"
+
+typedef struct osaPosixTask_tag
+{
+    pthread_t      thread;
+    osaTaskPtr_t   pfTask;
+    osaTaskParam_t param;
+}osaPosixTask_t;
+
+typedef struct osaPosixSync_tag
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        value;      /* semaphore count or event flags */
+    bool_t          autoClear;
+}osaPosixSync_t;
+
+/* The tasks run their loop forever, as with an RTOS */
+const uint8_t gUseRtos_c = 1;
+
+static pthread_mutex_t mOsaIntLock;
+static pthread_once_t  mOsaIntLockOnce = PTHREAD_ONCE_INIT;
+static __thread osaPosixTask_t *mpOsaCurrentTask;
+static osaPosixTask_t  mOsaMainTask;
+
+/* Computes the absolute CLOCK_REALTIME deadline of a timed wait */
+static void OSA_PosixDeadline(struct timespec *pTs, uint32_t millisec)
+{
+    uint64_t ns;
+
+    clock_gettime(CLOCK_REALTIME, pTs);
+    ns = (uint64_t)pTs->tv_nsec + (uint64_t)millisec * 1000000ULL;
+    pTs->tv_sec += (time_t)(ns / 1000000000ULL);
+    pTs->tv_nsec = (long)(ns % 1000000000ULL);
+}
+
+/* Waits on the condition of a sync object, with its mutex taken. Returns FALSE on timeout. */
+static bool_t OSA_PosixWait(osaPosixSync_t *pSync, const struct timespec *pDeadline, uint32_t millisec)
+{
+    if( 0 == millisec )
+    {
+        return FALSE;
+    }
+    if( osaWaitForever_c == millisec )
+    {
+        pthread_cond_wait(&pSync->cond, &pSync->lock);
+        return TRUE;
+    }
+    return ETIMEDOUT != pthread_cond_timedwait(&pSync->cond, &pSync->lock, pDeadline);
+}
+
+static osaPosixSync_t *OSA_PosixSyncCreate(uint32_t value, bool_t autoClear)
+{
+    osaPosixSync_t *pSync = malloc(sizeof(osaPosixSync_t));
+
+    if( NULL != pSync )
+    {
+        pthread_mutex_init(&pSync->lock, NULL);
+        pthread_cond_init(&pSync->cond, NULL);
+        pSync->value = value;
+        pSync->autoClear = autoClear;
+    }
+    return pSync;
+}
+
+static osaStatus_t OSA_PosixSyncDestroy(void *pObject)
+{
+    osaPosixSync_t *pSync = pObject;
+
+    if( NULL == pSync )
+    {
+        return osaStatus_Error;
+    }
+    pthread_cond_destroy(&pSync->cond);
+    pthread_mutex_destroy(&pSync->lock);
+    free(pSync);
+    return osaStatus_Success;
+}
+
+static void *OSA_PosixTaskEntry(void *param)
+{
+    osaPosixTask_t *pTask = param;
+
+    mpOsaCurrentTask = pTask;
+    pTask->pfTask(pTask->param);
+    return NULL;
+}
+
+static void OSA_PosixIntLockInit(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mOsaIntLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/* ==== Tasks ==== */
+
+osaTaskId_t OSA_TaskCreate(osaThreadDef_t *thread_def, osaTaskParam_t task_param)
+{
+    osaPosixTask_t *pTask = malloc(sizeof(osaPosixTask_t));
+
+    if( NULL == pTask )
+    {
+        return NULL;
+    }
+    pTask->pfTask = thread_def->pthread;
+    pTask->param = task_param;
+    if( pthread_create(&pTask->thread, NULL, OSA_PosixTaskEntry, pTask) )
+    {
+        free(pTask);
+        return NULL;
+    }
+    return pTask;
+}
+
+osaTaskId_t OSA_TaskGetId(void)
+{
+    /* Threads not created by OSA_TaskCreate() (main, adapters) share one ID */
+    return (NULL != mpOsaCurrentTask) ? (osaTaskId_t)mpOsaCurrentTask : (osaTaskId_t)&mOsaMainTask;
+}
+
+osaStatus_t OSA_TaskYield(void)
+{
+    sched_yield();
+    return osaStatus_Success;
+}
+
+osaTaskPriority_t OSA_TaskGetPriority(osaTaskId_t taskId)
+{
+    (void)taskId;
+    return OSA_PRIORITY_NORMAL;
+}
+
+osaStatus_t OSA_TaskSetPriority(osaTaskId_t taskId, osaTaskPriority_t taskPriority)
+{
+    (void)taskId;
+    (void)taskPriority;
+    return osaStatus_Success;
+}
+
+osaStatus_t OSA_TaskDestroy(osaTaskId_t taskId)
+{
+    (void)taskId;
+    return osaStatus_Error;
+}
+
+/* ==== Time ==== */
+
+void OSA_TimeDelay(uint32_t millisec)
+{
+    struct timespec ts;
+
+    ts.tv_sec = millisec / 1000;
+    ts.tv_nsec = (long)(millisec % 1000) * 1000000L;
+    while( (0 != nanosleep(&ts, &ts)) && (EINTR == errno) )
+    {
+    }
+}
+
+uint32_t OSA_TimeGetMsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U);
+}
+
+/* ==== Semaphores ==== */
+
+osaSemaphoreId_t OSA_SemaphoreCreate(uint32_t initValue)
+{
+    return OSA_PosixSyncCreate(initValue, FALSE);
+}
+
+osaStatus_t OSA_SemaphoreDestroy(osaSemaphoreId_t semId)
+{
+    return OSA_PosixSyncDestroy(semId);
+}
+
+osaStatus_t OSA_SemaphoreWait(osaSemaphoreId_t semId, uint32_t millisec)
+{
+    osaPosixSync_t *pSync = semId;
+    osaStatus_t status = osaStatus_Success;
+    struct timespec deadline;
+
+    if( NULL == pSync )
+    {
+        return osaStatus_Error;
+    }
+
+    OSA_PosixDeadline(&deadline, millisec);
+    pthread_mutex_lock(&pSync->lock);
+    while( 0 == pSync->value )
+    {
+        if( !OSA_PosixWait(pSync, &deadline, millisec) )
+        {
+            status = osaStatus_Timeout;
+            break;
+        }
+    }
+    if( osaStatus_Success == status )
+    {
+        pSync->value--;
+    }
+    pthread_mutex_unlock(&pSync->lock);
+    return status;
+}
+
+osaStatus_t OSA_SemaphorePost(osaSemaphoreId_t semId)
+{
+    osaPosixSync_t *pSync = semId;
+
+    if( NULL == pSync )
+    {
+        return osaStatus_Error;
+    }
+
+    pthread_mutex_lock(&pSync->lock);
+    pSync->value++;
+    pthread_cond_signal(&pSync->cond);
+    pthread_mutex_unlock(&pSync->lock);
+    return osaStatus_Success;
+}
+
+/* ==== Mutexes ==== */
+
+osaMutexId_t OSA_MutexCreate(void)
+{
+    pthread_mutex_t *pMutex = malloc(sizeof(pthread_mutex_t));
+    pthread_mutexattr_t attr;
+
+    if( NULL != pMutex )
+    {
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(pMutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+    return pMutex;
+}
+
+osaStatus_t OSA_MutexLock(osaMutexId_t mutexId, uint32_t millisec)
+{
+    struct timespec deadline;
+    int err;
+
+    if( NULL == mutexId )
+    {
+        return osaStatus_Error;
+    }
+
+    if( osaWaitForever_c == millisec )
+    {
+        err = pthread_mutex_lock(mutexId);
+    }
+    else if( 0 == millisec )
+    {
+        err = pthread_mutex_trylock(mutexId);
+    }
+    else
+    {
+        OSA_PosixDeadline(&deadline, millisec);
+        err = pthread_mutex_timedlock(mutexId, &deadline);
+    }
+
+    if( 0 == err )
+    {
+        return osaStatus_Success;
+    }
+    return ((EBUSY == err) || (ETIMEDOUT == err)) ? osaStatus_Timeout : osaStatus_Error;
+}
+
+osaStatus_t OSA_MutexUnlock(osaMutexId_t mutexId)
+{
+    if( (NULL == mutexId) || pthread_mutex_unlock(mutexId) )
+    {
+        return osaStatus_Error;
+    }
+    return osaStatus_Success;
+}
+
+osaStatus_t OSA_MutexDestroy(osaMutexId_t mutexId)
+{
+    if( NULL == mutexId )
+    {
+        return osaStatus_Error;
+    }
+    pthread_mutex_destroy(mutexId);
+    free(mutexId);
+    return osaStatus_Success;
+}
+
+/* ==== Events ==== */
+
+osaEventId_t OSA_EventCreate(bool_t autoClear)
+{
+    return OSA_PosixSyncCreate(0, autoClear);
+}
+
+osaStatus_t OSA_EventSet(osaEventId_t eventId, osaEventFlags_t flagsToSet)
+{
+    osaPosixSync_t *pSync = eventId;
+
+    if( NULL == pSync )
+    {
+        return osaStatus_Error;
+    }
+
+    pthread_mutex_lock(&pSync->lock);
+    pSync->value |= flagsToSet & osaEventFlagsAll_c;
+    pthread_cond_broadcast(&pSync->cond);
+    pthread_mutex_unlock(&pSync->lock);
+    return osaStatus_Success;
+}
+
+osaStatus_t OSA_EventClear(osaEventId_t eventId, osaEventFlags_t flagsToClear)
+{
+    osaPosixSync_t *pSync = eventId;
+
+    if( NULL == pSync )
+    {
+        return osaStatus_Error;
+    }
+
+    pthread_mutex_lock(&pSync->lock);
+    pSync->value &= ~flagsToClear;
+    pthread_mutex_unlock(&pSync->lock);
+    return osaStatus_Success;
+}
+
+osaStatus_t OSA_EventWait(osaEventId_t eventId, osaEventFlags_t flagsToWait, bool_t waitAll, uint32_t millisec, osaEventFlags_t *pSetFlags)
+{
+    osaPosixSync_t *pSync = eventId;
+    osaEventFlags_t flags;
+    struct timespec deadline;
+
+    if( NULL == pSync )
+    {
+        return osaStatus_Error;
+    }
+
+    flagsToWait &= osaEventFlagsAll_c;
+    OSA_PosixDeadline(&deadline, millisec);
+    pthread_mutex_lock(&pSync->lock);
+    for( ;; )
+    {
+        flags = pSync->value & flagsToWait;
+        if( waitAll ? (flags == flagsToWait) : (0 != flags) )
+        {
+            break;
+        }
+        if( !OSA_PosixWait(pSync, &deadline, millisec) )
+        {
+            flags = pSync->value & flagsToWait;
+            break;
+        }
+    }
+    if( pSync->autoClear && (waitAll ? (flags == flagsToWait) : (0 != flags)) )
+    {
+        pSync->value &= ~flags;
+    }
+    pthread_mutex_unlock(&pSync->lock);
+
+    if( pSetFlags )
+    {
+        *pSetFlags = flags;
+    }
+    return (waitAll ? (flags == flagsToWait) : (0 != flags)) ? osaStatus_Success : osaStatus_Timeout;
+}
+
+osaStatus_t OSA_EventDestroy(osaEventId_t eventId)
+{
+    return OSA_PosixSyncDestroy(eventId);
+}
+
+/* ==== Message queues (not used by the serial stack) ==== */
+
+osaMsgQId_t OSA_MsgQCreate(uint32_t msgNo)
+{
+    (void)msgNo;
+    return NULL;
+}
+
+osaStatus_t OSA_MsgQPut(osaMsgQId_t msgQId, osaMsg_t pMessage)
+{
+    (void)msgQId;
+    (void)pMessage;
+    return osaStatus_Error;
+}
+
+osaStatus_t OSA_MsgQGet(osaMsgQId_t msgQId, osaMsg_t pMessage, uint32_t millisec)
+{
+    (void)msgQId;
+    (void)pMessage;
+    (void)millisec;
+    return osaStatus_Error;
+}
+
+osaStatus_t OSA_MsgQDestroy(osaMsgQId_t msgQId)
+{
+    (void)msgQId;
+    return osaStatus_Error;
+}
+
+/* ==== Interrupts ==== */
+
+void OSA_InterruptDisable(void)
+{
+    pthread_once(&mOsaIntLockOnce, OSA_PosixIntLockInit);
+    pthread_mutex_lock(&mOsaIntLock);
+}
+
+void OSA_InterruptEnable(void)
+{
+    pthread_mutex_unlock(&mOsaIntLock);
+}
+
+void OSA_DisableIRQGlobal(void)
+{
+    OSA_InterruptDisable();
+}
+
+void OSA_EnableIRQGlobal(void)
+{
+    OSA_InterruptEnable();
+}
+
+void OSA_InstallIntHandler(uint32_t IRQNumber, void (*handler)(void))
+{
+    (void)IRQNumber;
+    (void)handler;
+}
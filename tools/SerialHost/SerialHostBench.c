@@ -0,0 +1,345 @@
+/*!
+* \file
+*
+* Host build of the framework serial stack: the Serial Manager
+* (framework/SerialManager/Source/SerialManager.c) runs on the POSIX OS
+* abstraction (OSA_Posix.c), with a custom interface mapped on a pseudo-terminal
+* or a Unix socket by the POSIX adapter
+* (framework/SerialManager/Source/POSIX_Adapter). An application thread echoes
+* everything it receives with Serial_SyncWrite().
+*
+* Without -e or -s, the benchmark opens the pty itself, sends a stream through
+* the echo and checks it back, then measures the round trip of short packets.
+*
+* Build from this directory:
+*     cc -O2 -std=gnu99 -pthread -DgSerialMgrUseUart_c=0 \
+*        -DgSerialMgrUseCustomInterface_c=1 -DgSMGR_UseOsSemForSynchronization_c=1 \
+*        -Ihost -I../../framework/common -I../../framework/OSAbstraction/Interface \
+*        -I../../framework/SerialManager/Interface \
+*        -I../../framework/SerialManager/Source/POSIX_Adapter \
+*        -I../../framework/FunctionLib -I../../framework/Panic/Interface \
+*        -I../../framework/MemManager/Interface -I../../framework/Messaging/Interface \
+*        -I../../framework/Lists -I../../framework/GPIO -o serialhost \
+*        SerialHostBench.c OSA_Posix.c ../../framework/SerialManager/Source/SerialManager.c \
+*        ../../framework/SerialManager/Source/POSIX_Adapter/POSIX_Adapter.c \
+*        ../../framework/FunctionLib/FunctionLib.c
+* Add -DgSerialMgrRxBufSize_c=..., -DgSerialMgrTxCoalescingBufSize_c=... etc. to
+* match the firmware configuration.
+*
+* Usage: serialhost [-b baud] [-n bytes] [-p pings] [-l length] [-e | -s path]
+*     -b baud      emulated baud rate, 0 for no throttling (default 115200)
+*     -n bytes     size of the echoed stream (default 65536)
+*     -p pings     number of round trips (default 100)
+*     -l length    size of a ping (default 16)
+*     -e           only echo on the pty, whose name is printed, until stopped
+*     -s path      only echo on a Unix socket, until stopped
+*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "EmbeddedTypes.h"
+#include "SerialManager.h"
+#include "POSIX_Adapter.h"
+#include "Panic.h"
+#include "fsl_os_abstraction.h"
+
+static uint8_t mInterfaceId;
+static osaSemaphoreId_t mRxSem;
+static int mFd;
+static uint32_t mStreamSize = 65536;
+
+void panic(panicId_t id, uint32_t location, uint32_t extra1, uint32_t extra2)
+{
+    fprintf(stderr, "panic %lu %lu %lu %lu\n", (unsigned long)id, (unsigned long)location,
+            (unsigned long)extra1, (unsigned long)extra2);
+    abort();
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Called by the Serial Manager task */
+static void RxCallback(void *param)
+{
+    (void)param;
+    (void)OSA_SemaphorePost(mRxSem);
+}
+
+/* The application: echoes the received data */
+static void *EchoThread(void *param)
+{
+    uint8_t buf[256];
+    uint16_t count;
+
+    (void)param;
+
+    for( ;; )
+    {
+        (void)OSA_SemaphoreWait(mRxSem, osaWaitForever_c);
+        while( (gSerial_Success_c == Serial_Read(mInterfaceId, buf, sizeof(buf), &count)) && count )
+        {
+            if( gSerial_Success_c != Serial_SyncWrite(mInterfaceId, buf, count) )
+            {
+                fprintf(stderr, "Serial_SyncWrite failed\n");
+            }
+        }
+    }
+    return NULL;
+}
+
+static int ReadAll(uint8_t *pBuf, size_t size)
+{
+    ssize_t n;
+
+    while( size )
+    {
+        n = read(mFd, pBuf, size);
+        if( n <= 0 )
+        {
+            if( (n < 0) && (EINTR == errno) )
+            {
+                continue;
+            }
+            return -1;
+        }
+        pBuf += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static int WriteAll(const uint8_t *pBuf, size_t size)
+{
+    ssize_t n;
+
+    while( size )
+    {
+        n = write(mFd, pBuf, size);
+        if( n < 0 )
+        {
+            if( EINTR == errno )
+            {
+                continue;
+            }
+            return -1;
+        }
+        pBuf += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static void *StreamWriter(void *param)
+{
+    uint8_t buf[1024];
+    uint32_t sent = 0, chunk, i;
+
+    (void)param;
+
+    while( sent < mStreamSize )
+    {
+        chunk = (mStreamSize - sent < sizeof(buf)) ? mStreamSize - sent : sizeof(buf);
+        for( i = 0; i < chunk; i++ )
+        {
+            buf[i] = (uint8_t)((sent + i) * 7);
+        }
+        if( WriteAll(buf, chunk) )
+        {
+            break;
+        }
+        sent += chunk;
+    }
+    return NULL;
+}
+
+static int OpenSlave(const char *pName)
+{
+    struct termios tio;
+    int fd = open(pName, O_RDWR | O_NOCTTY);
+
+    if( (fd >= 0) && (0 == tcgetattr(fd, &tio)) )
+    {
+        cfmakeraw(&tio);
+        (void)tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+static int RunStream(uint32_t baud)
+{
+    uint8_t buf[1024];
+    uint32_t received = 0, chunk, i;
+    pthread_t writer;
+    double t0, t;
+
+    t0 = Now();
+    pthread_create(&writer, NULL, StreamWriter, NULL);
+    while( received < mStreamSize )
+    {
+        chunk = (mStreamSize - received < sizeof(buf)) ? mStreamSize - received : sizeof(buf);
+        if( ReadAll(buf, chunk) )
+        {
+            fprintf(stderr, "read failed\n");
+            return -1;
+        }
+        for( i = 0; i < chunk; i++ )
+        {
+            if( buf[i] != (uint8_t)((received + i) * 7) )
+            {
+                fprintf(stderr, "echo mismatch at byte %u\n", received + i);
+                return -1;
+            }
+        }
+        received += chunk;
+    }
+    t = Now() - t0;
+    pthread_join(writer, NULL);
+
+    printf("stream: %u bytes echoed in %.3f s, %.0f bytes/s", mStreamSize, t, mStreamSize / t);
+    if( baud )
+    {
+        printf(" (line %u bytes/s)", baud / 10);
+    }
+    printf("\n");
+    return 0;
+}
+
+static int RunPings(uint32_t pings, uint32_t length)
+{
+    uint8_t tx[256], rx[256];
+    double t, sum = 0, min = 1e9, max = 0;
+    uint32_t i, j;
+
+    for( i = 0; i < pings; i++ )
+    {
+        for( j = 0; j < length; j++ )
+        {
+            tx[j] = (uint8_t)(i + j);
+        }
+        t = Now();
+        if( WriteAll(tx, length) || ReadAll(rx, length) )
+        {
+            fprintf(stderr, "ping %u failed\n", i);
+            return -1;
+        }
+        t = Now() - t;
+        if( memcmp(tx, rx, length) )
+        {
+            fprintf(stderr, "ping %u: echo mismatch\n", i);
+            return -1;
+        }
+        sum += t;
+        min = (t < min) ? t : min;
+        max = (t > max) ? t : max;
+    }
+
+    if( pings )
+    {
+        printf("pings: %u x %u bytes, round trip min %.3f avg %.3f max %.3f ms\n",
+               pings, length, min * 1e3, sum / pings * 1e3, max * 1e3);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t baud = 115200, pings = 100, length = 16;
+    const char *pSocket = NULL;
+    bool_t echoOnly = FALSE;
+    posixSerialStatistics_t stats;
+    serialRxStatistics_t rxStats;
+    pthread_t echo;
+    char name[64];
+    uint32_t status;
+    int opt, ret;
+
+    while( -1 != (opt = getopt(argc, argv, "b:n:p:l:es:")) )
+    {
+        switch( opt )
+        {
+        case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'n': mStreamSize = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'p': pings = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'l': length = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'e': echoOnly = TRUE; break;
+        case 's': pSocket = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-b baud] [-n bytes] [-p pings] [-l length] [-e | -s path]\n", argv[0]);
+            return 2;
+        }
+    }
+    if( (0 == length) || (length > 256) )
+    {
+        fprintf(stderr, "the ping length must be 1..256\n");
+        return 2;
+    }
+
+    SerialManager_Init();
+    mRxSem = OSA_SemaphoreCreate(0);
+    if( (gSerial_Success_c != Serial_InitInterface(&mInterfaceId, gSerialMgrCustom_c, 0)) ||
+        (gSerial_Success_c != Serial_SetRxCallBack(mInterfaceId, RxCallback, NULL)) )
+    {
+        fprintf(stderr, "the interface could not be initialized\n");
+        return 1;
+    }
+    pthread_create(&echo, NULL, EchoThread, NULL);
+
+    if( pSocket )
+    {
+        status = POSIX_SerialOpenSocket(mInterfaceId, baud, pSocket);
+        strncpy(name, pSocket, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+    }
+    else
+    {
+        status = POSIX_SerialOpenPty(mInterfaceId, baud, name, sizeof(name));
+    }
+    if( gPosixSerialSuccess_c != status )
+    {
+        fprintf(stderr, "the adapter could not be opened (%u)\n", status);
+        return 1;
+    }
+
+    if( pSocket || echoOnly )
+    {
+        printf("echoing on %s\n", name);
+        fflush(stdout);
+        for( ;; )
+        {
+            pause();
+        }
+    }
+
+    mFd = OpenSlave(name);
+    if( mFd < 0 )
+    {
+        perror(name);
+        return 1;
+    }
+
+    ret = RunStream(baud) || RunPings(pings, length);
+
+    (void)POSIX_SerialGetStatistics(&stats);
+    (void)Serial_GetRxStatistics(mInterfaceId, &rxStats);
+    printf("adapter: rx %llu tx %llu bytes, %u transfers, %u rx stalls; drops %u, throttles %u\n",
+           (unsigned long long)stats.rxBytes, (unsigned long long)stats.txBytes,
+           stats.txTransfers, stats.rxStalls, rxStats.drops, rxStats.throttles);
+
+    close(mFd);
+    (void)POSIX_SerialClose();
+    return ret;
+}
@@ -0,0 +1,9 @@
+/* Host stand-in for the SDK/board header of the same name: the serial stack
+   built on the host uses no peripheral, see ../SerialHostBench.c */
+#ifndef HOST_FSL_DEVICE_REGISTERS_H_
+#define HOST_FSL_DEVICE_REGISTERS_H_
+
+/* Used by the GPIO adapter declarations */
+typedef int IRQn_Type;
+
+#endif
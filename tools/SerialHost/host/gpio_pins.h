@@ -0,0 +1,5 @@
+/* Host stand-in for the SDK/board header of the same name: the serial stack
+   built on the host uses no peripheral, see ../SerialHostBench.c */
+#ifndef HOST_GPIO_PINS_H_
+#define HOST_GPIO_PINS_H_
+#endif
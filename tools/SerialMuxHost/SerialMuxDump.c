@@ -0,0 +1,143 @@
+/*!
+* \file
+*
+* Example of the host demultiplexer: prints the traffic of each channel and
+* sends the lines typed on stdin to one channel.
+*
+* Build: cc -std=c99 -O2 -o muxdump SerialMuxDump.c SerialMuxHost.c
+* Usage: muxdump /dev/ttyACM0 [tx channel] [window]
+*/
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+#include "SerialMuxHost.h"
+
+static int SerialWrite(void *pParam, const uint8_t *pData, size_t size)
+{
+    int fd = *(int *)pParam;
+    ssize_t n;
+
+    while( size )
+    {
+        n = write(fd, pData, size);
+        if( n < 0 )
+        {
+            if( EINTR == errno )
+            {
+                continue;
+            }
+            return -1;
+        }
+        pData += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static void ChannelRx(void *pParam, uint8_t channel, const uint8_t *pData, uint16_t size)
+{
+    (void)pParam;
+    printf("[ch%u] ", channel);
+    fwrite(pData, 1, size, stdout);
+    if( size && ('\n' != pData[size - 1]) )
+    {
+        putchar('\n');
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    static muxHost_t mux;
+    struct termios tio;
+    uint8_t buf[256];
+    char line[512];
+    size_t pending = 0;
+    size_t sent;
+    uint8_t txChannel;
+    uint16_t window;
+    ssize_t n;
+    int fd, i;
+    fd_set fds;
+
+    if( argc < 2 )
+    {
+        fprintf(stderr, "usage: %s <tty> [tx channel] [window]\n", argv[0]);
+        return 1;
+    }
+    txChannel = (argc > 2) ? (uint8_t)atoi(argv[2]) : 0;
+    window = (argc > 3) ? (uint16_t)atoi(argv[3]) : MUX_HOST_DEFAULT_WINDOW;
+
+    fd = open(argv[1], O_RDWR | O_NOCTTY);
+    if( fd < 0 || tcgetattr(fd, &tio) )
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, B115200);
+    tcsetattr(fd, TCSANOW, &tio);
+
+    MuxHost_Init(&mux, SerialWrite, &fd, window);
+    for( i = 0; i < MUX_HOST_MAX_CHANNELS; i++ )
+    {
+        MuxHost_SetRxCallback(&mux, (uint8_t)i, ChannelRx, NULL);
+    }
+
+    for( ;; )
+    {
+        FD_ZERO(&fds);
+        FD_SET(fd, &fds);
+        /* Stop reading stdin while the previous line waits for credit */
+        if( 0 == pending )
+        {
+            FD_SET(STDIN_FILENO, &fds);
+        }
+        if( select(fd + 1, &fds, NULL, NULL, NULL) < 0 )
+        {
+            if( EINTR == errno )
+            {
+                continue;
+            }
+            break;
+        }
+
+        if( FD_ISSET(fd, &fds) )
+        {
+            n = read(fd, buf, sizeof(buf));
+            if( n <= 0 )
+            {
+                break;
+            }
+            MuxHost_Input(&mux, buf, (size_t)n);
+        }
+
+        if( (0 == pending) && FD_ISSET(STDIN_FILENO, &fds) )
+        {
+            if( NULL == fgets(line, sizeof(line), stdin) )
+            {
+                break;
+            }
+            pending = strlen(line);
+        }
+
+        if( pending )
+        {
+            sent = MuxHost_Send(&mux, txChannel, (const uint8_t *)line, pending);
+            memmove(line, &line[sent], pending - sent);
+            pending -= sent;
+        }
+    }
+
+    fprintf(stderr, "rx frames %lu, rx errors %lu, tx frames %lu\n",
+            (unsigned long)mux.rxFrames, (unsigned long)mux.rxErrors, (unsigned long)mux.txFrames);
+    close(fd);
+    return 0;
+}
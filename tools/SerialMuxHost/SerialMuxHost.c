@@ -0,0 +1,259 @@
+/*!
+* \file
+*
+* Host side demultiplexer for the serial channel multiplexer of the Serial
+* Manager. See SerialMuxHost.h.
+*/
+
+#include <string.h>
+#include "SerialMuxHost.h"
+
+#define MUX_SYNC            (0xA5)
+#define MUX_HDR_SIZE        (3)
+#define MUX_TYPE_DATA       (0)
+#define MUX_TYPE_CREDIT     (1)
+
+enum{
+    muxRxSync,
+    muxRxHeader,
+    muxRxLength,
+    muxRxPayload,
+    muxRxChecksum
+};
+
+/* Builds and writes one frame */
+static int MuxHost_WriteFrame(muxHost_t *pMux, uint8_t type, uint8_t channel,
+                              const uint8_t *pPayload, uint8_t size)
+{
+    uint8_t frame[MUX_HDR_SIZE + 255 + 1];
+    uint8_t checksum;
+    uint8_t i;
+
+    frame[0] = MUX_SYNC;
+    frame[1] = (uint8_t)((type << 4) | channel);
+    frame[2] = size;
+    checksum = frame[1] ^ frame[2];
+    for( i = 0; i < size; i++ )
+    {
+        frame[MUX_HDR_SIZE + i] = pPayload[i];
+        checksum ^= pPayload[i];
+    }
+    frame[MUX_HDR_SIZE + size] = checksum;
+
+    pMux->txFrames++;
+    return pMux->write(pMux->pWriteParam, frame, (size_t)MUX_HDR_SIZE + size + 1);
+}
+
+/* Sends the current Rx credit of a channel */
+static int MuxHost_SendCredit(muxHost_t *pMux, uint8_t channel)
+{
+    uint8_t payload[2];
+
+    payload[0] = (uint8_t)pMux->channels[channel].rxLimit;
+    payload[1] = (uint8_t)(pMux->channels[channel].rxLimit >> 8);
+    return MuxHost_WriteFrame(pMux, MUX_TYPE_CREDIT, channel, payload, sizeof(payload));
+}
+
+static void MuxHost_Frame(muxHost_t *pMux)
+{
+    uint8_t channel = pMux->rxHeader & 0x0F;
+    uint8_t type = pMux->rxHeader >> 4;
+    muxHostChannel_t *pCh;
+
+    if( channel >= MUX_HOST_MAX_CHANNELS )
+    {
+        pMux->rxErrors++;
+        return;
+    }
+
+    pCh = &pMux->channels[channel];
+    pMux->rxFrames++;
+
+    if( MUX_TYPE_DATA == type )
+    {
+        pCh->rxReceived += pMux->rxLength;
+        if( pCh->rxCb )
+        {
+            pCh->rxCb(pCh->pRxParam, channel, pMux->rxPayload, pMux->rxLength);
+        }
+
+        /* The data was consumed by the callback, so the whole window is free again.
+           Grant it in large steps to limit the number of credit frames */
+        if( (uint16_t)(pCh->rxReceived + pMux->window - pCh->rxLimit) >= (pMux->window / 2) )
+        {
+            pCh->rxLimit = pCh->rxReceived + pMux->window;
+            (void)MuxHost_SendCredit(pMux, channel);
+        }
+    }
+    else if( MUX_TYPE_CREDIT == type )
+    {
+        if( 2 == pMux->rxLength )
+        {
+            pCh->txLimit = (uint16_t)(pMux->rxPayload[0] | (pMux->rxPayload[1] << 8));
+        }
+        else
+        {
+            (void)MuxHost_SendCredit(pMux, channel);
+        }
+    }
+    else
+    {
+        pMux->rxErrors++;
+    }
+}
+
+/*
+ * Initializes the demultiplexer. window is the number of bytes each side may
+ * send before getting credit (gSerialMuxRxWindow_c of the firmware).
+ */
+void MuxHost_Init(muxHost_t *pMux, muxHostWrite_t write, void *pWriteParam, uint16_t window)
+{
+    uint32_t i;
+
+    memset(pMux, 0, sizeof(*pMux));
+    pMux->write = write;
+    pMux->pWriteParam = pWriteParam;
+    pMux->window = window;
+    pMux->rxState = muxRxSync;
+
+    for( i = 0; i < MUX_HOST_MAX_CHANNELS; i++ )
+    {
+        pMux->channels[i].txLimit = window;
+        pMux->channels[i].rxLimit = window;
+    }
+}
+
+void MuxHost_SetRxCallback(muxHost_t *pMux, uint8_t channel, muxHostRxCb_t cb, void *pParam)
+{
+    if( channel < MUX_HOST_MAX_CHANNELS )
+    {
+        pMux->channels[channel].rxCb = cb;
+        pMux->channels[channel].pRxParam = pParam;
+    }
+}
+
+/* Parses the bytes received from the serial port */
+void MuxHost_Input(muxHost_t *pMux, const uint8_t *pData, size_t size)
+{
+    uint8_t byte;
+
+    while( size-- )
+    {
+        byte = *pData++;
+
+        switch( pMux->rxState )
+        {
+        case muxRxSync:
+            if( MUX_SYNC == byte )
+            {
+                pMux->rxState = muxRxHeader;
+            }
+            break;
+
+        case muxRxHeader:
+            pMux->rxHeader = byte;
+            pMux->rxChecksum = byte;
+            pMux->rxState = muxRxLength;
+            break;
+
+        case muxRxLength:
+            if( byte > MUX_HOST_MAX_PAYLOAD )
+            {
+                pMux->rxErrors++;
+                pMux->rxState = muxRxSync;
+                break;
+            }
+            pMux->rxLength = byte;
+            pMux->rxCount = 0;
+            pMux->rxChecksum ^= byte;
+            pMux->rxState = byte ? muxRxPayload : muxRxChecksum;
+            break;
+
+        case muxRxPayload:
+            pMux->rxPayload[pMux->rxCount++] = byte;
+            pMux->rxChecksum ^= byte;
+            if( pMux->rxCount == pMux->rxLength )
+            {
+                pMux->rxState = muxRxChecksum;
+            }
+            break;
+
+        default:
+            if( byte == pMux->rxChecksum )
+            {
+                MuxHost_Frame(pMux);
+            }
+            else
+            {
+                pMux->rxErrors++;
+            }
+            pMux->rxState = muxRxSync;
+            break;
+        }
+    }
+}
+
+/*
+ * Sends data on a channel, as far as the device credit allows.
+ * Returns the number of bytes sent; the caller retries the rest after more
+ * data was received (MuxHost_TxCredit() tells how much may be sent).
+ */
+size_t MuxHost_Send(muxHost_t *pMux, uint8_t channel, const uint8_t *pData, size_t size)
+{
+    muxHostChannel_t *pCh;
+    size_t sent = 0;
+    uint16_t chunk;
+
+    if( channel >= MUX_HOST_MAX_CHANNELS )
+    {
+        return 0;
+    }
+
+    pCh = &pMux->channels[channel];
+
+    while( sent < size )
+    {
+        chunk = (uint16_t)(pCh->txLimit - pCh->txSent);
+        if( 0 == chunk )
+        {
+            break;
+        }
+        if( chunk > MUX_HOST_MAX_PAYLOAD )
+        {
+            chunk = MUX_HOST_MAX_PAYLOAD;
+        }
+        if( chunk > size - sent )
+        {
+            chunk = (uint16_t)(size - sent);
+        }
+
+        if( MuxHost_WriteFrame(pMux, MUX_TYPE_DATA, channel, &pData[sent], (uint8_t)chunk) )
+        {
+            break;
+        }
+        pCh->txSent += chunk;
+        sent += chunk;
+    }
+
+    return sent;
+}
+
+/* Returns the number of bytes that can be sent on a channel */
+uint16_t MuxHost_TxCredit(const muxHost_t *pMux, uint8_t channel)
+{
+    if( channel >= MUX_HOST_MAX_CHANNELS )
+    {
+        return 0;
+    }
+    return (uint16_t)(pMux->channels[channel].txLimit - pMux->channels[channel].txSent);
+}
+
+/* Asks the device to resend its credit, e.g. after a corrupted credit frame */
+int MuxHost_RequestCredit(muxHost_t *pMux, uint8_t channel)
+{
+    if( channel >= MUX_HOST_MAX_CHANNELS )
+    {
+        return -1;
+    }
+    return MuxHost_WriteFrame(pMux, MUX_TYPE_CREDIT, channel, NULL, 0);
+}
@@ -0,0 +1,82 @@
+/*!
+* \file
+*
+* Host side demultiplexer for the serial channel multiplexer of the Serial
+* Manager (framework/SerialManager/Interface/SerialMux.h).
+*
+* The library is portable C99 and does not access the serial port itself:
+* the application feeds the received bytes with MuxHost_Input() and provides
+* a write function for the frames to be sent.
+*
+* Build together with the application, e.g.:
+*     cc -std=c99 -O2 -o muxdump SerialMuxDump.c SerialMuxHost.c
+*/
+
+#ifndef __SERIAL_MUX_HOST_H__
+#define __SERIAL_MUX_HOST_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Must match the gSerialMuxXxx settings of the firmware */
+#ifndef MUX_HOST_MAX_CHANNELS
+#define MUX_HOST_MAX_CHANNELS      (16)
+#endif
+#ifndef MUX_HOST_MAX_PAYLOAD
+#define MUX_HOST_MAX_PAYLOAD       (64)
+#endif
+#ifndef MUX_HOST_DEFAULT_WINDOW
+#define MUX_HOST_DEFAULT_WINDOW    (16)    /* gSerialMuxRxWindow_c of the firmware */
+#endif
+
+/* Called with the payload of each data frame received on a channel */
+typedef void (*muxHostRxCb_t)(void *pParam, uint8_t channel, const uint8_t *pData, uint16_t size);
+
+/* Writes a complete frame to the serial port. Returns 0 on success */
+typedef int (*muxHostWrite_t)(void *pParam, const uint8_t *pData, size_t size);
+
+typedef struct muxHostChannel_tag{
+    muxHostRxCb_t rxCb;
+    void         *pRxParam;
+    uint16_t      txSent;       /* payload bytes sent since start-up (modulo 2^16) */
+    uint16_t      txLimit;      /* payload bytes the device accepts */
+    uint16_t      rxReceived;   /* payload bytes received since start-up */
+    uint16_t      rxLimit;      /* payload bytes granted to the device */
+}muxHostChannel_t;
+
+typedef struct muxHost_tag{
+    muxHostWrite_t   write;
+    void            *pWriteParam;
+    uint16_t         window;
+    muxHostChannel_t channels[MUX_HOST_MAX_CHANNELS];
+
+    /* Frame parser */
+    uint8_t          rxState;
+    uint8_t          rxHeader;
+    uint8_t          rxLength;
+    uint8_t          rxCount;
+    uint8_t          rxChecksum;
+    uint8_t          rxPayload[255];
+
+    /* Statistics */
+    uint32_t         rxFrames;
+    uint32_t         rxErrors;
+    uint32_t         txFrames;
+}muxHost_t;
+
+void     MuxHost_Init(muxHost_t *pMux, muxHostWrite_t write, void *pWriteParam, uint16_t window);
+void     MuxHost_SetRxCallback(muxHost_t *pMux, uint8_t channel, muxHostRxCb_t cb, void *pParam);
+void     MuxHost_Input(muxHost_t *pMux, const uint8_t *pData, size_t size);
+size_t   MuxHost_Send(muxHost_t *pMux, uint8_t channel, const uint8_t *pData, size_t size);
+uint16_t MuxHost_TxCredit(const muxHost_t *pMux, uint8_t channel);
+int      MuxHost_RequestCredit(muxHost_t *pMux, uint8_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SERIAL_MUX_HOST_H__ */